@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+"""Measure the compile-time savings of the explicit instantiation library and the module.
+
+Compiles build_time/consumer.cpp, which uses Fraction<T> and the kernels
+for every explicitly instantiated T, as UNITS separate translation units:
+once as plain header-only code and once with FRACTIONS_EXTERN_TEMPLATES
+plus source/instantiations.cpp compiled once. With --module it is also
+compiled importing the fractions module, whose interface unit
+(module/fractions.cppm) is compiled once; this needs -std=c++20 or later
+and a GCC (-fmodules-ts) or Clang with working module support. The extern
+and module builds are linked to check that every declaration is provided.
+
+Usage: build_time.py [--cxx g++] [--std c++17] [--opt -O0,-O2] [--units 4] [--module]
+"""
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def compile_unit(cxx, flags, source, output, defines, cwd=None):
+    args = [cxx] + flags + ["-D" + d for d in defines] + ["-c", source, "-o", output]
+    start = time.perf_counter()
+    subprocess.run(args, check=True, cwd=cwd)
+    return time.perf_counter() - start
+
+
+def is_clang(cxx):
+    version = subprocess.run([cxx, "--version"], check=True, capture_output=True, text=True)
+    return "clang" in version.stdout
+
+
+def prepare(build, cxx, flags, tmp):
+    """Compiles what a build needs once.
+
+    @return the unit flags, the unit defines, the seconds spent and the objects to link
+    """
+    if build == "header":
+        return flags, [], 0.0, []
+    if build == "extern":
+        obj = os.path.join(tmp, "instantiations.o")
+        library = os.path.join(ROOT, "source", "instantiations.cpp")
+        defines = ["FRACTIONS_EXTERN_TEMPLATES"]
+        return flags, defines, compile_unit(cxx, flags, library, obj, defines), [obj]
+    interface = os.path.join(ROOT, "module", "fractions.cppm")
+    obj = os.path.join(tmp, "fractions_module.o")
+    if is_clang(cxx):
+        pcm = os.path.join(tmp, "fractions.pcm")
+        start = time.perf_counter()
+        subprocess.run([cxx] + flags + ["--precompile", "-x", "c++-module", interface, "-o", pcm],
+                       check=True)
+        seconds = time.perf_counter() - start
+        seconds += compile_unit(cxx, flags, pcm, obj, [])
+        flags = flags + ["-fmodule-file=fractions=" + pcm]
+    else:
+        # GCC writes the compiled interface to gcm.cache/ in the working directory
+        flags = flags + ["-fmodules-ts"]
+        seconds = compile_unit(cxx, flags + ["-x", "c++"], interface, obj, [], cwd=tmp)
+    return flags, ["FRACTIONS_IMPORT_MODULE"], seconds, [obj]
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    parser.add_argument("--std", default="c++17")
+    parser.add_argument("--opt", default="-O0,-O2", help="comma-separated optimization flags")
+    parser.add_argument("--units", type=int, default=4, help="translation units per build")
+    parser.add_argument("--module", action="store_true", help="also time importing the module")
+    args = parser.parse_args(argv[1:])
+
+    consumer = os.path.join(ROOT, "benchmark", "build_time", "consumer.cpp")
+    builds = ("header", "extern", "module") if args.module else ("header", "extern")
+    print("{:<6}{:<9}{:>12}{:>12}{:>14}{:>10}".format(
+        "opt", "build", "s/unit", "KiB/unit", "s/all units", "saved"))
+    with tempfile.TemporaryDirectory() as tmp:
+        for opt in args.opt.split(","):
+            flags = ["-std=" + args.std, opt, "-pthread", "-I", os.path.join(ROOT, "include")]
+            totals = {}
+            for build in builds:
+                unit_flags, extra, total, objects = prepare(build, args.cxx, flags, tmp)
+                seconds, size = 0.0, 0
+                for unit in range(args.units):
+                    obj = os.path.join(tmp, "{}{}.o".format(build, unit))
+                    defines = extra + ["UNIT={}".format(unit)]
+                    if unit == 0:
+                        defines.append("BUILD_TIME_MAIN")
+                    seconds += compile_unit(args.cxx, unit_flags, consumer, obj, defines, cwd=tmp)
+                    size += os.path.getsize(obj)
+                    objects.append(obj)
+                total += seconds
+                if build != "header":
+                    subprocess.run([args.cxx, "-pthread"] + objects
+                                   + ["-o", os.path.join(tmp, "consumer")], check=True)
+                totals[build] = total
+                saved = 1.0 - total / totals["header"]
+                print("{:<6}{:<9}{:>12.2f}{:>12.1f}{:>14.2f}{:>9.0f}%".format(
+                    opt, build, seconds / args.units, size / args.units / 1024.0, total,
+                    100.0 * saved))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
@@ -0,0 +1,61 @@
+// A translation unit that uses Fraction<T> and the kernels for every explicitly instantiated T,
+// compiled repeatedly by build_time.py: including the headers, with FRACTIONS_EXTERN_TEMPLATES, or
+// importing the fractions module (FRACTIONS_IMPORT_MODULE).
+#include <cstdint>
+#include <vector>
+
+#ifdef FRACTIONS_IMPORT_MODULE
+import fractions;
+#else
+#    include <fractions/batch.hpp>
+#    include <fractions/fractions.hpp>
+#    include <fractions/kernels.hpp>
+#    include <fractions/scan.hpp>
+#endif
+
+#ifndef UNIT
+#    define UNIT 0
+#endif
+#define CONSUMER_NAME2(prefix, unit) prefix##unit
+#define CONSUMER_NAME(prefix, unit) CONSUMER_NAME2(prefix, unit)
+
+using namespace fractions;
+
+namespace {
+    template <typename T> auto work(std::vector<Fraction<T>> &v) -> T {
+        std::vector<std::uint64_t> mask(v.size() / 64 + 1);
+        normalize_all(v.data(), v.size());
+        add_all(v.data(), v.data(), v.data(), v.size());
+        sort_all(v.data(), v.data() + v.size());
+        compare_mask(v.data(), v.size(), CompareOp::Less, v[0], mask.data());
+        auto s = sum_all(v.data(), v.size()) + dot(v.data(), v.data(), v.size());
+        s = fma(s, v[1], v[2]);
+        s = s * v[0] - v[1] / v[2];
+        s += T(1);
+        s -= T(2);
+        s *= T(3);
+        return s.numer() + T(s < v[0]) + gcd(s.numer(), s.denom()) + lcm(T(4), T(6))
+               + T(argmax(v.data(), v.size()));
+    }
+
+    template <typename T> auto run() -> long {
+        std::vector<Fraction<T>> v;
+        for (int i = 1; i != 100; ++i) {
+            v.emplace_back(T(i), T(i % 7 + 1));
+        }
+        return static_cast<long>(work(v));
+    }
+}  // namespace
+
+auto CONSUMER_NAME(consume_, UNIT)() -> long {
+    return run<std::int32_t>() + run<std::int64_t>() + run<std::uint32_t>() + run<std::uint64_t>()
+#ifdef __SIZEOF_INT128__
+           + run<fractions::widened<std::int64_t>::type>()
+#endif
+        ;
+}
+
+#ifdef BUILD_TIME_MAIN
+auto consume_0() -> long;
+auto main() -> int { return consume_0() == 0 ? 1 : 0; }
+#endif
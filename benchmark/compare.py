@@ -0,0 +1,37 @@
+#!/usr/bin/env python3
+"""Compare two JSON files written by FractionsBench --json.
+
+Prints, for every benchmark present in both files, the ns/op of each run
+and the speedup of the second over the first (> 1 means faster).
+"""
+
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data["context"], {(b["name"], b["type"]): b for b in data["benchmarks"]}
+
+
+def main(argv):
+    if len(argv) != 3:
+        print("usage: compare.py BASE.json HEAD.json", file=sys.stderr)
+        return 2
+    base_ctx, base = load(argv[1])
+    head_ctx, head = load(argv[2])
+    print("{:<28}{:<8}{:>14}{:>14}{:>10}".format(
+        "benchmark", "type", base_ctx.get("label") or "base", head_ctx.get("label") or "head",
+        "speedup"))
+    for key in base:
+        if key not in head:
+            continue
+        b = base[key]["ns_per_op"]
+        h = head[key]["ns_per_op"]
+        print("{:<28}{:<8}{:>14.3f}{:>14.3f}{:>10.3f}".format(key[0], key[1], b, h, b / h))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
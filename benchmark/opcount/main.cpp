@@ -0,0 +1,275 @@
+/** @file benchmark/opcount/main.cpp
+ *  Counts the integer operations of every Fraction operator and kernel.
+ *
+ *  Each case runs over the same deterministic operands with
+ *  `CountingInt<std::int64_t>` terms and reports the average number of
+ *  additions, subtractions, multiplications, divisions, modulos, negations,
+ *  comparisons, copies and moves per operation (per element for the
+ *  kernels). The numbers do not depend on the machine, so two JSON reports
+ *  can be diffed to catch algorithmic regressions.
+ */
+
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <fractions/counting_int.hpp>
+#include <fractions/expression.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/kernels.hpp>
+#include <fractions/scan.hpp>
+#include <fractions/selection.hpp>
+#include <fractions/statistics.hpp>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "../source/harness.hpp"
+
+namespace {
+    using I = fractions::CountingInt<std::int64_t>;
+    using F = fractions::Fraction<I>;
+
+    constexpr std::size_t pool_size = 256;
+
+    /** Small operands; the denominators divide 720 so that kernel sums stay in range. */
+    struct Pool {
+        std::vector<I> n, d;
+        std::vector<F> a, b;
+
+        Pool() {
+            static const std::int64_t denoms[] = {1, 2, 3, 4, 5, 6, 8, 9, 10, 12, 15, 16, 720};
+            bench::Rng rng{0xC0C0ULL};
+            for (std::size_t i = 0; i != pool_size; ++i) {
+                const auto k = rng.range(1, 12);
+                this->n.push_back(I(k * rng.range(-1000, 1000)));
+                this->d.push_back(I(k * rng.range(1, 1000)));
+                this->a.push_back(F(I(rng.range(-1000, 1000)), I(denoms[rng.range(0, 12)])));
+                this->b.push_back(F(I(rng.range(-1000, 1000)), I(denoms[rng.range(0, 12)])));
+            }
+        }
+    };
+
+    struct Case {
+        std::string name;
+        std::size_t ops;  // operations (or elements) per run
+        std::function<void(const Pool &)> run;
+    };
+
+    struct Report {
+        std::string name;
+        double per_op[9];
+    };
+
+    auto columns() -> const char *const (&)[9] {
+        static const char *const names[9]
+            = {"add", "sub", "mul", "div", "mod", "neg", "cmp", "copy", "move"};
+        return names;
+    }
+
+    template <typename Op> auto binary(const std::string &name, Op op) -> Case {
+        return Case{name, pool_size, [op](const Pool &p) {
+                        for (std::size_t k = 0; k != pool_size; ++k) {
+                            const auto r = op(p, k);
+                            bench::do_not_optimize(r);
+                        }
+                    }};
+    }
+
+    /** Textbook addition: cross-multiply, then reduce the result. */
+    auto add_naive(const F &x, const F &y) -> F {
+        return F(x.numer() * y.denom() + y.numer() * x.denom(), x.denom() * y.denom());
+    }
+
+    auto all_cases() -> std::vector<Case> {
+        std::vector<Case> cases;
+        cases.push_back(binary("gcd", [](const Pool &p, std::size_t k) {
+            return fractions::gcd(p.n[k], p.d[k]);
+        }));
+        cases.push_back(binary("lcm", [](const Pool &p, std::size_t k) {
+            return fractions::lcm(p.n[k], p.d[k]);
+        }));
+        cases.push_back(
+            binary("construct", [](const Pool &p, std::size_t k) { return F(p.n[k], p.d[k]); }));
+        cases.push_back(binary("reduce", [](const Pool &p, std::size_t k) {
+            F f;
+            f._numer = p.n[k];
+            f._denom = p.d[k];
+            f.reduce();
+            return f;
+        }));
+        cases.push_back(
+            binary("add", [](const Pool &p, std::size_t k) { return p.a[k] + p.b[k]; }));
+        cases.push_back(binary("add_naive", [](const Pool &p, std::size_t k) {
+            return add_naive(p.a[k], p.b[k]);
+        }));
+        cases.push_back(
+            binary("sub", [](const Pool &p, std::size_t k) { return p.a[k] - p.b[k]; }));
+        cases.push_back(
+            binary("mul", [](const Pool &p, std::size_t k) { return p.a[k] * p.b[k]; }));
+        cases.push_back(
+            binary("div", [](const Pool &p, std::size_t k) { return p.a[k] / p.b[k]; }));
+        cases.push_back(binary("add_assign", [](const Pool &p, std::size_t k) {
+            auto x = p.a[k];
+            return x += p.b[k];
+        }));
+        cases.push_back(binary("sub_assign", [](const Pool &p, std::size_t k) {
+            auto x = p.a[k];
+            return x -= p.b[k];
+        }));
+        cases.push_back(binary("add_int", [](const Pool &p, std::size_t k) {
+            auto x = p.a[k];
+            return x += p.n[k];
+        }));
+        cases.push_back(binary("sub_int", [](const Pool &p, std::size_t k) {
+            auto x = p.a[k];
+            return x -= p.n[k];
+        }));
+        cases.push_back(
+            binary("mul_int", [](const Pool &p, std::size_t k) { return p.a[k] * p.n[k]; }));
+        cases.push_back(
+            binary("div_int", [](const Pool &p, std::size_t k) { return p.a[k] / p.d[k]; }));
+        cases.push_back(binary("neg", [](const Pool &p, std::size_t k) { return -p.a[k]; }));
+        cases.push_back(
+            binary("less", [](const Pool &p, std::size_t k) { return p.a[k] < p.b[k]; }));
+        cases.push_back(
+            binary("equal", [](const Pool &p, std::size_t k) { return p.a[k] == p.b[k]; }));
+        cases.push_back(binary("cross", [](const Pool &p, std::size_t k) {
+            return p.a[k].cross(p.b[k]);
+        }));
+
+        // kernels, per element
+        cases.push_back(binary("fma", [](const Pool &p, std::size_t k) {
+            return fractions::fma(p.a[k], p.b[k], p.a[(k + 1) % pool_size]);
+        }));
+        cases.push_back(binary("formula_eager", [](const Pool &p, std::size_t k) {
+            return p.a[k] * p.b[k] + p.a[(k + 1) % pool_size];
+        }));
+        cases.push_back(binary("formula_lazy", [](const Pool &p, std::size_t k) {
+            return F(fractions::lazy(p.a[k]) * fractions::lazy(p.b[k])
+                     + fractions::lazy(p.a[(k + 1) % pool_size]));
+        }));
+        cases.push_back(Case{"dot", pool_size, [](const Pool &p) {
+                                 const auto r = fractions::dot(p.a.data(), p.b.data(), pool_size);
+                                 bench::do_not_optimize(r);
+                             }});
+        cases.push_back(Case{"sum_naive", pool_size, [](const Pool &p) {
+                                 F s;
+                                 for (const auto &x : p.a) {
+                                     s += x;
+                                 }
+                                 bench::do_not_optimize(s);
+                             }});
+        cases.push_back(Case{"running_stats", pool_size, [](const Pool &p) {
+                                 const auto s = fractions::accumulate_stats(p.a.data(), pool_size);
+                                 const auto v = s.variance();
+                                 bench::do_not_optimize(v);
+                             }});
+        cases.push_back(Case{"compare_mask", pool_size, [](const Pool &p) {
+                                 std::uint64_t mask[pool_size / 64];
+                                 fractions::compare_mask(p.a.data(), pool_size,
+                                                         fractions::CompareOp::Less, p.b[0], mask);
+                                 bench::do_not_optimize(mask);
+                             }});
+        cases.push_back(Case{"argmin", pool_size, [](const Pool &p) {
+                                 const auto i = fractions::argmin(p.a.data(), pool_size);
+                                 bench::do_not_optimize(i);
+                             }});
+        cases.push_back(Case{"nth_element", pool_size, [](const Pool &p) {
+                                 auto v = p.a;
+                                 fractions::nth_element(v.data(), v.data() + pool_size / 2,
+                                                        v.data() + pool_size);
+                                 bench::do_not_optimize(v);
+                             }});
+        cases.push_back(Case{"partial_sort", pool_size, [](const Pool &p) {
+                                 auto v = p.a;
+                                 fractions::partial_sort(v.data(), v.data() + 16,
+                                                         v.data() + pool_size);
+                                 bench::do_not_optimize(v);
+                             }});
+        cases.push_back(Case{"median", pool_size, [](const Pool &p) {
+                                 auto v = p.a;
+                                 const auto m = fractions::median(v.begin(), v.end());
+                                 bench::do_not_optimize(m);
+                             }});
+        return cases;
+    }
+
+    auto count(const Case &c, const Pool &pool) -> Report {
+        fractions::reset_op_counts();
+        c.run(pool);
+        const auto o = fractions::op_counts();
+        const std::uint64_t totals[9] = {o.additions, o.subtractions, o.multiplications,
+                                         o.divisions, o.modulos,      o.negations,
+                                         o.comparisons, o.copies,     o.moves};
+        Report r;
+        r.name = c.name;
+        for (int i = 0; i != 9; ++i) {
+            r.per_op[i] = double(totals[i]) / double(c.ops);
+        }
+        return r;
+    }
+}  // namespace
+
+auto main(int argc, char **argv) -> int {
+    cxxopts::Options options(*argv, "Integer operation counts of the fractions library");
+
+    std::string filter;
+    std::string json;
+
+    // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("f,filter", "Count only cases whose name matches this regex",
+     cxxopts::value(filter)->default_value(".*"))
+    ("j,json", "Write the counts as JSON to this file", cxxopts::value(json))
+  ;
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+
+    if (result["help"].as<bool>()) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    const Pool pool;
+    const std::regex pattern(filter);
+    std::vector<Report> reports;
+    std::cout << std::left << std::setw(16) << "operation" << std::right;
+    for (const auto *col : columns()) {
+        std::cout << std::setw(9) << col;
+    }
+    std::cout << '\n' << std::fixed << std::setprecision(2);
+    for (const auto &c : all_cases()) {
+        if (!std::regex_search(c.name, pattern)) {
+            continue;
+        }
+        reports.push_back(count(c, pool));
+        std::cout << std::left << std::setw(16) << c.name << std::right;
+        for (const auto v : reports.back().per_op) {
+            std::cout << std::setw(9) << v;
+        }
+        std::cout << '\n';
+    }
+
+    if (!json.empty()) {
+        std::ofstream out(json);
+        if (!out) {
+            std::cerr << "cannot write " << json << std::endl;
+            return 1;
+        }
+        out << "{\n  \"integer\": \"int64\",\n  \"operations\": [";
+        for (std::size_t i = 0; i != reports.size(); ++i) {
+            out << "\n    {\"name\": \"" << bench::json_escape(reports[i].name) << "\"";
+            for (int j = 0; j != 9; ++j) {
+                out << ", \"" << columns()[j] << "\": " << reports[i].per_op[j];
+            }
+            out << "}" << (i + 1 != reports.size() ? "," : "");
+        }
+        out << "\n  ]\n}\n";
+    }
+    return 0;
+}
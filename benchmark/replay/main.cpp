@@ -0,0 +1,258 @@
+/** @file benchmark/replay/main.cpp
+ *  Re-executes an operation log recorded by a FRACTIONS_TRACE build.
+ *
+ *  The records are grouped by integer type and operation; each group is
+ *  replayed in log order several times and the fastest pass is reported per
+ *  operation, followed by one in-order pass over the whole log. A checksum
+ *  of all results is printed so that builds can be compared for both speed
+ *  and behaviour on the same recorded workload.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <cxxopts.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/trace.hpp>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../source/harness.hpp"
+
+namespace {
+    using fractions::Fraction;
+    using fractions::trace::Op;
+    using fractions::trace::Record;
+
+    template <typename T> auto operand(const Record &r, std::size_t i) -> Fraction<T> {
+        Fraction<T> f;
+        f._numer = static_cast<T>(r.values[i]);
+        f._denom = static_cast<T>(r.values[i + 1]);
+        return f;
+    }
+
+    template <typename T> auto hash(const Fraction<T> &f) -> std::uint64_t {
+        return static_cast<std::uint64_t>(f._numer) * 0x9E3779B97F4A7C15ULL
+               ^ static_cast<std::uint64_t>(f._denom);
+    }
+
+    /** Executes one record and returns a digest of its result. */
+    template <typename T> auto execute(const Record &r) -> std::uint64_t {
+        const auto n = static_cast<T>(r.values[2]);
+        switch (r.op) {
+            case Op::Construct:
+                return hash(Fraction<T>(static_cast<T>(r.values[0]), static_cast<T>(r.values[1])));
+            case Op::Add:
+                return hash(operand<T>(r, 0) + operand<T>(r, 2));
+            case Op::Sub:
+                return hash(operand<T>(r, 0) - operand<T>(r, 2));
+            case Op::Mul:
+                return hash(operand<T>(r, 0) * operand<T>(r, 2));
+            case Op::Div:
+                return hash(operand<T>(r, 0) / operand<T>(r, 2));
+            case Op::AddAssign: {
+                auto a = operand<T>(r, 0);
+                return hash(a += operand<T>(r, 2));
+            }
+            case Op::SubAssign: {
+                auto a = operand<T>(r, 0);
+                return hash(a -= operand<T>(r, 2));
+            }
+            case Op::MulAssign: {
+                auto a = operand<T>(r, 0);
+                return hash(a *= operand<T>(r, 2));
+            }
+            case Op::DivAssign: {
+                auto a = operand<T>(r, 0);
+                return hash(a /= operand<T>(r, 2));
+            }
+            case Op::AddInt: {
+                auto a = operand<T>(r, 0);
+                return hash(a += n);
+            }
+            case Op::SubInt: {
+                auto a = operand<T>(r, 0);
+                return hash(a -= n);
+            }
+            case Op::MulInt: {
+                auto a = operand<T>(r, 0);
+                return hash(a *= n);
+            }
+            case Op::DivInt: {
+                auto a = operand<T>(r, 0);
+                return hash(a /= n);
+            }
+            case Op::Less:
+                return operand<T>(r, 0) < operand<T>(r, 2) ? 1U : 0U;
+            case Op::Equal:
+                return operand<T>(r, 0) == operand<T>(r, 2) ? 1U : 0U;
+        }
+        return 0;
+    }
+
+    /** Type codes of the log (see trace.hpp) that this build can replay. */
+    auto dispatch(const Record &r) -> std::uint64_t {
+        switch (r.type) {
+            case 2:
+                return execute<std::int32_t>(r);
+            case 3:
+                return execute<std::int64_t>(r);
+#ifdef __SIZEOF_INT128__
+            case 4:
+                return execute<fractions::detail::int128_t>(r);
+#endif
+            case 10:
+                return execute<std::uint32_t>(r);
+            case 11:
+                return execute<std::uint64_t>(r);
+            default:
+                return 0;
+        }
+    }
+
+    auto supported(std::uint8_t type) -> bool {
+        switch (type) {
+            case 2:
+            case 3:
+#ifdef __SIZEOF_INT128__
+            case 4:
+#endif
+            case 10:
+            case 11:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    auto type_label(std::uint8_t type) -> std::string {
+        switch (type) {
+            case 2:
+                return bench::type_name<std::int32_t>();
+            case 3:
+                return bench::type_name<std::int64_t>();
+#ifdef __SIZEOF_INT128__
+            case 4:
+                return bench::type_name<fractions::detail::int128_t>();
+#endif
+            case 10:
+                return bench::type_name<std::uint32_t>();
+            case 11:
+                return bench::type_name<std::uint64_t>();
+            default:
+                return "code" + std::to_string(type);
+        }
+    }
+
+    /** Fastest of `repeat` passes over the records, in seconds. */
+    auto time_pass(const std::vector<Record> &records, int repeat, std::uint64_t &digest)
+        -> double {
+        using clock = std::chrono::steady_clock;
+        double best = 0;
+        for (int i = 0; i < repeat; ++i) {
+            std::uint64_t sum = 0;
+            const auto start = clock::now();
+            for (const auto &r : records) {
+                sum += dispatch(r);
+            }
+            bench::do_not_optimize(sum);
+            const auto elapsed = std::chrono::duration<double>(clock::now() - start).count();
+            best = i == 0 ? elapsed : std::min(best, elapsed);
+            digest = sum;
+        }
+        return best;
+    }
+
+    auto result(std::string name, std::string type, std::size_t count, double seconds)
+        -> bench::Result {
+        const auto per_op = count != 0 ? seconds / double(count) : 0.0;
+        return bench::Result{std::move(name),
+                             std::move(type),
+                             count,
+                             per_op * 1e9,
+                             per_op > 0 ? 1.0 / per_op : 0.0,
+                             0.0};
+    }
+}  // namespace
+
+auto main(int argc, char **argv) -> int {
+    cxxopts::Options options(*argv, "Replays a fractions operation log");
+
+    std::string input;
+    std::string json;
+    std::string label;
+    int repeat = 5;
+
+    // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("i,input", "The log written by a FRACTIONS_TRACE build", cxxopts::value(input))
+    ("r,repeat", "Passes per operation; the fastest is reported",
+     cxxopts::value(repeat)->default_value("5"))
+    ("j,json", "Write the results as JSON to this file", cxxopts::value(json))
+    ("label", "Label stored in the JSON context (e.g. a commit id)",
+     cxxopts::value(label)->default_value(""))
+  ;
+    // clang-format on
+
+    options.parse_positional({"input"});
+    auto parsed = options.parse(argc, argv);
+
+    if (parsed["help"].as<bool>() || input.empty()) {
+        std::cout << options.help() << std::endl;
+        return input.empty() && !parsed["help"].as<bool>() ? 1 : 0;
+    }
+
+    std::vector<Record> log;
+    if (!fractions::trace::read(input.c_str(), log)) {
+        std::cerr << "cannot read trace " << input << std::endl;
+        return 1;
+    }
+
+    // group by (type, op), keeping log order within each group
+    std::vector<Record> groups[16][fractions::trace::op_count];
+    std::vector<Record> all;
+    std::size_t skipped = 0;
+    for (const auto &r : log) {
+        if (!supported(r.type)) {
+            ++skipped;
+            continue;
+        }
+        groups[r.type][static_cast<std::size_t>(r.op)].push_back(r);
+        all.push_back(r);
+    }
+
+    std::vector<bench::Result> results;
+    std::uint64_t digest = 0;
+    bench::print_header(std::cout);
+    for (std::uint8_t type = 0; type != 16; ++type) {
+        for (std::size_t op = 0; op != fractions::trace::op_count; ++op) {
+            const auto &records = groups[type][op];
+            if (records.empty()) {
+                continue;
+            }
+            const auto seconds = time_pass(records, repeat, digest);
+            results.push_back(result(fractions::trace::name(static_cast<Op>(op)),
+                                     type_label(type), records.size(), seconds));
+            bench::print_row(std::cout, results.back());
+        }
+    }
+    const auto seconds = time_pass(all, repeat, digest);
+    results.push_back(result("replay_all", "mixed", all.size(), seconds));
+    bench::print_row(std::cout, results.back());
+
+    std::cout << "\nrecords: " << log.size() << ", replayed: " << all.size()
+              << ", skipped (unsupported type): " << skipped << ", checksum: " << std::hex
+              << digest << std::dec << std::endl;
+
+    if (!json.empty()) {
+        std::ofstream out(json);
+        if (!out) {
+            std::cerr << "cannot write " << json << std::endl;
+            return 1;
+        }
+        bench::write_json(out, results, label);
+    }
+    return 0;
+}
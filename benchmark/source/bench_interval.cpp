@@ -0,0 +1,106 @@
+#include <cstdint>
+#include <fractions/fractions.hpp>
+#include <fractions/interval.hpp>
+#include <string>
+
+#include "harness.hpp"
+
+using fractions::Fraction;
+using fractions::RationalInterval;
+
+namespace {
+
+    /** Bits of the magnitude of v. */
+    template <typename T> auto bits(T v) -> double {
+        int n = 0;
+        for (; v != 0; v /= 2) {
+            ++n;
+        }
+        return n;
+    }
+
+    template <typename T> auto term_bits(const Fraction<T> &x) -> double {
+        const auto n = bits(x.numer()), d = bits(x.denom());
+        return n < d ? d : n;
+    }
+
+    /**
+     * x <- x^2 / 4 + 1/5 from x = 1/3, which contracts towards
+     * 2 - 2 sqrt(4/5). Exact arithmetic about doubles the term size every
+     * step; the enclosure keeps it below the bits of max_denom.
+     */
+    template <typename X> auto step(const X &x, const X &quarter, const X &fifth) -> X {
+        return x * x * quarter + fifth;
+    }
+
+    /** One operation is one step; the chain restarts from 1/3 every length steps. */
+    template <typename T> void add_interval_chain(int length, T max_denom) {
+        using I = RationalInterval<T>;
+        const auto start = I(Fraction<T>(T(1), T(3)), max_denom);
+        const auto quarter = I(Fraction<T>(T(1), T(4)), max_denom);
+        const auto fifth = I(Fraction<T>(T(1), T(5)), max_denom);
+        auto x = start;
+        for (int i = 0; i != length; ++i) {
+            x = step(x, quarter, fifth);
+        }
+        const auto name = "interval_chain_" + std::to_string(length) + "_d2^"
+                          + std::to_string(int(bits(max_denom)) - 1);
+        auto &c = bench::add(name, bench::type_name<T>(), [=](std::uint64_t iters) {
+            auto y = start;
+            int k = 0;
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                y = step(y, quarter, fifth);
+                bench::do_not_optimize(y);
+                if (++k == length) {
+                    y = start;
+                    k = 0;
+                }
+            }
+        });
+        const auto lo = term_bits(x.lo()), hi = term_bits(x.hi());
+        c.counters = {{"term_bits", lo < hi ? hi : lo}};
+    }
+
+    /** The same chain in exact arithmetic, as long as the terms fit. */
+    template <typename T> void add_exact_chain(int length) {
+        using F = Fraction<T>;
+        const auto start = F(T(1), T(3));
+        const auto quarter = F(T(1), T(4));
+        const auto fifth = F(T(1), T(5));
+        auto x = start;
+        for (int i = 0; i != length; ++i) {
+            x = step(x, quarter, fifth);
+        }
+        const auto name = "exact_chain_" + std::to_string(length);
+        auto &c = bench::add(name, bench::type_name<T>(), [=](std::uint64_t iters) {
+            auto y = start;
+            int k = 0;
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                y = step(y, quarter, fifth);
+                bench::do_not_optimize(y);
+                if (++k == length) {
+                    y = start;
+                    k = 0;
+                }
+            }
+        });
+        c.counters = {{"term_bits", term_bits(x)}};
+    }
+
+}  // namespace
+
+void bench::register_interval_benchmarks() {
+    // exact terms double every step: four steps reach 74 bits
+    for (const int length : {1, 2, 3}) {
+        add_exact_chain<std::int64_t>(length);
+    }
+#ifdef __SIZEOF_INT128__
+    for (const int length : {1, 2, 3, 4}) {
+        add_exact_chain<fractions::detail::int128_t>(length);
+    }
+#endif
+    for (const int length : {4, 64, 1024}) {
+        add_interval_chain<std::int64_t>(length, std::int64_t(1) << 10);
+        add_interval_chain<std::int64_t>(length, std::int64_t(1) << 20);
+    }
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fractions/codec.hpp>
+#include <fractions/column_file.hpp>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+using fractions::Fraction;
+
+namespace {
+
+    constexpr std::size_t file_rows = 1U << 18;
+
+    /** A data file in TMPDIR (or the working directory), removed at exit. */
+    struct ScratchFile {
+        std::string path;
+
+        explicit ScratchFile(const std::string &name) {
+            const char *dir = std::getenv("TMPDIR");
+            this->path = std::string(dir != nullptr ? dir : ".") + "/" + name;
+        }
+        ~ScratchFile() { std::remove(this->path.c_str()); }
+    };
+
+    /**
+     * The same rows as text ("n/d" lines) and in the column format. With
+     * `shared` all rows are unreduced cents (denominator 100), so that every
+     * block stores one denominator; otherwise the denominators vary.
+     */
+    template <typename T> struct Dataset {
+        ScratchFile text, columns;
+
+        Dataset(const std::string &name, bool shared)
+            : text("fractions_bench_" + name + ".txt"),
+              columns("fractions_bench_" + name + ".frc") {
+            bench::Rng rng{shared ? 11U : 12U};
+            std::ofstream out(this->text.path, std::ios::binary);
+            fractions::ColumnWriter<T> writer;
+            writer.open(this->columns.path);
+            for (std::size_t i = 0; i != file_rows; ++i) {
+                Fraction<T> x;
+                x._numer = T(rng.range(-1000000, 1000000));
+                x._denom = shared ? T(100) : T(rng.range(1, 1000));
+                out << x._numer << '/' << x._denom << '\n';
+                writer.push(x);
+            }
+            writer.close();
+        }
+    };
+
+    /** Writes the files on first use, so that filtered-out cases cost nothing. */
+    template <typename T> class LazyDataset {
+        std::string _name;
+        bool _shared;
+        std::unique_ptr<Dataset<T>> _set;
+
+      public:
+        LazyDataset(std::string name, bool shared) : _name(std::move(name)), _shared(shared) {}
+
+        auto get() -> const Dataset<T> & {
+            if (!this->_set) {
+                this->_set.reset(new Dataset<T>(this->_name, this->_shared));
+            }
+            return *this->_set;
+        }
+    };
+
+    auto slurp(const std::string &path) -> std::string {
+        std::ifstream in(path, std::ios::binary);
+        std::ostringstream s;
+        s << in.rdbuf();
+        return s.str();
+    }
+
+    /** Runs body(count) over files of file_rows rows until iters rows are processed. */
+    template <typename Body> void over_files(std::uint64_t iters, Body body) {
+        while (iters != 0) {
+            const auto count = std::size_t(std::min<std::uint64_t>(iters, file_rows));
+            body(count);
+            iters -= count;
+        }
+    }
+
+    template <typename T> void register_load(const std::string &data, bool shared) {
+        using F = Fraction<T>;
+        const auto name = bench::type_name<T>();
+        const auto set = std::make_shared<LazyDataset<T>>(name + "_" + data, shared);
+
+        // read and parse the text file into Fraction<T> rows
+        bench::add("load_text_" + data, name, [set](std::uint64_t iters) {
+            over_files(iters, [&set](std::size_t n) {
+                const auto text = slurp(set->get().text.path);
+                std::vector<F> rows(n);
+                const char *p = text.c_str();
+                char *end = nullptr;
+                for (auto &x : rows) {
+                    x._numer = T(std::strtoll(p, &end, 10));
+                    x._denom = T(std::strtoll(end + 1, &end, 10));
+                    p = end;
+                }
+                bench::do_not_optimize(rows.back());
+            });
+        });
+
+        // map the column file and materialize Fraction<T> rows
+        bench::add(
+            "load_columns_" + data, name,
+            [set](std::uint64_t iters) {
+                over_files(iters, [&set](std::size_t n) {
+                    fractions::ColumnFile<T> in;
+                    in.open(set->get().columns.path);
+                    std::vector<F> rows(n);
+                    for (std::size_t b = 0, i = 0; i < n; ++b) {
+                        const auto block = in.block(b);
+                        const auto k = std::min(block.size(), n - i);
+                        for (std::size_t j = 0; j != k; ++j) {
+                            rows[i + j] = block[j];
+                        }
+                        i += k;
+                    }
+                    bench::do_not_optimize(rows.back());
+                });
+            },
+            double(2 * sizeof(T)));
+
+        // map the column file and scan the numerators in place
+        bench::add(
+            "scan_columns_" + data, name,
+            [set](std::uint64_t iters) {
+                over_files(iters, [&set](std::size_t n) {
+                    fractions::ColumnFile<T> in;
+                    in.open(set->get().columns.path);
+                    std::int64_t total = 0;
+                    for (std::size_t b = 0, i = 0; i < n; ++b) {
+                        const auto block = in.block(b);
+                        const auto k = std::min(block.size(), n - i);
+                        for (std::size_t j = 0; j != k; ++j) {
+                            total += std::int64_t(block.numer()[j]);
+                        }
+                        i += k;
+                    }
+                    bench::do_not_optimize(total);
+                });
+            },
+            double(sizeof(T)));
+    }
+
+    constexpr std::size_t codec_rows = 1U << 16;
+
+    /**
+     * In-memory rows for the codec: "small" has numerators in [-15, 15] over
+     * a shared denominator (one byte per row), "ticks" a price walk that
+     * switches between a few denominators, "random" unrelated rows.
+     */
+    auto codec_rows_for(const std::string &data) -> std::vector<Fraction<std::int64_t>> {
+        bench::Rng rng{13};
+        const std::int64_t tick_denoms[] = {100, 64, 8, 1000};
+        std::vector<Fraction<std::int64_t>> rows(codec_rows);
+        std::int64_t price = 1500000, denom = 100;
+        for (auto &x : rows) {
+            if (data == "small") {
+                x._numer = rng.range(-15, 15);
+                x._denom = 100;
+            } else if (data == "ticks") {
+                price += rng.range(-20, 20);
+                if (rng.range(0, 7) == 0) {
+                    denom = tick_denoms[rng.range(0, 3)];
+                }
+                x._numer = price;
+                x._denom = denom;
+            } else {
+                x._numer = rng.range(-1000000000000, 1000000000000);
+                x._denom = rng.range(1, 1000000);
+            }
+        }
+        return rows;
+    }
+
+    /** Runs body(count) over the codec rows until iters rows are processed. */
+    template <typename Body> void over_rows(std::uint64_t iters, Body body) {
+        while (iters != 0) {
+            const auto count = std::size_t(std::min<std::uint64_t>(iters, codec_rows));
+            body(count);
+            iters -= count;
+        }
+    }
+
+    void register_codec(const std::string &data) {
+        using F = Fraction<std::int64_t>;
+        const auto rows = std::make_shared<std::vector<F>>(codec_rows_for(data));
+        const auto bytes = std::make_shared<std::vector<unsigned char>>(
+            fractions::encode(rows->data(), rows->size()));
+        // the decode case reports the encoded bytes it reads, so its GB/s over
+        // ops/s is the stored size per row (16 bytes raw)
+        const auto per_row = double(bytes->size()) / double(codec_rows);
+
+        bench::add(
+            "encode_" + data, "int64",
+            [rows](std::uint64_t iters) {
+                over_rows(iters, [&rows](std::size_t n) {
+                    fractions::FractionEncoder<std::int64_t> enc;
+                    enc.push(rows->data(), n);
+                    bench::do_not_optimize(enc.bytes().back());
+                });
+            },
+            double(sizeof(F)));
+
+        bench::add(
+            "decode_" + data, "int64",
+            [rows, bytes](std::uint64_t iters) {
+                std::vector<F> out;
+                over_rows(iters, [&](std::size_t n) {
+                    fractions::FractionDecoder<std::int64_t> dec(bytes->data(), bytes->size());
+                    out.resize(n);
+                    dec.decode(out.data(), n);
+                    bench::do_not_optimize(out.back());
+                });
+            },
+            per_row);
+    }
+
+}  // namespace
+
+void bench::register_io_benchmarks() {
+    register_load<std::int32_t>("shared", true);
+    register_load<std::int64_t>("shared", true);
+    register_load<std::int64_t>("mixed", false);
+    for (const auto *data : {"small", "ticks", "random"}) {
+        register_codec(data);
+    }
+}
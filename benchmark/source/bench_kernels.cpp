@@ -0,0 +1,328 @@
+#include <algorithm>
+#include <cstdint>
+#include <fractions/bytecode.hpp>
+#include <fractions/dispatch.hpp>
+#include <fractions/expression.hpp>
+#include <fractions/kernels.hpp>
+#include <fractions/scan.hpp>
+#include <fractions/selection.hpp>
+#include <fractions/statistics.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+using fractions::Fraction;
+
+namespace {
+
+    constexpr std::size_t column_size = 1U << 16;
+
+    /**
+     * A column of small numerators over power-of-two denominators, so that
+     * long sums stay representable and the shared-denominator fast paths
+     * of the kernels are exercised the way price or grid data would.
+     */
+    template <typename T> auto make_column(std::uint64_t seed) -> std::vector<Fraction<T>> {
+        bench::Rng rng{seed};
+        std::vector<Fraction<T>> v(column_size);
+        for (auto &x : v) {
+            x = Fraction<T>(T(rng.range(-100, 100)), T(std::int64_t(1) << rng.range(0, 3)));
+        }
+        return v;
+    }
+
+    /** Runs body(first, count) over the column until iters rows are processed. */
+    template <typename Body> void over_rows(std::uint64_t iters, Body body) {
+        while (iters != 0) {
+            const auto count = std::size_t(std::min<std::uint64_t>(iters, column_size));
+            body(count);
+            iters -= count;
+        }
+    }
+
+    template <typename T> void register_column_kernels() {
+        using F = Fraction<T>;
+        const auto name = bench::type_name<T>();
+        const auto x = std::make_shared<const std::vector<F>>(make_column<T>(1));
+        const auto y = std::make_shared<const std::vector<F>>(make_column<T>(2));
+
+        // inner products: naive loop versus the single-reduction kernel
+        bench::add(
+            "dot_naive", name,
+            [x, y](std::uint64_t iters) {
+                over_rows(iters, [&](std::size_t n) {
+                    F acc;
+                    for (std::size_t i = 0; i != n; ++i) {
+                        acc += (*x)[i] * (*y)[i];
+                    }
+                    bench::do_not_optimize(acc);
+                });
+            },
+            2.0 * sizeof(F));
+        bench::add(
+            "dot", name,
+            [x, y](std::uint64_t iters) {
+                over_rows(iters, [&](std::size_t n) {
+                    const auto r = fractions::dot(x->data(), y->data(), n);
+                    bench::do_not_optimize(r);
+                });
+            },
+            2.0 * sizeof(F));
+
+        // statistics: repeated operator+= versus the streaming accumulator
+        bench::add(
+            "sum_naive", name,
+            [x](std::uint64_t iters) {
+                over_rows(iters, [&](std::size_t n) {
+                    F acc;
+                    for (std::size_t i = 0; i != n; ++i) {
+                        acc += (*x)[i];
+                    }
+                    bench::do_not_optimize(acc);
+                });
+            },
+            double(sizeof(F)));
+        bench::add(
+            "running_stats", name,
+            [x](std::uint64_t iters) {
+                over_rows(iters, [&](std::size_t n) {
+                    const auto s = fractions::accumulate_stats(x->data(), n);
+                    const auto v = s.variance();
+                    bench::do_not_optimize(v);
+                });
+            },
+            double(sizeof(F)));
+
+        // threshold scans: scalar operator< versus the mask kernels
+        const auto c = F(T(17), T(3));
+        bench::add(
+            "compare_scalar", name,
+            [x, c](std::uint64_t iters) {
+                std::vector<std::uint64_t> mask(column_size / 64);
+                over_rows(iters, [&](std::size_t n) {
+                    for (std::size_t i = 0; i != n; ++i) {
+                        const auto bit = std::uint64_t(c < (*x)[i]) << (i % 64);
+                        mask[i / 64] = (i % 64 == 0 ? 0 : mask[i / 64]) | bit;
+                    }
+                    bench::do_not_optimize(mask[0]);
+                });
+            },
+            double(sizeof(F)));
+        bench::add(
+            "compare_mask_aos", name,
+            [x, c](std::uint64_t iters) {
+                std::vector<std::uint64_t> mask(column_size / 64);
+                over_rows(iters, [&](std::size_t n) {
+                    fractions::compare_mask(x->data(), n, fractions::CompareOp::Greater, c,
+                                            mask.data());
+                    bench::do_not_optimize(mask[0]);
+                });
+            },
+            double(sizeof(F)));
+        auto num = std::make_shared<std::vector<T>>();
+        auto den = std::make_shared<std::vector<T>>();
+        for (const auto &v : *x) {
+            num->push_back(v.numer());
+            den->push_back(v.denom());
+        }
+        bench::add(
+            "compare_mask_soa", name,
+            [num, den, c](std::uint64_t iters) {
+                std::vector<std::uint64_t> mask(column_size / 64);
+                over_rows(iters, [&](std::size_t n) {
+                    fractions::compare_mask(num->data(), den->data(), n,
+                                            fractions::CompareOp::Greater, c, mask.data());
+                    bench::do_not_optimize(mask[0]);
+                });
+            },
+            2.0 * sizeof(T));
+        bench::add(
+            "argmin", name,
+            [x](std::uint64_t iters) {
+                over_rows(iters, [&](std::size_t n) {
+                    const auto i = fractions::argmin(x->data(), n);
+                    bench::do_not_optimize(i);
+                });
+            },
+            double(sizeof(F)));
+
+        // selection: exact std::nth_element versus filtered keys
+        bench::add("std_nth_element", name, [x](std::uint64_t iters) {
+            std::vector<F> w;
+            over_rows(iters, [&](std::size_t n) {
+                w.assign(x->begin(), x->begin() + std::ptrdiff_t(n));
+                std::nth_element(w.begin(), w.begin() + std::ptrdiff_t(n / 2), w.end());
+                bench::do_not_optimize(w[n / 2]);
+            });
+        });
+        bench::add("nth_element", name, [x](std::uint64_t iters) {
+            std::vector<F> w;
+            over_rows(iters, [&](std::size_t n) {
+                w.assign(x->begin(), x->begin() + std::ptrdiff_t(n));
+                fractions::nth_element(w.data(), w.data() + n / 2, w.data() + n);
+                bench::do_not_optimize(w[n / 2]);
+            });
+        });
+    }
+
+    template <typename T> void register_expression_kernels() {
+        using F = Fraction<T>;
+        const auto name = bench::type_name<T>();
+        const auto x = std::make_shared<const std::vector<F>>(make_column<T>(3));
+        constexpr std::size_t mask = 1023;
+
+        // a*b + c*d - e: eager temporaries versus one fused reduction
+        bench::add("formula_eager", name, [x](std::uint64_t iters) {
+            const auto &v = *x;
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const auto k = std::size_t(i) & mask;
+                const F r = v[k] * v[k + 1] + v[k + 2] * v[k + 3] - v[k + 4];
+                bench::do_not_optimize(r);
+            }
+        });
+        bench::add("formula_lazy", name, [x](std::uint64_t iters) {
+            const auto &v = *x;
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const auto k = std::size_t(i) & mask;
+                const F r = fractions::lazy(v[k]) * v[k + 1] + fractions::lazy(v[k + 2]) * v[k + 3]
+                            - v[k + 4];
+                bench::do_not_optimize(r);
+            }
+        });
+
+        // the same formula compiled once: a row at a time, and a column at a time
+        auto program = std::make_shared<fractions::Program<T>>();
+        fractions::compile("a*b + c*d - e", {"a", "b", "c", "d", "e"}, *program);
+        bench::add("formula_vm", name, [x, program](std::uint64_t iters) {
+            const auto &v = *x;
+            auto regs = program->scratch();
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const auto k = std::size_t(i) & mask;
+                const F r = program->run(&v[k], regs);
+                bench::do_not_optimize(r);
+            }
+        });
+        bench::add("formula_vm_columnar", name, [x, program](std::uint64_t iters) {
+            const auto &v = *x;
+            const F *columns[] = {&v[0], &v[1], &v[2], &v[3], &v[4]};
+            std::vector<F> out(mask + 1);
+            over_rows(iters, [&](std::size_t n) {
+                for (std::size_t lo = 0; lo < n; lo += mask + 1) {
+                    program->evaluate(columns, std::min(n - lo, mask + 1), out.data());
+                    bench::do_not_optimize(out[0]);
+                }
+            });
+        });
+        bench::add("fma", name, [x](std::uint64_t iters) {
+            const auto &v = *x;
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const auto k = std::size_t(i) & mask;
+                const auto r = fractions::fma(v[k], v[k + 1], v[k + 2]);
+                bench::do_not_optimize(r);
+            }
+        });
+    }
+
+    /**
+     * The runtime-dispatched kernels, once per variant this CPU supports;
+     * each case forces its variant before running.
+     */
+    template <typename T> void register_dispatch_kernels() {
+        using F = Fraction<T>;
+        namespace dispatch = fractions::dispatch;
+        const auto name = bench::type_name<T>();
+        bench::Rng rng{4};
+        auto raw = std::make_shared<std::vector<F>>(column_size);
+        for (auto &x : *raw) {
+            const auto common = T(rng.range(1, 12));
+            x._numer = T(T(rng.range(-1000000, 1000000)) * common);
+            x._denom = T(T(rng.range(1, 1000000)) * common);
+        }
+        auto reduced = std::make_shared<std::vector<F>>(*raw);
+        for (auto &x : *reduced) {
+            x.normalize();
+        }
+        auto num = std::make_shared<std::vector<T>>();
+        auto den = std::make_shared<std::vector<T>>();
+        std::string text;
+        for (const auto &v : *reduced) {
+            num->push_back(v.numer());
+            den->push_back(v.denom());
+            text += std::to_string(v.numer()) + "/" + std::to_string(v.denom()) + "\n";
+        }
+        const auto shared_text = std::make_shared<const std::string>(text);
+        const auto c = F(T(17), T(3));
+
+        const dispatch::Isa all[] = {dispatch::Isa::Scalar, dispatch::Isa::Sse42,
+                                     dispatch::Isa::Avx2, dispatch::Isa::Avx512};
+        for (const auto isa : all) {
+            if (dispatch::detected() < isa) {
+                continue;
+            }
+            const std::string suffix = std::string("_") + dispatch::name(isa);
+            bench::add(
+                "dispatch_reduce" + suffix, name,
+                [raw, isa](std::uint64_t iters) {
+                    dispatch::force(isa);
+                    std::vector<F> w;
+                    over_rows(iters, [&](std::size_t n) {
+                        w.assign(raw->begin(), raw->begin() + std::ptrdiff_t(n));
+                        dispatch::normalize_all(w.data(), n);
+                        bench::do_not_optimize(w[0]);
+                    });
+                },
+                double(sizeof(F)));
+            bench::add(
+                "dispatch_compare" + suffix, name,
+                [num, den, c, isa](std::uint64_t iters) {
+                    dispatch::force(isa);
+                    std::vector<std::uint64_t> mask(column_size / 64);
+                    over_rows(iters, [&](std::size_t n) {
+                        dispatch::compare_mask(num->data(), den->data(), n,
+                                               fractions::CompareOp::Greater, c, mask.data());
+                        bench::do_not_optimize(mask[0]);
+                    });
+                },
+                2.0 * sizeof(T));
+            bench::add(
+                "dispatch_convert" + suffix, name,
+                [reduced, isa](std::uint64_t iters) {
+                    dispatch::force(isa);
+                    std::vector<double> out(column_size);
+                    over_rows(iters, [&](std::size_t n) {
+                        dispatch::to_double(reduced->data(), n, out.data());
+                        bench::do_not_optimize(out[0]);
+                    });
+                },
+                double(sizeof(F)));
+            if (sizeof(T) == 8) {
+                bench::add(
+                    "dispatch_parse" + suffix, name,
+                    [shared_text, isa](std::uint64_t iters) {
+                        dispatch::force(isa);
+                        std::vector<Fraction<std::int64_t>> out(column_size);
+                        over_rows(iters, [&](std::size_t n) {
+                            std::size_t count = 0;
+                            // stops with out full after n rows
+                            dispatch::parse(shared_text->data(), shared_text->size(), out.data(),
+                                            n, count);
+                            bench::do_not_optimize(out[0]);
+                        });
+                    },
+                    double(shared_text->size()) / double(column_size));
+            }
+        }
+    }
+
+}  // namespace
+
+void bench::register_kernel_benchmarks() {
+    register_column_kernels<std::int32_t>();
+    register_column_kernels<std::int64_t>();
+    register_expression_kernels<std::int32_t>();
+    register_expression_kernels<std::int64_t>();
+    register_dispatch_kernels<std::int32_t>();
+    register_dispatch_kernels<std::int64_t>();
+}
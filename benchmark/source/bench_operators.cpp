@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstdint>
+#include <fractions/fractions.hpp>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "harness.hpp"
+
+using fractions::Fraction;
+
+namespace {
+
+    constexpr std::size_t pool_size = 1024;  // power of two
+    constexpr std::size_t pool_mask = pool_size - 1;
+
+    /**
+     * Operands of a quarter of the bit width, so that sums of products do
+     * not overflow; raw (n, d) pairs share a small common factor to give
+     * reduce() something to do.
+     */
+    template <typename T> struct Operands {
+        std::vector<T> n, d;
+        std::vector<Fraction<T>> a, b;
+
+        Operands() {
+            constexpr int bits = 8 * int(sizeof(T));
+            const std::int64_t limit = std::int64_t(1) << std::min(bits / 4, 32);
+            const std::int64_t lo = std::is_signed<T>::value ? -limit : 0;
+            bench::Rng rng{0x5EED0000ULL + sizeof(T)};
+            for (std::size_t i = 0; i != pool_size; ++i) {
+                const auto k = rng.range(1, 16);
+                this->n.push_back(T(k * rng.range(lo, limit)));
+                this->d.push_back(T(k * rng.range(1, limit)));
+                this->a.push_back(Fraction<T>(T(rng.range(lo, limit)), T(rng.range(1, limit))));
+                this->b.push_back(Fraction<T>(T(rng.range(lo, limit)), T(rng.range(1, limit))));
+            }
+        }
+    };
+
+    template <typename T, typename Op>
+    void add_binary(const std::string &name, std::shared_ptr<const Operands<T>> ops, Op op) {
+        bench::add(name, bench::type_name<T>(), [ops, op](std::uint64_t iters) {
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const auto k = std::size_t(i) & pool_mask;
+                const auto r = op(*ops, k);
+                bench::do_not_optimize(r);
+            }
+        });
+    }
+
+    template <typename T> void register_type() {
+        using F = Fraction<T>;
+        const auto ops = std::make_shared<const Operands<T>>();
+        const auto inf = F(T(1), T(0));
+        const auto nan = F(T(0), T(0));
+
+        // integer helpers
+        add_binary<T>("gcd", ops, [](const Operands<T> &o, std::size_t k) {
+            return fractions::gcd(o.n[k], o.d[k]);
+        });
+        add_binary<T>("gcd_recur", ops, [](const Operands<T> &o, std::size_t k) {
+            return fractions::gcd_recur(o.n[k], o.d[k]);
+        });
+        add_binary<T>("lcm", ops, [](const Operands<T> &o, std::size_t k) {
+            return fractions::lcm(o.n[k], o.d[k]);
+        });
+
+        // construction and normalization
+        add_binary<T>("construct", ops,
+                      [](const Operands<T> &o, std::size_t k) { return F(o.n[k], o.d[k]); });
+        add_binary<T>("construct_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return F(o.n[k]); });
+        add_binary<T>("reduce", ops, [](const Operands<T> &o, std::size_t k) {
+            F f;
+            f._numer = o.n[k];
+            f._denom = o.d[k];
+            f.reduce();
+            return f;
+        });
+
+        // arithmetic
+        add_binary<T>("add", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] + o.b[k]; });
+        add_binary<T>("sub", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] - o.b[k]; });
+        add_binary<T>("mul", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] * o.b[k]; });
+        add_binary<T>("div", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] / o.b[k]; });
+        add_binary<T>("add_assign", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x += o.b[k];
+        });
+        add_binary<T>("sub_assign", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x -= o.b[k];
+        });
+        add_binary<T>("mul_assign", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x *= o.b[k];
+        });
+        add_binary<T>("div_assign", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x /= o.b[k];
+        });
+        add_binary<T>("neg", ops, [](const Operands<T> &o, std::size_t k) { return -o.a[k]; });
+        add_binary<T>("increment", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return ++x;
+        });
+        add_binary<T>("decrement", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return --x;
+        });
+        add_binary<T>("post_increment", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            x++;
+            return x;
+        });
+        add_binary<T>("post_decrement", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            x--;
+            return x;
+        });
+
+        // arithmetic with an integer on the right
+        add_binary<T>("add_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] + o.d[k]; });
+        add_binary<T>("sub_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] - o.d[k]; });
+        add_binary<T>("mul_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] * o.d[k]; });
+        add_binary<T>("div_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] / o.d[k]; });
+        add_binary<T>("add_assign_int", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x += o.d[k];
+        });
+        add_binary<T>("sub_assign_int", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x -= o.d[k];
+        });
+        add_binary<T>("mul_assign_int", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x *= o.d[k];
+        });
+        add_binary<T>("div_assign_int", ops, [](const Operands<T> &o, std::size_t k) {
+            auto x = o.a[k];
+            return x /= o.d[k];
+        });
+
+        // arithmetic with an integer on the left
+        add_binary<T>("int_add", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] + o.a[k]; });
+        add_binary<T>("int_sub", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] - o.a[k]; });
+        add_binary<T>("int_mul", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] * o.a[k]; });
+        add_binary<T>("int_div", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] / o.a[k]; });
+
+        // comparisons
+        add_binary<T>("less", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] < o.b[k]; });
+        add_binary<T>("greater", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] > o.b[k]; });
+        add_binary<T>("less_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] <= o.b[k]; });
+        add_binary<T>("greater_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] >= o.b[k]; });
+        add_binary<T>("equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] == o.b[k]; });
+        add_binary<T>("not_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] != o.b[k]; });
+        add_binary<T>("less_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] < o.d[k]; });
+        add_binary<T>("greater_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] > o.d[k]; });
+        add_binary<T>("less_equal_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] <= o.d[k]; });
+        add_binary<T>("greater_equal_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] >= o.d[k]; });
+        add_binary<T>("equal_int", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] == o.d[k]; });
+        add_binary<T>("int_less", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] < o.a[k]; });
+        add_binary<T>("int_greater", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] > o.a[k]; });
+        add_binary<T>("int_less_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] <= o.a[k]; });
+        add_binary<T>("int_greater_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] >= o.a[k]; });
+        add_binary<T>("int_equal", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.d[k] == o.a[k]; });
+        add_binary<T>("cross", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k].cross(o.b[k]); });
+        add_binary<T>("to_double", ops, [](const Operands<T> &o, std::size_t k) {
+            return fractions::to_double(o.a[k]);
+        });
+
+        // infinity and nan
+        add_binary<T>("construct_inf", ops,
+                      [](const Operands<T> &o, std::size_t k) { return F(o.n[k], T(0)); });
+        add_binary<T>("add_inf", ops,
+                      [inf](const Operands<T> &o, std::size_t k) { return o.a[k] + inf; });
+        add_binary<T>("mul_inf", ops,
+                      [inf](const Operands<T> &o, std::size_t k) { return o.a[k] * inf; });
+        add_binary<T>("div_by_zero", ops,
+                      [](const Operands<T> &o, std::size_t k) { return o.a[k] / F(T(0)); });
+        add_binary<T>("less_inf", ops,
+                      [inf](const Operands<T> &o, std::size_t k) { return o.a[k] < inf; });
+        add_binary<T>("add_nan", ops,
+                      [nan](const Operands<T> &o, std::size_t k) { return o.a[k] + nan; });
+        add_binary<T>("equal_nan", ops,
+                      [nan](const Operands<T> &o, std::size_t k) { return o.a[k] == nan; });
+    }
+
+}  // namespace
+
+void bench::register_operator_benchmarks() {
+    register_type<std::int32_t>();
+    register_type<std::int64_t>();
+    register_type<std::uint32_t>();
+    register_type<std::uint64_t>();
+#ifdef __SIZEOF_INT128__
+    register_type<fractions::detail::int128_t>();
+#endif
+}
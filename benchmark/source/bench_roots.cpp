@@ -0,0 +1,101 @@
+#include <cstdint>
+#include <fractions/polynomial.hpp>
+#include <fractions/roots.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+using fractions::Fraction;
+using fractions::RationalPolynomial;
+using fractions::RealRoots;
+
+namespace {
+
+    /** Chebyshev T_n: n simple roots in (-1, 1), clustered towards the ends. */
+    template <typename T> auto chebyshev(int n) -> std::vector<T> {
+        std::vector<T> prev{T(1)}, cur{T(0), T(1)};
+        for (int k = 1; k < n; ++k) {
+            std::vector<T> next(cur.size() + 1, T(0));
+            for (std::size_t i = 0; i != cur.size(); ++i) {
+                next[i + 1] = T(next[i + 1] + T(2) * cur[i]);
+            }
+            for (std::size_t i = 0; i != prev.size(); ++i) {
+                next[i] = T(next[i] - prev[i]);
+            }
+            prev.swap(cur);
+            cur.swap(next);
+        }
+        return cur;
+    }
+
+    /** Dense coefficients in [-9, 9]: few real roots, many sign changes to rule out. */
+    template <typename T> auto random_dense(int n) -> std::vector<T> {
+        bench::Rng rng{0x2007ULL + std::uint64_t(n)};
+        std::vector<T> c;
+        for (int i = 0; i != n; ++i) {
+            c.push_back(T(rng.range(-9, 9)));
+        }
+        c.push_back(T(rng.range(1, 9)));
+        return c;
+    }
+
+    /** x^n - x - 1: two real roots, a long gap of zero coefficients. */
+    template <typename T> auto sparse(int n) -> std::vector<T> {
+        std::vector<T> c(std::size_t(n) + 1, T(0));
+        c[0] = T(-1);
+        c[1] = T(-1);
+        c[std::size_t(n)] = T(1);
+        return c;
+    }
+
+    template <typename T>
+    void add_isolation(const std::string &name, const std::vector<T> &coeffs) {
+        const auto p = std::make_shared<const RationalPolynomial<T>>(coeffs);
+        bench::add(name, bench::type_name<T>(), [p](std::uint64_t iters) {
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                const RealRoots<T> roots(*p);
+                bench::do_not_optimize(roots);
+            }
+        });
+    }
+
+    /**
+     * The degrees stop where the Taylor shifts of the isolation would
+     * overflow the coefficient type: the shifted coefficients grow by about
+     * a factor of 2^n for a polynomial of degree n.
+     */
+    template <typename T> void register_roots(const std::vector<int> &chebyshev_degrees,
+                                              const std::vector<int> &dense_degrees) {
+        for (const auto n : chebyshev_degrees) {
+            add_isolation<T>("roots_chebyshev_" + std::to_string(n), chebyshev<T>(n));
+        }
+        for (const auto n : dense_degrees) {
+            add_isolation<T>("roots_dense_" + std::to_string(n), random_dense<T>(n));
+        }
+        for (const auto n : {64, 256, 512}) {
+            add_isolation<T>("roots_sparse_" + std::to_string(n), sparse<T>(n));
+        }
+
+        // isolation plus refinement of every root to 1/1000
+        const auto p = std::make_shared<const RationalPolynomial<T>>(chebyshev<T>(8));
+        bench::add("roots_refine_chebyshev_8", bench::type_name<T>(), [p](std::uint64_t iters) {
+            for (std::uint64_t i = 0; i != iters; ++i) {
+                RealRoots<T> roots(*p);
+                for (std::size_t k = 0; k != roots.size(); ++k) {
+                    roots.refine(k, Fraction<T>(T(1), T(1000)));
+                }
+                bench::do_not_optimize(roots);
+            }
+        });
+    }
+
+}  // namespace
+
+void bench::register_root_benchmarks() {
+    register_roots<std::int64_t>({8, 12}, {16, 32});
+#ifdef __SIZEOF_INT128__
+    register_roots<fractions::detail::int128_t>({8, 16, 20}, {16, 32, 64});
+#endif
+}
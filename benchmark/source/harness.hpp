@@ -0,0 +1,307 @@
+#pragma once
+
+/** @file benchmark/source/harness.hpp
+ *  A small self-calibrating benchmark harness with table and JSON output.
+ *
+ *  A benchmark case is a callable run(iterations) performing that many
+ *  operations. measure() grows the iteration count until one run takes at
+ *  least the requested minimum time and reports the time per operation of
+ *  the fastest of a few repetitions. Given hardware counters, one more run of
+ *  the calibrated length is counted and reported per operation. A case may
+ *  also carry fixed counters of its own (e.g. the term size a chain of
+ *  operations ends with), reported next to the timings.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fractions/widen.hpp>
+
+#include "perf_counters.hpp"
+
+namespace bench {
+
+    /** A registered benchmark. */
+    struct Case {
+        std::string name;  ///< operation, e.g. "add"
+        std::string type;  ///< integer type, e.g. "int64"
+        double bytes_per_op;  ///< input bytes touched per operation (0 if not meaningful)
+        std::function<void(std::uint64_t)> run;  ///< performs the given number of operations
+        std::vector<std::pair<std::string, double>> counters{};  ///< reported as is, e.g. term_bits
+    };
+
+    /** The measurement of one case. */
+    struct Result {
+        std::string name;
+        std::string type;
+        std::uint64_t iterations;
+        double ns_per_op;
+        double ops_per_sec;
+        double bytes_per_sec;
+        // hardware counters per operation, NaN if not measured
+        double instructions_per_op = std::nan("");
+        double cycles_per_op = std::nan("");
+        double branches_per_op = std::nan("");
+        double branch_misses_per_op = std::nan("");
+        double l1d_misses_per_op = std::nan("");
+        std::vector<std::pair<std::string, double>> counters{};  // from the case
+
+        /** @return Instructions per cycle (NaN if not measured). */
+        auto ipc() const -> double { return this->instructions_per_op / this->cycles_per_op; }
+
+        /** @return The fraction of branches mispredicted (NaN if not measured). */
+        auto branch_miss_rate() const -> double {
+            return this->branch_misses_per_op / this->branches_per_op;
+        }
+    };
+
+    inline auto cases() -> std::vector<Case> & {
+        static std::vector<Case> all;
+        return all;
+    }
+
+    /** Registers a case; @return it, to attach counters. */
+    inline auto add(std::string name, std::string type, std::function<void(std::uint64_t)> run,
+                    double bytes_per_op = 0.0) -> Case & {
+        cases().push_back(
+            Case{std::move(name), std::move(type), bytes_per_op, std::move(run), {}});
+        return cases().back();
+    }
+
+    /** Keeps the compiler from optimizing away the computation of value. */
+    template <typename T> inline void do_not_optimize(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+        asm volatile("" : : "r"(&value) : "memory");
+#else
+        static const void *volatile sink;
+        sink = &value;
+#endif
+    }
+
+    /** Short names of the benchmarked integer types. */
+    template <typename T> auto type_name() -> std::string;
+    template <> inline auto type_name<std::int32_t>() -> std::string { return "int32"; }
+    template <> inline auto type_name<std::int64_t>() -> std::string { return "int64"; }
+    template <> inline auto type_name<std::uint32_t>() -> std::string { return "uint32"; }
+    template <> inline auto type_name<std::uint64_t>() -> std::string { return "uint64"; }
+#ifdef __SIZEOF_INT128__
+    template <> inline auto type_name<fractions::detail::int128_t>() -> std::string {
+        return "int128";
+    }
+#endif
+
+    /** Deterministic 64-bit generator (splitmix64). */
+    struct Rng {
+        std::uint64_t state;
+
+        auto next() -> std::uint64_t {
+            auto z = (this->state += 0x9E3779B97F4A7C15ULL);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
+
+        /** Uniform in [lo, hi] for hi - lo < 2^63. */
+        auto range(std::int64_t lo, std::int64_t hi) -> std::int64_t {
+            const auto span = static_cast<std::uint64_t>(hi - lo) + 1;
+            return lo + static_cast<std::int64_t>(this->next() % span);
+        }
+    };
+
+    inline auto measure(const Case &c, double min_time, int repetitions = 3,
+                        PerfCounters *perf = nullptr) -> Result {
+        using clock = std::chrono::steady_clock;
+        auto time = [&c](std::uint64_t iters) {
+            const auto start = clock::now();
+            c.run(iters);
+            return std::chrono::duration<double>(clock::now() - start).count();
+        };
+        std::uint64_t iters = 1;
+        auto elapsed = time(iters);
+        while (elapsed < min_time) {
+            // aim 20% past the target, grow at most tenfold per step
+            const auto factor
+                = elapsed > 0 ? std::min(10.0, 1.2 * min_time / elapsed) : 10.0;
+            iters = std::max(iters + 1, static_cast<std::uint64_t>(double(iters) * factor));
+            elapsed = time(iters);
+        }
+        for (int r = 1; r < repetitions; ++r) {
+            elapsed = std::min(elapsed, time(iters));
+        }
+        const auto per_op = elapsed / double(iters);
+        Result r{c.name,
+                 c.type,
+                 iters,
+                 per_op * 1e9,
+                 1.0 / per_op,
+                 c.bytes_per_op > 0 ? c.bytes_per_op / per_op : 0.0};
+        r.counters = c.counters;
+        if (perf != nullptr && perf->available()) {
+            perf->start();
+            c.run(iters);
+            const auto counts = perf->stop();
+            r.instructions_per_op = counts[PerfEvent::Instructions] / double(iters);
+            r.cycles_per_op = counts[PerfEvent::Cycles] / double(iters);
+            r.branches_per_op = counts[PerfEvent::Branches] / double(iters);
+            r.branch_misses_per_op = counts[PerfEvent::BranchMisses] / double(iters);
+            r.l1d_misses_per_op = counts[PerfEvent::L1dMisses] / double(iters);
+        }
+        return r;
+    }
+
+    /** Prints the table header; perf adds the hardware counter columns. */
+    inline void print_header(std::ostream &os, bool perf = false) {
+        os << std::left << std::setw(28) << "benchmark" << std::setw(8) << "type" << std::right
+           << std::setw(14) << "ns/op" << std::setw(16) << "ops/s" << std::setw(12) << "GB/s";
+        if (perf) {
+            os << std::setw(12) << "insn/op" << std::setw(8) << "IPC" << std::setw(12) << "br/op"
+               << std::setw(12) << "brmiss/op" << std::setw(10) << "brmiss%" << std::setw(12)
+               << "L1dmiss/op";
+        }
+        os << '\n';
+    }
+
+    namespace detail {
+        /** Prints v in the current format, or "-" if it is NaN. */
+        inline void print_cell(std::ostream &os, int width, double v) {
+            os << std::setw(width);
+            if (std::isnan(v)) {
+                os << "-";
+            } else {
+                os << v;
+            }
+        }
+    }  // namespace detail
+
+    inline void print_row(std::ostream &os, const Result &r, bool perf = false) {
+        os << std::left << std::setw(28) << r.name << std::setw(8) << r.type << std::right
+           << std::fixed << std::setprecision(3) << std::setw(14) << r.ns_per_op
+           << std::scientific << std::setprecision(3) << std::setw(16) << r.ops_per_sec
+           << std::fixed;
+        detail::print_cell(os, 12, r.bytes_per_sec > 0 ? r.bytes_per_sec / 1e9 : std::nan(""));
+        if (perf) {
+            os << std::setprecision(1);
+            detail::print_cell(os, 12, r.instructions_per_op);
+            os << std::setprecision(2);
+            detail::print_cell(os, 8, r.ipc());
+            os << std::setprecision(1);
+            detail::print_cell(os, 12, r.branches_per_op);
+            os << std::setprecision(3);
+            detail::print_cell(os, 12, r.branch_misses_per_op);
+            os << std::setprecision(2);
+            detail::print_cell(os, 10, 100 * r.branch_miss_rate());
+            os << std::setprecision(3);
+            detail::print_cell(os, 12, r.l1d_misses_per_op);
+        }
+        os << std::defaultfloat;
+        for (const auto &counter : r.counters) {
+            os << "  " << counter.first << '=' << counter.second;
+        }
+        os << '\n';
+    }
+
+    /** A JSON number, or null for NaN. */
+    inline auto json_number(double v) -> std::string {
+        if (std::isnan(v) || std::isinf(v)) {
+            return "null";
+        }
+        std::ostringstream os;
+        os << std::setprecision(6) << v;
+        return os.str();
+    }
+
+    inline auto json_escape(const std::string &s) -> std::string {
+        std::string out;
+        for (const auto ch : s) {
+            if (ch == '"' || ch == '\\') {
+                out += '\\';
+            }
+            out += ch;
+        }
+        return out;
+    }
+
+    /**
+     * Writes the results as
+     * {"context": {...}, "benchmarks": [{"name", "type", "iterations",
+     * "ns_per_op", "ops_per_sec", "bytes_per_sec"}, ...]}, adding
+     * "instructions_per_op", "cycles_per_op", "ipc", "branches_per_op",
+     * "branch_misses_per_op", "branch_miss_rate" and "l1d_misses_per_op" to
+     * the results with hardware counts and
+     * "counters": {"name": value, ...} to those whose case has counters.
+     */
+    inline void write_json(std::ostream &os, const std::vector<Result> &results,
+                           const std::string &label) {
+        const auto now = std::time(nullptr);
+        char date[32];
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        os << "{\n  \"context\": {\n";
+        os << "    \"date\": \"" << date << "\",\n";
+        os << "    \"label\": \"" << json_escape(label) << "\",\n";
+#if defined(__clang__)
+        os << "    \"compiler\": \"clang " << __clang_major__ << "." << __clang_minor__ << "\"\n";
+#elif defined(__GNUC__)
+        os << "    \"compiler\": \"gcc " << __GNUC__ << "." << __GNUC_MINOR__ << "\"\n";
+#elif defined(_MSC_VER)
+        os << "    \"compiler\": \"msvc " << _MSC_VER << "\"\n";
+#else
+        os << "    \"compiler\": \"unknown\"\n";
+#endif
+        os << "  },\n  \"benchmarks\": [";
+        for (std::size_t i = 0; i != results.size(); ++i) {
+            const auto &r = results[i];
+            std::ostringstream row;
+            row << std::setprecision(6);
+            row << "\n    {\"name\": \"" << json_escape(r.name) << "\", \"type\": \""
+                << json_escape(r.type) << "\", \"iterations\": " << r.iterations
+                << ", \"ns_per_op\": " << r.ns_per_op << ", \"ops_per_sec\": " << r.ops_per_sec
+                << ", \"bytes_per_sec\": " << r.bytes_per_sec;
+            if (!std::isnan(r.cycles_per_op) || !std::isnan(r.instructions_per_op)) {
+                row << ", \"instructions_per_op\": " << json_number(r.instructions_per_op)
+                    << ", \"cycles_per_op\": " << json_number(r.cycles_per_op)
+                    << ", \"ipc\": " << json_number(r.ipc())
+                    << ", \"branches_per_op\": " << json_number(r.branches_per_op)
+                    << ", \"branch_misses_per_op\": " << json_number(r.branch_misses_per_op)
+                    << ", \"branch_miss_rate\": " << json_number(r.branch_miss_rate())
+                    << ", \"l1d_misses_per_op\": " << json_number(r.l1d_misses_per_op);
+            }
+            if (!r.counters.empty()) {
+                row << ", \"counters\": {";
+                for (std::size_t k = 0; k != r.counters.size(); ++k) {
+                    row << (k != 0 ? ", " : "") << '"' << json_escape(r.counters[k].first)
+                        << "\": " << json_number(r.counters[k].second);
+                }
+                row << "}";
+            }
+            row << "}";
+            os << row.str() << (i + 1 != results.size() ? "," : "");
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    /** Registers the Fraction operator benchmarks for all integer types. */
+    void register_operator_benchmarks();
+
+    /** Registers the kernel benchmarks (dot, expressions, scans, statistics, selection). */
+    void register_kernel_benchmarks();
+
+    /** Registers the file loading benchmarks (text parsing versus the column format). */
+    void register_io_benchmarks();
+
+    /** Registers the real root isolation benchmarks on high-degree polynomials. */
+    void register_root_benchmarks();
+
+    /** Registers the interval arithmetic benchmarks (term size and latency of long chains). */
+    void register_interval_benchmarks();
+
+}  // namespace bench
@@ -0,0 +1,92 @@
+#include <cxxopts.hpp>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <regex>
+#include <string>
+#include <vector>
+
+#include "harness.hpp"
+
+auto main(int argc, char** argv) -> int {
+    cxxopts::Options options(*argv, "Benchmarks of the fractions library");
+
+    std::string filter;
+    std::string type;
+    std::string json;
+    std::string label;
+    double min_time = 0.1;
+
+    // clang-format off
+  options.add_options()
+    ("h,help", "Show help")
+    ("l,list", "List the benchmarks without running them")
+    ("f,filter", "Run only benchmarks whose name matches this regex",
+     cxxopts::value(filter)->default_value(".*"))
+    ("t,type", "Run only benchmarks of this integer type (e.g. int64)",
+     cxxopts::value(type)->default_value(""))
+    ("m,min-time", "Minimum time per measurement in seconds",
+     cxxopts::value(min_time)->default_value("0.1"))
+    ("j,json", "Write the results as JSON to this file", cxxopts::value(json))
+    ("label", "Label stored in the JSON context (e.g. a commit id)",
+     cxxopts::value(label)->default_value(""))
+    ("p,perf", "Also count instructions, cycles, branches, branch and L1d misses (Linux perf)")
+  ;
+    // clang-format on
+
+    auto result = options.parse(argc, argv);
+
+    if (result["help"].as<bool>()) {
+        std::cout << options.help() << std::endl;
+        return 0;
+    }
+
+    bench::register_operator_benchmarks();
+    bench::register_kernel_benchmarks();
+    bench::register_io_benchmarks();
+    bench::register_root_benchmarks();
+    bench::register_interval_benchmarks();
+
+    const std::regex pattern(filter);
+    std::vector<const bench::Case*> selected;
+    for (const auto& c : bench::cases()) {
+        if (std::regex_search(c.name, pattern) && (type.empty() || c.type == type)) {
+            selected.push_back(&c);
+        }
+    }
+
+    if (result["list"].as<bool>()) {
+        for (const auto* c : selected) {
+            std::cout << c->name << ' ' << c->type << '\n';
+        }
+        return 0;
+    }
+
+    std::unique_ptr<bench::PerfCounters> perf;
+    if (result["perf"].as<bool>()) {
+        perf.reset(new bench::PerfCounters());
+        if (!perf->available()) {
+            std::cerr << "hardware counters unavailable (check perf_event_paranoid), "
+                         "reporting times only"
+                      << std::endl;
+            perf.reset();
+        }
+    }
+
+    std::vector<bench::Result> results;
+    bench::print_header(std::cout, perf != nullptr);
+    for (const auto* c : selected) {
+        results.push_back(bench::measure(*c, min_time, 3, perf.get()));
+        bench::print_row(std::cout, results.back(), perf != nullptr);
+    }
+
+    if (!json.empty()) {
+        std::ofstream out(json);
+        if (!out) {
+            std::cerr << "cannot write " << json << std::endl;
+            return 1;
+        }
+        bench::write_json(out, results, label);
+    }
+    return 0;
+}
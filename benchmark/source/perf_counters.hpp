@@ -0,0 +1,134 @@
+#pragma once
+
+/** @file benchmark/source/perf_counters.hpp
+ *  Hardware performance counters around a benchmark run (Linux perf_event_open).
+ *
+ *  Each event is opened as its own counter of the calling thread, excluding
+ *  the kernel, so that an event the CPU or the virtual machine does not
+ *  provide leaves the others usable. Counts are scaled by enabled / running
+ *  time when the kernel had to multiplex them. On other systems, or when
+ *  perf_event_paranoid or a container forbids access, no event opens and
+ *  all readings are NaN.
+ */
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#ifdef __linux__
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
+namespace bench {
+
+    /** The counted hardware events. */
+    enum class PerfEvent { Instructions, Cycles, Branches, BranchMisses, L1dMisses };
+
+    constexpr int perf_event_count = 5;
+
+    /** Counts of one run; NaN for events that could not be counted. */
+    struct PerfSample {
+        double counts[perf_event_count];
+
+        auto operator[](PerfEvent e) const -> double { return this->counts[int(e)]; }
+    };
+
+    class PerfCounters {
+        int _fds[perf_event_count];
+
+      public:
+        PerfCounters() {
+            for (auto &fd : this->_fds) {
+                fd = -1;
+            }
+#ifdef __linux__
+            const std::uint64_t l1d_read_miss = PERF_COUNT_HW_CACHE_L1D
+                                                | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                                                | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            const struct {
+                std::uint32_t type;
+                std::uint64_t config;
+            } events[perf_event_count] = {
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+                {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+                {PERF_TYPE_HW_CACHE, l1d_read_miss},
+            };
+            for (int i = 0; i != perf_event_count; ++i) {
+                perf_event_attr attr;
+                std::memset(&attr, 0, sizeof(attr));
+                attr.size = sizeof(attr);
+                attr.type = events[i].type;
+                attr.config = events[i].config;
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+                this->_fds[i] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+            }
+#endif
+        }
+
+        ~PerfCounters() {
+#ifdef __linux__
+            for (const auto fd : this->_fds) {
+                if (fd >= 0) {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        PerfCounters(const PerfCounters &) = delete;
+        auto operator=(const PerfCounters &) -> PerfCounters & = delete;
+
+        /** @return true if at least one event can be counted. */
+        auto available() const -> bool {
+            for (const auto fd : this->_fds) {
+                if (fd >= 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        /** Resets and starts all open counters. */
+        void start() {
+#ifdef __linux__
+            for (const auto fd : this->_fds) {
+                if (fd >= 0) {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        /** Stops the counters and returns their (multiplexing-scaled) counts. */
+        auto stop() -> PerfSample {
+            PerfSample s;
+            for (int i = 0; i != perf_event_count; ++i) {
+                s.counts[i] = std::numeric_limits<double>::quiet_NaN();
+#ifdef __linux__
+                const auto fd = this->_fds[i];
+                if (fd < 0) {
+                    continue;
+                }
+                ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+                std::uint64_t value[3] = {0, 0, 0};  // count, time enabled, time running
+                if (read(fd, value, sizeof(value)) == static_cast<ssize_t>(sizeof(value))
+                    && value[2] != 0) {
+                    s.counts[i] = double(value[0]) * double(value[1]) / double(value[2]);
+                }
+#endif
+            }
+            return s;
+        }
+    };
+
+}  // namespace bench
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Compare libfractions_c, called through ctypes, with fractions.Fraction.
+
+Usage: bench_fractions_c.py [LIBRARY] [ROWS]
+
+LIBRARY defaults to build/capi/libfractions_c.so. Every operation runs
+over ROWS (default 100000) pairs of random 64-bit fractions: once with
+Fraction objects in a Python loop, once as a single batch call into the
+library and, for add, as one library call per row, which shows the
+per-call FFI overhead that the batch entry points amortize. The results
+of the library are checked against Fraction before timing.
+"""
+
+import ctypes
+import random
+import sys
+import time
+from fractions import Fraction
+
+
+class Q64(ctypes.Structure):
+    _fields_ = [("numer", ctypes.c_int64), ("denom", ctypes.c_int64)]
+
+
+def load(path):
+    lib = ctypes.CDLL(path)
+    q64p = ctypes.POINTER(Q64)
+    size = ctypes.c_size_t
+    for name in ("fractions_q64_add", "fractions_q64_mul"):
+        getattr(lib, name).argtypes = [q64p, q64p, q64p, size]
+    lib.fractions_q64_reduce.argtypes = [q64p, size]
+    lib.fractions_q64_compare.argtypes = [q64p, q64p, ctypes.POINTER(ctypes.c_int8), size]
+    lib.fractions_q64_parse.argtypes = [ctypes.c_char_p, size, q64p, size,
+                                        ctypes.POINTER(size)]
+    lib.fractions_q64_format.argtypes = [q64p, size, ctypes.c_char_p, size,
+                                         ctypes.POINTER(size)]
+    return lib
+
+
+def timed(fn, repeat=3):
+    best = float("inf")
+    for _ in range(repeat):
+        start = time.perf_counter()
+        fn()
+        best = min(best, time.perf_counter() - start)
+    return best
+
+
+def main(argv):
+    path = argv[1] if len(argv) > 1 else "build/capi/libfractions_c.so"
+    rows = int(argv[2]) if len(argv) > 2 else 100000
+    lib = load(path)
+    rng = random.Random(1)
+
+    def rand():
+        return Fraction(rng.randint(-10**6, 10**6), rng.randint(1, 10**6))
+
+    xs = [rand() for _ in range(rows)]
+    ys = [rand() for _ in range(rows)]
+    a = (Q64 * rows)(*[(x.numerator, x.denominator) for x in xs])
+    b = (Q64 * rows)(*[(y.numerator, y.denominator) for y in ys])
+    out = (Q64 * rows)()
+    cmp = (ctypes.c_int8 * rows)()
+    text = "\n".join(str(x) for x in xs).encode()
+    count = ctypes.c_size_t()
+    length = ctypes.c_size_t()
+    buffer = ctypes.create_string_buffer(len(text) + 64)
+
+    # check the library against Fraction
+    assert lib.fractions_q64_add(a, b, out, rows) == 0
+    assert all(Fraction(o.numer, o.denom) == x + y for o, x, y in zip(out, xs, ys))
+    assert lib.fractions_q64_mul(a, b, out, rows) == 0
+    assert all(Fraction(o.numer, o.denom) == x * y for o, x, y in zip(out, xs, ys))
+    assert lib.fractions_q64_compare(a, b, cmp, rows) == 0
+    assert all(c == (x > y) - (x < y) for c, x, y in zip(cmp, xs, ys))
+    assert lib.fractions_q64_parse(text, len(text), out, rows, ctypes.byref(count)) == 0
+    assert count.value == rows and all(o.numer == x.numerator for o, x in zip(out, xs))
+    assert lib.fractions_q64_format(a, rows, buffer, len(buffer), ctypes.byref(length)) == 0
+    assert buffer.value.rstrip(b"\n") == text
+
+    def add_rows():
+        add = lib.fractions_q64_add
+        for x, y, o in zip(a, b, out):
+            add(ctypes.byref(x), ctypes.byref(y), ctypes.byref(o), 1)
+
+    cases = [
+        ("add", lambda: [x + y for x, y in zip(xs, ys)],
+         lambda: lib.fractions_q64_add(a, b, out, rows)),
+        ("add (one call per row)", None, add_rows),
+        ("mul", lambda: [x * y for x, y in zip(xs, ys)],
+         lambda: lib.fractions_q64_mul(a, b, out, rows)),
+        ("reduce", lambda: [Fraction(x.numerator * 6, x.denominator * 6) for x in xs],
+         lambda: lib.fractions_q64_reduce(out, rows)),
+        ("compare", lambda: [(x > y) - (x < y) for x, y in zip(xs, ys)],
+         lambda: lib.fractions_q64_compare(a, b, cmp, rows)),
+        ("parse", lambda: [Fraction(s) for s in text.decode().split("\n")],
+         lambda: lib.fractions_q64_parse(text, len(text), out, rows, ctypes.byref(count))),
+        ("format", lambda: "\n".join(str(x) for x in xs),
+         lambda: lib.fractions_q64_format(a, rows, buffer, len(buffer), ctypes.byref(length))),
+    ]
+    print("{:<26}{:>16}{:>16}{:>10}".format("operation", "Fraction ns/row", "C ns/row",
+                                             "speedup"))
+    for name, python, native in cases:
+        c = timed(native) / rows * 1e9
+        if python is None:
+            print("{:<26}{:>16}{:>16.1f}{:>10}".format(name, "-", c, "-"))
+            continue
+        p = timed(python) / rows * 1e9
+        print("{:<26}{:>16.1f}{:>16.1f}{:>10.1f}".format(name, p, c, p / c))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv))
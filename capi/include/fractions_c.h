@@ -0,0 +1,132 @@
+#ifndef FRACTIONS_C_H
+#define FRACTIONS_C_H
+
+/** @file capi/include/fractions_c.h
+ *  C interface of the fractions library (libfractions_c).
+ *
+ *  Fractions are plain structs of a numerator and a denominator, with
+ *  64-bit terms (fractions_q64) or 128-bit terms (fractions_q128, stored
+ *  as two 64-bit words so that the layout does not depend on compiler
+ *  support for __int128). Every operation works on arrays: callers pass
+ *  pointers and a row count, so that one call through an FFI (ctypes,
+ *  cffi, JNI, ...) processes a whole column.
+ *
+ *  Unless noted otherwise, inputs must be normalized: denominator >= 0 and
+ *  coprime to the numerator (see fractions_q64_reduce). A zero denominator
+ *  stands for infinity (numerator != 0) or NaN (0/0), as in Fraction<T>.
+ *
+ *  The 64-bit operations compute exactly in 128 bits; a result whose terms
+ *  do not fit in 64 bits is stored as 0/0 and reported by the return code.
+ *  The 128-bit operations cancel common factors before multiplying and
+ *  check every product and sum: their terms are limited to +-(2^127 - 1)
+ *  and a result outside that range is stored as 0/0 and reported in the
+ *  same way. Comparisons are exact for any terms. Compilers without
+ *  __int128 (MSVC) build a library whose 64-bit additions and
+ *  multiplications wrap around and whose 128-bit operations are
+ *  unsupported.
+ *
+ *  Every function returns FRACTIONS_C_OK or one of the error codes below.
+ *  The ABI only changes together with FRACTIONS_C_ABI_VERSION.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32) && !defined(FRACTIONS_C_STATIC)
+#    ifdef FRACTIONS_C_BUILDING
+#        define FRACTIONS_C_API __declspec(dllexport)
+#    else
+#        define FRACTIONS_C_API __declspec(dllimport)
+#    endif
+#elif defined(__GNUC__)
+#    define FRACTIONS_C_API __attribute__((visibility("default")))
+#else
+#    define FRACTIONS_C_API
+#endif
+
+#define FRACTIONS_C_ABI_VERSION 1
+
+#define FRACTIONS_C_OK 0
+#define FRACTIONS_C_OVERFLOW 1    /* some result did not fit; stored as 0/0 */
+#define FRACTIONS_C_PARSE_ERROR 2 /* malformed or out-of-range input text */
+#define FRACTIONS_C_NO_SPACE 3    /* the output array or buffer is too small */
+#define FRACTIONS_C_UNSUPPORTED 4 /* 128-bit terms without compiler support */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct fractions_q64 {
+    int64_t numer;
+    int64_t denom;
+} fractions_q64;
+
+/** A two's complement 128-bit integer: hi * 2^64 + lo. */
+typedef struct fractions_i128 {
+    uint64_t lo;
+    int64_t hi;
+} fractions_i128;
+
+typedef struct fractions_q128 {
+    fractions_i128 numer;
+    fractions_i128 denom;
+} fractions_q128;
+
+/** @return FRACTIONS_C_ABI_VERSION of the loaded library. */
+FRACTIONS_C_API int fractions_c_abi_version(void);
+
+/** out[i] = a[i] + b[i] for i < n (out may alias a or b). */
+FRACTIONS_C_API int fractions_q64_add(const fractions_q64 *a, const fractions_q64 *b,
+                                      fractions_q64 *out, size_t n);
+
+/** out[i] = a[i] * b[i] for i < n (out may alias a or b). */
+FRACTIONS_C_API int fractions_q64_mul(const fractions_q64 *a, const fractions_q64 *b,
+                                      fractions_q64 *out, size_t n);
+
+/** Normalizes x[0..n) in place; the inputs may be arbitrary. */
+FRACTIONS_C_API int fractions_q64_reduce(fractions_q64 *x, size_t n);
+
+/** out[i] = -1, 0 or 1 as a[i] is less than, equal to or greater than b[i]. */
+FRACTIONS_C_API int fractions_q64_compare(const fractions_q64 *a, const fractions_q64 *b,
+                                          int8_t *out, size_t n);
+
+/**
+ * Parses fractions ("-3/4", "+5", "1/0") separated by whitespace or commas
+ * from text[0..length) into out, normalizing them.
+ *
+ * @param[out] count The number of fractions stored, also on failure (the
+ * position of the bad token, or capacity if out is full).
+ */
+FRACTIONS_C_API int fractions_q64_parse(const char *text, size_t length, fractions_q64 *out,
+                                        size_t capacity, size_t *count);
+
+/**
+ * Writes x[0..n) as "n/d" (or "n" for integers), one per line, followed by
+ * a terminating NUL.
+ *
+ * @param[out] length The length of the text without the NUL. If the text
+ * and the NUL do not fit in capacity, FRACTIONS_C_NO_SPACE is returned,
+ * length is the size needed and the buffer contents are unspecified.
+ */
+FRACTIONS_C_API int fractions_q64_format(const fractions_q64 *x, size_t n, char *buffer,
+                                         size_t capacity, size_t *length);
+
+/* The same operations on 128-bit terms. */
+
+FRACTIONS_C_API int fractions_q128_add(const fractions_q128 *a, const fractions_q128 *b,
+                                       fractions_q128 *out, size_t n);
+FRACTIONS_C_API int fractions_q128_mul(const fractions_q128 *a, const fractions_q128 *b,
+                                       fractions_q128 *out, size_t n);
+FRACTIONS_C_API int fractions_q128_reduce(fractions_q128 *x, size_t n);
+FRACTIONS_C_API int fractions_q128_compare(const fractions_q128 *a, const fractions_q128 *b,
+                                           int8_t *out, size_t n);
+FRACTIONS_C_API int fractions_q128_parse(const char *text, size_t length, fractions_q128 *out,
+                                         size_t capacity, size_t *count);
+FRACTIONS_C_API int fractions_q128_format(const fractions_q128 *x, size_t n, char *buffer,
+                                          size_t capacity, size_t *length);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
+
+#endif /* FRACTIONS_C_H */
@@ -0,0 +1,503 @@
+#ifndef FRACTIONS_C_BUILDING
+#    define FRACTIONS_C_BUILDING
+#endif
+#include <fractions_c.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fractions/dispatch.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/widen.hpp>
+#include <limits>
+
+namespace {
+
+    using fractions::Fraction;
+
+    struct Add {
+        template <typename F> auto operator()(const F &x, const F &y) const -> F { return x + y; }
+    };
+
+    struct Mul {
+        template <typename F> auto operator()(const F &x, const F &y) const -> F { return x * y; }
+    };
+
+    /** Euclid on magnitudes, so that no term has to be negated. */
+    template <typename U> auto gcd_unsigned(U a, U b) -> U {
+        while (b != 0) {
+            const U t = static_cast<U>(a % b);
+            a = b;
+            b = t;
+        }
+        return a;
+    }
+
+    template <typename W, typename U> auto magnitude(const W &v) -> U {
+        return v < 0 ? static_cast<U>(U(0) - static_cast<U>(v)) : static_cast<U>(v);
+    }
+
+    /** The full product a * b as hi * 2^bits + lo, from half-width limbs. */
+    template <typename U> void wide_product(U a, U b, U &hi, U &lo) {
+        const int half = std::numeric_limits<U>::digits / 2;
+        const U mask = static_cast<U>(~U(0) >> half);
+        const U a0 = a & mask, a1 = a >> half, b0 = b & mask, b1 = b >> half;
+        const U p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+        const U mid = static_cast<U>((p00 >> half) + (p01 & mask) + (p10 & mask));
+        lo = static_cast<U>((p00 & mask) | (mid << half));
+        hi = static_cast<U>(p11 + (p01 >> half) + (p10 >> half) + (mid >> half));
+    }
+
+    /**
+     * @return The sign of xn/xd - yn/yd for denominators >= 0, from the
+     * cross products computed exactly in twice the width of W.
+     */
+    template <typename W, typename U> auto compare_cross(W xn, W xd, W yn, W yd) -> int {
+        const int lsign = xn == 0 || yd == 0 ? 0 : (xn < 0 ? -1 : 1);
+        const int rsign = yn == 0 || xd == 0 ? 0 : (yn < 0 ? -1 : 1);
+        if (lsign != rsign) {
+            return lsign < rsign ? -1 : 1;
+        }
+        if (lsign == 0) {
+            return 0;
+        }
+        U lhi, llo, rhi, rlo;
+        wide_product(magnitude<W, U>(xn), static_cast<U>(yd), lhi, llo);
+        wide_product(magnitude<W, U>(yn), static_cast<U>(xd), rhi, rlo);
+        const int order = lhi != rhi ? (lhi < rhi ? -1 : 1) : llo != rlo ? (llo < rlo ? -1 : 1) : 0;
+        return lsign < 0 ? -order : order;
+    }
+
+    /**
+     * The 64-bit terms, computed in the widened type (exact where it is
+     * __int128), or directly in 64 bits where the terms are small enough
+     * for the products not to overflow.
+     */
+    struct Q64 {
+        using C = fractions_q64;
+        using W = fractions::widened<std::int64_t>::type;
+        using U = fractions::widened<std::uint64_t>::type;
+
+        static auto load(const C &x) -> Fraction<W> {
+            Fraction<W> f;
+            f._numer = W(x.numer);
+            f._denom = W(x.denom);
+            return f;
+        }
+
+        static auto fits(const W &v) -> bool {
+            return !(v < W(std::numeric_limits<std::int64_t>::min()))
+                   && !(W(std::numeric_limits<std::int64_t>::max()) < v);
+        }
+
+        /** @return false (storing 0/0) if the terms do not fit. */
+        static auto store(const Fraction<W> &f, C &x) -> bool {
+            if (!fits(f._numer) || !fits(f._denom)) {
+                x.numer = 0;
+                x.denom = 0;
+                return false;
+            }
+            x.numer = static_cast<std::int64_t>(f._numer);
+            x.denom = static_cast<std::int64_t>(f._denom);
+            return true;
+        }
+
+        /** @return true if both terms are within +-(2^31 - 1). */
+        static auto small(const C &x) -> bool {
+            const std::int64_t m = 0x7FFFFFFF;
+            return x.numer >= -m && x.numer <= m && x.denom <= m;
+        }
+
+        static auto reduce(C &x) -> bool {
+            auto f = load(x);
+            f.normalize();
+            return store(f, x);
+        }
+
+        template <typename Op> static auto apply(Op op, const C &x, const C &y, C &out) -> bool {
+            if (small(x) && small(y)) {
+                // products of such terms, and sums of two of them, fit in 63 bits
+                Fraction<std::int64_t> a, b;
+                a._numer = x.numer;
+                a._denom = x.denom;
+                b._numer = y.numer;
+                b._denom = y.denom;
+                const auto r = op(a, b);
+                out.numer = r._numer;
+                out.denom = r._denom;
+                return true;
+            }
+            return store(op(load(x), load(y)), out);
+        }
+
+        /** @return The sign of x - y for denominators >= 0. */
+        static auto compare(const C &x, const C &y) -> int {
+#ifdef __SIZEOF_INT128__
+            // the cross products are exact in 128 bits
+            const auto l = W(x.numer) * W(y.denom);
+            const auto r = W(y.numer) * W(x.denom);
+            return l < r ? -1 : (r < l ? 1 : 0);
+#else
+            return compare_cross<std::int64_t, std::uint64_t>(x.numer, x.denom, y.numer, y.denom);
+#endif
+        }
+    };
+
+#ifdef __SIZEOF_INT128__
+    /**
+     * The 128-bit terms. There is no wider type to compute in, so common
+     * factors are cancelled before multiplying (Knuth, TAOCP 4.5.1) and
+     * every remaining product and sum is overflow-checked. Terms are
+     * limited to +-(2^127 - 1), so that none of them is negated out of range.
+     */
+    struct Q128 {
+        using C = fractions_q128;
+        using W = fractions::detail::int128_t;
+        using U = fractions::detail::uint128_t;
+
+        static auto limit() -> U { return ~U(0) >> 1; }
+
+        static auto to_wide(const fractions_i128 &v) -> W {
+            return static_cast<W>((static_cast<U>(static_cast<std::uint64_t>(v.hi)) << 64) | v.lo);
+        }
+
+        static auto from_wide(const W &v) -> fractions_i128 {
+            fractions_i128 r;
+            r.lo = static_cast<std::uint64_t>(static_cast<U>(v));
+            r.hi = static_cast<std::int64_t>(v >> 64);
+            return r;
+        }
+
+        static auto load(const C &x) -> Fraction<W> {
+            Fraction<W> f;
+            f._numer = to_wide(x.numer);
+            f._denom = to_wide(x.denom);
+            return f;
+        }
+
+        static auto fits(const W &v) -> bool { return magnitude<W, U>(v) <= limit(); }
+
+        /** Stores 0/0; @return false. */
+        static auto overflow(C &x) -> bool {
+            x.numer = from_wide(0);
+            x.denom = from_wide(0);
+            return false;
+        }
+
+        /** @return false (storing 0/0) if a term is out of range. */
+        static auto store(const W &numer, const W &denom, C &x) -> bool {
+            if (!fits(numer) || !fits(denom)) {
+                return overflow(x);
+            }
+            x.numer = from_wide(numer);
+            x.denom = from_wide(denom);
+            return true;
+        }
+
+        static auto store(const Fraction<W> &f, C &x) -> bool {
+            return store(f._numer, f._denom, x);
+        }
+
+        static auto gcd(const W &a, const W &b) -> W {
+            return static_cast<W>(gcd_unsigned(magnitude<W, U>(a), magnitude<W, U>(b)));
+        }
+
+        /** Divides by the gcd on magnitudes, which also covers -2^127. */
+        static auto reduce(C &x) -> bool {
+            const auto f = load(x);
+            auto n = magnitude<W, U>(f._numer), d = magnitude<W, U>(f._denom);
+            if (const auto g = gcd_unsigned(n, d)) {
+                n /= g;
+                d /= g;
+            }
+            if (n > limit() || d > limit()) {
+                return overflow(x);
+            }
+            const bool negative = (f._numer < 0) != (f._denom < 0) && n != 0;
+            return store(negative ? -static_cast<W>(n) : static_cast<W>(n), static_cast<W>(d), x);
+        }
+
+        static auto apply(Add, const C &x, const C &y, C &out) -> bool {
+            const auto a = load(x), b = load(y);
+            if (!fits(a._numer) || !fits(a._denom) || !fits(b._numer) || !fits(b._denom)) {
+                return overflow(out);
+            }
+            W t, l, r, d;
+            if (a._denom == b._denom) {
+                if (!fractions::detail::checked_add(a._numer, b._numer, t)) {
+                    return overflow(out);
+                }
+                const auto g = gcd(t, a._denom);
+                return g > 1 ? store(t / g, a._denom / g, out) : store(t, a._denom, out);
+            }
+            // g > 0: the denominators differ, so they are not both zero
+            const auto g = gcd(a._denom, b._denom);
+            const auto ad = a._denom / g, bd = b._denom / g;
+            if (!fractions::detail::checked_mul(a._numer, bd, l)
+                || !fractions::detail::checked_mul(b._numer, ad, r)
+                || !fractions::detail::checked_add(l, r, t)) {
+                return overflow(out);
+            }
+            const auto g2 = gcd(t, g);
+            if (!fractions::detail::checked_mul(ad, b._denom / g2, d)) {
+                return overflow(out);
+            }
+            return store(t / g2, d, out);
+        }
+
+        static auto apply(Mul, const C &x, const C &y, C &out) -> bool {
+            const auto a = load(x), b = load(y);
+            if (!fits(a._numer) || !fits(a._denom) || !fits(b._numer) || !fits(b._denom)) {
+                return overflow(out);
+            }
+            auto g1 = gcd(a._numer, b._denom), g2 = gcd(b._numer, a._denom);
+            g1 = g1 == 0 ? W(1) : g1;
+            g2 = g2 == 0 ? W(1) : g2;
+            W n, d;
+            if (!fractions::detail::checked_mul(a._numer / g1, b._numer / g2, n)
+                || !fractions::detail::checked_mul(a._denom / g2, b._denom / g1, d)) {
+                return overflow(out);
+            }
+            return store(n, d, out);
+        }
+
+        static auto compare(const C &x, const C &y) -> int {
+            return compare_cross<W, U>(to_wide(x.numer), to_wide(x.denom), to_wide(y.numer),
+                                       to_wide(y.denom));
+        }
+    };
+#endif
+
+    template <typename Q, typename Op>
+    auto binary(const typename Q::C *a, const typename Q::C *b, typename Q::C *out, std::size_t n,
+                Op op) -> int {
+        int status = FRACTIONS_C_OK;
+        for (std::size_t i = 0; i != n; ++i) {
+            if (!Q::apply(op, a[i], b[i], out[i])) {
+                status = FRACTIONS_C_OVERFLOW;
+            }
+        }
+        return status;
+    }
+
+    template <typename Q> auto reduce(typename Q::C *x, std::size_t n) -> int {
+        int status = FRACTIONS_C_OK;
+        for (std::size_t i = 0; i != n; ++i) {
+            if (!Q::reduce(x[i])) {
+                status = FRACTIONS_C_OVERFLOW;
+            }
+        }
+        return status;
+    }
+
+    template <typename Q>
+    auto compare(const typename Q::C *a, const typename Q::C *b, std::int8_t *out, std::size_t n)
+        -> int {
+        for (std::size_t i = 0; i != n; ++i) {
+            out[i] = static_cast<std::int8_t>(Q::compare(a[i], b[i]));
+        }
+        return FRACTIONS_C_OK;
+    }
+
+    /** Maps a failed parse to its status: a full out or a malformed fraction. */
+    auto parse_status(bool ok, std::size_t rows, std::size_t capacity) -> int {
+        return ok ? FRACTIONS_C_OK
+                  : rows == capacity ? FRACTIONS_C_NO_SPACE : FRACTIONS_C_PARSE_ERROR;
+    }
+
+    /**
+     * The 64-bit terms go through dispatch::parse, in chunks of a local
+     * buffer, so that the C structs are never accessed as Fraction.
+     */
+    auto parse_q64(const char *text, std::size_t length, fractions_q64 *out,
+                   std::size_t capacity, std::size_t *count) -> int {
+        Fraction<std::int64_t> chunk[256];
+        std::size_t rows = 0, pos = 0;
+        bool ok = false;
+        for (;;) {
+            const auto room = std::min(capacity - rows, sizeof(chunk) / sizeof(chunk[0]));
+            std::size_t n = 0, end = 0;
+            ok = fractions::dispatch::parse(text + pos, length - pos, chunk, room, n, nullptr,
+                                            &end);
+            for (std::size_t i = 0; i != n; ++i) {
+                out[rows + i].numer = chunk[i]._numer;
+                out[rows + i].denom = chunk[i]._denom;
+            }
+            rows += n;
+            pos += end;
+            // a full chunk with text left: go on while out has room
+            if (ok || n != room || rows == capacity) {
+                break;
+            }
+        }
+        if (count != nullptr) {
+            *count = rows;
+        }
+        return parse_status(ok, rows, capacity);
+    }
+
+    /** The 128-bit terms, with the same tokenizer. */
+    template <typename Q>
+    auto parse(const char *text, std::size_t length, typename Q::C *out, std::size_t capacity,
+               std::size_t *count) -> int {
+        using W = typename Q::W;
+        std::size_t rows = 0, end = 0;
+        const bool ok = fractions::dispatch::detail::scan_fractions<
+            fractions::dispatch::detail::ScalarDigits>(
+            text, length, capacity, Q::limit(), rows, end, nullptr,
+            [out](std::size_t row, bool negative, typename Q::U numer, typename Q::U denom) {
+                const auto n = static_cast<W>(numer);
+                // terms of at most limit stay in range when reduced
+                Q::store(Fraction<W>(negative ? W(0) - n : n, static_cast<W>(denom)), out[row]);
+            });
+        if (count != nullptr) {
+            *count = rows;
+        }
+        return parse_status(ok, rows, capacity);
+    }
+
+    /** Writes v in decimal to buf (room for 41 characters); returns the length. */
+    template <typename W, typename U> auto to_chars(W v, char *buf) -> std::size_t {
+        char digits[40];
+        std::size_t k = 0;
+        auto m = v < 0 ? static_cast<U>(U(0) - static_cast<U>(v)) : static_cast<U>(v);
+        do {
+            digits[k++] = static_cast<char>('0' + static_cast<int>(m % 10));
+            m /= 10;
+        } while (m != 0);
+        std::size_t len = 0;
+        if (v < 0) {
+            buf[len++] = '-';
+        }
+        while (k != 0) {
+            buf[len++] = digits[--k];
+        }
+        return len;
+    }
+
+    template <typename Q>
+    auto format(const typename Q::C *x, std::size_t n, char *buffer, std::size_t capacity,
+                std::size_t *length) -> int {
+        using W = typename Q::W;
+        using U = typename Q::U;
+        char row[84];
+        std::size_t total = 0;
+        for (std::size_t i = 0; i != n; ++i) {
+            const auto f = Q::load(x[i]);
+            auto len = to_chars<W, U>(f._numer, row);
+            if (f._denom != 1) {
+                row[len++] = '/';
+                len += to_chars<W, U>(f._denom, row + len);
+            }
+            row[len++] = '\n';
+            if (total + len < capacity) {
+                std::memcpy(buffer + total, row, len);
+            }
+            total += len;
+        }
+        if (length != nullptr) {
+            *length = total;
+        }
+        if (total < capacity) {
+            buffer[total] = '\0';
+            return FRACTIONS_C_OK;
+        }
+        return FRACTIONS_C_NO_SPACE;
+    }
+
+}  // namespace
+
+extern "C" {
+
+int fractions_c_abi_version(void) { return FRACTIONS_C_ABI_VERSION; }
+
+int fractions_q64_add(const fractions_q64 *a, const fractions_q64 *b, fractions_q64 *out,
+                      size_t n) {
+    return binary<Q64>(a, b, out, n, Add());
+}
+
+int fractions_q64_mul(const fractions_q64 *a, const fractions_q64 *b, fractions_q64 *out,
+                      size_t n) {
+    return binary<Q64>(a, b, out, n, Mul());
+}
+
+int fractions_q64_reduce(fractions_q64 *x, size_t n) { return reduce<Q64>(x, n); }
+
+int fractions_q64_compare(const fractions_q64 *a, const fractions_q64 *b, int8_t *out,
+                          size_t n) {
+    return compare<Q64>(a, b, out, n);
+}
+
+int fractions_q64_parse(const char *text, size_t length, fractions_q64 *out, size_t capacity,
+                        size_t *count) {
+    return parse_q64(text, length, out, capacity, count);
+}
+
+int fractions_q64_format(const fractions_q64 *x, size_t n, char *buffer, size_t capacity,
+                         size_t *length) {
+    return format<Q64>(x, n, buffer, capacity, length);
+}
+
+#ifdef __SIZEOF_INT128__
+
+int fractions_q128_add(const fractions_q128 *a, const fractions_q128 *b, fractions_q128 *out,
+                       size_t n) {
+    return binary<Q128>(a, b, out, n, Add());
+}
+
+int fractions_q128_mul(const fractions_q128 *a, const fractions_q128 *b, fractions_q128 *out,
+                       size_t n) {
+    return binary<Q128>(a, b, out, n, Mul());
+}
+
+int fractions_q128_reduce(fractions_q128 *x, size_t n) { return reduce<Q128>(x, n); }
+
+int fractions_q128_compare(const fractions_q128 *a, const fractions_q128 *b, int8_t *out,
+                           size_t n) {
+    return compare<Q128>(a, b, out, n);
+}
+
+int fractions_q128_parse(const char *text, size_t length, fractions_q128 *out, size_t capacity,
+                         size_t *count) {
+    return parse<Q128>(text, length, out, capacity, count);
+}
+
+int fractions_q128_format(const fractions_q128 *x, size_t n, char *buffer, size_t capacity,
+                          size_t *length) {
+    return format<Q128>(x, n, buffer, capacity, length);
+}
+
+#else
+
+int fractions_q128_add(const fractions_q128 *, const fractions_q128 *, fractions_q128 *, size_t) {
+    return FRACTIONS_C_UNSUPPORTED;
+}
+
+int fractions_q128_mul(const fractions_q128 *, const fractions_q128 *, fractions_q128 *, size_t) {
+    return FRACTIONS_C_UNSUPPORTED;
+}
+
+int fractions_q128_reduce(fractions_q128 *, size_t) { return FRACTIONS_C_UNSUPPORTED; }
+
+int fractions_q128_compare(const fractions_q128 *, const fractions_q128 *, int8_t *, size_t) {
+    return FRACTIONS_C_UNSUPPORTED;
+}
+
+int fractions_q128_parse(const char *, size_t, fractions_q128 *, size_t, size_t *count) {
+    if (count != nullptr) {
+        *count = 0;
+    }
+    return FRACTIONS_C_UNSUPPORTED;
+}
+
+int fractions_q128_format(const fractions_q128 *, size_t, char *, size_t, size_t *length) {
+    if (length != nullptr) {
+        *length = 0;
+    }
+    return FRACTIONS_C_UNSUPPORTED;
+}
+
+#endif
+
+}  // extern "C"
@@ -0,0 +1,186 @@
+#pragma once
+
+/** @file include/fractions/approximation.hpp
+ *  Rational approximation helpers based on continued fractions.
+ */
+
+#include <utility>
+
+#include "fractions.hpp"
+
+namespace fractions {
+
+    /**
+     * Computes the largest integer not greater than the fraction.
+     *
+     * Example:
+     * ```
+     * floor(Fraction<int>(7, 2)) == 3
+     * floor(Fraction<int>(-7, 2)) == -4
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] x A finite fraction (positive denominator).
+     * @return floor(x)
+     */
+    template <typename T> CONSTEXPR14 auto floor(const Fraction<T> &x) -> T {
+        const auto q = x.numer() / x.denom();
+        return (x.numer() < 0 && q * x.denom() != x.numer()) ? q - 1 : q;
+    }
+
+    namespace detail {
+
+        /**
+         * Simplest fraction in the closed interval [ln/ld, hn/hd] with
+         * 0 < ln/ld <= hn/hd, returned as (numerator, denominator).
+         */
+        template <typename T>
+        auto simplest_positive(const T &ln, const T &ld, const T &hn, const T &hd)
+            -> std::pair<T, T> {
+            const T fl = ln / ld;
+            if (fl * ld == ln) {
+                return std::make_pair(fl, T(1));
+            }
+            if ((fl + 1) * hd <= hn) {
+                return std::make_pair(T(fl + 1), T(1));
+            }
+            // both fractional parts lie in (0, 1): recurse on the reciprocals
+            const auto sub = simplest_positive(hd, T(hn - fl * hd), ld, T(ln - fl * ld));
+            return std::make_pair(T(fl * sub.first + sub.second), sub.first);
+        }
+
+        /**
+         * Neighbours of x = p/q in the Farey sequence of order n: the closest
+         * fractions lo <= x <= hi with denominators at most n, found by
+         * walking the Stern-Brocot tree with accelerated (continued-fraction)
+         * steps. Returns (x, x) if q <= n.
+         */
+        template <typename T>
+        auto farey_neighbours(const Fraction<T> &x, const T &n)
+            -> std::pair<Fraction<T>, Fraction<T>> {
+            const auto &p = x.numer();
+            const auto &q = x.denom();
+            if (q <= n) {
+                return std::make_pair(x, x);
+            }
+            T l_n = floor(x), l_d(1);
+            T u_n = l_n + 1, u_d(1);
+            while (true) {
+                // advance lo towards x: lo + k hi stays below x and within n
+                auto k1 = (p * l_d - q * l_n) / (q * u_n - p * u_d);
+                const auto lim1 = (n - l_d) / u_d;
+                k1 = lim1 < k1 ? lim1 : k1;
+                l_n += k1 * u_n;
+                l_d += k1 * u_d;
+                // advance hi towards x
+                auto k2 = (q * u_n - p * u_d) / (p * l_d - q * l_n);
+                const auto lim2 = (n - u_d) / l_d;
+                k2 = lim2 < k2 ? lim2 : k2;
+                u_n += k2 * l_n;
+                u_d += k2 * l_d;
+                if (k1 == 0 && k2 == 0) {
+                    break;
+                }
+            }
+            return std::make_pair(Fraction<T>(l_n, l_d), Fraction<T>(u_n, u_d));
+        }
+
+    }  // namespace detail
+
+    /**
+     * Finds the simplest fraction (smallest denominator, then smallest
+     * magnitude numerator) in the closed interval [lo, hi], i.e. the first
+     * fraction of the Stern-Brocot tree that falls inside it.
+     *
+     * Example:
+     * ```
+     * simplest_between(Fraction<int>(3, 10), Fraction<int>(2, 5)) == Fraction<int>(1, 3)
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] lo The lower end (finite).
+     * @param[in] hi The upper end (finite); the ends may be given in any order.
+     * @return The simplest fraction between lo and hi.
+     */
+    template <typename T>
+    auto simplest_between(Fraction<T> lo, Fraction<T> hi) -> Fraction<T> {
+        if (hi < lo) {
+            std::swap(lo, hi);
+        }
+        if (!(T(0) < lo) && !(hi < T(0))) {
+            return Fraction<T>();
+        }
+        if (hi < T(0)) {
+            return -simplest_between(-hi, -lo);
+        }
+        const auto res
+            = detail::simplest_positive(lo.numer(), lo.denom(), hi.numer(), hi.denom());
+        return Fraction<T>(res.first, res.second);
+    }
+
+    /**
+     * Best approximation from below: the largest fraction not greater than x
+     * whose denominator is at most max_denom.
+     *
+     * Example:
+     * ```
+     * approx_below(Fraction<int>(31416, 10000), 10) == Fraction<int>(25, 8)
+     * ```
+     *
+     * Infinite values (zero denominator) are returned unchanged.
+     *
+     * @tparam T The integer type.
+     * @param[in] x The value to approximate.
+     * @param[in] max_denom The largest allowed denominator (positive).
+     * @return The approximation.
+     */
+    template <typename T> auto approx_below(const Fraction<T> &x, const T &max_denom)
+        -> Fraction<T> {
+        if (x.denom() == 0) {
+            return x;
+        }
+        return detail::farey_neighbours(x, max_denom).first;
+    }
+
+    /**
+     * Best approximation from above: the smallest fraction not less than x
+     * whose denominator is at most max_denom.
+     *
+     * Infinite values (zero denominator) are returned unchanged.
+     *
+     * @tparam T The integer type.
+     * @param[in] x The value to approximate.
+     * @param[in] max_denom The largest allowed denominator (positive).
+     * @return The approximation.
+     */
+    template <typename T> auto approx_above(const Fraction<T> &x, const T &max_denom)
+        -> Fraction<T> {
+        if (x.denom() == 0) {
+            return x;
+        }
+        return detail::farey_neighbours(x, max_denom).second;
+    }
+
+    /**
+     * Closest fraction to x with denominator at most max_denom, as Python's
+     * `Fraction.limit_denominator`; ties go to the lower neighbour.
+     *
+     * Example:
+     * ```
+     * limit_denominator(Fraction<int>(31416, 10000), 10) == Fraction<int>(22, 7)
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] x The value to approximate.
+     * @param[in] max_denom The largest allowed denominator (positive).
+     * @return The approximation.
+     */
+    template <typename T> auto limit_denominator(const Fraction<T> &x, const T &max_denom)
+        -> Fraction<T> {
+        if (x.denom() == 0) {
+            return x;
+        }
+        const auto nb = detail::farey_neighbours(x, max_denom);
+        return (nb.second - x) < (x - nb.first) ? nb.second : nb.first;
+    }
+}  // namespace fractions
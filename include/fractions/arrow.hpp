@@ -0,0 +1,393 @@
+#pragma once
+
+/** @file include/fractions/arrow.hpp
+ *  Export and import of fraction columns through the Arrow C Data
+ *  Interface (https://arrow.apache.org/docs/format/CDataInterface.html).
+ *
+ *  A column of fractions is exchanged as a non-nullable struct array
+ *  (format "+s") with two int64 children (format "l") named "numer" and
+ *  "denom". The children point at the caller's numerator and denominator
+ *  arrays (the SoA layout of the scan and column file kernels), so nothing
+ *  is copied: the exported structures hold a reference to an owner object
+ *  that keeps the arrays alive, and the release callbacks drop it. Each
+ *  child holds its own reference, so a consumer may move a child out and
+ *  release it separately, as the interface allows.
+ *
+ *  Rows of Fraction<T> (an array of structs) or of other integer types
+ *  cannot be exported in place; export_fractions() copies them into owned
+ *  int64 columns.
+ *
+ * Example:
+ * ```
+ * auto numer = std::make_shared<std::vector<std::int64_t>>(...);
+ * auto denom = std::make_shared<std::vector<std::int64_t>>(...);
+ * ArrowArray array;
+ * ArrowSchema schema;
+ * export_columns(numer, denom, &array, &schema);  // hand both to the consumer
+ *
+ * ArrowColumns columns;
+ * if (columns.import(&array, &schema)) {  // takes ownership of array
+ *     compare_mask(columns.numer(), columns.denom(), columns.size(), CompareOp::Less, limit,
+ *                  mask);
+ * }
+ * schema.release(&schema);
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+
+#ifndef ARROW_C_DATA_INTERFACE
+#    define ARROW_C_DATA_INTERFACE
+
+#    define ARROW_FLAG_DICTIONARY_ORDERED 1
+#    define ARROW_FLAG_NULLABLE 2
+#    define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+    // Array type description
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray *);
+    // Opaque producer-specific data
+    void *private_data;
+};
+
+}  // extern "C"
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+namespace fractions {
+
+    namespace detail {
+
+        /** Private data of an exported array: the buffer list and the children. */
+        struct ArrowArrayData {
+            std::shared_ptr<const void> owner;
+            const void *buffers[2] = {nullptr, nullptr};
+            ArrowArray child_arrays[2];
+            ArrowArray *children[2] = {nullptr, nullptr};
+        };
+
+        inline void release_arrow_array(ArrowArray *array) {
+            if (array == nullptr || array->release == nullptr) {
+                return;
+            }
+            for (std::int64_t i = 0; i != array->n_children; ++i) {
+                auto *child = array->children[i];
+                if (child->release != nullptr) {
+                    child->release(child);
+                }
+            }
+            delete static_cast<ArrowArrayData *>(array->private_data);
+            array->release = nullptr;
+        }
+
+        /** Fills an int64 child over data[0..n) that keeps owner alive. */
+        inline void make_arrow_child(ArrowArray &child, const std::int64_t *data, std::size_t n,
+                                     const std::shared_ptr<const void> &owner) {
+            auto *priv = new ArrowArrayData;
+            priv->owner = owner;
+            priv->buffers[1] = data;
+            child = ArrowArray{};
+            child.length = static_cast<std::int64_t>(n);
+            child.n_buffers = 2;
+            child.buffers = priv->buffers;
+            child.release = &release_arrow_array;
+            child.private_data = priv;
+        }
+
+        /** Private data of an exported schema. */
+        struct ArrowSchemaData {
+            ArrowSchema child_schemas[2];
+            ArrowSchema *children[2] = {nullptr, nullptr};
+        };
+
+        inline void release_arrow_schema(ArrowSchema *schema) {
+            if (schema == nullptr || schema->release == nullptr) {
+                return;
+            }
+            for (std::int64_t i = 0; i != schema->n_children; ++i) {
+                auto *child = schema->children[i];
+                if (child->release != nullptr) {
+                    child->release(child);
+                }
+            }
+            delete static_cast<ArrowSchemaData *>(schema->private_data);
+            schema->release = nullptr;
+        }
+
+        /** Children own nothing (their strings are literals). */
+        inline void release_arrow_child_schema(ArrowSchema *schema) { schema->release = nullptr; }
+
+        inline void make_arrow_schema(ArrowSchema *schema) {
+            auto *priv = new ArrowSchemaData;
+            const char *names[2] = {"numer", "denom"};
+            for (int i = 0; i != 2; ++i) {
+                auto &child = priv->child_schemas[i];
+                child = ArrowSchema{};
+                child.format = "l";
+                child.name = names[i];
+                child.release = &release_arrow_child_schema;
+                priv->children[i] = &child;
+            }
+            *schema = ArrowSchema{};
+            schema->format = "+s";
+            schema->name = "";
+            schema->n_children = 2;
+            schema->children = priv->children;
+            schema->release = &release_arrow_schema;
+            schema->private_data = priv;
+        }
+
+        /** @return true if a has a null count of 0, or an unknown one (-1) and no bitmap. */
+        inline auto arrow_no_nulls(const ArrowArray &a) -> bool {
+            return a.null_count == 0
+                   || (a.null_count == -1 && (a.n_buffers == 0 || a.buffers[0] == nullptr));
+        }
+
+        inline auto arrow_fail(std::string *error, const std::string &what) -> bool {
+            if (error != nullptr) {
+                *error = what;
+            }
+            return false;
+        }
+
+    }  // namespace detail
+
+    /**
+     * Exports numer[0..n) and denom[0..n) as an Arrow struct array without
+     * copying them.
+     *
+     * @param[in] numer The numerators.
+     * @param[in] denom The denominators.
+     * @param[in] n The number of rows.
+     * @param[in] owner Keeps both arrays alive until the consumer releases
+     * the last exported structure (may be null if they outlive it anyway).
+     * @param[out] array Receives the array (the consumer must release it).
+     * @param[out] schema If not null, receives the schema (likewise).
+     */
+    inline void export_columns(const std::int64_t *numer, const std::int64_t *denom,
+                               std::size_t n, std::shared_ptr<const void> owner,
+                               ArrowArray *array, ArrowSchema *schema = nullptr) {
+        auto *priv = new detail::ArrowArrayData;
+        priv->owner = owner;
+        detail::make_arrow_child(priv->child_arrays[0], numer, n, owner);
+        detail::make_arrow_child(priv->child_arrays[1], denom, n, owner);
+        priv->children[0] = &priv->child_arrays[0];
+        priv->children[1] = &priv->child_arrays[1];
+        *array = ArrowArray{};
+        array->length = static_cast<std::int64_t>(n);
+        array->n_buffers = 1;  // no validity bitmap: the struct is not nullable
+        array->n_children = 2;
+        array->buffers = priv->buffers;
+        array->children = priv->children;
+        array->release = &detail::release_arrow_array;
+        array->private_data = priv;
+        if (schema != nullptr) {
+            detail::make_arrow_schema(schema);
+        }
+    }
+
+    /**
+     * Exports two shared int64 columns of equal length without copying;
+     * the structures share ownership of the vectors.
+     *
+     * @return false (and nothing exported) if the lengths differ.
+     */
+    inline auto export_columns(std::shared_ptr<const std::vector<std::int64_t>> numer,
+                               std::shared_ptr<const std::vector<std::int64_t>> denom,
+                               ArrowArray *array, ArrowSchema *schema = nullptr,
+                               std::string *error = nullptr) -> bool {
+        if (numer->size() != denom->size()) {
+            return detail::arrow_fail(error, "the columns differ in length");
+        }
+        // one owner for both vectors
+        auto owner = std::make_shared<std::pair<decltype(numer), decltype(denom)>>(numer, denom);
+        export_columns(numer->data(), denom->data(), numer->size(), owner, array, schema);
+        return true;
+    }
+
+    /**
+     * Exports x[0..n) as an Arrow struct array, copying the rows into owned
+     * int64 columns (the rows are stored as they are, unreduced).
+     *
+     * @tparam T An integer type that converts to int64 without loss.
+     */
+    template <typename T>
+    void export_fractions(const Fraction<T> *x, std::size_t n, ArrowArray *array,
+                          ArrowSchema *schema = nullptr) {
+        static_assert(std::is_integral<T>::value
+                          && (sizeof(T) < 8 || (sizeof(T) == 8 && std::is_signed<T>::value)),
+                      "Arrow int64 columns hold the terms without loss");
+        auto columns = std::make_shared<std::vector<std::int64_t>>(2 * n);
+        auto *numer = columns->data();
+        auto *denom = numer + n;
+        for (std::size_t i = 0; i != n; ++i) {
+            numer[i] = static_cast<std::int64_t>(x[i]._numer);
+            denom[i] = static_cast<std::int64_t>(x[i]._denom);
+        }
+        export_columns(numer, denom, n, std::move(columns), array, schema);
+    }
+
+    /**
+     * @brief An imported Arrow struct array of int64 numerators and
+     * denominators, read in place.
+     *
+     * Owns the imported array and releases it on destruction. Move-only.
+     */
+    class ArrowColumns {
+        ArrowArray _array{};
+        const std::int64_t *_numer = nullptr;
+        const std::int64_t *_denom = nullptr;
+        std::size_t _size = 0;
+
+      public:
+        ArrowColumns() = default;
+        ArrowColumns(const ArrowColumns &) = delete;
+        auto operator=(const ArrowColumns &) -> ArrowColumns & = delete;
+
+        ArrowColumns(ArrowColumns &&other) noexcept { this->swap(other); }
+        auto operator=(ArrowColumns &&other) noexcept -> ArrowColumns & {
+            if (this != &other) {
+                this->reset();
+                this->swap(other);
+            }
+            return *this;
+        }
+
+        ~ArrowColumns() { this->reset(); }
+
+        /**
+         * Imports a struct array with two non-null int64 children (the
+         * numerators and the denominators). On success the array is moved
+         * in (its release callback is cleared); on failure the caller keeps
+         * it.
+         *
+         * @param[in,out] array The array.
+         * @param[in] schema If not null, must describe a struct of two int64
+         * fields; the caller keeps it.
+         * @param[out] error If not null, receives the reason of a failure.
+         * @return true on success.
+         */
+        auto import(ArrowArray *array, const ArrowSchema *schema = nullptr,
+                    std::string *error = nullptr) -> bool {
+            this->reset();
+            if (schema != nullptr) {
+                if (std::strcmp(schema->format, "+s") != 0 || schema->n_children != 2) {
+                    return detail::arrow_fail(error, "expected a struct of two fields");
+                }
+                for (int i = 0; i != 2; ++i) {
+                    if (std::strcmp(schema->children[i]->format, "l") != 0) {
+                        return detail::arrow_fail(error, "expected int64 fields");
+                    }
+                }
+            }
+            if (array == nullptr || array->release == nullptr) {
+                return detail::arrow_fail(error, "the array is released");
+            }
+            if (array->n_children != 2) {
+                return detail::arrow_fail(error, "expected a struct of two fields");
+            }
+            if (array->offset < 0 || array->length < 0
+                || array->offset > std::numeric_limits<std::int64_t>::max() - array->length) {
+                return detail::arrow_fail(error, "malformed struct array");
+            }
+            if (!detail::arrow_no_nulls(*array)) {
+                return detail::arrow_fail(error, "null rows are not supported");
+            }
+            const std::int64_t *data[2];
+            for (int i = 0; i != 2; ++i) {
+                const auto *child = array->children[i];
+                // the child's own offset applies on top of the parent's within its buffers
+                if (child->n_buffers != 2 || child->offset < 0
+                    || child->length < array->offset + array->length
+                    || child->offset > std::numeric_limits<std::int64_t>::max() - child->length) {
+                    return detail::arrow_fail(error, "malformed int64 field");
+                }
+                if (!detail::arrow_no_nulls(*child)) {
+                    return detail::arrow_fail(error, "null terms are not supported");
+                }
+                data[i] = static_cast<const std::int64_t *>(child->buffers[1]) + child->offset
+                          + array->offset;
+            }
+            this->_array = *array;
+            array->release = nullptr;
+            this->_numer = data[0];
+            this->_denom = data[1];
+            this->_size = static_cast<std::size_t>(array->length);
+            return true;
+        }
+
+        /** Releases the imported array. */
+        void reset() {
+            if (this->_array.release != nullptr) {
+                this->_array.release(&this->_array);
+            }
+            this->_numer = nullptr;
+            this->_denom = nullptr;
+            this->_size = 0;
+        }
+
+        /** @return The number of rows. */
+        auto size() const -> std::size_t { return this->_size; }
+
+        /** @return The numerator column. */
+        auto numer() const -> const std::int64_t * { return this->_numer; }
+
+        /** @return The denominator column. */
+        auto denom() const -> const std::int64_t * { return this->_denom; }
+
+        /** @return Row i as stored (not normalized). */
+        auto operator[](std::size_t i) const -> Fraction<std::int64_t> {
+            Fraction<std::int64_t> x;
+            x._numer = this->_numer[i];
+            x._denom = this->_denom[i];
+            return x;
+        }
+
+        void swap(ArrowColumns &other) noexcept {
+            std::swap(this->_array, other._array);
+            std::swap(this->_numer, other._numer);
+            std::swap(this->_denom, other._denom);
+            std::swap(this->_size, other._size);
+        }
+    };
+
+}  // namespace fractions
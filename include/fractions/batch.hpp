@@ -0,0 +1,177 @@
+#pragma once
+
+/** @file include/fractions/batch.hpp
+ *  Multithreaded bulk kernels over arrays of fractions.
+ *
+ *  Every kernel splits its input into contiguous chunks of at least 16384
+ *  elements, one per thread, like dot(); `threads == 0` uses all hardware
+ *  threads and inputs too short to split run on the calling thread only.
+ *  See also dot(), accumulate_stats(), compare_mask(), nth_element() and
+ *  partial_sort(), which take the same `threads` argument.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+#include "fractions.hpp"
+#include "kernels.hpp"
+#include "statistics.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    /**
+     * Brings every element of x[0..n) into canonical form (non-negative,
+     * reduced denominator) in place.
+     *
+     * @tparam T The integer type.
+     * @param[in,out] x The fractions.
+     * @param[in] n The number of fractions.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void normalize_all(Fraction<T> *x, std::size_t n, unsigned threads = 1) {
+        detail::parallel_for(n, threads, 1, [x](std::size_t first, std::size_t last) {
+            for (auto i = first; i != last; ++i) {
+                x[i].normalize();
+            }
+        });
+    }
+
+    /**
+     * Computes out[i] = a[i] + b[i] for i in [0, n); out may alias a or b.
+     *
+     * @tparam T The integer type.
+     * @param[in] a The first summands.
+     * @param[in] b The second summands.
+     * @param[out] out The sums.
+     * @param[in] n The number of elements.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void add_all(const Fraction<T> *a, const Fraction<T> *b, Fraction<T> *out, std::size_t n,
+                 unsigned threads = 1) {
+        detail::parallel_for(n, threads, 1, [a, b, out](std::size_t first, std::size_t last) {
+            for (auto i = first; i != last; ++i) {
+                out[i] = a[i] + b[i];
+            }
+        });
+    }
+
+    /**
+     * Sums x[0..n) over the lcm of the denominators with one final
+     * reduction (see dot()). The accumulation is overflow-checked in
+     * `widened<T>`.
+     *
+     * @tparam T The integer type.
+     * @param[in] x The values (finite).
+     * @param[in] n The number of values.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     * @return The sum (0/0 if it or the unreduced sum does not fit).
+     */
+    template <typename T>
+    auto sum_all(const Fraction<T> *x, std::size_t n, unsigned threads = 1) -> Fraction<T> {
+        using W = typename widened<T>::type;
+        return detail::parallel_accumulate<detail::Accumulator<T>>(
+                   n, threads,
+                   [x](std::size_t first, std::size_t last) {
+                       detail::Accumulator<T> acc;
+                       for (auto i = first; i != last && acc.ok; ++i) {
+                           acc.add(W(x[i].numer()), W(x[i].denom()));
+                       }
+                       return acc;
+                   })
+            .result();
+    }
+
+    /**
+     * Sorts [first, last) ascending with CrossLess (exact; denominators must
+     * be positive or, for infinities, zero with a non-zero numerator). The
+     * chunks are sorted on separate threads and then merged pairwise, the
+     * merges of one round running in parallel. Not stable.
+     *
+     * @tparam T The integer type.
+     * @param[in,out] first The begin of the range.
+     * @param[in,out] last The end of the range.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void sort_all(Fraction<T> *first, Fraction<T> *last, unsigned threads = 1) {
+        const auto n = static_cast<std::size_t>(last - first);
+        const CrossLess<T> less;
+        if (threads == 0) {
+            threads = std::max(1U, std::thread::hardware_concurrency());
+        }
+        const auto workers = std::min<std::size_t>(
+            threads, std::max<std::size_t>(1, n / detail::dot_chunk_min));
+        if (workers == 1) {
+            std::sort(first, last, less);
+            return;
+        }
+        const auto chunk = (n + workers - 1) / workers;
+        std::vector<std::size_t> bounds;
+        for (std::size_t b = 0; b < n; b += chunk) {
+            bounds.push_back(b);
+        }
+        bounds.push_back(n);
+        {
+            std::vector<std::thread> pool;
+            for (std::size_t k = 1; k + 1 < bounds.size(); ++k) {
+                const auto lo = bounds[k];
+                const auto hi = bounds[k + 1];
+                pool.emplace_back(
+                    [first, less, lo, hi]() { std::sort(first + lo, first + hi, less); });
+            }
+            std::sort(first, first + bounds[1], less);
+            for (auto &th : pool) {
+                th.join();
+            }
+        }
+
+        std::vector<Fraction<T>> buffer(n);
+        auto *src = first;
+        auto *dst = buffer.data();
+        while (bounds.size() > 2) {
+            std::vector<std::size_t> merged;
+            std::vector<std::thread> pool;
+            for (std::size_t k = 0; k + 1 < bounds.size(); k += 2) {
+                const auto lo = bounds[k];
+                merged.push_back(lo);
+                if (k + 2 < bounds.size()) {
+                    const auto mid = bounds[k + 1];
+                    const auto hi = bounds[k + 2];
+                    pool.emplace_back([src, dst, lo, mid, hi, less]() {
+                        std::merge(src + lo, src + mid, src + mid, src + hi, dst + lo, less);
+                    });
+                } else {
+                    std::copy(src + lo, src + bounds[k + 1], dst + lo);
+                }
+            }
+            merged.push_back(n);
+            for (auto &th : pool) {
+                th.join();
+            }
+            bounds.swap(merged);
+            std::swap(src, dst);
+        }
+        if (src != first) {
+            std::copy(src, src + n, first);
+        }
+    }
+}  // namespace fractions
+
+// see FRACTIONS_FOR_INSTANTIATED_TYPES in fractions.hpp
+#define FRACTIONS_BATCH_TEMPLATES(prefix, T)                                                    \
+    prefix void normalize_all<T>(Fraction<T> *, std::size_t, unsigned);                         \
+    prefix void add_all<T>(const Fraction<T> *, const Fraction<T> *, Fraction<T> *, std::size_t,\
+                           unsigned);                                                           \
+    prefix auto sum_all<T>(const Fraction<T> *, std::size_t, unsigned) -> Fraction<T>;          \
+    prefix void sort_all<T>(Fraction<T> *, Fraction<T> *, unsigned);
+
+#ifdef FRACTIONS_EXTERN_TEMPLATES
+namespace fractions {
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_BATCH_TEMPLATES, extern template)
+}  // namespace fractions
+#endif
@@ -0,0 +1,191 @@
+#pragma once
+
+/** @file include/fractions/bigint.hpp
+ *  A minimal arbitrary-precision signed integer for exact sign computations.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace fractions {
+
+    /**
+     * @brief Arbitrary-precision signed integer supporting the ring
+     * operations + - * and comparison.
+     *
+     * Meant as the "wide integer" of exact fallback paths (determinant signs,
+     * cleared numerators), where the operands of a fixed-width T overflow
+     * any fixed width. There is no division.
+     *
+     * Example:
+     * ```
+     * BigInt a(INT64_MAX);
+     * (a * a * a).sign() == 1;
+     * ```
+     */
+    class BigInt {
+        std::vector<std::uint32_t> _mag;  // magnitude, little-endian, no leading zeros
+        bool _neg = false;
+
+        void trim() {
+            while (!this->_mag.empty() && this->_mag.back() == 0) {
+                this->_mag.pop_back();
+            }
+            if (this->_mag.empty()) {
+                this->_neg = false;
+            }
+        }
+
+        static auto cmp_mag(const std::vector<std::uint32_t> &a,
+                            const std::vector<std::uint32_t> &b) -> int {
+            if (a.size() != b.size()) {
+                return a.size() < b.size() ? -1 : 1;
+            }
+            for (auto i = a.size(); i-- != 0;) {
+                if (a[i] != b[i]) {
+                    return a[i] < b[i] ? -1 : 1;
+                }
+            }
+            return 0;
+        }
+
+        // |a| + |b|
+        static auto add_mag(const std::vector<std::uint32_t> &a,
+                            const std::vector<std::uint32_t> &b) -> std::vector<std::uint32_t> {
+            const auto &lng = a.size() >= b.size() ? a : b;
+            const auto &sht = a.size() >= b.size() ? b : a;
+            std::vector<std::uint32_t> res(lng.size() + 1);
+            std::uint64_t carry = 0;
+            for (std::size_t i = 0; i != lng.size(); ++i) {
+                carry += std::uint64_t(lng[i]) + (i < sht.size() ? sht[i] : 0U);
+                res[i] = static_cast<std::uint32_t>(carry);
+                carry >>= 32;
+            }
+            res[lng.size()] = static_cast<std::uint32_t>(carry);
+            return res;
+        }
+
+        // |a| - |b|, requires |a| >= |b|
+        static auto sub_mag(const std::vector<std::uint32_t> &a,
+                            const std::vector<std::uint32_t> &b) -> std::vector<std::uint32_t> {
+            std::vector<std::uint32_t> res(a.size());
+            std::int64_t borrow = 0;
+            for (std::size_t i = 0; i != a.size(); ++i) {
+                auto d = std::int64_t(a[i]) - (i < b.size() ? b[i] : 0U) - borrow;
+                borrow = d < 0 ? 1 : 0;
+                res[i] = static_cast<std::uint32_t>(d + (borrow << 32));
+            }
+            return res;
+        }
+
+      public:
+        /**
+         * Constructs zero.
+         */
+        BigInt() = default;
+
+        /**
+         * Constructs a BigInt from a built-in integer (including 128-bit
+         * integers where the compiler provides them).
+         *
+         * @param[in] v The value.
+         */
+        template <typename I,
+                  typename std::enable_if<std::is_integral<I>::value, int>::type = 0>
+        explicit BigInt(I v) {
+            using U = typename std::make_unsigned<I>::type;
+            auto mag = static_cast<U>(v);
+            if (v < 0) {
+                this->_neg = true;
+                mag = static_cast<U>(U(0) - mag);
+            }
+            while (mag != 0) {
+                this->_mag.push_back(static_cast<std::uint32_t>(mag & 0xFFFFFFFFU));
+                mag = static_cast<U>((mag >> 16) >> 16);
+            }
+        }
+
+        /** @return -1, 0 or 1 according to the sign. */
+        auto sign() const noexcept -> int {
+            return this->_mag.empty() ? 0 : (this->_neg ? -1 : 1);
+        }
+
+        /** @return The number of significant bits of the magnitude. */
+        auto bit_length() const noexcept -> std::size_t {
+            if (this->_mag.empty()) {
+                return 0;
+            }
+            std::size_t bits = 32 * (this->_mag.size() - 1);
+            for (auto top = this->_mag.back(); top != 0; top >>= 1) {
+                ++bits;
+            }
+            return bits;
+        }
+
+        auto operator-() const -> BigInt {
+            auto res = *this;
+            res._neg = !res._neg;
+            res.trim();
+            return res;
+        }
+
+        auto operator+=(const BigInt &rhs) -> BigInt & {
+            if (this->_neg == rhs._neg) {
+                this->_mag = add_mag(this->_mag, rhs._mag);
+            } else if (cmp_mag(this->_mag, rhs._mag) >= 0) {
+                this->_mag = sub_mag(this->_mag, rhs._mag);
+            } else {
+                this->_mag = sub_mag(rhs._mag, this->_mag);
+                this->_neg = rhs._neg;
+            }
+            this->trim();
+            return *this;
+        }
+
+        auto operator-=(const BigInt &rhs) -> BigInt & { return *this += -rhs; }
+
+        auto operator*=(const BigInt &rhs) -> BigInt & {
+            if (this->_mag.empty() || rhs._mag.empty()) {
+                *this = BigInt();
+                return *this;
+            }
+            std::vector<std::uint32_t> res(this->_mag.size() + rhs._mag.size());
+            for (std::size_t i = 0; i != this->_mag.size(); ++i) {
+                std::uint64_t carry = 0;
+                for (std::size_t j = 0; j != rhs._mag.size(); ++j) {
+                    carry += std::uint64_t(this->_mag[i]) * rhs._mag[j] + res[i + j];
+                    res[i + j] = static_cast<std::uint32_t>(carry);
+                    carry >>= 32;
+                }
+                res[i + rhs._mag.size()] = static_cast<std::uint32_t>(carry);
+            }
+            this->_mag.swap(res);
+            this->_neg = this->_neg != rhs._neg;
+            this->trim();
+            return *this;
+        }
+
+        friend auto operator+(BigInt lhs, const BigInt &rhs) -> BigInt { return lhs += rhs; }
+        friend auto operator-(BigInt lhs, const BigInt &rhs) -> BigInt { return lhs -= rhs; }
+        friend auto operator*(BigInt lhs, const BigInt &rhs) -> BigInt { return lhs *= rhs; }
+
+        friend auto operator==(const BigInt &lhs, const BigInt &rhs) -> bool {
+            return lhs._neg == rhs._neg && lhs._mag == rhs._mag;
+        }
+
+        friend auto operator!=(const BigInt &lhs, const BigInt &rhs) -> bool {
+            return !(lhs == rhs);
+        }
+
+        friend auto operator<(const BigInt &lhs, const BigInt &rhs) -> bool {
+            if (lhs._neg != rhs._neg) {
+                return lhs._neg;
+            }
+            const auto c = cmp_mag(lhs._mag, rhs._mag);
+            return lhs._neg ? c > 0 : c < 0;
+        }
+    };
+}  // namespace fractions
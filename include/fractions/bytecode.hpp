@@ -0,0 +1,596 @@
+#pragma once
+
+/** @file include/fractions/bytecode.hpp
+ *  A formula compiler and register machine for evaluating one rational
+ *  expression over many rows.
+ *
+ *  compile() parses a formula such as `(a*b + c)/d` once into register
+ *  code, folding subexpressions of constants into one constant.
+ *  The Program then evaluates rows with a tight interpreter loop
+ *  (run(), operator()) or whole columns with evaluate(), which applies each
+ *  instruction to a block of rows before moving on to the next one.
+ *
+ * Example:
+ * ```
+ * Program<int> p;
+ * compile("(a*b + c) / d", {"a", "b", "c", "d"}, p);
+ * const Fraction<int> row[] = {{1, 2}, {2, 3}, {1, 6}, {2, 1}};
+ * p(row);  // 1/4
+ * ```
+ *
+ * Arithmetic is the eager Fraction arithmetic, so each instruction
+ * normalizes its result and division by zero gives a zero denominator.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "fractions.hpp"
+#include "kernels.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    /** @brief Instruction set of Program. */
+    enum class OpCode : std::uint8_t { Neg, Add, Sub, Mul, Div };
+
+    /** @brief regs[dst] = regs[a] op regs[b]; Neg ignores b. */
+    struct Instruction {
+        OpCode op;
+        std::uint32_t dst;
+        std::uint32_t a;
+        std::uint32_t b;
+    };
+
+    template <typename T> class Program;
+
+    namespace detail {
+        template <typename T> class FormulaCompiler;
+    }
+
+    /**
+     * @brief Compiled formula over `Fraction<T>` variables.
+     *
+     * The registers are laid out as the inputs (in the order of the
+     * variable names given to compile()), the folded constants and the
+     * temporaries; the temporaries are reused in stack order, so their
+     * number is the nesting depth of the formula rather than its size.
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> class Program {
+        friend class detail::FormulaCompiler<T>;
+
+        std::size_t _inputs = 0;
+        std::vector<Fraction<T>> _constants;
+        std::size_t _temps = 0;
+        std::vector<Instruction> _code;
+        std::uint32_t _result = 0;
+
+        static constexpr std::size_t block = 256;  // rows per column step of evaluate()
+
+      public:
+        /** @return The number of variables. */
+        auto inputs() const -> std::size_t { return this->_inputs; }
+
+        /** @return The constants, held in the registers following the inputs. */
+        auto constants() const -> const std::vector<Fraction<T>> & { return this->_constants; }
+
+        /** @return The total number of registers. */
+        auto registers() const -> std::size_t {
+            return this->_inputs + this->_constants.size() + this->_temps;
+        }
+
+        /** @return The instructions. */
+        auto code() const -> const std::vector<Instruction> & { return this->_code; }
+
+        /** @return The register holding the value of the formula after the code ran. */
+        auto result() const -> std::uint32_t { return this->_result; }
+
+        /** @return A register file with the constants loaded, for run(). */
+        auto scratch() const -> std::vector<Fraction<T>> {
+            std::vector<Fraction<T>> regs(this->registers());
+            std::copy(this->_constants.begin(), this->_constants.end(),
+                      regs.begin() + std::ptrdiff_t(this->_inputs));
+            return regs;
+        }
+
+        /**
+         * Evaluates one row without allocating.
+         *
+         * @param[in] args The values of the variables.
+         * @param[in,out] regs A register file obtained from scratch().
+         * @return The value of the formula.
+         */
+        auto run(const Fraction<T> *args, std::vector<Fraction<T>> &regs) const -> Fraction<T> {
+            auto *r = regs.data();
+            std::copy(args, args + this->_inputs, r);
+            for (const auto &ins : this->_code) {
+                switch (ins.op) {
+                    case OpCode::Neg:
+                        r[ins.dst] = -r[ins.a];
+                        break;
+                    case OpCode::Add:
+                        r[ins.dst] = r[ins.a] + r[ins.b];
+                        break;
+                    case OpCode::Sub:
+                        r[ins.dst] = r[ins.a] - r[ins.b];
+                        break;
+                    case OpCode::Mul:
+                        r[ins.dst] = r[ins.a] * r[ins.b];
+                        break;
+                    case OpCode::Div:
+                        r[ins.dst] = r[ins.a] / r[ins.b];
+                        break;
+                }
+            }
+            return r[this->_result];
+        }
+
+        /**
+         * Evaluates one row.
+         *
+         * @param[in] args The values of the variables.
+         * @return The value of the formula.
+         */
+        auto operator()(const Fraction<T> *args) const -> Fraction<T> {
+            auto regs = this->scratch();
+            return this->run(args, regs);
+        }
+
+        /**
+         * Evaluates rows [0, n) column by column: out[i] is the value for
+         * the variables columns[0][i], columns[1][i], ...
+         *
+         * @param[in] columns One array of n values per variable.
+         * @param[in] n The number of rows.
+         * @param[out] out The n results.
+         * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+         */
+        void evaluate(const Fraction<T> *const *columns, std::size_t n, Fraction<T> *out,
+                      unsigned threads = 1) const {
+            detail::parallel_for(n, threads, block, [this, columns, out](std::size_t first,
+                                                                        std::size_t last) {
+                std::vector<Fraction<T>> temps(this->_temps * block);
+                for (auto lo = first; lo < last; lo += block) {
+                    this->evaluate_block(columns, lo, std::min(block, last - lo), temps, out);
+                }
+            });
+        }
+
+      private:
+        /** A register as a column of the current block (stride 0 for a constant). */
+        struct Operand {
+            const Fraction<T> *values;
+            std::size_t stride;
+        };
+
+        auto operand(std::uint32_t reg, const Fraction<T> *const *columns, std::size_t lo,
+                     const std::vector<Fraction<T>> &temps) const -> Operand {
+            if (reg < this->_inputs) {
+                return Operand{columns[reg] + lo, 1};
+            }
+            reg -= std::uint32_t(this->_inputs);
+            if (reg < this->_constants.size()) {
+                return Operand{&this->_constants[reg], 0};
+            }
+            reg -= std::uint32_t(this->_constants.size());
+            return Operand{temps.data() + std::size_t(reg) * block, 1};
+        }
+
+        template <typename Op>
+        static void apply(Operand a, Operand b, Fraction<T> *dst, std::size_t len, Op op) {
+            for (std::size_t r = 0; r != len; ++r) {
+                dst[r] = op(a.values[r * a.stride], b.values[r * b.stride]);
+            }
+        }
+
+        struct neg_fn {
+            auto operator()(const Fraction<T> &a, const Fraction<T> &) const -> Fraction<T> {
+                return -a;
+            }
+        };
+        struct add_fn {
+            auto operator()(const Fraction<T> &a, const Fraction<T> &b) const -> Fraction<T> {
+                return a + b;
+            }
+        };
+        struct sub_fn {
+            auto operator()(const Fraction<T> &a, const Fraction<T> &b) const -> Fraction<T> {
+                return a - b;
+            }
+        };
+        struct mul_fn {
+            auto operator()(const Fraction<T> &a, const Fraction<T> &b) const -> Fraction<T> {
+                return a * b;
+            }
+        };
+        struct div_fn {
+            auto operator()(const Fraction<T> &a, const Fraction<T> &b) const -> Fraction<T> {
+                return a / b;
+            }
+        };
+
+        void evaluate_block(const Fraction<T> *const *columns, std::size_t lo, std::size_t len,
+                            std::vector<Fraction<T>> &temps, Fraction<T> *out) const {
+            if (this->_code.empty()) {
+                const auto r = this->operand(this->_result, columns, lo, temps);
+                for (std::size_t i = 0; i != len; ++i) {
+                    out[lo + i] = r.values[i * r.stride];
+                }
+                return;
+            }
+            const auto first_temp = this->_inputs + this->_constants.size();
+            for (std::size_t k = 0; k != this->_code.size(); ++k) {
+                const auto &ins = this->_code[k];
+                auto *dst = k + 1 == this->_code.size()
+                                ? out + lo
+                                : temps.data() + (ins.dst - first_temp) * block;
+                const auto a = this->operand(ins.a, columns, lo, temps);
+                const auto b = this->operand(ins.b, columns, lo, temps);
+                switch (ins.op) {
+                    case OpCode::Neg:
+                        apply(a, a, dst, len, neg_fn());
+                        break;
+                    case OpCode::Add:
+                        apply(a, b, dst, len, add_fn());
+                        break;
+                    case OpCode::Sub:
+                        apply(a, b, dst, len, sub_fn());
+                        break;
+                    case OpCode::Mul:
+                        apply(a, b, dst, len, mul_fn());
+                        break;
+                    case OpCode::Div:
+                        apply(a, b, dst, len, div_fn());
+                        break;
+                }
+            }
+        }
+    };
+
+    template <typename T> constexpr std::size_t Program<T>::block;
+
+    namespace detail {
+
+        /**
+         * Recursive-descent parser emitting register code. Operands are kept
+         * tagged (input, constant or temporary) while parsing, so that
+         * constants can be folded, and are numbered when the code is final.
+         */
+        template <typename T> class FormulaCompiler {
+            enum class Kind { Input, Constant, Temp };
+
+            struct Value {
+                Kind kind;
+                std::uint32_t index;
+            };
+
+            struct Pending {
+                OpCode op;
+                Value dst, a, b;
+            };
+
+            static constexpr int max_depth = 256;
+
+            const std::string &_text;
+            const std::vector<std::string> &_names;
+            std::string *_error;
+            std::size_t _pos = 0;
+            int _depth = 0;
+            std::vector<Fraction<T>> _constants;
+            std::vector<Pending> _code;
+            std::uint32_t _temps = 0;
+            std::uint32_t _max_temps = 0;
+
+          public:
+            FormulaCompiler(const std::string &text, const std::vector<std::string> &names,
+                            std::string *error)
+                : _text(text), _names(names), _error(error) {}
+
+            auto compile(Program<T> &program) -> bool {
+                Value v;
+                if (!this->expr(v)) {
+                    return false;
+                }
+                this->skip();
+                if (this->_pos != this->_text.size()) {
+                    return this->unexpected();
+                }
+                this->finish(v, program);
+                return true;
+            }
+
+          private:
+            auto fail(const std::string &what) -> bool {
+                if (this->_error != nullptr) {
+                    *this->_error = what + " at column " + std::to_string(this->_pos + 1);
+                }
+                return false;
+            }
+
+            auto unexpected() -> bool {
+                if (this->_pos == this->_text.size()) {
+                    return this->fail("unexpected end of formula");
+                }
+                return this->fail(std::string("unexpected '") + this->_text[this->_pos] + "'");
+            }
+
+            void skip() {
+                while (this->_pos < this->_text.size()
+                       && (this->_text[this->_pos] == ' ' || this->_text[this->_pos] == '\t')) {
+                    ++this->_pos;
+                }
+            }
+
+            auto peek() -> char {
+                this->skip();
+                return this->_pos < this->_text.size() ? this->_text[this->_pos] : '\0';
+            }
+
+            /** @return The character after the current one, or '\0'. */
+            auto next() const -> char {
+                return this->_pos + 1 < this->_text.size() ? this->_text[this->_pos + 1] : '\0';
+            }
+
+            static auto is_digit(char c) -> bool { return c >= '0' && c <= '9'; }
+
+            static auto is_alpha(char c) -> bool {
+                return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+            }
+
+            auto constant(const Fraction<T> &value) -> Value {
+                this->_constants.push_back(value);
+                return Value{Kind::Constant, std::uint32_t(this->_constants.size() - 1)};
+            }
+
+            /** @return The bits of the larger term of x. */
+            static auto bits(const Fraction<T> &x) -> int {
+                int n = 0, d = 0;
+                for (auto v = x._numer; v != T(0); v = T(v / T(2))) {
+                    ++n;
+                }
+                for (auto v = x._denom; v != T(0); v = T(v / T(2))) {
+                    ++d;
+                }
+                return n < d ? d : n;
+            }
+
+            /**
+             * True if `x op y` cannot overflow T: the terms of a sum, product
+             * or quotient have at most bits(x) + bits(y) + 1 bits.
+             */
+            static auto foldable(OpCode op, const Fraction<T> &x, const Fraction<T> &y) -> bool {
+                return !is_fixed_width<T>::value || op == OpCode::Neg
+                       || bits(x) + bits(y) + 1 <= std::numeric_limits<T>::digits;
+            }
+
+            /**
+             * Emits `op a b` into the lowest free temporary, or folds it if
+             * both are constants and folding cannot overflow.
+             */
+            auto emit(OpCode op, Value a, Value b) -> Value {
+                if (a.kind == Kind::Constant && b.kind == Kind::Constant
+                    && foldable(op, this->_constants[a.index], this->_constants[b.index])) {
+                    const auto &x = this->_constants[a.index];
+                    const auto &y = this->_constants[b.index];
+                    switch (op) {
+                        case OpCode::Neg:
+                            return this->constant(-x);
+                        case OpCode::Add:
+                            return this->constant(x + y);
+                        case OpCode::Sub:
+                            return this->constant(x - y);
+                        case OpCode::Mul:
+                            return this->constant(x * y);
+                        case OpCode::Div:
+                            return this->constant(x / y);
+                    }
+                }
+                // the temporaries of the operands are the topmost ones
+                this->_temps -= std::uint32_t(a.kind == Kind::Temp);
+                this->_temps -= std::uint32_t(op != OpCode::Neg && b.kind == Kind::Temp);
+                const Value dst{Kind::Temp, this->_temps++};
+                this->_max_temps = std::max(this->_max_temps, this->_temps);
+                this->_code.push_back(Pending{op, dst, a, b});
+                return dst;
+            }
+
+            auto expr(Value &v) -> bool {
+                if (++this->_depth > max_depth) {
+                    return this->fail("nesting too deep");
+                }
+                if (!this->term(v)) {
+                    return false;
+                }
+                for (auto c = this->peek(); c == '+' || c == '-'; c = this->peek()) {
+                    ++this->_pos;
+                    Value rhs;
+                    if (!this->term(rhs)) {
+                        return false;
+                    }
+                    v = this->emit(c == '+' ? OpCode::Add : OpCode::Sub, v, rhs);
+                }
+                --this->_depth;
+                return true;
+            }
+
+            auto term(Value &v) -> bool {
+                if (!this->unary(v)) {
+                    return false;
+                }
+                for (auto c = this->peek(); c == '*' || c == '/'; c = this->peek()) {
+                    ++this->_pos;
+                    Value rhs;
+                    if (!this->unary(rhs)) {
+                        return false;
+                    }
+                    v = this->emit(c == '*' ? OpCode::Mul : OpCode::Div, v, rhs);
+                }
+                return true;
+            }
+
+            auto unary(Value &v) -> bool {
+                const auto c = this->peek();
+                if (c != '-' && c != '+') {
+                    return this->primary(v);
+                }
+                if (++this->_depth > max_depth) {
+                    return this->fail("nesting too deep");
+                }
+                ++this->_pos;
+                if (!this->unary(v)) {
+                    return false;
+                }
+                --this->_depth;
+                if (c == '-') {
+                    v = this->emit(OpCode::Neg, v, v);
+                }
+                return true;
+            }
+
+            auto primary(Value &v) -> bool {
+                const auto c = this->peek();
+                if (c == '(') {
+                    ++this->_pos;
+                    if (!this->expr(v)) {
+                        return false;
+                    }
+                    if (this->peek() != ')') {
+                        return this->fail("expected ')'");
+                    }
+                    ++this->_pos;
+                    return true;
+                }
+                if (is_alpha(c) || (c == '$' && is_digit(this->next()))) {
+                    const auto start = this->_pos++;
+                    while (this->_pos < this->_text.size()
+                           && (is_alpha(this->_text[this->_pos])
+                               || is_digit(this->_text[this->_pos]))) {
+                        ++this->_pos;
+                    }
+                    const auto name = this->_text.substr(start, this->_pos - start);
+                    const auto it = std::find(this->_names.begin(), this->_names.end(), name);
+                    if (it == this->_names.end()) {
+                        this->_pos = start;
+                        return this->fail("unknown variable '" + name + "'");
+                    }
+                    v = Value{Kind::Input, std::uint32_t(it - this->_names.begin())};
+                    return true;
+                }
+                if (is_digit(c) || c == '.') {
+                    return this->number(v);
+                }
+                return this->unexpected();
+            }
+
+            /**
+             * Reads an unsigned integer or decimal literal ("12", "1.25") into
+             * an exact constant; a sign is parsed as unary minus.
+             */
+            auto number(Value &v) -> bool {
+                const auto start = this->_pos;
+                T numer(0), denom(1);
+                bool point = false, digits = false;
+                for (; this->_pos < this->_text.size(); ++this->_pos) {
+                    const auto c = this->_text[this->_pos];
+                    if (c == '.' && !point) {
+                        point = true;
+                        continue;
+                    }
+                    if (!is_digit(c)) {
+                        break;
+                    }
+                    const auto digit = T(c - '0');
+                    if (std::numeric_limits<T>::is_specialized
+                        && (numer > (std::numeric_limits<T>::max() - digit) / T(10)
+                            || (point && denom > std::numeric_limits<T>::max() / T(10)))) {
+                        this->_pos = start;
+                        return this->fail("number out of range");
+                    }
+                    numer = T(numer * T(10) + digit);
+                    if (point) {
+                        denom = T(denom * T(10));
+                    }
+                    digits = true;
+                }
+                if (!digits) {
+                    this->_pos = start;
+                    return this->fail("invalid number");
+                }
+                v = this->constant(Fraction<T>(numer, denom));
+                return true;
+            }
+
+            /** Numbers the registers, dropping constants that were folded away. */
+            void finish(Value v, Program<T> &program) {
+                std::vector<std::uint32_t> slot(this->_constants.size(), 0);
+                std::vector<bool> used(this->_constants.size(), false);
+                const auto mark = [&used](const Value &x) {
+                    if (x.kind == Kind::Constant) {
+                        used[x.index] = true;
+                    }
+                };
+                for (const auto &p : this->_code) {
+                    mark(p.a);
+                    mark(p.b);
+                }
+                mark(v);
+                program._inputs = this->_names.size();
+                program._constants.clear();
+                for (std::size_t i = 0; i != this->_constants.size(); ++i) {
+                    if (used[i]) {
+                        slot[i] = std::uint32_t(program._constants.size());
+                        program._constants.push_back(this->_constants[i]);
+                    }
+                }
+                program._temps = this->_max_temps;
+                const auto inputs = std::uint32_t(program._inputs);
+                const auto temps = std::uint32_t(inputs + program._constants.size());
+                const auto reg = [&slot, inputs, temps](const Value &x) -> std::uint32_t {
+                    return x.kind == Kind::Input      ? x.index
+                           : x.kind == Kind::Constant ? inputs + slot[x.index]
+                                                      : temps + x.index;
+                };
+                program._code.clear();
+                for (const auto &p : this->_code) {
+                    program._code.push_back(Instruction{p.op, reg(p.dst), reg(p.a), reg(p.b)});
+                }
+                program._result = reg(v);
+            }
+        };
+
+        template <typename T> constexpr int FormulaCompiler<T>::max_depth;
+
+    }  // namespace detail
+
+    /**
+     * Compiles a formula over the given variables.
+     *
+     * The formula consists of integer and decimal literals, the variable
+     * names (letters, digits and underscores, or `$` followed by digits such
+     * as `$3`), `+ - * /`, unary minus and parentheses, with the usual
+     * precedence. Subexpressions of constants whose terms could overflow T
+     * are not folded but left to the evaluation, like any other operation.
+     * Literals are unsigned and a leading `-` is unary minus, so a literal
+     * must fit in T before its negation: the minimum of T (e.g.
+     * `-2147483648` for int) is out of range.
+     *
+     * @tparam T The integer type.
+     * @param[in] formula The formula, e.g. `(a*b + c) / d`.
+     * @param[in] variables The variable names; their order is the order of the inputs.
+     * @param[out] program The compiled program (unchanged on failure).
+     * @param[out] error If not null, receives a message with the column of a syntax error.
+     * @return true on success.
+     */
+    template <typename T>
+    auto compile(const std::string &formula, const std::vector<std::string> &variables,
+                 Program<T> &program, std::string *error = nullptr) -> bool {
+        return detail::FormulaCompiler<T>(formula, variables, error).compile(program);
+    }
+
+}  // namespace fractions
@@ -0,0 +1,421 @@
+#pragma once
+
+/** @file include/fractions/codec.hpp
+ *  Compact serialization of fraction streams.
+ *
+ *  Every row starts with one varint `zigzag(numerator) << 2 | mode`, where
+ *  the mode says where the denominator comes from:
+ *
+ *  - 0: the denominator of the previous row (nothing follows);
+ *  - 1: an entry of the dictionary of recent denominators (its index follows);
+ *  - 2: a new denominator (zigzag of its difference to the previous one
+ *    follows), which is then added to the dictionary;
+ *  - 3: escape for numerators whose zigzag code needs more than 62 bits:
+ *    the head is exactly 3, and the code and the actual mode (0, 1 or 2)
+ *    follow as separate varints; any other head with mode 3 is corrupt.
+ *
+ *  Varints are LEB128. The stream starts with denominator 1 and an empty
+ *  dictionary, which holds the last dictionary_size new denominators. Rows
+ *  sharing a denominator with small numerators thus take a single byte, and
+ *  a tick stream that alternates between a few denominators two or three.
+ *
+ *  Any signed or unsigned integer of at most 64 bits can be stored; values
+ *  are encoded modulo 2^64, so every row round-trips, including zero and
+ *  negative denominators.
+ *
+ *  Decoding reads 8 bytes at a time and extracts a varint of up to 8 bytes
+ *  with a few shifts and masks, and, where SSE2 is available, recognizes
+ *  16 single-byte rows at once and decodes them in vector registers; other
+ *  targets use the same test on 8 bytes in a general-purpose register.
+ *
+ * Example:
+ * ```
+ * const auto bytes = encode(ticks.data(), ticks.size());
+ * std::vector<Fraction<std::int64_t>> back;
+ * decode(bytes.data(), bytes.size(), back);
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "fractions.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#    include <emmintrin.h>
+#    define FRACTIONS_CODEC_SSE2 1
+#endif
+
+namespace fractions {
+
+    namespace detail {
+
+        constexpr std::size_t dictionary_size = 256;
+
+        inline auto zigzag64(std::uint64_t v) -> std::uint64_t {
+            return (v << 1) ^ (std::uint64_t(0) - (v >> 63));
+        }
+
+        inline auto unzigzag64(std::uint64_t v) -> std::uint64_t {
+            return (v >> 1) ^ (std::uint64_t(0) - (v & 1U));
+        }
+
+        /** Converts to 64 bits, sign-extending signed types. */
+        template <typename T> auto to_bits(const T &x) -> std::uint64_t {
+            return static_cast<std::uint64_t>(static_cast<std::int64_t>(x));
+        }
+
+        template <typename T> auto from_bits(std::uint64_t w) -> T { return static_cast<T>(w); }
+
+        inline void put_varint64(std::vector<unsigned char> &out, std::uint64_t v) {
+            while (v >= 0x80U) {
+                out.push_back(static_cast<unsigned char>((v & 0x7FU) | 0x80U));
+                v >>= 7;
+            }
+            out.push_back(static_cast<unsigned char>(v));
+        }
+
+        /** @return The number of trailing zero bits of w (not 0). */
+        inline auto ctz64(std::uint64_t w) -> int {
+#if defined(__GNUC__) || defined(__clang__)
+            return __builtin_ctzll(w);
+#else
+            int n = 0;
+            for (; (w & 1U) == 0; w >>= 1) {
+                ++n;
+            }
+            return n;
+#endif
+        }
+
+        inline auto load_le64(const unsigned char *p) -> std::uint64_t {
+            std::uint64_t w = 0;
+            for (int i = 7; i >= 0; --i) {
+                w = (w << 8) | p[i];
+            }
+            return w;
+        }
+
+        /**
+         * Reads a varint at p (end is one past the input). Where 8 bytes
+         * are readable, a varint of up to 8 bytes is extracted from one
+         * 64-bit load by compacting the 7-bit groups pairwise.
+         *
+         * @return The byte past the varint, or null if it is truncated or too long.
+         */
+        inline auto get_varint64(const unsigned char *p, const unsigned char *end,
+                                 std::uint64_t &v) -> const unsigned char * {
+            if (end - p >= 8) {
+                const auto w = load_le64(p);
+                const auto stops = ~w & 0x8080808080808080ULL;
+                if (stops != 0) {
+                    const auto bytes = ctz64(stops) / 8 + 1;
+                    auto x = (bytes == 8 ? w : w & ((std::uint64_t(1) << (8 * bytes)) - 1))
+                             & 0x7F7F7F7F7F7F7F7FULL;
+                    x = ((x & 0x7F007F007F007F00ULL) >> 1) | (x & 0x007F007F007F007FULL);
+                    x = ((x & 0x3FFF00003FFF0000ULL) >> 2) | (x & 0x00003FFF00003FFFULL);
+                    x = ((x & 0x0FFFFFFF00000000ULL) >> 4) | (x & 0x000000000FFFFFFFULL);
+                    v = x;
+                    return p + bytes;
+                }
+            }
+            v = 0;
+            for (int shift = 0; shift < 64 && p != end; shift += 7) {
+                const auto byte = *p++;
+                v |= std::uint64_t(byte & 0x7FU) << shift;
+                if ((byte & 0x80U) == 0) {
+                    return shift == 63 && byte > 1 ? nullptr : p;
+                }
+            }
+            return nullptr;
+        }
+
+    }  // namespace detail
+
+    /**
+     * @brief Appends fractions to a compact byte stream (see codec.hpp).
+     *
+     * @tparam T The integer type (a built-in integer of at most 64 bits).
+     */
+    template <typename T> class FractionEncoder {
+        static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                      "the codec stores built-in integers of at most 64 bits");
+
+        std::vector<unsigned char> _bytes;
+        std::uint64_t _prev = 1;
+        std::vector<std::uint64_t> _dict;
+        std::unordered_map<std::uint64_t, std::uint32_t> _index;
+        std::size_t _next = 0;
+
+      public:
+        /** Appends one row. */
+        void push(const Fraction<T> &x) {
+            const auto d = detail::to_bits(x.denom());
+            std::uint64_t mode = 0, payload = 0;
+            if (d != this->_prev) {
+                const auto it = this->_index.find(d);
+                if (it != this->_index.end()) {
+                    mode = 1;
+                    payload = it->second;
+                } else {
+                    mode = 2;
+                    payload = detail::zigzag64(d - this->_prev);
+                    this->remember(d);
+                }
+                this->_prev = d;
+            }
+            const auto z = detail::zigzag64(detail::to_bits(x.numer()));
+            if (z >> 62 == 0) {
+                detail::put_varint64(this->_bytes, (z << 2) | mode);
+            } else {
+                detail::put_varint64(this->_bytes, 3);
+                detail::put_varint64(this->_bytes, z);
+                detail::put_varint64(this->_bytes, mode);
+            }
+            if (mode != 0) {
+                detail::put_varint64(this->_bytes, payload);
+            }
+        }
+
+        /** Appends rows x[0..n). */
+        void push(const Fraction<T> *x, std::size_t n) {
+            for (std::size_t i = 0; i != n; ++i) {
+                this->push(x[i]);
+            }
+        }
+
+        /** @return The encoded stream so far. */
+        auto bytes() const -> const std::vector<unsigned char> & { return this->_bytes; }
+
+        /**
+         * Hands out the bytes encoded so far and clears the buffer; the
+         * stream state carries over, so the chunks must be decoded in order
+         * by one FractionDecoder.
+         */
+        auto take() -> std::vector<unsigned char> {
+            std::vector<unsigned char> out;
+            out.swap(this->_bytes);
+            return out;
+        }
+
+      private:
+        void remember(std::uint64_t d) {
+            if (this->_dict.size() < detail::dictionary_size) {
+                this->_index[d] = std::uint32_t(this->_dict.size());
+                this->_dict.push_back(d);
+                return;
+            }
+            this->_index.erase(this->_dict[this->_next]);
+            this->_dict[this->_next] = d;
+            this->_index[d] = std::uint32_t(this->_next);
+            this->_next = (this->_next + 1) % detail::dictionary_size;
+        }
+    };
+
+    /**
+     * @brief Reads fractions back from a stream written by FractionEncoder.
+     *
+     * @tparam T The integer type the stream was written with.
+     */
+    template <typename T> class FractionDecoder {
+        static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                      "the codec stores built-in integers of at most 64 bits");
+
+        const unsigned char *_p = nullptr;
+        const unsigned char *_end = nullptr;
+        std::uint64_t _prev = 1;
+        std::vector<std::uint64_t> _dict;
+        std::size_t _next = 0;
+        bool _failed = false;
+
+      public:
+        FractionDecoder() = default;
+
+        /** Starts decoding data[0..size). */
+        FractionDecoder(const unsigned char *data, std::size_t size) { this->feed(data, size); }
+
+        /**
+         * Continues with the next chunk of the same stream; the previous
+         * chunk must have been consumed completely.
+         */
+        void feed(const unsigned char *data, std::size_t size) {
+            this->_p = data;
+            this->_end = data + size;
+        }
+
+        /** @return true once the current chunk is consumed. */
+        auto done() const -> bool { return this->_p == this->_end; }
+
+        /** @return true if the input was truncated or corrupt. */
+        auto failed() const -> bool { return this->_failed; }
+
+        /** Decodes one row; returns false at the end of the chunk or on corrupt input. */
+        auto next(Fraction<T> &x) -> bool {
+            if (this->_failed || this->_p == this->_end) {
+                return false;
+            }
+            std::uint64_t head, z, mode;
+            auto *p = detail::get_varint64(this->_p, this->_end, head);
+            if (p == nullptr) {
+                return this->fail();
+            }
+            if (head == 3) {
+                p = detail::get_varint64(p, this->_end, z);
+                p = p != nullptr ? detail::get_varint64(p, this->_end, mode) : nullptr;
+                if (p == nullptr || mode > 2) {
+                    return this->fail();
+                }
+            } else if ((head & 3U) == 3) {
+                return this->fail();  // mode 3 is only the escape head itself
+            } else {
+                z = head >> 2;
+                mode = head & 3U;
+            }
+            if (mode != 0) {
+                std::uint64_t payload;
+                p = detail::get_varint64(p, this->_end, payload);
+                if (p == nullptr) {
+                    return this->fail();
+                }
+                if (mode == 1) {
+                    if (payload >= this->_dict.size()) {
+                        return this->fail();
+                    }
+                    this->_prev = this->_dict[std::size_t(payload)];
+                } else {
+                    this->_prev += detail::unzigzag64(payload);
+                    this->remember(this->_prev);
+                }
+            }
+            this->_p = p;
+            x._numer = detail::from_bits<T>(detail::unzigzag64(z));
+            x._denom = detail::from_bits<T>(this->_prev);
+            return true;
+        }
+
+        /**
+         * Decodes up to n rows into out.
+         *
+         * @return The number of rows decoded (less than n at the end of the
+         * chunk or on corrupt input; see failed()).
+         */
+        auto decode(Fraction<T> *out, std::size_t n) -> std::size_t {
+            std::size_t i = 0;
+            while (i != n && !this->_failed) {
+                const auto fast = this->single_byte_run(out + i, n - i);
+                i += fast;
+                if (fast == 0) {
+                    if (!this->next(out[i])) {
+                        break;
+                    }
+                    ++i;
+                }
+            }
+            return i;
+        }
+
+      private:
+        auto fail() -> bool {
+            this->_failed = true;
+            return false;
+        }
+
+        void remember(std::uint64_t d) {
+            if (this->_dict.size() < detail::dictionary_size) {
+                this->_dict.push_back(d);
+                return;
+            }
+            this->_dict[this->_next] = d;
+            this->_next = (this->_next + 1) % detail::dictionary_size;
+        }
+
+        /**
+         * Decodes a block of rows that are one byte each (mode 0, numerator
+         * in [-32, 31]): 16 with SSE2, otherwise 8.
+         *
+         * @return The number of rows decoded (0 if the next block is not such a run).
+         */
+        auto single_byte_run(Fraction<T> *out, std::size_t room) -> std::size_t {
+            std::int8_t numer[16];
+#ifdef FRACTIONS_CODEC_SSE2
+            constexpr std::size_t width = 16;
+            if (room < width || this->_end - this->_p < std::ptrdiff_t(width)) {
+                return 0;
+            }
+            const auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(this->_p));
+            // no continuation bit and mode 0 in every byte
+            const auto bad = _mm_and_si128(bytes, _mm_set1_epi8(char(0x83)));
+            if (_mm_movemask_epi8(_mm_cmpeq_epi8(bad, _mm_setzero_si128())) != 0xFFFF) {
+                return 0;
+            }
+            // numer = (z >> 1) ^ -(z & 1) with z = byte >> 2
+            const auto z = _mm_and_si128(_mm_srli_epi16(bytes, 2), _mm_set1_epi8(0x3F));
+            const auto half = _mm_and_si128(_mm_srli_epi16(z, 1), _mm_set1_epi8(0x1F));
+            const auto sign = _mm_sub_epi8(_mm_setzero_si128(), _mm_and_si128(z, _mm_set1_epi8(1)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(numer), _mm_xor_si128(half, sign));
+#else
+            constexpr std::size_t width = 8;
+            if (room < width || this->_end - this->_p < std::ptrdiff_t(width)) {
+                return 0;
+            }
+            const auto w = detail::load_le64(this->_p);
+            if ((w & 0x8383838383838383ULL) != 0) {
+                return 0;
+            }
+            for (std::size_t k = 0; k != width; ++k) {
+                const auto z = std::uint8_t((w >> (8 * k + 2)) & 0x3FU);
+                numer[k] = std::int8_t((z >> 1) ^ (0U - (z & 1U)));
+            }
+#endif
+            const auto d = detail::from_bits<T>(this->_prev);
+            for (std::size_t k = 0; k != width; ++k) {
+                out[k]._numer = detail::from_bits<T>(detail::to_bits(numer[k]));
+                out[k]._denom = d;
+            }
+            this->_p += width;
+            return width;
+        }
+    };
+
+    /**
+     * Encodes x[0..n) as one stream (see codec.hpp).
+     *
+     * @tparam T The integer type.
+     * @param[in] x The rows.
+     * @param[in] n The number of rows.
+     * @return The bytes.
+     */
+    template <typename T>
+    auto encode(const Fraction<T> *x, std::size_t n) -> std::vector<unsigned char> {
+        FractionEncoder<T> enc;
+        enc.push(x, n);
+        return enc.take();
+    }
+
+    /**
+     * Decodes a whole stream, appending the rows to out.
+     *
+     * @tparam T The integer type the stream was written with.
+     * @param[in] data The bytes.
+     * @param[in] size The number of bytes.
+     * @param[in,out] out The rows.
+     * @return false if the stream is truncated or corrupt (the rows before
+     * the damage are appended).
+     */
+    template <typename T>
+    auto decode(const unsigned char *data, std::size_t size, std::vector<Fraction<T>> &out)
+        -> bool {
+        FractionDecoder<T> dec(data, size);
+        // every row takes at least one byte
+        const auto first = out.size();
+        out.resize(first + size);
+        const auto n = dec.decode(out.data() + first, size);
+        out.resize(first + n);
+        return !dec.failed() && dec.done();
+    }
+
+}  // namespace fractions
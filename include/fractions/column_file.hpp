@@ -0,0 +1,594 @@
+#pragma once
+
+/** @file include/fractions/column_file.hpp
+ *  A binary columnar file format for large fraction datasets, with a
+ *  streaming writer and a zero-copy memory-mapped reader.
+ *
+ *  The rows are stored in blocks of a fixed number of rows (the last one
+ *  may be shorter). Each block holds its numerators as one contiguous
+ *  array of T and its denominators as a second one, unless all rows of the
+ *  block share one denominator, which is then stored once in the
+ *  directory. The directory at the end of the file lists, for each block,
+ *  its offset, row count, shared denominator and the minimum and maximum of
+ *  its rows, so that scans can skip blocks without touching them.
+ *
+ *  Layout (native byte order, checked by the reader):
+ *  ```
+ *  header       64 bytes: "FRCOLS01", version, byte-order mark, term size,
+ *               signedness, rows, rows per block, blocks, directory offset
+ *  block data   numerators[rows] (and denominators[rows]), 64-byte aligned
+ *  directory    one 56-byte entry per block
+ *  ```
+ *
+ *  On POSIX systems the reader maps the file, and the numerators and
+ *  denominators are read in place; elsewhere the file is read into memory.
+ *
+ * Example:
+ * ```
+ * ColumnWriter<std::int64_t> out;
+ * out.open("prices.frc");
+ * for (const auto &p : prices) out.push(p);
+ * out.close();
+ *
+ * ColumnFile<std::int64_t> in;
+ * in.open("prices.frc");
+ * for (std::size_t b = 0; b != in.blocks(); ++b) {
+ *     const auto block = in.block(b);
+ *     if (block.has_stats() && !(threshold < block.max())) {
+ *         continue;  // no row of the block exceeds the threshold
+ *     }
+ *     if (!block.shared()) {  // the SoA kernels read the mapped columns in place
+ *         compare_mask(block.numer(), block.denom(), block.size(), CompareOp::Greater,
+ *                      threshold, mask);
+ *     }
+ * }
+ * ```
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+#include "statistics.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define FRACTIONS_COLUMN_FILE_MMAP 1
+#endif
+
+namespace fractions {
+
+    namespace detail {
+
+        constexpr char column_file_magic[8] = {'F', 'R', 'C', 'O', 'L', 'S', '0', '1'};
+        constexpr std::uint32_t column_file_version = 1;
+        constexpr std::uint32_t column_file_bom = 0x01020304;
+        constexpr std::size_t column_file_align = 64;
+
+        struct ColumnFileHeader {
+            char magic[8];
+            std::uint32_t version;
+            std::uint32_t bom;
+            std::uint32_t term_size;
+            std::uint32_t is_signed;
+            std::uint64_t rows;
+            std::uint64_t block_rows;
+            std::uint64_t blocks;
+            std::uint64_t directory;
+            std::uint8_t reserved[8];
+        };
+
+        /** Directory entry; the terms are stored as T converted to 64 bits. */
+        struct ColumnBlockEntry {
+            std::uint64_t offset;
+            std::uint32_t rows;
+            std::uint32_t flags;
+            std::uint64_t shared_denom;
+            std::uint64_t min_numer;
+            std::uint64_t min_denom;
+            std::uint64_t max_numer;
+            std::uint64_t max_denom;
+        };
+
+        constexpr std::uint32_t block_shared_denom = 1;
+        constexpr std::uint32_t block_has_stats = 2;
+
+        static_assert(sizeof(ColumnFileHeader) == 64, "unexpected header padding");
+        static_assert(sizeof(ColumnBlockEntry) == 56, "unexpected directory padding");
+
+        template <typename T> auto to_word(const T &x) -> std::uint64_t {
+            return static_cast<std::uint64_t>(x);
+        }
+
+        template <typename T> auto from_word(std::uint64_t w) -> T { return static_cast<T>(w); }
+
+    }  // namespace detail
+
+    /**
+     * @brief A read-only view of one block: a contiguous numerator column
+     * and either a contiguous denominator column or one shared denominator.
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> class ColumnBlock {
+        const T *_numer;
+        const T *_denom;  // null if shared
+        T _shared;
+        std::size_t _size;
+        Fraction<T> _min, _max;
+        bool _has_stats;
+
+      public:
+        ColumnBlock(const T *numer, const T *denom, T shared, std::size_t size,
+                    Fraction<T> min, Fraction<T> max, bool has_stats)
+            : _numer(numer),
+              _denom(denom),
+              _shared(shared),
+              _size(size),
+              _min(min),
+              _max(max),
+              _has_stats(has_stats) {}
+
+        /** @return The number of rows. */
+        auto size() const -> std::size_t { return this->_size; }
+
+        /** @return The numerators. */
+        auto numer() const -> const T * { return this->_numer; }
+
+        /** @return The denominators, or null if the block shares one denominator. */
+        auto denom() const -> const T * { return this->_denom; }
+
+        /** @return true if all rows have the denominator shared_denom(). */
+        auto shared() const -> bool { return this->_denom == nullptr; }
+
+        /** @return The shared denominator (meaningful if shared()). */
+        auto shared_denom() const -> const T & { return this->_shared; }
+
+        /** @return The denominator of row i. */
+        auto denom(std::size_t i) const -> const T & {
+            return this->_denom != nullptr ? this->_denom[i] : this->_shared;
+        }
+
+        /** @return Row i. */
+        auto operator[](std::size_t i) const -> Fraction<T> {
+            Fraction<T> x;
+            x._numer = this->_numer[i];
+            x._denom = this->denom(i);
+            return x;
+        }
+
+        /** @return false if the block holds no rows other than 0/0. */
+        auto has_stats() const -> bool { return this->_has_stats; }
+
+        /** @return The smallest row (if has_stats()). */
+        auto min() const -> const Fraction<T> & { return this->_min; }
+
+        /** @return The largest row (if has_stats()). */
+        auto max() const -> const Fraction<T> & { return this->_max; }
+
+        /** Copies the rows to out[0..size()). */
+        void copy_to(Fraction<T> *out) const {
+            for (std::size_t i = 0; i != this->_size; ++i) {
+                out[i]._numer = this->_numer[i];
+                out[i]._denom = this->denom(i);
+            }
+        }
+    };
+
+    /**
+     * @brief Reader of the columnar file format (see column_file.hpp).
+     *
+     * Move-only; the views returned by block() stay valid until the file is
+     * closed or the reader destroyed.
+     *
+     * @tparam T The integer type (a built-in integer of at most 64 bits).
+     */
+    template <typename T> class ColumnFile {
+        static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                      "the column file stores built-in integers of at most 64 bits");
+
+        const unsigned char *_data = nullptr;
+        std::size_t _length = 0;
+        std::vector<unsigned char> _buffer;  // used where the file cannot be mapped
+        bool _mapped = false;
+        detail::ColumnFileHeader _header{};
+        const detail::ColumnBlockEntry *_directory = nullptr;
+
+      public:
+        ColumnFile() = default;
+        ColumnFile(const ColumnFile &) = delete;
+        auto operator=(const ColumnFile &) -> ColumnFile & = delete;
+
+        ColumnFile(ColumnFile &&other) noexcept { this->swap(other); }
+        auto operator=(ColumnFile &&other) noexcept -> ColumnFile & {
+            if (this != &other) {
+                this->close();
+                this->swap(other);
+            }
+            return *this;
+        }
+
+        ~ColumnFile() { this->close(); }
+
+        /**
+         * Maps the file and validates its header and directory.
+         *
+         * @param[in] path The file name.
+         * @param[out] error If not null, receives the reason of a failure.
+         * @return true on success.
+         */
+        auto open(const std::string &path, std::string *error = nullptr) -> bool {
+            this->close();
+            if (!this->map(path)) {
+                return fail(error, "cannot read " + path);
+            }
+            std::string reason;
+            if (!this->validate(reason)) {
+                this->close();
+                return fail(error, path + ": " + reason);
+            }
+            return true;
+        }
+
+        /** Unmaps the file. */
+        void close() {
+#ifdef FRACTIONS_COLUMN_FILE_MMAP
+            if (this->_mapped) {
+                munmap(const_cast<unsigned char *>(this->_data), this->_length);
+            }
+#endif
+            this->_data = nullptr;
+            this->_length = 0;
+            this->_mapped = false;
+            this->_buffer.clear();
+            this->_directory = nullptr;
+            this->_header = detail::ColumnFileHeader{};
+        }
+
+        /** @return true if a file is open. */
+        auto is_open() const -> bool { return this->_data != nullptr; }
+
+        /** @return true if the file is memory-mapped rather than read into memory. */
+        auto mapped() const -> bool { return this->_mapped; }
+
+        /** @return The number of rows. */
+        auto size() const -> std::size_t { return std::size_t(this->_header.rows); }
+
+        /** @return The number of blocks. */
+        auto blocks() const -> std::size_t { return std::size_t(this->_header.blocks); }
+
+        /** @return The number of rows of every block but the last. */
+        auto block_rows() const -> std::size_t { return std::size_t(this->_header.block_rows); }
+
+        /** @return A view of block b (b < blocks()). */
+        auto block(std::size_t b) const -> ColumnBlock<T> {
+            const auto &e = this->_directory[b];
+            const auto *numer = reinterpret_cast<const T *>(this->_data + e.offset);
+            const auto shared = (e.flags & detail::block_shared_denom) != 0;
+            return ColumnBlock<T>(
+                numer, shared ? nullptr : numer + e.rows, detail::from_word<T>(e.shared_denom),
+                e.rows, make(e.min_numer, e.min_denom), make(e.max_numer, e.max_denom),
+                (e.flags & detail::block_has_stats) != 0);
+        }
+
+        /** @return Row i (i < size()). */
+        auto operator[](std::size_t i) const -> Fraction<T> {
+            return this->block(i / this->block_rows())[i % this->block_rows()];
+        }
+
+        /** @return All rows as an array of Fraction<T>. */
+        auto read_all() const -> std::vector<Fraction<T>> {
+            std::vector<Fraction<T>> out(this->size());
+            for (std::size_t b = 0; b != this->blocks(); ++b) {
+                this->block(b).copy_to(out.data() + b * this->block_rows());
+            }
+            return out;
+        }
+
+      private:
+        static auto fail(std::string *error, const std::string &what) -> bool {
+            if (error != nullptr) {
+                *error = what;
+            }
+            return false;
+        }
+
+        static auto make(std::uint64_t n, std::uint64_t d) -> Fraction<T> {
+            Fraction<T> x;
+            x._numer = detail::from_word<T>(n);
+            x._denom = detail::from_word<T>(d);
+            return x;
+        }
+
+        void swap(ColumnFile &other) noexcept {
+            std::swap(this->_data, other._data);
+            std::swap(this->_length, other._length);
+            std::swap(this->_buffer, other._buffer);
+            std::swap(this->_mapped, other._mapped);
+            std::swap(this->_header, other._header);
+            std::swap(this->_directory, other._directory);
+        }
+
+        auto map(const std::string &path) -> bool {
+#ifdef FRACTIONS_COLUMN_FILE_MMAP
+            const int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                return false;
+            }
+            struct stat st;
+            if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+                ::close(fd);
+                return false;
+            }
+            const auto length = static_cast<std::size_t>(st.st_size);
+            void *p = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);
+            if (p == MAP_FAILED) {
+                return false;
+            }
+            this->_data = static_cast<const unsigned char *>(p);
+            this->_length = length;
+            this->_mapped = true;
+            return true;
+#else
+            std::FILE *f = std::fopen(path.c_str(), "rb");
+            if (f == nullptr) {
+                return false;
+            }
+            // over-allocate so that the columns can be aligned like in a mapping
+            std::vector<unsigned char> bytes;
+            unsigned char chunk[1 << 16];
+            std::size_t got;
+            while ((got = std::fread(chunk, 1, sizeof(chunk), f)) != 0) {
+                bytes.insert(bytes.end(), chunk, chunk + got);
+            }
+            std::fclose(f);
+            if (bytes.empty()) {
+                return false;
+            }
+            this->_buffer.resize(bytes.size() + detail::column_file_align);
+            auto *base = this->_buffer.data();
+            const auto skew = reinterpret_cast<std::uintptr_t>(base) % detail::column_file_align;
+            auto *aligned = base + (skew == 0 ? 0 : detail::column_file_align - skew);
+            std::memcpy(aligned, bytes.data(), bytes.size());
+            this->_data = aligned;
+            this->_length = bytes.size();
+            return true;
+#endif
+        }
+
+        auto validate(std::string &reason) -> bool {
+            if (this->_length < sizeof(detail::ColumnFileHeader)) {
+                reason = "truncated header";
+                return false;
+            }
+            std::memcpy(&this->_header, this->_data, sizeof(this->_header));
+            const auto &h = this->_header;
+            if (std::memcmp(h.magic, detail::column_file_magic, sizeof(h.magic)) != 0) {
+                reason = "not a fraction column file";
+                return false;
+            }
+            if (h.version != detail::column_file_version || h.bom != detail::column_file_bom) {
+                reason = "unsupported version or byte order";
+                return false;
+            }
+            if (h.term_size != sizeof(T) || (h.is_signed != 0) != std::is_signed<T>::value) {
+                reason = "stored integer type differs from the requested one";
+                return false;
+            }
+            // all bounds in 64 bits, every product and sum checked: the header may be hostile
+            const std::uint64_t entry = sizeof(detail::ColumnBlockEntry);
+            const std::uint64_t blocks
+                = h.block_rows == 0 ? 0 : h.rows / h.block_rows + (h.rows % h.block_rows != 0);
+            if (h.block_rows == 0 || h.block_rows > std::numeric_limits<std::uint32_t>::max()
+                || h.rows > std::numeric_limits<std::size_t>::max() || h.blocks != blocks
+                || h.directory % alignof(detail::ColumnBlockEntry) != 0
+                || h.directory > this->_length
+                || h.blocks > (this->_length - h.directory) / entry) {
+                reason = "corrupt directory";
+                return false;
+            }
+            this->_directory
+                = reinterpret_cast<const detail::ColumnBlockEntry *>(this->_data + h.directory);
+            for (std::uint64_t b = 0; b != h.blocks; ++b) {
+                const auto &e = this->_directory[b];
+                const auto columns = (e.flags & detail::block_shared_denom) != 0 ? 1U : 2U;
+                std::uint64_t first = 0, bytes = 0;
+                const std::uint64_t row_bytes = columns * sizeof(T);
+                const bool sized = detail::checked_mul(b, h.block_rows, first) && first < h.rows
+                                   && detail::checked_mul(std::uint64_t(e.rows), row_bytes, bytes);
+                const auto expected = b + 1 == h.blocks ? h.rows - first : h.block_rows;
+                if (!sized || e.rows != expected || e.offset % alignof(T) != 0
+                    || e.offset > h.directory || bytes > h.directory - e.offset) {
+                    reason = "corrupt block " + std::to_string(b);
+                    return false;
+                }
+            }
+            return true;
+        }
+    };
+
+    /**
+     * @brief Streaming writer of the columnar file format (see
+     * column_file.hpp): rows are buffered one block at a time.
+     *
+     * @tparam T The integer type (a built-in integer of at most 64 bits).
+     */
+    template <typename T> class ColumnWriter {
+        static_assert(std::is_integral<T>::value && sizeof(T) <= 8,
+                      "the column file stores built-in integers of at most 64 bits");
+
+        std::FILE *_file = nullptr;
+        std::size_t _block_rows;
+        std::vector<T> _numer, _denom;
+        std::vector<detail::ColumnBlockEntry> _directory;
+        std::uint64_t _offset = 0;
+        std::uint64_t _rows = 0;
+        bool _ok = true;
+
+      public:
+        /** @param[in] block_rows The rows per block (at least 1). */
+        explicit ColumnWriter(std::size_t block_rows = 65536)
+            : _block_rows(block_rows != 0 ? block_rows : 1) {}
+
+        ColumnWriter(const ColumnWriter &) = delete;
+        auto operator=(const ColumnWriter &) -> ColumnWriter & = delete;
+
+        ~ColumnWriter() { this->close(); }
+
+        /**
+         * Creates (or truncates) the file.
+         *
+         * @param[in] path The file name.
+         * @param[out] error If not null, receives the reason of a failure.
+         * @return true on success.
+         */
+        auto open(const std::string &path, std::string *error = nullptr) -> bool {
+            this->close();
+            this->_file = std::fopen(path.c_str(), "wb");
+            if (this->_file == nullptr) {
+                if (error != nullptr) {
+                    *error = "cannot write " + path;
+                }
+                return false;
+            }
+            this->_ok = true;
+            this->_rows = 0;
+            this->_directory.clear();
+            this->_numer.clear();
+            this->_denom.clear();
+            // the header is written by close(), when the counts are known
+            const detail::ColumnFileHeader blank{};
+            this->put(&blank, sizeof(blank));
+            return this->_ok;
+        }
+
+        /** Appends a row (denominator non-negative). */
+        void push(const Fraction<T> &x) {
+            this->_numer.push_back(x.numer());
+            this->_denom.push_back(x.denom());
+            if (this->_numer.size() == this->_block_rows) {
+                this->flush();
+            }
+        }
+
+        /** Appends rows x[0..n). */
+        void write(const Fraction<T> *x, std::size_t n) {
+            for (std::size_t i = 0; i != n; ++i) {
+                this->push(x[i]);
+            }
+        }
+
+        /**
+         * Writes the pending block, the directory and the header and closes
+         * the file.
+         *
+         * @return true if everything was written.
+         */
+        auto close() -> bool {
+            if (this->_file == nullptr) {
+                return this->_ok;
+            }
+            this->flush();
+            this->pad();
+            detail::ColumnFileHeader h{};
+            std::memcpy(h.magic, detail::column_file_magic, sizeof(h.magic));
+            h.version = detail::column_file_version;
+            h.bom = detail::column_file_bom;
+            h.term_size = sizeof(T);
+            h.is_signed = std::is_signed<T>::value ? 1 : 0;
+            h.rows = this->_rows;
+            h.block_rows = this->_block_rows;
+            h.blocks = this->_directory.size();
+            h.directory = this->_offset;
+            if (!this->_directory.empty()) {
+                this->put(this->_directory.data(),
+                          this->_directory.size() * sizeof(detail::ColumnBlockEntry));
+            }
+            if (std::fseek(this->_file, 0, SEEK_SET) != 0) {
+                this->_ok = false;
+            }
+            this->put(&h, sizeof(h));
+            if (std::fclose(this->_file) != 0) {
+                this->_ok = false;
+            }
+            this->_file = nullptr;
+            return this->_ok;
+        }
+
+      private:
+        void put(const void *p, std::size_t n) {
+            if (std::fwrite(p, 1, n, this->_file) != n) {
+                this->_ok = false;
+            }
+            this->_offset += n;
+        }
+
+        void pad() {
+            static const unsigned char zeros[detail::column_file_align] = {};
+            const auto rest = this->_offset % detail::column_file_align;
+            if (rest != 0) {
+                this->put(zeros, std::size_t(detail::column_file_align - rest));
+            }
+        }
+
+        void flush() {
+            const auto n = this->_numer.size();
+            if (n == 0) {
+                return;
+            }
+            this->pad();
+            detail::ColumnBlockEntry e{};
+            e.offset = this->_offset;
+            e.rows = std::uint32_t(n);
+            bool shared = true;
+            for (std::size_t i = 1; i != n && shared; ++i) {
+                shared = this->_denom[i] == this->_denom[0];
+            }
+            const CrossLess<T> less;
+            Fraction<T> lo, hi;
+            bool any = false;
+            for (std::size_t i = 0; i != n; ++i) {
+                Fraction<T> x;
+                x._numer = this->_numer[i];
+                x._denom = this->_denom[i];
+                if (x._numer == T(0) && x._denom == T(0)) {
+                    continue;
+                }
+                if (!any || less(x, lo)) {
+                    lo = x;
+                }
+                if (!any || less(hi, x)) {
+                    hi = x;
+                }
+                any = true;
+            }
+            e.flags = (shared ? detail::block_shared_denom : 0U)
+                      | (any ? detail::block_has_stats : 0U);
+            e.shared_denom = shared ? detail::to_word(this->_denom[0]) : 0;
+            e.min_numer = detail::to_word(lo.numer());
+            e.min_denom = detail::to_word(lo.denom());
+            e.max_numer = detail::to_word(hi.numer());
+            e.max_denom = detail::to_word(hi.denom());
+            this->put(this->_numer.data(), n * sizeof(T));
+            if (!shared) {
+                this->put(this->_denom.data(), n * sizeof(T));
+            }
+            this->_directory.push_back(e);
+            this->_rows += n;
+            this->_numer.clear();
+            this->_denom.clear();
+        }
+    };
+
+}  // namespace fractions
@@ -0,0 +1,336 @@
+#pragma once
+
+/** @file include/fractions/counters.hpp
+ *  Event counters and histograms for profiling which paths a workload takes.
+ *
+ *  Counting is compiled in only when FRACTIONS_COUNTERS is defined (CMake
+ *  option FRACTIONS_COUNTERS); otherwise the hooks in fractions.hpp expand
+ *  to nothing. In a counting build, gcd(), reduce(), normalize(), the
+ *  branches of the arithmetic and comparison operators, the overflow and
+ *  error-bound checks of the geometric predicates, the eager fallback of
+ *  lazy expressions and overflows of the checked accumulator behind fma(),
+ *  dot(), sum_all() and RunningStats bump an Event counter, and every gcd()
+ *  adds its number of Euclid steps and the bit length of its larger operand
+ *  to two histograms. The other overflow-checked paths (the exact simplex
+ *  phase, the narrowing of statistics results, the calculator) are not
+ *  counted; they report overflow through their results.
+ *
+ *  Each thread counts into its own block, without locks or atomic
+ *  read-modify-write operations; snapshot() sums the blocks of all running
+ *  threads and those of the threads that have exited, minus the totals
+ *  recorded by the last reset().
+ *
+ * Example:
+ * ```
+ * counters::reset();
+ * run_workload();
+ * counters::report(std::cout, counters::snapshot());
+ * ```
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace fractions {
+
+    namespace counters {
+
+        /** The counted events. */
+        enum class Event : std::uint8_t {
+            GcdCall,             ///< gcd()
+            GcdZeroOperand,      ///< gcd() with a zero first operand
+            Reduce,              ///< reduce()
+            ReduceCoprime,       ///< reduce() finding gcd 1 (no division)
+            Normalize,           ///< normalize()
+            NegativeDenom,       ///< sign flip of a negative denominator
+            AddSameDenom,        ///< a + b, equal denominators
+            AddZeroDenom,        ///< a + b with an infinite or nan operand
+            AddGeneral,          ///< a + b, different denominators
+            AddAssignSameDenom,  ///< a += b, equal denominators
+            AddAssignGeneral,    ///< a += b, different denominators
+            SubAssignSameDenom,  ///< a -= b, equal denominators
+            SubAssignGeneral,    ///< a -= b, different denominators
+            AddIntWhole,         ///< a += n, a an integer
+            AddIntGeneral,       ///< a += n, a not an integer
+            SubIntWhole,         ///< a -= n, a an integer
+            SubIntGeneral,       ///< a -= n, a not an integer
+            MulAssign,           ///< a *= b (also a * b)
+            MulInt,              ///< a *= n
+            DivAssign,           ///< a /= b (also a / b)
+            DivInt,              ///< a /= n
+            LessSameDenom,       ///< a < b, equal denominators
+            LessCross,           ///< a < b by cross reduction
+            Equal,               ///< a == b
+            FilterDecided,       ///< predicate decided in floating point
+            FilterExact,         ///< predicate fell back to exact arithmetic
+            FilterOverflow,      ///< ... because the error bound overflowed
+            ExprEager,           ///< lazy expression evaluated eagerly after an overflow
+            AccumulatorOverflow,  ///< checked accumulator overflowed widened<T>
+        };
+
+        /** Number of distinct Event values. */
+        constexpr std::size_t event_count = 29;
+
+        /** Euclid step counts at or above the last bin are added to it. */
+        constexpr std::size_t euclid_bins = 64;
+
+        /** Bit lengths 0 to 128. */
+        constexpr std::size_t bit_bins = 129;
+
+        /** @return The name of e, e.g. "reduce_coprime". */
+        inline auto name(Event e) -> const char * {
+            static const char *const names[event_count] = {"gcd_call",
+                                                           "gcd_zero_operand",
+                                                           "reduce",
+                                                           "reduce_coprime",
+                                                           "normalize",
+                                                           "negative_denom",
+                                                           "add_same_denom",
+                                                           "add_zero_denom",
+                                                           "add_general",
+                                                           "add_assign_same_denom",
+                                                           "add_assign_general",
+                                                           "sub_assign_same_denom",
+                                                           "sub_assign_general",
+                                                           "add_int_whole",
+                                                           "add_int_general",
+                                                           "sub_int_whole",
+                                                           "sub_int_general",
+                                                           "mul_assign",
+                                                           "mul_int",
+                                                           "div_assign",
+                                                           "div_int",
+                                                           "less_same_denom",
+                                                           "less_cross",
+                                                           "equal",
+                                                           "filter_decided",
+                                                           "filter_exact",
+                                                           "filter_overflow",
+                                                           "expr_eager",
+                                                           "accumulator_overflow"};
+            return names[static_cast<std::size_t>(e)];
+        }
+
+        /** @brief Aggregated counts. */
+        struct Snapshot {
+            std::uint64_t events[event_count] = {};
+            std::uint64_t euclid_steps[euclid_bins] = {};  ///< gcd() calls by Euclid steps
+            std::uint64_t operand_bits[bit_bins] = {};  ///< gcd() calls by larger operand bits
+
+            auto operator[](Event e) const -> std::uint64_t {
+                return this->events[static_cast<std::size_t>(e)];
+            }
+        };
+
+        namespace detail {
+
+            using Counter = std::atomic<std::uint64_t>;
+
+            /** Counters of one thread; only the owner writes them. */
+            struct Block {
+                Counter events[event_count];
+                Counter euclid_steps[euclid_bins];
+                Counter operand_bits[bit_bins];
+                unsigned steps = 0;  ///< Euclid steps of the running gcd()
+
+                Block() { this->clear(); }
+
+                void clear() {
+                    for (auto &c : this->events) {
+                        c.store(0, std::memory_order_relaxed);
+                    }
+                    for (auto &c : this->euclid_steps) {
+                        c.store(0, std::memory_order_relaxed);
+                    }
+                    for (auto &c : this->operand_bits) {
+                        c.store(0, std::memory_order_relaxed);
+                    }
+                }
+
+                void add_to(Snapshot &s) const {
+                    for (std::size_t i = 0; i != event_count; ++i) {
+                        s.events[i] += this->events[i].load(std::memory_order_relaxed);
+                    }
+                    for (std::size_t i = 0; i != euclid_bins; ++i) {
+                        s.euclid_steps[i] += this->euclid_steps[i].load(std::memory_order_relaxed);
+                    }
+                    for (std::size_t i = 0; i != bit_bins; ++i) {
+                        s.operand_bits[i] += this->operand_bits[i].load(std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            /** The live blocks and the sum of the blocks of exited threads. */
+            struct Registry {
+                std::mutex mutex;
+                std::vector<Block *> live;
+                Snapshot retired;
+                Snapshot base;  ///< totals at the last reset(), subtracted by snapshot()
+
+                /** @return The counts since the start; the caller holds the mutex. */
+                auto total() const -> Snapshot {
+                    Snapshot s = this->retired;
+                    for (const auto *b : this->live) {
+                        b->add_to(s);
+                    }
+                    return s;
+                }
+            };
+
+            inline auto registry() -> Registry & {
+                static Registry r;
+                return r;
+            }
+
+            struct Local {
+                Block block;
+
+                Local() {
+                    auto &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    r.live.push_back(&this->block);
+                }
+
+                ~Local() {
+                    auto &r = registry();
+                    std::lock_guard<std::mutex> lock(r.mutex);
+                    this->block.add_to(r.retired);
+                    for (auto it = r.live.begin(); it != r.live.end(); ++it) {
+                        if (*it == &this->block) {
+                            r.live.erase(it);
+                            break;
+                        }
+                    }
+                }
+
+                Local(const Local &) = delete;
+                auto operator=(const Local &) -> Local & = delete;
+            };
+
+            inline auto local() -> Block & {
+                thread_local Local l;
+                return l.block;
+            }
+
+            /** Owner-only increment: a relaxed load and store, no locked instruction. */
+            inline void bump(Counter &c) {
+                c.store(c.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            }
+
+            inline void bump(Event e) { bump(local().events[static_cast<std::size_t>(e)]); }
+
+            inline void euclid_step() { ++local().steps; }
+
+            template <typename T>
+            auto bit_length(const T &a) ->
+                typename std::enable_if<std::is_integral<T>::value, std::size_t>::type {
+                using U = typename std::make_unsigned<T>::type;
+                auto u = static_cast<U>(a);
+                if (a < T(0)) {
+                    u = static_cast<U>(U(0) - u);
+                }
+                std::size_t bits = 0;
+                for (; u != 0; u = static_cast<U>(u >> 1)) {
+                    ++bits;
+                }
+                return bits;
+            }
+
+            /** Types without a fixed width go to bin 0. */
+            template <typename T>
+            auto bit_length(const T &) ->
+                typename std::enable_if<!std::is_integral<T>::value, std::size_t>::type {
+                return 0;
+            }
+
+            /**
+             * @brief Counts one gcd(): the call and the bit length on entry, the
+             * Euclid steps taken by gcd_recur() on exit.
+             */
+            class GcdScope {
+                Block &_block;
+
+              public:
+                template <typename T>
+                GcdScope(const T &m, const T &n) : _block(local()) {
+                    bump(this->_block.events[static_cast<std::size_t>(Event::GcdCall)]);
+                    const auto bits = std::max(bit_length(m), bit_length(n));
+                    bump(this->_block.operand_bits[std::min(bits, bit_bins - 1)]);
+                    this->_block.steps = 0;
+                }
+
+                ~GcdScope() {
+                    const std::size_t steps = this->_block.steps;
+                    bump(this->_block.euclid_steps[std::min(steps, euclid_bins - 1)]);
+                }
+
+                GcdScope(const GcdScope &) = delete;
+                auto operator=(const GcdScope &) -> GcdScope & = delete;
+            };
+
+        }  // namespace detail
+
+        /**
+         * @return The counts of all threads: the running ones (read while
+         * they may still be counting) and the exited ones.
+         */
+        inline auto snapshot() -> Snapshot {
+            auto &r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            auto s = r.total();
+            for (std::size_t i = 0; i != event_count; ++i) {
+                s.events[i] -= r.base.events[i];
+            }
+            for (std::size_t i = 0; i != euclid_bins; ++i) {
+                s.euclid_steps[i] -= r.base.euclid_steps[i];
+            }
+            for (std::size_t i = 0; i != bit_bins; ++i) {
+                s.operand_bits[i] -= r.base.operand_bits[i];
+            }
+            return s;
+        }
+
+        /**
+         * Restarts all counts from zero. The blocks are never written by
+         * other threads: the current totals become the base that snapshot()
+         * subtracts, so a reset cannot be undone by a racing increment (the
+         * increment lands on one side of it).
+         */
+        inline void reset() {
+            auto &r = detail::registry();
+            std::lock_guard<std::mutex> lock(r.mutex);
+            r.base = r.total();
+        }
+
+        /**
+         * Prints the non-zero counters and histogram bins, one per line.
+         *
+         * @param[out] os The output stream.
+         * @param[in] s The counts.
+         */
+        template <typename Stream> void report(Stream &os, const Snapshot &s) {
+            for (std::size_t i = 0; i != event_count; ++i) {
+                if (s.events[i] != 0) {
+                    os << name(static_cast<Event>(i)) << ' ' << s.events[i] << '\n';
+                }
+            }
+            for (std::size_t i = 0; i != euclid_bins; ++i) {
+                if (s.euclid_steps[i] != 0) {
+                    os << "gcd_euclid_steps[" << i << (i + 1 == euclid_bins ? "+" : "") << "] "
+                       << s.euclid_steps[i] << '\n';
+                }
+            }
+            for (std::size_t i = 0; i != bit_bins; ++i) {
+                if (s.operand_bits[i] != 0) {
+                    os << "gcd_operand_bits[" << i << "] " << s.operand_bits[i] << '\n';
+                }
+            }
+        }
+
+    }  // namespace counters
+}  // namespace fractions
@@ -0,0 +1,246 @@
+#pragma once
+
+/** @file include/fractions/counting_int.hpp
+ *  An integer wrapper that counts the arithmetic it performs.
+ *
+ *  `Fraction<CountingInt<T>>` computes exactly what `Fraction<T>` computes
+ *  while counting every addition, subtraction, multiplication, division,
+ *  modulo, negation, comparison, copy and move of its terms. The counts
+ *  depend only on the algorithm and the operands, not on the hardware or
+ *  the optimizer, which makes them suitable for comparing algorithms and for
+ *  catching regressions in tests.
+ *
+ * Example:
+ * ```
+ * using I = CountingInt<int>;
+ * reset_op_counts();
+ * auto c = Fraction<I>(1, 2) + Fraction<I>(1, 3);
+ * op_counts().multiplications;  // multiplications of the addition
+ * ```
+ *
+ * The counters are process-wide and atomic, so operations of kernels that
+ * run on several threads are included. `widened<CountingInt<T>>` is
+ * `CountingInt<widened<T>>`, so the wide intermediate arithmetic of the
+ * kernels is counted as well.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "widen.hpp"
+
+namespace fractions {
+
+    /** @brief Counts of integer operations. */
+    struct OpCounts {
+        std::uint64_t additions = 0;
+        std::uint64_t subtractions = 0;
+        std::uint64_t multiplications = 0;
+        std::uint64_t divisions = 0;
+        std::uint64_t modulos = 0;
+        std::uint64_t negations = 0;
+        std::uint64_t comparisons = 0;
+        std::uint64_t copies = 0;
+        std::uint64_t moves = 0;
+
+        /** @return The number of arithmetic operations (excluding comparisons, copies, moves). */
+        auto arithmetic() const -> std::uint64_t {
+            return this->additions + this->subtractions + this->multiplications
+                   + this->divisions + this->modulos + this->negations;
+        }
+
+        friend auto operator==(const OpCounts &lhs, const OpCounts &rhs) -> bool {
+            return lhs.additions == rhs.additions && lhs.subtractions == rhs.subtractions
+                   && lhs.multiplications == rhs.multiplications
+                   && lhs.divisions == rhs.divisions && lhs.modulos == rhs.modulos
+                   && lhs.negations == rhs.negations && lhs.comparisons == rhs.comparisons
+                   && lhs.copies == rhs.copies && lhs.moves == rhs.moves;
+        }
+
+        friend auto operator!=(const OpCounts &lhs, const OpCounts &rhs) -> bool {
+            return !(lhs == rhs);
+        }
+    };
+
+    namespace detail {
+
+        enum class CountedOp {
+            Addition,
+            Subtraction,
+            Multiplication,
+            Division,
+            Modulo,
+            Negation,
+            Comparison,
+            Copy,
+            Move
+        };
+
+        inline auto op_counters() -> std::atomic<std::uint64_t> (&)[9] {
+            static std::atomic<std::uint64_t> counters[9];
+            return counters;
+        }
+
+        inline void count(CountedOp op) {
+            op_counters()[static_cast<int>(op)].fetch_add(1, std::memory_order_relaxed);
+        }
+
+    }  // namespace detail
+
+    /** @return The operations counted since the last reset_op_counts(). */
+    inline auto op_counts() -> OpCounts {
+        const auto &c = detail::op_counters();
+        OpCounts r;
+        r.additions = c[0].load(std::memory_order_relaxed);
+        r.subtractions = c[1].load(std::memory_order_relaxed);
+        r.multiplications = c[2].load(std::memory_order_relaxed);
+        r.divisions = c[3].load(std::memory_order_relaxed);
+        r.modulos = c[4].load(std::memory_order_relaxed);
+        r.negations = c[5].load(std::memory_order_relaxed);
+        r.comparisons = c[6].load(std::memory_order_relaxed);
+        r.copies = c[7].load(std::memory_order_relaxed);
+        r.moves = c[8].load(std::memory_order_relaxed);
+        return r;
+    }
+
+    /** Zeroes the operation counters. */
+    inline void reset_op_counts() {
+        for (auto &c : detail::op_counters()) {
+            c.store(0, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief A signed or unsigned integer T that counts its operations (see
+     * op_counts()).
+     *
+     * Implicitly constructible from T, so that literals such as 0 and 1 in
+     * generic code work; constructions from a value are not counted.
+     *
+     * @tparam T The underlying integer type.
+     */
+    template <typename T> class CountingInt {
+        T _value;
+
+        using Op = detail::CountedOp;
+
+      public:
+        CountingInt() : _value(0) {}
+        CountingInt(T value) : _value(value) {}
+
+        /** Conversion between widths, e.g. to and from widened<T>; not counted. */
+        template <typename U,
+                  typename = typename std::enable_if<!std::is_same<U, T>::value>::type>
+        explicit CountingInt(const CountingInt<U> &other)
+            : _value(static_cast<T>(other.value())) {}
+
+        CountingInt(const CountingInt &other) : _value(other._value) {
+            detail::count(Op::Copy);
+        }
+        CountingInt(CountingInt &&other) noexcept : _value(other._value) {
+            detail::count(Op::Move);
+        }
+        auto operator=(const CountingInt &other) -> CountingInt & {
+            detail::count(Op::Copy);
+            this->_value = other._value;
+            return *this;
+        }
+        auto operator=(CountingInt &&other) noexcept -> CountingInt & {
+            detail::count(Op::Move);
+            this->_value = other._value;
+            return *this;
+        }
+
+        /** @return The wrapped value. */
+        auto value() const -> const T & { return this->_value; }
+
+        explicit operator T() const { return this->_value; }
+        explicit operator double() const { return static_cast<double>(this->_value); }
+
+        auto operator-() const -> CountingInt {
+            detail::count(Op::Negation);
+            return CountingInt(static_cast<T>(-this->_value));
+        }
+
+        auto operator+=(const CountingInt &rhs) -> CountingInt & {
+            detail::count(Op::Addition);
+            this->_value = static_cast<T>(this->_value + rhs._value);
+            return *this;
+        }
+        auto operator-=(const CountingInt &rhs) -> CountingInt & {
+            detail::count(Op::Subtraction);
+            this->_value = static_cast<T>(this->_value - rhs._value);
+            return *this;
+        }
+        auto operator*=(const CountingInt &rhs) -> CountingInt & {
+            detail::count(Op::Multiplication);
+            this->_value = static_cast<T>(this->_value * rhs._value);
+            return *this;
+        }
+        auto operator/=(const CountingInt &rhs) -> CountingInt & {
+            detail::count(Op::Division);
+            this->_value = static_cast<T>(this->_value / rhs._value);
+            return *this;
+        }
+        auto operator%=(const CountingInt &rhs) -> CountingInt & {
+            detail::count(Op::Modulo);
+            this->_value = static_cast<T>(this->_value % rhs._value);
+            return *this;
+        }
+
+        friend auto operator+(CountingInt lhs, const CountingInt &rhs) -> CountingInt {
+            return std::move(lhs += rhs);
+        }
+        friend auto operator-(CountingInt lhs, const CountingInt &rhs) -> CountingInt {
+            return std::move(lhs -= rhs);
+        }
+        friend auto operator*(CountingInt lhs, const CountingInt &rhs) -> CountingInt {
+            return std::move(lhs *= rhs);
+        }
+        friend auto operator/(CountingInt lhs, const CountingInt &rhs) -> CountingInt {
+            return std::move(lhs /= rhs);
+        }
+        friend auto operator%(CountingInt lhs, const CountingInt &rhs) -> CountingInt {
+            return std::move(lhs %= rhs);
+        }
+
+        friend auto operator==(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value == rhs._value;
+        }
+        friend auto operator!=(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value != rhs._value;
+        }
+        friend auto operator<(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value < rhs._value;
+        }
+        friend auto operator>(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value > rhs._value;
+        }
+        friend auto operator<=(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value <= rhs._value;
+        }
+        friend auto operator>=(const CountingInt &lhs, const CountingInt &rhs) -> bool {
+            detail::count(Op::Comparison);
+            return lhs._value >= rhs._value;
+        }
+
+        template <typename Stream>
+        friend auto operator<<(Stream &os, const CountingInt &x) -> Stream & {
+            os << x._value;
+            return os;
+        }
+    };
+
+    /** @brief Widens the underlying integer, keeping the counting. */
+    template <typename T> struct widened<CountingInt<T>> {
+        using type = CountingInt<typename widened<T>::type>;
+    };
+
+}  // namespace fractions
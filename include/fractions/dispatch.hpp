@@ -0,0 +1,632 @@
+#pragma once
+
+/** @file include/fractions/dispatch.hpp
+ *  Batch kernels that pick their instruction set at run time.
+ *
+ *  The kernels of batch.hpp and scan.hpp are compiled for whatever the
+ *  including translation unit targets, so a binary built for the oldest
+ *  host of a fleet never uses the vector units of the newer ones. The
+ *  kernels here (reduce, compare, convert and parse) are compiled once per
+ *  x86-64 level with function-level target attributes:
+ *
+ *  - Isa::Scalar: the baseline of the build;
+ *  - Isa::Sse42: SSE4.2 and POPCNT (x86-64-v2);
+ *  - Isa::Avx2: AVX2, BMI1/2 and FMA (x86-64-v3);
+ *  - Isa::Avx512: AVX-512 F, BW, CD, DQ and VL on top of AVX2 (x86-64-v4).
+ *
+ *  The first call detects the CPU features and binds a table of function
+ *  pointers to the best supported variant. The environment variable
+ *  FRACTIONS_ISA (scalar, sse4.2, avx2 or avx512) lowers that choice, and
+ *  dispatch::force() rebinds the table, e.g. to test or benchmark every
+ *  variant on one machine. Every variant returns the same results.
+ *
+ *  Only GCC and Clang on x86 build the vector variants; elsewhere all
+ *  calls run the scalar one.
+ *
+ *  Example:
+ *  ```
+ *  std::vector<Fraction<std::int64_t>> x = ...;
+ *  fractions::dispatch::normalize_all(x.data(), x.size());
+ *  fractions::dispatch::active();  // e.g. Isa::Avx2
+ *  ```
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <string>
+
+#include "fractions.hpp"
+#include "kernels.hpp"
+#include "scan.hpp"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#    include <immintrin.h>
+#    define FRACTIONS_DISPATCH_X86 1
+#endif
+
+namespace fractions {
+
+    namespace dispatch {
+
+        /** Instruction set of a kernel variant, in increasing order. */
+        enum class Isa { Scalar, Sse42, Avx2, Avx512 };
+
+        /** @return "scalar", "sse4.2", "avx2" or "avx512". */
+        inline auto name(Isa isa) -> const char * {
+            switch (isa) {
+                case Isa::Scalar:
+                    return "scalar";
+                case Isa::Sse42:
+                    return "sse4.2";
+                case Isa::Avx2:
+                    return "avx2";
+                case Isa::Avx512:
+                    return "avx512";
+            }
+            return "scalar";
+        }
+
+        /** Looks up an instruction set by name(); false if there is none. */
+        inline auto from_name(const std::string &text, Isa &isa) -> bool {
+            const Isa all[] = {Isa::Scalar, Isa::Sse42, Isa::Avx2, Isa::Avx512};
+            for (const auto candidate : all) {
+                if (text == name(candidate)) {
+                    isa = candidate;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        namespace detail {
+
+            inline auto detect() -> Isa {
+#ifdef FRACTIONS_DISPATCH_X86
+                __builtin_cpu_init();
+                const bool v2
+                    = __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+                const bool v3 = v2 && __builtin_cpu_supports("avx2")
+                                && __builtin_cpu_supports("bmi") && __builtin_cpu_supports("bmi2")
+                                && __builtin_cpu_supports("fma");
+                const bool v4 = v3 && __builtin_cpu_supports("avx512f")
+                                && __builtin_cpu_supports("avx512bw")
+                                && __builtin_cpu_supports("avx512cd")
+                                && __builtin_cpu_supports("avx512dq")
+                                && __builtin_cpu_supports("avx512vl");
+                return v4 ? Isa::Avx512 : v3 ? Isa::Avx2 : v2 ? Isa::Sse42 : Isa::Scalar;
+#else
+                return Isa::Scalar;
+#endif
+            }
+
+            /** Normalizes x[i] for i in [first, last). */
+            template <typename T>
+            inline void normalize_range(Fraction<T> *x, std::size_t first, std::size_t last) {
+                for (auto i = first; i != last; ++i) {
+                    x[i].normalize();
+                }
+            }
+
+            template <typename T>
+            inline void to_double_range(const Fraction<T> *x, std::size_t first,
+                                        std::size_t last, double *out) {
+                for (auto i = first; i != last; ++i) {
+                    out[i] = static_cast<double>(x[i]._numer) / static_cast<double>(x[i]._denom);
+                }
+            }
+
+            template <typename T>
+            inline void compare_range(const T *numer, const T *denom, std::size_t first,
+                                      std::size_t last, CompareOp op, const Fraction<T> &c,
+                                      std::uint64_t *mask) {
+                ::fractions::detail::compare_mask_op(
+                    ::fractions::detail::SoaColumn<T>{numer + first, denom + first},
+                    last - first, op, c, mask + first / 64);
+            }
+
+            inline auto is_separator(char c) -> bool {
+                return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == ',';
+            }
+
+            /** Reads the digits at text[pos..end) into v; false if none or if v exceeds limit. */
+            template <typename U>
+            inline auto read_digits(const char *text, std::size_t &pos, std::size_t end, U limit,
+                                    U &v) -> bool {
+                const auto start = pos;
+                v = 0;
+                for (; pos != end && text[pos] >= '0' && text[pos] <= '9'; ++pos) {
+                    const auto digit = static_cast<U>(text[pos] - '0');
+                    if (v > (limit - digit) / 10) {
+                        return false;
+                    }
+                    v = static_cast<U>(v * 10 + digit);
+                }
+                return pos != start;
+            }
+
+            /**
+             * The tokenizer of every fraction parser (also the one of the C
+             * interface): skips separators, reads "[+-]digits[/digits]" with
+             * Digits::read(text, pos, length, limit, v) and passes each
+             * fraction to store(row, negative, numer, denom).
+             *
+             * @param[out] end The offset where parsing stopped: length on
+             * success, else the start of the fraction that is malformed or
+             * did not fit.
+             * @return false on a malformed token (count < capacity) or if
+             * capacity fractions were stored before the end of the text
+             * (count == capacity).
+             */
+            template <typename Digits, typename U, typename Store>
+            inline auto scan_fractions(const char *text, std::size_t length, std::size_t capacity,
+                                       U limit, std::size_t &count, std::size_t &end,
+                                       std::string *error, Store store) -> bool {
+                std::size_t pos = 0;
+                count = 0;
+                for (;;) {
+                    while (pos != length && is_separator(text[pos])) {
+                        ++pos;
+                    }
+                    end = pos;
+                    if (pos == length) {
+                        return true;
+                    }
+                    if (count == capacity) {
+                        if (error != nullptr) {
+                            *error = "more than " + std::to_string(capacity) + " fractions";
+                        }
+                        return false;
+                    }
+                    const bool negative = text[pos] == '-';
+                    if (text[pos] == '-' || text[pos] == '+') {
+                        ++pos;
+                    }
+                    U numer = 0, denom = 1;
+                    bool ok = Digits::read(text, pos, length, limit, numer);
+                    if (ok && pos != length && text[pos] == '/') {
+                        ++pos;
+                        ok = Digits::read(text, pos, length, limit, denom);
+                    }
+                    if (!ok || (pos != length && !is_separator(text[pos]))) {
+                        if (error != nullptr) {
+                            *error = "malformed or out-of-range fraction at offset "
+                                     + std::to_string(end);
+                        }
+                        return false;
+                    }
+                    store(count, negative, numer, denom);
+                    ++count;
+                }
+            }
+
+            /** Numerator and denominator of at most 2^63 - 1 into out[row], normalized. */
+            template <void (*Normalize)(Fraction<std::int64_t> *, std::size_t, std::size_t)>
+            struct StoreNormalized {
+                Fraction<std::int64_t> *out;
+
+                void operator()(std::size_t row, bool negative, std::uint64_t numer,
+                                std::uint64_t denom) const {
+                    const auto n = static_cast<std::int64_t>(numer);
+                    this->out[row]._numer = negative ? -n : n;
+                    this->out[row]._denom = static_cast<std::int64_t>(denom);
+                    Normalize(this->out, row, row + 1);
+                }
+            };
+
+            /**
+             * Parses fractions separated by whitespace or commas, reading the
+             * digit runs with Digits::read(text, pos, length, limit, v) and
+             * reducing each fraction with Normalize(out, row, row + 1).
+             */
+            template <typename Digits,
+                      void (*Normalize)(Fraction<std::int64_t> *, std::size_t, std::size_t)>
+            inline auto parse_text(const char *text, std::size_t length,
+                                   Fraction<std::int64_t> *out, std::size_t capacity,
+                                   std::size_t &count, std::size_t &end, std::string *error)
+                -> bool {
+                const std::uint64_t limit = std::numeric_limits<std::int64_t>::max();
+                return scan_fractions<Digits>(text, length, capacity, limit, count, end, error,
+                                              StoreNormalized<Normalize>{out});
+            }
+
+            struct ScalarDigits {
+                template <typename U>
+                static auto read(const char *text, std::size_t &pos, std::size_t end, U limit,
+                                 U &v) -> bool {
+                    return read_digits(text, pos, end, limit, v);
+                }
+            };
+
+            /** The kernels of one variant. */
+            struct Table {
+                Isa isa;
+                void (*normalize_i32)(Fraction<std::int32_t> *, std::size_t, std::size_t);
+                void (*normalize_i64)(Fraction<std::int64_t> *, std::size_t, std::size_t);
+                void (*compare_i32)(const std::int32_t *, const std::int32_t *, std::size_t,
+                                    std::size_t, CompareOp, const Fraction<std::int32_t> &,
+                                    std::uint64_t *);
+                void (*compare_i64)(const std::int64_t *, const std::int64_t *, std::size_t,
+                                    std::size_t, CompareOp, const Fraction<std::int64_t> &,
+                                    std::uint64_t *);
+                void (*to_double_i32)(const Fraction<std::int32_t> *, std::size_t, std::size_t,
+                                      double *);
+                void (*to_double_i64)(const Fraction<std::int64_t> *, std::size_t, std::size_t,
+                                      double *);
+                bool (*parse)(const char *, std::size_t, Fraction<std::int64_t> *, std::size_t,
+                              std::size_t &, std::size_t &, std::string *);
+            };
+
+            inline auto scalar_table() -> const Table & {
+                static const Table table
+                    = {Isa::Scalar,
+                       normalize_range<std::int32_t>,
+                       normalize_range<std::int64_t>,
+                       compare_range<std::int32_t>,
+                       compare_range<std::int64_t>,
+                       to_double_range<std::int32_t>,
+                       to_double_range<std::int64_t>,
+                       parse_text<ScalarDigits, normalize_range<std::int64_t>>};
+                return table;
+            }
+
+#ifdef FRACTIONS_DISPATCH_X86
+            /** Number of trailing zero bits of a nonzero w. */
+            inline auto ctz(std::uint64_t w) -> int { return __builtin_ctzll(w); }
+
+            /**
+             * Stein's binary gcd: shifts and subtractions instead of divisions,
+             * arranged so that the loop has no branch besides its exit test.
+             */
+            inline auto binary_gcd(std::uint64_t a, std::uint64_t b) -> std::uint64_t {
+                if (a == 0 || b == 0) {
+                    return a | b;
+                }
+                auto za = ctz(a);
+                const auto zb = ctz(b);
+                const auto shift = za < zb ? za : zb;
+                b >>= zb;
+                do {
+                    a >>= za;
+                    // b - a has the trailing zeros of |b - a|; the top bit keeps ctz defined
+                    za = ctz((b - a) | (std::uint64_t(1) << 63));
+                    const auto larger = a < b ? b : a;
+                    b = a < b ? a : b;
+                    a = larger - b;
+                } while (a != 0);
+                return b << shift;
+            }
+
+            /**
+             * Fraction::normalize() with a binary gcd, for the variants whose
+             * hosts count trailing zeros in one cycle (TZCNT, BMI1).
+             */
+            template <typename T>
+            inline void normalize_binary_range(Fraction<T> *x, std::size_t first,
+                                               std::size_t last) {
+                for (auto i = first; i != last; ++i) {
+                    auto &f = x[i];
+                    f.keep_denom_positive();
+                    const auto n = static_cast<std::int64_t>(f._numer);
+                    const auto magnitude = n < 0 ? std::uint64_t(0) - std::uint64_t(n)
+                                                 : std::uint64_t(n);
+                    const auto common
+                        = binary_gcd(magnitude, static_cast<std::uint64_t>(f._denom));
+                    if (common > 1) {
+                        f._numer /= static_cast<T>(common);
+                        f._denom /= static_cast<T>(common);
+                    }
+                }
+            }
+
+            /**
+             * Digit runs of 16 bytes or less: PCMPISTRI (SSE4.2) finds the end
+             * of the run and the digits are combined in three multiply-add
+             * steps (PMADDUBSW, PMADDWD, PACKUSDW, PMADDWD). Longer runs, and
+             * runs too close to either end of the text for 16-byte loads, take
+             * the scalar path.
+             */
+            struct Sse42Digits {
+                __attribute__((target("sse4.2"))) static auto read(const char *text,
+                                                                   std::size_t &pos,
+                                                                   std::size_t end,
+                                                                   std::uint64_t limit,
+                                                                   std::uint64_t &v) -> bool {
+                    if (pos + 16 > end) {
+                        return read_digits(text, pos, end, limit, v);
+                    }
+                    const auto chunk
+                        = _mm_loadu_si128(reinterpret_cast<const __m128i *>(text + pos));
+                    const auto len = static_cast<std::size_t>(
+                        _mm_cmpistri(_mm_setr_epi8('0', '9', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+                                                   0, 0),
+                                     chunk,
+                                     _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES
+                                         | _SIDD_NEGATIVE_POLARITY));
+                    if (len == 0 || len == 16 || pos + len < 16) {
+                        return read_digits(text, pos, end, limit, v);
+                    }
+                    // right-align the run in 16 bytes and zero the bytes before it
+                    static const unsigned char keep[32]
+                        = {0,    0,    0,    0,    0,    0,    0,    0,    0,    0,    0,
+                           0,    0,    0,    0,    0,    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                           0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
+                    auto digits = _mm_loadu_si128(
+                        reinterpret_cast<const __m128i *>(text + pos + len - 16));
+                    digits = _mm_and_si128(
+                        _mm_sub_epi8(digits, _mm_set1_epi8('0')),
+                        _mm_loadu_si128(reinterpret_cast<const __m128i *>(keep + len)));
+                    const auto pairs = _mm_maddubs_epi16(
+                        digits, _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10,
+                                              1));
+                    const auto quads
+                        = _mm_madd_epi16(pairs, _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1));
+                    const auto octs = _mm_madd_epi16(
+                        _mm_packus_epi32(quads, quads),
+                        _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1));
+                    const auto high = static_cast<std::uint32_t>(_mm_cvtsi128_si32(octs));
+                    const auto low
+                        = static_cast<std::uint32_t>(_mm_cvtsi128_si32(_mm_srli_si128(octs, 4)));
+                    v = std::uint64_t(high) * 100000000U + low;
+                    pos += len;
+                    // at most 15 digits, far below the limit of 2^63 - 1
+                    return v <= limit;
+                }
+            };
+
+// Defines the kernels of one variant, namespace ns, compiled for the given features; flatten
+// inlines the shared templates so that all of their code is generated for it.
+#    define FRACTIONS_DISPATCH_VARIANT(ns, features, normalize, digits)                          \
+        namespace ns {                                                                           \
+            __attribute__((target(features), flatten)) inline void normalize_i32(                \
+                Fraction<std::int32_t> *x, std::size_t first, std::size_t last) {                \
+                normalize<std::int32_t>(x, first, last);                                         \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline void normalize_i64(                \
+                Fraction<std::int64_t> *x, std::size_t first, std::size_t last) {                \
+                normalize<std::int64_t>(x, first, last);                                         \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline void compare_i32(                  \
+                const std::int32_t *numer, const std::int32_t *denom, std::size_t first,         \
+                std::size_t last, CompareOp op, const Fraction<std::int32_t> &c,                 \
+                std::uint64_t *mask) {                                                           \
+                compare_range(numer, denom, first, last, op, c, mask);                           \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline void compare_i64(                  \
+                const std::int64_t *numer, const std::int64_t *denom, std::size_t first,         \
+                std::size_t last, CompareOp op, const Fraction<std::int64_t> &c,                 \
+                std::uint64_t *mask) {                                                           \
+                compare_range(numer, denom, first, last, op, c, mask);                           \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline void to_double_i32(                \
+                const Fraction<std::int32_t> *x, std::size_t first, std::size_t last,            \
+                double *out) {                                                                   \
+                to_double_range(x, first, last, out);                                            \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline void to_double_i64(                \
+                const Fraction<std::int64_t> *x, std::size_t first, std::size_t last,            \
+                double *out) {                                                                   \
+                to_double_range(x, first, last, out);                                            \
+            }                                                                                    \
+            __attribute__((target(features), flatten)) inline auto parse(                        \
+                const char *text, std::size_t length, Fraction<std::int64_t> *out,               \
+                std::size_t capacity, std::size_t &count, std::size_t &end, std::string *error)  \
+                -> bool {                                                                        \
+                return parse_text<digits, normalize<std::int64_t>>(text, length, out, capacity,  \
+                                                                  count, end, error);            \
+            }                                                                                    \
+            inline auto table() -> const Table & {                                               \
+                static const Table kernels = {Isa::ns,       normalize_i32, normalize_i64,       \
+                                              compare_i32,   compare_i64,   to_double_i32,       \
+                                              to_double_i64, parse};                             \
+                return kernels;                                                                  \
+            }                                                                                    \
+        }
+
+            FRACTIONS_DISPATCH_VARIANT(Sse42, "sse4.2,popcnt", normalize_range, Sse42Digits)
+            FRACTIONS_DISPATCH_VARIANT(Avx2, "avx2,bmi,bmi2,fma,popcnt",
+                                       normalize_binary_range, Sse42Digits)
+            FRACTIONS_DISPATCH_VARIANT(
+                Avx512,
+                "avx512f,avx512bw,avx512cd,avx512dq,avx512vl,avx2,bmi,bmi2,fma,popcnt",
+                normalize_binary_range, Sse42Digits)
+
+#    undef FRACTIONS_DISPATCH_VARIANT
+#endif
+
+            inline auto table_for(Isa isa) -> const Table & {
+#ifdef FRACTIONS_DISPATCH_X86
+                switch (isa) {
+                    case Isa::Scalar:
+                        break;
+                    case Isa::Sse42:
+                        return Sse42::table();
+                    case Isa::Avx2:
+                        return Avx2::table();
+                    case Isa::Avx512:
+                        return Avx512::table();
+                }
+#else
+                (void)isa;
+#endif
+                return scalar_table();
+            }
+
+            /** The detected instruction set, lowered to FRACTIONS_ISA if that names a lower one. */
+            inline auto initial() -> Isa {
+                auto isa = detect();
+                auto requested = isa;
+                const char *env = std::getenv("FRACTIONS_ISA");
+                if (env != nullptr && from_name(env, requested) && requested < isa) {
+                    isa = requested;
+                }
+                return isa;
+            }
+
+            /** The bound kernel table, chosen on first use. */
+            inline auto active_table() -> std::atomic<const Table *> & {
+                static std::atomic<const Table *> table{&table_for(initial())};
+                return table;
+            }
+
+            inline auto kernels() -> const Table & {
+                return *active_table().load(std::memory_order_acquire);
+            }
+
+        }  // namespace detail
+
+        /** @return The best instruction set the CPU (and the build) supports. */
+        inline auto detected() -> Isa {
+            static const Isa isa = detail::detect();
+            return isa;
+        }
+
+        /** @return The instruction set of the kernels that calls currently run. */
+        inline auto active() -> Isa { return detail::kernels().isa; }
+
+        /**
+         * Binds the kernels to the variant for isa, for all threads; calls
+         * already running finish with the previous one.
+         *
+         * @param[in] isa The instruction set; at most detected().
+         * @param[out] error Receives a description if isa is not supported.
+         * @return false (keeping the current variant) if isa is not supported.
+         */
+        inline auto force(Isa isa, std::string *error = nullptr) -> bool {
+            if (detected() < isa) {
+                if (error != nullptr) {
+                    *error = std::string("this CPU or build does not support ") + name(isa)
+                             + " (best: " + name(detected()) + ")";
+                }
+                return false;
+            }
+            detail::active_table().store(&detail::table_for(isa), std::memory_order_release);
+            return true;
+        }
+
+        /** Rebinds the kernels to the initial choice (detected(), lowered by FRACTIONS_ISA). */
+        inline void reset() {
+            detail::active_table().store(&detail::table_for(detail::initial()),
+                                         std::memory_order_release);
+        }
+
+        /**
+         * Brings every element of x[0..n) into canonical form in place, like
+         * fractions::normalize_all(). Terms must be greater than the minimum
+         * of the integer type.
+         *
+         * @param[in,out] x The fractions.
+         * @param[in] n The number of fractions.
+         * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+         */
+        inline void normalize_all(Fraction<std::int32_t> *x, std::size_t n, unsigned threads = 1) {
+            const auto kernel = detail::kernels().normalize_i32;
+            ::fractions::detail::parallel_for(
+                n, threads, 1, [x, kernel](std::size_t first, std::size_t last) {
+                    kernel(x, first, last);
+                });
+        }
+
+        /** The same for 64-bit terms. */
+        inline void normalize_all(Fraction<std::int64_t> *x, std::size_t n, unsigned threads = 1) {
+            const auto kernel = detail::kernels().normalize_i64;
+            ::fractions::detail::parallel_for(
+                n, threads, 1, [x, kernel](std::size_t first, std::size_t last) {
+                    kernel(x, first, last);
+                });
+        }
+
+        /**
+         * Evaluates `numer[i] / denom[i] op c` into a bitmask, like the SoA
+         * overload of fractions::compare_mask().
+         *
+         * @param[in] numer The numerators.
+         * @param[in] denom The denominators (non-negative).
+         * @param[in] n The number of rows.
+         * @param[in] op The comparison.
+         * @param[in] c The constant (non-negative denominator).
+         * @param[out] mask The (n + 63) / 64 result words.
+         * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+         */
+        inline void compare_mask(const std::int32_t *numer, const std::int32_t *denom,
+                                 std::size_t n, CompareOp op, const Fraction<std::int32_t> &c,
+                                 std::uint64_t *mask, unsigned threads = 1) {
+            const auto kernel = detail::kernels().compare_i32;
+            ::fractions::detail::parallel_for(
+                n, threads, 64, [&](std::size_t first, std::size_t last) {
+                    kernel(numer, denom, first, last, op, c, mask);
+                });
+        }
+
+        /** The same for 64-bit terms. */
+        inline void compare_mask(const std::int64_t *numer, const std::int64_t *denom,
+                                 std::size_t n, CompareOp op, const Fraction<std::int64_t> &c,
+                                 std::uint64_t *mask, unsigned threads = 1) {
+            const auto kernel = detail::kernels().compare_i64;
+            ::fractions::detail::parallel_for(
+                n, threads, 64, [&](std::size_t first, std::size_t last) {
+                    kernel(numer, denom, first, last, op, c, mask);
+                });
+        }
+
+        /**
+         * Converts x[0..n) to double, out[i] = to_double(x[i]).
+         *
+         * @param[in] x The fractions.
+         * @param[in] n The number of fractions.
+         * @param[out] out The n quotients.
+         * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+         */
+        inline void to_double(const Fraction<std::int32_t> *x, std::size_t n, double *out,
+                              unsigned threads = 1) {
+            const auto kernel = detail::kernels().to_double_i32;
+            ::fractions::detail::parallel_for(
+                n, threads, 1, [x, out, kernel](std::size_t first, std::size_t last) {
+                    kernel(x, first, last, out);
+                });
+        }
+
+        /** The same for 64-bit terms. */
+        inline void to_double(const Fraction<std::int64_t> *x, std::size_t n, double *out,
+                              unsigned threads = 1) {
+            const auto kernel = detail::kernels().to_double_i64;
+            ::fractions::detail::parallel_for(
+                n, threads, 1, [x, out, kernel](std::size_t first, std::size_t last) {
+                    kernel(x, first, last, out);
+                });
+        }
+
+        /**
+         * Parses fractions ("-3/4", "+5", "1/0") separated by whitespace or
+         * commas from text[0..length) into out, normalizing them. Terms must
+         * not exceed 2^63 - 1.
+         *
+         * @param[in] text The text.
+         * @param[in] length The length of the text.
+         * @param[out] out The fractions.
+         * @param[in] capacity The size of out.
+         * @param[out] count The number of fractions stored, also on failure.
+         * @param[out] error Receives a description of a malformed token or of a full out.
+         * @param[out] end If not null, receives the offset where parsing stopped: length on
+         * success, else the start of the fraction that is malformed or did not fit, so that
+         * a full out can be emptied and parsing resumed there.
+         * @return false on a malformed token (count < capacity) or if out is full before the
+         * end of the text (count == capacity).
+         */
+        inline auto parse(const char *text, std::size_t length, Fraction<std::int64_t> *out,
+                          std::size_t capacity, std::size_t &count, std::string *error = nullptr,
+                          std::size_t *end = nullptr) -> bool {
+            std::size_t stop = 0;
+            const bool ok = detail::kernels().parse(text, length, out, capacity, count, stop,
+                                                    error);
+            if (end != nullptr) {
+                *end = stop;
+            }
+            return ok;
+        }
+
+    }  // namespace dispatch
+
+}  // namespace fractions
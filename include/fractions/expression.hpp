@@ -0,0 +1,339 @@
+#pragma once
+
+/** @file include/fractions/expression.hpp
+ *  Opt-in expression templates for fused Fraction arithmetic.
+ *
+ *  Every eager Fraction operator normalizes its result, so `a * b + c * d - e`
+ *  builds four reduced temporaries at the cost of some ten gcd calls. Wrapping
+ *  one operand with lazy() instead records the expression tree; converting
+ *  the tree to a Fraction evaluates it with all denominators cleared into a
+ *  single numerator/denominator pair of `widened<T>` integers and performs
+ *  exactly one gcd reduction at the end.
+ *
+ *  The cleared numerator and denominator grow with the expression (a product
+ *  of all denominators in the worst case); equal denominators are shared
+ *  instead of multiplied, and a sum whose product of denominators overflows
+ *  the widened type is retried over the lcm. If the cleared terms still
+ *  overflow, or the reduced result does not fit in T, eval() falls back to
+ *  evaluating the tree eagerly, reducing after every operation.
+ */
+
+#include <type_traits>
+
+#include "fractions.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    namespace detail {
+
+        /** Unreduced value numer / denom in a wide integer type; ok is false after an overflow. */
+        template <typename W> struct Cleared {
+            W numer;
+            W denom;
+            bool ok;
+        };
+
+        /** a.numer * db op b.numer * da over a.denom * db, checking every step. */
+        template <typename W, typename Combine>
+        auto cross_combine(const Cleared<W> &a, const Cleared<W> &b, const W &da, const W &db,
+                           Combine combine) -> Cleared<W> {
+            Cleared<W> r{W(0), W(1), a.ok && b.ok};
+            W l, rr;
+            r.ok = r.ok && checked_mul(a.numer, db, l) && checked_mul(b.numer, da, rr)
+                   && combine(l, rr, r.numer) && checked_mul(a.denom, db, r.denom);
+            return r;
+        }
+
+        /**
+         * Adds (Sub = false) or subtracts the cleared values: over the
+         * product of the denominators, or over their lcm if that overflows.
+         */
+        template <bool Sub, typename W>
+        auto add_cleared(const Cleared<W> &a, const Cleared<W> &b) -> Cleared<W> {
+            const auto combine = [](const W &x, const W &y, W &out) {
+                return Sub ? checked_sub(x, y, out) : checked_add(x, y, out);
+            };
+            if (a.denom == b.denom) {
+                Cleared<W> r{W(0), a.denom, a.ok && b.ok};
+                r.ok = r.ok && combine(a.numer, b.numer, r.numer);
+                return r;
+            }
+            auto r = cross_combine(a, b, a.denom, b.denom, combine);
+            if (!r.ok && a.ok && b.ok) {
+                const auto common = gcd(a.denom, b.denom);
+                if (common != W(0) && common != W(1)) {
+                    r = cross_combine(a, b, W(a.denom / common), W(b.denom / common), combine);
+                }
+            }
+            return r;
+        }
+
+        struct add_op {
+            template <typename W>
+            static auto apply(const Cleared<W> &a, const Cleared<W> &b) -> Cleared<W> {
+                return add_cleared<false>(a, b);
+            }
+            template <typename T>
+            static auto eager(const Fraction<T> &a, const Fraction<T> &b) -> Fraction<T> {
+                return a + b;
+            }
+        };
+
+        struct sub_op {
+            template <typename W>
+            static auto apply(const Cleared<W> &a, const Cleared<W> &b) -> Cleared<W> {
+                return add_cleared<true>(a, b);
+            }
+            template <typename T>
+            static auto eager(const Fraction<T> &a, const Fraction<T> &b) -> Fraction<T> {
+                return a - b;
+            }
+        };
+
+        struct mul_op {
+            template <typename W>
+            static auto apply(const Cleared<W> &a, const Cleared<W> &b) -> Cleared<W> {
+                Cleared<W> r{W(0), W(1), a.ok && b.ok};
+                r.ok = r.ok && checked_mul(a.numer, b.numer, r.numer)
+                       && checked_mul(a.denom, b.denom, r.denom);
+                return r;
+            }
+            template <typename T>
+            static auto eager(const Fraction<T> &a, const Fraction<T> &b) -> Fraction<T> {
+                return a * b;
+            }
+        };
+
+        struct div_op {
+            template <typename W>
+            static auto apply(const Cleared<W> &a, const Cleared<W> &b) -> Cleared<W> {
+                Cleared<W> r{W(0), W(1), a.ok && b.ok};
+                r.ok = r.ok && checked_mul(a.numer, b.denom, r.numer)
+                       && checked_mul(a.denom, b.numer, r.denom);
+                return r;
+            }
+            template <typename T>
+            static auto eager(const Fraction<T> &a, const Fraction<T> &b) -> Fraction<T> {
+                return a / b;
+            }
+        };
+
+    }  // namespace detail
+
+    /**
+     * @brief CRTP base of all expression nodes.
+     *
+     * An expression over `Fraction<T>` converts implicitly to `Fraction<T>`,
+     * which is where the evaluation happens:
+     * ```
+     * Fraction<int> r = lazy(a) * b + lazy(c) * d - e;
+     * ```
+     *
+     * @tparam T The integer type of the fractions.
+     * @tparam Derived The node type.
+     */
+    template <typename T, typename Derived> struct Expr {
+        using value_type = T;
+        using wide_type = typename widened<T>::type;
+
+        /** @return The node as its concrete type. */
+        auto self() const -> const Derived & { return static_cast<const Derived &>(*this); }
+
+        /**
+         * Evaluates the expression with a single final reduction, or eagerly
+         * if the cleared terms overflow the widened type or the result does
+         * not fit in T.
+         *
+         * @return The value in canonical form.
+         */
+        auto eval() const -> Fraction<T> {
+            auto c = this->self().cleared();
+            if (!c.ok) {
+                FRACTIONS_COUNT(ExprEager);
+                return this->self().eager();
+            }
+            if (c.denom < wide_type(0)) {
+                c.numer = -c.numer;
+                c.denom = -c.denom;
+            }
+            const auto common = gcd(c.numer, c.denom);
+            if (common != wide_type(1) && common != wide_type(0)) {
+                c.numer /= common;
+                c.denom /= common;
+            }
+            if (!detail::fits<T>(c.numer) || !detail::fits<T>(c.denom)) {
+                FRACTIONS_COUNT(ExprEager);
+                return this->self().eager();
+            }
+            Fraction<T> res;
+            res._numer = static_cast<T>(c.numer);
+            res._denom = static_cast<T>(c.denom);
+            return res;
+        }
+
+        operator Fraction<T>() const { return this->eval(); }
+    };
+
+    /**
+     * @brief Leaf node holding a copy of a Fraction operand.
+     */
+    template <typename T> struct LeafExpr : Expr<T, LeafExpr<T>> {
+        Fraction<T> value;
+
+        explicit LeafExpr(const Fraction<T> &v) : value(v) {}
+
+        auto cleared() const -> detail::Cleared<typename widened<T>::type> {
+            using W = typename widened<T>::type;
+            return detail::Cleared<W>{W(this->value.numer()), W(this->value.denom()), true};
+        }
+
+        auto eager() const -> Fraction<T> { return this->value; }
+    };
+
+    /**
+     * @brief Negation node.
+     */
+    template <typename T, typename E> struct NegExpr : Expr<T, NegExpr<T, E>> {
+        E operand;
+
+        explicit NegExpr(const E &e) : operand(e) {}
+
+        auto cleared() const -> detail::Cleared<typename widened<T>::type> {
+            auto c = this->operand.cleared();
+            c.numer = -c.numer;
+            return c;
+        }
+
+        auto eager() const -> Fraction<T> { return -this->operand.eager(); }
+    };
+
+    /**
+     * @brief Binary node; Op is one of detail::add_op, sub_op, mul_op, div_op.
+     */
+    template <typename T, typename Op, typename L, typename R> struct BinaryExpr
+        : Expr<T, BinaryExpr<T, Op, L, R>> {
+        L lhs;
+        R rhs;
+
+        BinaryExpr(const L &l, const R &r) : lhs(l), rhs(r) {}
+
+        auto cleared() const -> detail::Cleared<typename widened<T>::type> {
+            return Op::apply(this->lhs.cleared(), this->rhs.cleared());
+        }
+
+        auto eager() const -> Fraction<T> {
+            return Op::eager(this->lhs.eager(), this->rhs.eager());
+        }
+    };
+
+    /**
+     * Starts a lazily evaluated expression.
+     *
+     * Example:
+     * ```
+     * Fraction<int> a(1, 2), b(2, 3), c(3, 4), d(4, 5), e(5, 6);
+     * Fraction<int> r = lazy(a) * b + lazy(c) * d - e;  // 1/10, one gcd call
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] x The first operand.
+     * @return A leaf expression holding x.
+     */
+    template <typename T> auto lazy(const Fraction<T> &x) -> LeafExpr<T> {
+        return LeafExpr<T>(x);
+    }
+
+    namespace detail {
+
+        /** Maps an operand (node or Fraction) to its expression node type. */
+        template <typename X> struct as_expr {
+            static constexpr bool is_expr = false;
+        };
+
+        template <typename T> struct as_expr<Fraction<T>> {
+            static constexpr bool is_expr = false;
+            using value_type = T;
+            using type = LeafExpr<T>;
+            static auto wrap(const Fraction<T> &x) -> type { return type(x); }
+        };
+
+        template <typename T> struct as_expr<LeafExpr<T>> {
+            static constexpr bool is_expr = true;
+            using value_type = T;
+            using type = LeafExpr<T>;
+            static auto wrap(const type &x) -> const type & { return x; }
+        };
+
+        template <typename T, typename E> struct as_expr<NegExpr<T, E>> {
+            static constexpr bool is_expr = true;
+            using value_type = T;
+            using type = NegExpr<T, E>;
+            static auto wrap(const type &x) -> const type & { return x; }
+        };
+
+        template <typename T, typename Op, typename L, typename R>
+        struct as_expr<BinaryExpr<T, Op, L, R>> {
+            static constexpr bool is_expr = true;
+            using value_type = T;
+            using type = BinaryExpr<T, Op, L, R>;
+            static auto wrap(const type &x) -> const type & { return x; }
+        };
+
+        /**
+         * The node built by `L op R`, defined only if at least one side is an
+         * expression and both sides share the same T.
+         */
+        template <typename Op, typename L, typename R, typename = void> struct binary_result {};
+
+        template <typename Op, typename L, typename R> struct binary_result<
+            Op, L, R,
+            typename std::enable_if<
+                (as_expr<L>::is_expr || as_expr<R>::is_expr)
+                && std::is_same<typename as_expr<L>::value_type,
+                                typename as_expr<R>::value_type>::value>::type> {
+            using type = BinaryExpr<typename as_expr<L>::value_type, Op, typename as_expr<L>::type,
+                                    typename as_expr<R>::type>;
+        };
+
+        template <typename Op, typename L, typename R>
+        auto make_binary(const L &l, const R &r) -> typename binary_result<Op, L, R>::type {
+            return typename binary_result<Op, L, R>::type(as_expr<L>::wrap(l), as_expr<R>::wrap(r));
+        }
+
+    }  // namespace detail
+
+    /** @name Expression operators
+     *  Defined when at least one operand is an expression; the other may be
+     *  an expression or a Fraction of the same T.
+     */
+    ///@{
+    template <typename L, typename R>
+    auto operator+(const L &lhs, const R &rhs) ->
+        typename detail::binary_result<detail::add_op, L, R>::type {
+        return detail::make_binary<detail::add_op>(lhs, rhs);
+    }
+
+    template <typename L, typename R>
+    auto operator-(const L &lhs, const R &rhs) ->
+        typename detail::binary_result<detail::sub_op, L, R>::type {
+        return detail::make_binary<detail::sub_op>(lhs, rhs);
+    }
+
+    template <typename L, typename R>
+    auto operator*(const L &lhs, const R &rhs) ->
+        typename detail::binary_result<detail::mul_op, L, R>::type {
+        return detail::make_binary<detail::mul_op>(lhs, rhs);
+    }
+
+    template <typename L, typename R>
+    auto operator/(const L &lhs, const R &rhs) ->
+        typename detail::binary_result<detail::div_op, L, R>::type {
+        return detail::make_binary<detail::div_op>(lhs, rhs);
+    }
+
+    template <typename T, typename D> auto operator-(const Expr<T, D> &x) -> NegExpr<T, D> {
+        return NegExpr<T, D>(x.self());
+    }
+    ///@}
+}  // namespace fractions
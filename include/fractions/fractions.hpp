@@ -10,12 +10,46 @@
 
 // #include "common_concepts.h"
 
-#if __cpp_constexpr >= 201304
+#if __cpp_constexpr >= 201304 && !defined(FRACTIONS_TRACE) && !defined(FRACTIONS_COUNTERS)
 #    define CONSTEXPR14 constexpr
 #else
 #    define CONSTEXPR14 inline
 #endif
 
+// Namespace-scope constants are inline variables where the language has them: with external
+// linkage they may be used by the exported templates of the fractions module (fractions.cppm).
+#if __cpp_inline_variables >= 201606
+#    define FRACTIONS_INLINE_VAR inline
+#else
+#    define FRACTIONS_INLINE_VAR
+#endif
+
+// Operation tracing (see trace.hpp); the hooks vanish unless FRACTIONS_TRACE is defined.
+#ifdef FRACTIONS_TRACE
+#    include "trace.hpp"
+#    define FRACTIONS_TRACE_OP(op, ...) \
+        const ::fractions::trace::Scope fractions_trace_scope(::fractions::trace::Op::op, \
+                                                              __VA_ARGS__)
+#else
+#    define FRACTIONS_TRACE_OP(op, ...) ((void)0)
+#endif
+
+// Event counters (see counters.hpp); the hooks vanish unless FRACTIONS_COUNTERS is defined.
+#ifdef FRACTIONS_COUNTERS
+#    include "counters.hpp"
+#    define FRACTIONS_COUNT(event) \
+        ::fractions::counters::detail::bump(::fractions::counters::Event::event)
+#    define FRACTIONS_COUNT_IF(cond, event) ((cond) ? FRACTIONS_COUNT(event) : (void)0)
+#    define FRACTIONS_COUNT_GCD(m, n) \
+        const ::fractions::counters::detail::GcdScope fractions_gcd_scope(m, n)
+#    define FRACTIONS_COUNT_EUCLID_STEP() ::fractions::counters::detail::euclid_step()
+#else
+#    define FRACTIONS_COUNT(event) ((void)0)
+#    define FRACTIONS_COUNT_IF(cond, event) ((void)0)
+#    define FRACTIONS_COUNT_GCD(m, n) ((void)0)
+#    define FRACTIONS_COUNT_EUCLID_STEP() ((void)0)
+#endif
+
 namespace fractions {
 
     /**
@@ -66,6 +100,7 @@ namespace fractions {
         if (__n == 0) {
             return abs(__m);
         }
+        FRACTIONS_COUNT_EUCLID_STEP();
         return gcd_recur(__n, __m % __n);
     }
 
@@ -87,7 +122,9 @@ namespace fractions {
      * @return The GCD of __m and __n.
      */
     template <typename _Mn> CONSTEXPR14 auto gcd(const _Mn &__m, const _Mn &__n) -> _Mn {
+        FRACTIONS_COUNT_GCD(__m, __n);
         if (__m == 0) {
+            FRACTIONS_COUNT(GcdZeroOperand);
             return abs(__n);
         }
         return gcd_recur(__m, __n);
@@ -123,8 +160,8 @@ namespace fractions {
      * @tparam T
      */
     template <typename T> struct Fraction {
-        T _numer;  /// numerator
-        T _denom;  /// denominator
+        T _numer;  ///< numerator
+        T _denom;  ///< denominator
 
         /**
          * Constructs a new Fraction object from the given numerator and denominator.
@@ -141,6 +178,7 @@ namespace fractions {
          */
         CONSTEXPR14 Fraction(T numer, T denom)
             : _numer{std::move(numer)}, _denom{std::move(denom)} {
+            FRACTIONS_TRACE_OP(Construct, numer, denom);
             this->normalize();
         }
 
@@ -149,6 +187,7 @@ namespace fractions {
          * is always non-negative and co-prime with the numerator.
          */
         CONSTEXPR14 auto normalize() -> T {
+            FRACTIONS_COUNT(Normalize);
             this->keep_denom_positive();
             return this->reduce();
         }
@@ -160,6 +199,7 @@ namespace fractions {
          */
         CONSTEXPR14 void keep_denom_positive() {
             if (this->_denom < 0) {
+                FRACTIONS_COUNT(NegativeDenom);
                 this->_numer = -this->_numer;
                 this->_denom = -this->_denom;
             }
@@ -178,6 +218,8 @@ namespace fractions {
          */
         CONSTEXPR14 auto reduce() -> T {
             T common = gcd(this->_numer, this->_denom);
+            FRACTIONS_COUNT(Reduce);
+            FRACTIONS_COUNT_IF(common == 1, ReduceCoprime);
             if (common != 1 && common != 0) {
                 this->_numer /= common;
                 this->_denom /= common;
@@ -377,6 +419,8 @@ namespace fractions {
          * @return True if lhs == rhs, false otherwise.
          */
         friend CONSTEXPR14 auto operator==(const Fraction &lhs, const Fraction &rhs) -> bool {
+            FRACTIONS_TRACE_OP(Equal, lhs._numer, lhs._denom, rhs._numer, rhs._denom);
+            FRACTIONS_COUNT(Equal);
             return lhs._numer == rhs._numer && lhs._denom == rhs._denom;
         }
 
@@ -392,9 +436,12 @@ namespace fractions {
          * @return True if lhs < rhs, false otherwise.
          */
         friend CONSTEXPR14 auto operator<(const Fraction &lhs, const Fraction &rhs) -> bool {
+            FRACTIONS_TRACE_OP(Less, lhs._numer, lhs._denom, rhs._numer, rhs._denom);
             if (lhs._denom == rhs._denom) {
+                FRACTIONS_COUNT(LessSameDenom);
                 return lhs._numer < rhs._numer;
             }
+            FRACTIONS_COUNT(LessCross);
             auto lhs2{lhs};
             auto rhs2{rhs};
             std::swap(lhs2._denom, rhs2._numer);
@@ -536,6 +583,8 @@ namespace fractions {
          * @return A reference to this Fraction after multiplication.
          */
         CONSTEXPR14 auto operator*=(Fraction rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(MulAssign, this->_numer, this->_denom, rhs._numer, rhs._denom);
+            FRACTIONS_COUNT(MulAssign);
             std::swap(this->_numer, rhs._numer);
             this->reduce();
             rhs.reduce();
@@ -555,6 +604,7 @@ namespace fractions {
          * @return A new Fraction containing the result of the multiplication.
          */
         friend CONSTEXPR14 auto operator*(Fraction lhs, const Fraction &rhs) -> Fraction {
+            FRACTIONS_TRACE_OP(Mul, lhs._numer, lhs._denom, rhs._numer, rhs._denom);
             return lhs *= rhs;
         }
 
@@ -569,6 +619,8 @@ namespace fractions {
          * @return A reference to this Fraction after multiplication.
          */
         CONSTEXPR14 auto operator*=(T rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(MulInt, this->_numer, this->_denom, rhs);
+            FRACTIONS_COUNT(MulInt);
             std::swap(this->_numer, rhs);
             this->reduce();
             this->_numer *= rhs;
@@ -614,6 +666,8 @@ namespace fractions {
          * @return A reference to this Fraction after division.
          */
         CONSTEXPR14 auto operator/=(Fraction rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(DivAssign, this->_numer, this->_denom, rhs._numer, rhs._denom);
+            FRACTIONS_COUNT(DivAssign);
             std::swap(this->_denom, rhs._numer);
             this->normalize();
             rhs.reduce();
@@ -632,6 +686,7 @@ namespace fractions {
          * @return A Fraction after division.
          */
         friend CONSTEXPR14 auto operator/(Fraction lhs, const Fraction &rhs) -> Fraction {
+            FRACTIONS_TRACE_OP(Div, lhs._numer, lhs._denom, rhs._numer, rhs._denom);
             return lhs /= rhs;
         }
 
@@ -644,6 +699,8 @@ namespace fractions {
          * @return A reference to this Fraction after dividing by rhs.
          */
         CONSTEXPR14 auto operator/=(T rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(DivInt, this->_numer, this->_denom, rhs);
+            FRACTIONS_COUNT(DivInt);
             std::swap(this->_denom, rhs);
             this->normalize();
             this->_denom *= rhs;
@@ -694,13 +751,17 @@ namespace fractions {
          * Handles zero denominators by returning a Fraction with a zero denominator.
          */
         CONSTEXPR14 auto operator+(const Fraction &other) const -> Fraction {
+            FRACTIONS_TRACE_OP(Add, this->_numer, this->_denom, other._numer, other._denom);
             if (this->_denom == other._denom) {
+                FRACTIONS_COUNT(AddSameDenom);
                 return Fraction(this->_numer + other._numer, this->_denom);
             }
             const auto common = gcd(this->_denom, other._denom);
             if (common == 0) {
+                FRACTIONS_COUNT(AddZeroDenom);
                 return Fraction(other._denom * this->_numer + this->_denom * other._numer, 0);
             }
+            FRACTIONS_COUNT(AddGeneral);
             const auto l = this->_denom / common;
             const auto r = other._denom / common;
             auto d = this->_denom * r;
@@ -717,6 +778,7 @@ namespace fractions {
          * @return A new Fraction containing the result.
          */
         CONSTEXPR14 auto operator-(const Fraction &other) const -> Fraction {
+            FRACTIONS_TRACE_OP(Sub, this->_numer, this->_denom, other._numer, other._denom);
             return *this + (-other);
         }
 
@@ -755,7 +817,10 @@ namespace fractions {
          * @param rhs The integer to subtract.
          * @return A new Fraction containing the difference.
          */
-        CONSTEXPR14 auto operator-(const T &rhs) const -> Fraction { return *this -= rhs; }
+        CONSTEXPR14 auto operator-(const T &rhs) const -> Fraction {
+            auto res{*this};
+            return res -= rhs;
+        }
 
         /**
          * Adds another Fraction to this Fraction.
@@ -771,12 +836,15 @@ namespace fractions {
          * @return A reference to this Fraction after adding.
          */
         CONSTEXPR14 auto operator+=(const Fraction &rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(AddAssign, this->_numer, this->_denom, rhs._numer, rhs._denom);
             if (this->_denom == rhs._denom) {
+                FRACTIONS_COUNT(AddAssignSameDenom);
                 this->_numer += rhs._numer;
                 this->reduce();
                 return *this;
             }
 
+            FRACTIONS_COUNT(AddAssignGeneral);
             auto other{rhs};
             std::swap(this->_denom, other._numer);
             auto common_n = this->reduce();
@@ -806,12 +874,15 @@ namespace fractions {
          * @return A reference to this Fraction after subtracting.
          */
         CONSTEXPR14 auto operator-=(const Fraction &rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(SubAssign, this->_numer, this->_denom, rhs._numer, rhs._denom);
             if (this->_denom == rhs._denom) {
+                FRACTIONS_COUNT(SubAssignSameDenom);
                 this->_numer -= rhs._numer;
                 this->reduce();
                 return *this;
             }
 
+            FRACTIONS_COUNT(SubAssignGeneral);
             auto other{rhs};
             std::swap(this->_denom, other._numer);
             auto common_n = this->reduce();
@@ -838,11 +909,14 @@ namespace fractions {
          * @return A reference to this Fraction after adding.
          */
         CONSTEXPR14 auto operator+=(const T &rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(AddInt, this->_numer, this->_denom, rhs);
             if (this->_denom == 1) {
+                FRACTIONS_COUNT(AddIntWhole);
                 this->_numer += rhs;
                 return *this;
             }
 
+            FRACTIONS_COUNT(AddIntGeneral);
             auto other{rhs};
             std::swap(this->_denom, other);
             auto common_n = this->reduce();
@@ -913,11 +987,14 @@ namespace fractions {
          * @return A reference to this fraction after subtracting.
          */
         CONSTEXPR14 auto operator-=(const T &rhs) -> Fraction & {
+            FRACTIONS_TRACE_OP(SubInt, this->_numer, this->_denom, rhs);
             if (this->_denom == 1) {
+                FRACTIONS_COUNT(SubIntWhole);
                 this->_numer -= rhs;
                 return *this;
             }
 
+            FRACTIONS_COUNT(SubIntGeneral);
             auto other{rhs};
             std::swap(this->_denom, other);
             auto common_n = this->reduce();
@@ -1003,4 +1080,59 @@ namespace fractions {
             return os;
         }
     };
+
+    /**
+     * Converts a fraction to the nearest `double` (up to two roundings).
+     *
+     * Zero denominators follow IEEE semantics, so `1/0` gives infinity and
+     * `0/0` gives NaN.
+     *
+     * Example:
+     * ```
+     * to_double(Fraction<int>(1, 4)) == 0.25
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] frac The fraction to convert.
+     * @return The quotient numer / denom evaluated in double precision.
+     */
+    template <typename T> inline auto to_double(const Fraction<T> &frac) -> double {
+        return static_cast<double>(frac.numer()) / static_cast<double>(frac.denom());
+    }
 }  // namespace fractions
+
+// Explicit instantiations. With the FRACTIONS_EXPLICIT_INSTANTIATION CMake option, the Fractions
+// library compiles Fraction<T> and the kernels for the types below once (source/instantiations.cpp)
+// and defines FRACTIONS_EXTERN_TEMPLATES, which turns the lists into `extern template`
+// declarations, so that including translation units do not instantiate them again.
+
+/** Applies X(prefix, T) to every explicitly instantiated integer type T. */
+#ifdef __SIZEOF_INT128__
+#    define FRACTIONS_FOR_INSTANTIATED_TYPES(X, prefix)                                         \
+        X(prefix, std::int32_t)                                                                 \
+        X(prefix, std::int64_t)                                                                 \
+        X(prefix, std::uint32_t)                                                                \
+        X(prefix, std::uint64_t)                                                                \
+        X(prefix, ::fractions::detail::int128_t)
+#else
+#    define FRACTIONS_FOR_INSTANTIATED_TYPES(X, prefix)                                         \
+        X(prefix, std::int32_t)                                                                 \
+        X(prefix, std::int64_t)                                                                 \
+        X(prefix, std::uint32_t)                                                                \
+        X(prefix, std::uint64_t)
+#endif
+
+#define FRACTIONS_FRACTION_TEMPLATES(prefix, T)                                                 \
+    prefix struct Fraction<T>;                                                                  \
+    prefix auto gcd<T>(const T &, const T &) -> T;                                              \
+    prefix auto lcm<T>(const T &, const T &) -> T;
+
+#ifdef FRACTIONS_EXTERN_TEMPLATES
+#    include <cstdint>
+
+#    include "widen.hpp"
+
+namespace fractions {
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_FRACTION_TEMPLATES, extern template)
+}  // namespace fractions
+#endif
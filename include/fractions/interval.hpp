@@ -0,0 +1,238 @@
+#pragma once
+
+/** @file include/fractions/interval.hpp
+ *  Rational interval arithmetic with bounded denominators.
+ */
+
+#include "approximation.hpp"
+#include "fractions.hpp"
+
+namespace fractions {
+
+    /**
+     * @brief Closed interval [lo, hi] with rational endpoints whose
+     * denominators never exceed a configured bound.
+     *
+     * Every operation first computes the exact result interval and then
+     * rounds it outward: the lower end to its best approximation from below
+     * and the upper end to its best approximation from above (see
+     * approx_below() and approx_above()). The result therefore always
+     * contains the exact value while the endpoint term sizes stay bounded
+     * by max_denom, so long computation chains do not suffer from the
+     * numerator/denominator growth of plain Fraction arithmetic.
+     *
+     * Dividing by an interval that contains zero gives the whole line
+     * [-1/0, 1/0]; any further operation on an unbounded interval gives the
+     * whole line again.
+     *
+     * Example:
+     * ```
+     * RationalInterval<int> x(Fraction<int>(1, 3), Fraction<int>(1, 3), 10);
+     * auto y = x * x + x;  // [4/9, 4/9], rounded to denominators <= 10
+     * y.contains(Fraction<int>(4, 9));  // true
+     * ```
+     *
+     * The products of two endpoints must fit into T, so max_denom should
+     * be kept below the square root of the range of T divided by the
+     * largest magnitude involved.
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> class RationalInterval {
+        Fraction<T> _lo;
+        Fraction<T> _hi;
+        T _max_denom;
+
+        static auto whole() -> RationalInterval {
+            auto res = RationalInterval(Fraction<T>(), T(1));
+            res._lo = Fraction<T>(T(-1), T(0));
+            res._hi = Fraction<T>(T(1), T(0));
+            return res;
+        }
+
+        static auto max_of(const T &a, const T &b) -> const T & { return a < b ? b : a; }
+
+        static auto min_of(const Fraction<T> &a, const Fraction<T> &b) -> const Fraction<T> & {
+            return b < a ? b : a;
+        }
+
+        static auto max_of(const Fraction<T> &a, const Fraction<T> &b) -> const Fraction<T> & {
+            return a < b ? b : a;
+        }
+
+        void assign(const Fraction<T> &lo, const Fraction<T> &hi, const T &max_denom) {
+            this->_max_denom = max_denom;
+            this->_lo = approx_below(lo, max_denom);
+            this->_hi = approx_above(hi, max_denom);
+        }
+
+      public:
+        /**
+         * Constructs the interval [lo, hi] rounded outward to denominators
+         * at most max_denom.
+         *
+         * @param[in] lo The lower end.
+         * @param[in] hi The upper end (not less than lo).
+         * @param[in] max_denom The largest allowed endpoint denominator (positive).
+         */
+        RationalInterval(const Fraction<T> &lo, const Fraction<T> &hi, const T &max_denom)
+            : _lo(approx_below(lo, max_denom)),
+              _hi(approx_above(hi, max_denom)),
+              _max_denom(max_denom) {}
+
+        /**
+         * Constructs the smallest interval with denominators at most
+         * max_denom that contains the point x.
+         *
+         * @param[in] x The point.
+         * @param[in] max_denom The largest allowed endpoint denominator (positive).
+         */
+        RationalInterval(const Fraction<T> &x, const T &max_denom)
+            : RationalInterval(x, x, max_denom) {}
+
+        /** @return The lower end. */
+        auto lo() const noexcept -> const Fraction<T> & { return this->_lo; }
+
+        /** @return The upper end. */
+        auto hi() const noexcept -> const Fraction<T> & { return this->_hi; }
+
+        /** @return The largest allowed endpoint denominator. */
+        auto max_denom() const noexcept -> const T & { return this->_max_denom; }
+
+        /** @return true if both ends are finite. */
+        auto is_bounded() const -> bool {
+            return this->_lo.denom() != 0 && this->_hi.denom() != 0;
+        }
+
+        /** @return hi - lo (for bounded intervals). */
+        auto width() const -> Fraction<T> { return this->_hi - this->_lo; }
+
+        /**
+         * @param[in] x A finite value.
+         * @return true if lo <= x <= hi.
+         */
+        auto contains(const Fraction<T> &x) const -> bool {
+            return this->_lo <= x && x <= this->_hi;
+        }
+
+        auto operator-() const -> RationalInterval {
+            auto res = *this;
+            res._lo = -this->_hi;
+            res._hi = -this->_lo;
+            return res;
+        }
+
+        auto operator+=(const RationalInterval &rhs) -> RationalInterval & {
+            const auto &n = max_of(this->_max_denom, rhs._max_denom);
+            if (!this->is_bounded() || !rhs.is_bounded()) {
+                *this = whole();
+                this->_max_denom = n;
+                return *this;
+            }
+            this->assign(this->_lo + rhs._lo, this->_hi + rhs._hi, n);
+            return *this;
+        }
+
+        auto operator-=(const RationalInterval &rhs) -> RationalInterval & {
+            return *this += -rhs;
+        }
+
+        auto operator*=(const RationalInterval &rhs) -> RationalInterval & {
+            const auto &n = max_of(this->_max_denom, rhs._max_denom);
+            if (!this->is_bounded() || !rhs.is_bounded()) {
+                *this = whole();
+                this->_max_denom = n;
+                return *this;
+            }
+            const auto &a = this->_lo;
+            const auto &b = this->_hi;
+            const auto &c = rhs._lo;
+            const auto &d = rhs._hi;
+            // classify both operands as non-negative, non-positive or straddling
+            // zero, so that only the two relevant endpoint products are formed
+            // (four in the doubly straddling case)
+            Fraction<T> lo, hi;
+            if (!(a < T(0))) {
+                if (!(c < T(0))) {
+                    lo = a * c, hi = b * d;
+                } else if (!(T(0) < d)) {
+                    lo = b * c, hi = a * d;
+                } else {
+                    lo = b * c, hi = b * d;
+                }
+            } else if (!(T(0) < b)) {
+                if (!(c < T(0))) {
+                    lo = a * d, hi = b * c;
+                } else if (!(T(0) < d)) {
+                    lo = b * d, hi = a * c;
+                } else {
+                    lo = a * d, hi = a * c;
+                }
+            } else {
+                if (!(c < T(0))) {
+                    lo = a * d, hi = b * d;
+                } else if (!(T(0) < d)) {
+                    lo = b * c, hi = a * c;
+                } else {
+                    lo = min_of(a * d, b * c);
+                    hi = max_of(a * c, b * d);
+                }
+            }
+            this->assign(lo, hi, n);
+            return *this;
+        }
+
+        auto operator/=(const RationalInterval &rhs) -> RationalInterval & {
+            const auto &n = max_of(this->_max_denom, rhs._max_denom);
+            if (!rhs.is_bounded() || !(T(0) < rhs._lo || rhs._hi < T(0))) {
+                *this = whole();
+                this->_max_denom = n;
+                return *this;
+            }
+            // 1/[c, d] = [1/d, 1/c] is exact for a divisor of constant sign
+            auto inv = rhs;
+            inv._lo = Fraction<T>(rhs._hi.denom(), rhs._hi.numer());
+            inv._hi = Fraction<T>(rhs._lo.denom(), rhs._lo.numer());
+            return *this *= inv;
+        }
+
+        friend auto operator+(RationalInterval lhs, const RationalInterval &rhs)
+            -> RationalInterval {
+            return lhs += rhs;
+        }
+
+        friend auto operator-(RationalInterval lhs, const RationalInterval &rhs)
+            -> RationalInterval {
+            return lhs -= rhs;
+        }
+
+        friend auto operator*(RationalInterval lhs, const RationalInterval &rhs)
+            -> RationalInterval {
+            return lhs *= rhs;
+        }
+
+        friend auto operator/(RationalInterval lhs, const RationalInterval &rhs)
+            -> RationalInterval {
+            return lhs /= rhs;
+        }
+
+        friend auto operator==(const RationalInterval &lhs, const RationalInterval &rhs)
+            -> bool {
+            return lhs._lo == rhs._lo && lhs._hi == rhs._hi;
+        }
+
+        friend auto operator!=(const RationalInterval &lhs, const RationalInterval &rhs)
+            -> bool {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * Prints the interval as "[lo, hi]".
+         */
+        template <typename _Stream>
+        friend auto operator<<(_Stream &os, const RationalInterval &x) -> _Stream & {
+            os << "[" << x._lo << ", " << x._hi << "]";
+            return os;
+        }
+    };
+}  // namespace fractions
@@ -0,0 +1,377 @@
+#pragma once
+
+/** @file include/fractions/kernels.hpp
+ *  Fused multiply-add and inner products with a single final reduction.
+ *
+ *  The naive loop `acc += x[i] * y[i]` normalizes twice per element. The
+ *  kernels here keep an unreduced accumulator N / D in `widened<T>`
+ *  integers instead: each product enters with its raw numerator and
+ *  denominator, denominators already dividing D only scale the numerator,
+ *  and a gcd is taken only when a new denominator has to be merged into D
+ *  and once at the very end. Vectors sharing a common denominator (a grid,
+ *  a fixed-point scale) therefore cost one gcd in total.
+ *
+ *  D grows to the lcm of the product denominators and N to the matching
+ *  scaled sum. Every step is overflow-checked: if a term does not fit into
+ *  `widened<T>`, the result is 0/0. Inputs must be finite.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#if defined(__AVX2__)
+#    include <immintrin.h>
+#endif
+
+#include "fractions.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    namespace detail {
+
+        /** Smallest chunk a worker thread of dot() is given. */
+        FRACTIONS_INLINE_VAR constexpr std::size_t dot_chunk_min = 1U << 14;
+
+        /**
+         * Reduces numer / denom (denom >= 0) in the wide type W and narrows
+         * it to Fraction<T>; 0/0 if the reduced terms do not fit in T.
+         */
+        template <typename T, typename W> auto narrow(W numer, W denom) -> Fraction<T> {
+            const auto common = gcd(numer, denom);
+            if (common != W(1) && common != W(0)) {
+                numer /= common;
+                denom /= common;
+            }
+            Fraction<T> res(T(0), T(0));
+            if (fits<T>(numer) && fits<T>(denom)) {
+                res._numer = static_cast<T>(numer);
+                res._denom = static_cast<T>(denom);
+            }
+            return res;
+        }
+
+        /** Sums terms[0..n) into r; false if a partial sum overflows W. */
+        template <typename W> auto checked_sum(const W *terms, std::size_t n, W &r) -> bool {
+            r = W(0);
+            bool ok = true;
+            for (std::size_t j = 0; j != n; ++j) {
+                ok &= checked_add(r, terms[j], r);
+            }
+            return ok;
+        }
+
+        /**
+         * @brief Unreduced sum numer / denom in widened<T>, with denom the lcm
+         * of the denominators added so far; ok is false after an overflow.
+         */
+        template <typename T> struct Accumulator {
+            using W = typename widened<T>::type;
+
+            W numer{0};
+            W denom{1};
+            bool ok{true};  ///< sticky; result() is 0/0 once a term overflowed W
+
+            /** Marks the sum as overflowed. */
+            void fail() {
+                FRACTIONS_COUNT_IF(this->ok, AccumulatorOverflow);
+                this->ok = false;
+            }
+
+            /** Adds n / d for a positive d. */
+            void add(const W &n, const W &d) {
+                if (!this->ok) {
+                    return;
+                }
+                W l, r;
+                bool fine;
+                if (d == this->denom) {
+                    fine = checked_add(this->numer, n, this->numer);
+                } else if (this->denom % d == 0) {
+                    fine = checked_mul(n, W(this->denom / d), r)
+                           && checked_add(this->numer, r, this->numer);
+                } else if (d % this->denom == 0) {
+                    fine = checked_mul(this->numer, W(d / this->denom), l)
+                           && checked_add(l, n, this->numer);
+                    this->denom = d;
+                } else {
+                    const auto common = gcd(this->denom, d);
+                    fine = checked_mul(this->numer, W(d / common), l)
+                           && checked_mul(n, W(this->denom / common), r)
+                           && checked_add(l, r, this->numer)
+                           && checked_mul(W(this->denom / common), d, this->denom);
+                }
+                if (!fine) {
+                    this->fail();
+                }
+            }
+
+            /** Adds the exact product a * b. */
+            void add_product(const Fraction<T> &a, const Fraction<T> &b) {
+                W n, d;
+                if (checked_mul(W(a.numer()), W(b.numer()), n)
+                    && checked_mul(W(a.denom()), W(b.denom()), d)) {
+                    this->add(n, d);
+                } else {
+                    this->fail();
+                }
+            }
+
+            /** Adds the value of another accumulator. */
+            void merge(const Accumulator &other) {
+                if (other.ok) {
+                    this->add(other.numer, other.denom);
+                } else {
+                    this->ok = false;
+                }
+            }
+
+            /** @return The reduced sum (0/0 if it does not fit in T). */
+            auto result() const -> Fraction<T> {
+                return this->ok ? narrow<T>(this->numer, this->denom) : Fraction<T>(T(0), T(0));
+            }
+        };
+
+        /**
+         * Splits [0, n) into at most `threads` contiguous chunks of at least
+         * dot_chunk_min elements, runs range(first, last) -> Acc on each
+         * chunk (the first one on the calling thread) and merges the
+         * partial results in order. threads == 0 uses all hardware threads.
+         */
+        template <typename Acc, typename RangeFn>
+        auto parallel_accumulate(std::size_t n, unsigned threads, RangeFn range) -> Acc {
+            if (threads == 0) {
+                threads = std::max(1U, std::thread::hardware_concurrency());
+            }
+            const auto max_workers = std::max<std::size_t>(1, n / dot_chunk_min);
+            const auto workers = std::min<std::size_t>(threads, max_workers);
+            if (workers == 1) {
+                return range(std::size_t(0), n);
+            }
+            const auto chunk = (n + workers - 1) / workers;
+            std::vector<Acc> parts(workers);
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+            for (std::size_t t = 1; t != workers; ++t) {
+                pool.emplace_back([&parts, &range, n, chunk, t]() {
+                    parts[t] = range(t * chunk, std::min(n, (t + 1) * chunk));
+                });
+            }
+            parts[0] = range(std::size_t(0), chunk);
+            for (auto &th : pool) {
+                th.join();
+            }
+            for (std::size_t t = 1; t != workers; ++t) {
+                parts[0].merge(parts[t]);
+            }
+            return parts[0];
+        }
+
+        /**
+         * Splits [0, n) like parallel_accumulate(), with chunk boundaries at
+         * multiples of align, and runs fn(first, last) on each chunk (the
+         * first one on the calling thread).
+         */
+        template <typename RangeFn>
+        void parallel_for(std::size_t n, unsigned threads, std::size_t align, RangeFn fn) {
+            if (threads == 0) {
+                threads = std::max(1U, std::thread::hardware_concurrency());
+            }
+            const auto max_workers = std::max<std::size_t>(1, n / dot_chunk_min);
+            const auto workers = std::min<std::size_t>(threads, max_workers);
+            if (workers == 1) {
+                fn(std::size_t(0), n);
+                return;
+            }
+            const auto chunk = ((n + workers - 1) / workers + align - 1) / align * align;
+            std::vector<std::thread> pool;
+            pool.reserve(workers - 1);
+            for (std::size_t t = 1; t != workers && t * chunk < n; ++t) {
+                pool.emplace_back(
+                    [&fn, n, chunk, t]() { fn(t * chunk, std::min(n, (t + 1) * chunk)); });
+            }
+            fn(std::size_t(0), std::min(n, chunk));
+            for (auto &th : pool) {
+                th.join();
+            }
+        }
+
+        /**
+         * Accumulates x[i] * y[i] for i in [first, last). Blocks of eight
+         * products whose denominators agree are summed before entering the
+         * accumulator (one by one if the block sum overflows); with 32-bit
+         * terms the product loops vectorize.
+         */
+        template <typename T>
+        auto dot_range(const Fraction<T> *x, const Fraction<T> *y, std::size_t first,
+                       std::size_t last) -> Accumulator<T> {
+            using W = typename widened<T>::type;
+            constexpr std::size_t block = 8;
+            Accumulator<T> acc;
+            auto i = first;
+            for (; i + block <= last; i += block) {
+                W pn[block], pd[block];
+                bool fine = true;
+                for (std::size_t j = 0; j != block; ++j) {
+                    fine &= checked_mul(W(x[i + j].numer()), W(y[i + j].numer()), pn[j]);
+                    fine &= checked_mul(W(x[i + j].denom()), W(y[i + j].denom()), pd[j]);
+                }
+                if (!fine) {
+                    acc.fail();
+                    return acc;
+                }
+                bool same = true;
+                for (std::size_t j = 1; j != block; ++j) {
+                    same &= pd[j] == pd[0];
+                }
+                W sum;
+                if (same && checked_sum(pn, block, sum)) {
+                    acc.add(sum, pd[0]);
+                } else {
+                    for (std::size_t j = 0; j != block; ++j) {
+                        acc.add(pn[j], pd[j]);
+                    }
+                }
+            }
+            for (; i != last; ++i) {
+                acc.add_product(x[i], y[i]);
+            }
+            return acc;
+        }
+
+#if defined(__AVX2__)
+        /**
+         * AVX2 version for 32-bit terms: a Fraction<std::int32_t> occupies one
+         * 64-bit lane (numerator low, denominator high), so _mm256_mul_epi32
+         * yields four numerator products and, after a 32-bit shift, four
+         * denominator products at once.
+         */
+        inline auto dot_range(const Fraction<std::int32_t> *x, const Fraction<std::int32_t> *y,
+                              std::size_t first, std::size_t last)
+            -> Accumulator<std::int32_t> {
+            static_assert(sizeof(Fraction<std::int32_t>) == 8, "unexpected Fraction layout");
+            Accumulator<std::int32_t> acc;
+            auto i = first;
+            for (; i + 8 <= last; i += 8) {
+                const auto x0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i));
+                const auto x1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(x + i + 4));
+                const auto y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i));
+                const auto y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(y + i + 4));
+                const auto n0 = _mm256_mul_epi32(x0, y0);
+                const auto n1 = _mm256_mul_epi32(x1, y1);
+                const auto d0 = _mm256_mul_epi32(_mm256_srli_epi64(x0, 32),
+                                                 _mm256_srli_epi64(y0, 32));
+                const auto d1 = _mm256_mul_epi32(_mm256_srli_epi64(x1, 32),
+                                                 _mm256_srli_epi64(y1, 32));
+                const auto first_d = _mm256_permute4x64_epi64(d0, 0);
+                const auto eq = _mm256_and_si256(_mm256_cmpeq_epi64(d0, first_d),
+                                                 _mm256_cmpeq_epi64(d1, first_d));
+                alignas(32) std::int64_t pn[8], pd[8];
+                _mm256_store_si256(reinterpret_cast<__m256i *>(pn), n0);
+                _mm256_store_si256(reinterpret_cast<__m256i *>(pn + 4), n1);
+                std::int64_t sum;
+                if (_mm256_movemask_epi8(eq) == -1 && checked_sum(pn, 8, sum)) {
+                    acc.add(sum, _mm256_extract_epi64(d0, 0));
+                } else {
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(pd), d0);
+                    _mm256_store_si256(reinterpret_cast<__m256i *>(pd + 4), d1);
+                    for (std::size_t j = 0; j != 8; ++j) {
+                        acc.add(pn[j], pd[j]);
+                    }
+                }
+            }
+            for (; i != last; ++i) {
+                acc.add_product(x[i], y[i]);
+            }
+            return acc;
+        }
+#endif
+
+    }  // namespace detail
+
+    /**
+     * Computes a * b + c with one final reduction (at most one more gcd is
+     * needed if the denominator of c does not divide that of a * b or vice
+     * versa).
+     *
+     * Example:
+     * ```
+     * fma(Fraction<int>(1, 2), Fraction<int>(2, 3), Fraction<int>(1, 6)) == Fraction<int>(1, 2)
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] a The first factor.
+     * @param[in] b The second factor.
+     * @param[in] c The addend.
+     * @return a * b + c (0/0 if it does not fit in T)
+     */
+    template <typename T>
+    auto fma(const Fraction<T> &a, const Fraction<T> &b, const Fraction<T> &c) -> Fraction<T> {
+        using W = typename widened<T>::type;
+        detail::Accumulator<T> acc;
+        acc.numer = W(c.numer());
+        acc.denom = W(c.denom());
+        acc.add_product(a, b);
+        return acc.result();
+    }
+
+    /**
+     * Computes the inner product of x[0..n) and y[0..n) with one final
+     * reduction. Long vectors are split into contiguous chunks that are
+     * accumulated on separate threads and merged at the end; each thread
+     * gets at least 16384 elements.
+     *
+     * Example:
+     * ```
+     * std::vector<Fraction<int>> x{{1, 2}, {1, 3}}, y{{2, 1}, {3, 1}};
+     * dot(x.data(), y.data(), 2) == Fraction<int>(2)
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] x The first vector.
+     * @param[in] y The second vector.
+     * @param[in] n The length of both vectors.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     * @return sum of x[i] * y[i] (0/0 if it does not fit in T)
+     */
+    template <typename T>
+    auto dot(const Fraction<T> *x, const Fraction<T> *y, std::size_t n, unsigned threads = 1)
+        -> Fraction<T> {
+        return detail::parallel_accumulate<detail::Accumulator<T>>(
+                   n, threads, [x, y](std::size_t first, std::size_t last) {
+                       return detail::dot_range(x, y, first, last);
+                   })
+            .result();
+    }
+
+    /**
+     * Computes the inner product of two vectors of equal length.
+     *
+     * @tparam T The integer type.
+     * @param[in] x The first vector.
+     * @param[in] y The second vector.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     * @return sum of x[i] * y[i] (0/0 if it does not fit in T)
+     */
+    template <typename T>
+    auto dot(const std::vector<Fraction<T>> &x, const std::vector<Fraction<T>> &y,
+             unsigned threads = 1) -> Fraction<T> {
+        return dot(x.data(), y.data(), std::min(x.size(), y.size()), threads);
+    }
+}  // namespace fractions
+
+// see FRACTIONS_FOR_INSTANTIATED_TYPES in fractions.hpp
+#define FRACTIONS_KERNEL_TEMPLATES(prefix, T)                                                   \
+    prefix auto fma<T>(const Fraction<T> &, const Fraction<T> &, const Fraction<T> &)           \
+        -> Fraction<T>;                                                                         \
+    prefix auto dot<T>(const Fraction<T> *, const Fraction<T> *, std::size_t, unsigned)         \
+        -> Fraction<T>;
+
+#ifdef FRACTIONS_EXTERN_TEMPLATES
+namespace fractions {
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_KERNEL_TEMPLATES, extern template)
+}  // namespace fractions
+#endif
@@ -0,0 +1,449 @@
+#pragma once
+
+/** @file include/fractions/polynomial.hpp
+ *  Polynomials with rational coefficients kept in denominator-cleared form.
+ */
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+
+namespace fractions {
+
+    namespace detail {
+
+        /** Operand size below which karatsuba_mul() falls back to schoolbook. */
+        constexpr std::size_t karatsuba_threshold = 32;
+
+        /**
+         * Schoolbook product of a[0..na) and b[0..nb), accumulated into
+         * out[0..na+nb-1).
+         */
+        template <typename T>
+        void schoolbook_mul(const T *a, std::size_t na, const T *b, std::size_t nb, T *out) {
+            for (std::size_t i = 0; i != na; ++i) {
+                if (a[i] == 0) {
+                    continue;
+                }
+                for (std::size_t j = 0; j != nb; ++j) {
+                    out[i + j] += a[i] * b[j];
+                }
+            }
+        }
+
+        /**
+         * Karatsuba product of two equal-length operands a[0..n) and b[0..n),
+         * accumulated into out[0..2n-1).
+         */
+        template <typename T> void karatsuba_mul(const T *a, const T *b, std::size_t n, T *out) {
+            if (n < karatsuba_threshold) {
+                schoolbook_mul(a, n, b, n, out);
+                return;
+            }
+            const auto h = n / 2;   // h >= 1 since n >= karatsuba_threshold
+            const auto hi = n - h;  // hi >= h
+            std::vector<T> sa(a + h, a + n), sb(b + h, b + n);
+            for (std::size_t i = 0; i != h; ++i) {
+                sa[i] += a[i];
+                sb[i] += b[i];
+            }
+            std::vector<T> z0(2 * h - 1, T(0)), z1(2 * hi - 1, T(0)), z2(2 * hi - 1, T(0));
+            karatsuba_mul(a, b, h, z0.data());
+            karatsuba_mul(a + h, b + h, hi, z2.data());
+            karatsuba_mul(sa.data(), sb.data(), hi, z1.data());
+            for (std::size_t i = 0; i != z0.size(); ++i) {
+                z1[i] -= z0[i];
+                out[i] += z0[i];
+            }
+            for (std::size_t i = 0; i != z2.size(); ++i) {
+                z1[i] -= z2[i];
+                out[2 * h + i] += z2[i];
+            }
+            for (std::size_t i = 0; i != z1.size(); ++i) {
+                out[h + i] += z1[i];
+            }
+        }
+
+        /**
+         * Product of two integer polynomials (lowest degree first). Unbalanced
+         * operands are multiplied slice by slice so Karatsuba always sees
+         * equal lengths.
+         */
+        template <typename T>
+        auto poly_mul(const std::vector<T> &a, const std::vector<T> &b) -> std::vector<T> {
+            if (a.empty() || b.empty()) {
+                return {};
+            }
+            const auto &lng = a.size() >= b.size() ? a : b;
+            const auto &sht = a.size() >= b.size() ? b : a;
+            const auto n = sht.size();
+            std::vector<T> out(a.size() + b.size() - 1, T(0));
+            if (n < karatsuba_threshold) {
+                schoolbook_mul(lng.data(), lng.size(), sht.data(), n, out.data());
+                return out;
+            }
+            std::vector<T> slice(n), prod(2 * n - 1);
+            for (std::size_t off = 0; off < lng.size(); off += n) {
+                const auto len = lng.size() - off < n ? lng.size() - off : n;
+                for (std::size_t i = 0; i != n; ++i) {
+                    slice[i] = i < len ? lng[off + i] : T(0);
+                }
+                prod.assign(2 * n - 1, T(0));
+                karatsuba_mul(slice.data(), sht.data(), n, prod.data());
+                for (std::size_t i = 0; i != prod.size() && off + i < out.size(); ++i) {
+                    out[off + i] += prod[i];
+                }
+            }
+            return out;
+        }
+
+    }  // namespace detail
+
+    /**
+     * @brief Polynomial with rational coefficients.
+     *
+     * Stored as an integer polynomial plus a single positive content
+     * denominator, i.e. `(c_0 + c_1 x + ... + c_n x^n) / d`, in canonical
+     * form: the gcd of d and all c_i is 1 and the leading c_n is non-zero.
+     * Arithmetic works on the integer coefficients and reduces once per
+     * operation instead of once per coefficient.
+     *
+     * Example:
+     * ```
+     * // (x^2 - 1) / 2
+     * RationalPolynomial<int> p({-1, 0, 1}, 2);
+     * p(Fraction<int>(3)) == Fraction<int>(4);
+     * ```
+     * @tparam T The integer type.
+     */
+    template <typename T> class RationalPolynomial {
+        std::vector<T> _coeffs;  // lowest degree first
+        T _denom;
+
+      public:
+        /**
+         * Constructs the zero polynomial.
+         */
+        RationalPolynomial() : _denom(1) {}
+
+        /**
+         * Constructs the polynomial `(c_0 + c_1 x + ... ) / denom`.
+         *
+         * @param[in] coeffs The integer coefficients, lowest degree first.
+         * @param[in] denom The common denominator (non-zero).
+         */
+        explicit RationalPolynomial(std::vector<T> coeffs, T denom = T(1))
+            : _coeffs{std::move(coeffs)}, _denom{std::move(denom)} {
+            this->normalize();
+        }
+
+        /**
+         * Constructs a polynomial from fraction coefficients by clearing
+         * their denominators.
+         *
+         * @param[in] coeffs The coefficients, lowest degree first.
+         * @return The polynomial.
+         */
+        static auto from_fractions(const std::vector<Fraction<T>> &coeffs)
+            -> RationalPolynomial {
+            T d(1);
+            for (const auto &c : coeffs) {
+                d = lcm(d, c.denom());
+            }
+            std::vector<T> num;
+            num.reserve(coeffs.size());
+            for (const auto &c : coeffs) {
+                num.push_back(c.numer() * (d / c.denom()));
+            }
+            return RationalPolynomial(std::move(num), std::move(d));
+        }
+
+        /**
+         * Brings the polynomial to canonical form: trims leading zero
+         * coefficients, makes the denominator positive and divides out the
+         * gcd of the denominator and the content.
+         */
+        void normalize() {
+            while (!this->_coeffs.empty() && this->_coeffs.back() == 0) {
+                this->_coeffs.pop_back();
+            }
+            if (this->_coeffs.empty()) {
+                this->_denom = T(1);
+                return;
+            }
+            if (this->_denom < 0) {
+                this->_denom = -this->_denom;
+                for (auto &c : this->_coeffs) {
+                    c = -c;
+                }
+            }
+            auto common = this->_denom;
+            for (const auto &c : this->_coeffs) {
+                if (common == 1) {
+                    return;
+                }
+                common = gcd(c, common);
+            }
+            if (common == 1) {
+                return;
+            }
+            for (auto &c : this->_coeffs) {
+                c /= common;
+            }
+            this->_denom /= common;
+        }
+
+        /** @return The integer coefficients, lowest degree first. */
+        auto coeffs() const noexcept -> const std::vector<T> & { return this->_coeffs; }
+
+        /** @return The common denominator. */
+        auto denom() const noexcept -> const T & { return this->_denom; }
+
+        /** @return true for the zero polynomial. */
+        auto is_zero() const noexcept -> bool { return this->_coeffs.empty(); }
+
+        /** @return The degree (0 for constants, including zero). */
+        auto degree() const noexcept -> std::size_t {
+            return this->_coeffs.empty() ? 0 : this->_coeffs.size() - 1;
+        }
+
+        /**
+         * Gets the i-th coefficient as a fraction.
+         *
+         * @param[in] i The power of x.
+         * @return The coefficient of x^i.
+         */
+        auto coeff(std::size_t i) const -> Fraction<T> {
+            return i < this->_coeffs.size() ? Fraction<T>(this->_coeffs[i], this->_denom)
+                                            : Fraction<T>();
+        }
+
+        /**
+         * Evaluates at an integer point with Horner's rule.
+         *
+         * @param[in] x The point.
+         * @return The value p(x).
+         */
+        auto operator()(const T &x) const -> Fraction<T> {
+            T acc(0);
+            for (auto it = this->_coeffs.rbegin(); it != this->_coeffs.rend(); ++it) {
+                acc = acc * x + *it;
+            }
+            return Fraction<T>(std::move(acc), this->_denom);
+        }
+
+        /**
+         * Evaluates at a rational point p/q with homogeneous Horner's rule
+         *
+         *     sum c_i p^i q^(n-i) / (d q^n)
+         *
+         * which runs entirely on integers and reduces once at the end.
+         *
+         * @param[in] x The point.
+         * @return The value p(x).
+         */
+        auto operator()(const Fraction<T> &x) const -> Fraction<T> {
+            if (this->_coeffs.empty()) {
+                return Fraction<T>();
+            }
+            const auto &p = x.numer();
+            const auto &q = x.denom();
+            auto it = this->_coeffs.rbegin();
+            T acc = *it;
+            T qpow(1);
+            for (++it; it != this->_coeffs.rend(); ++it) {
+                qpow *= q;
+                acc = acc * p + *it * qpow;
+            }
+            return Fraction<T>(std::move(acc), this->_denom * qpow);
+        }
+
+        /**
+         * Evaluates at many rational points.
+         *
+         * Points are processed four at a time so the coefficient array is
+         * streamed once per group and the independent Horner chains overlap.
+         *
+         * @param[in] xs The points.
+         * @return The values p(x) for each x in xs.
+         */
+        auto evaluate(const std::vector<Fraction<T>> &xs) const -> std::vector<Fraction<T>> {
+            constexpr std::size_t lanes = 4;
+            std::vector<Fraction<T>> out;
+            out.reserve(xs.size());
+            if (this->_coeffs.empty()) {
+                out.assign(xs.size(), Fraction<T>());
+                return out;
+            }
+            std::size_t k = 0;
+            for (; k + lanes <= xs.size(); k += lanes) {
+                T acc[lanes], qpow[lanes];
+                for (std::size_t l = 0; l != lanes; ++l) {
+                    acc[l] = this->_coeffs.back();
+                    qpow[l] = T(1);
+                }
+                for (auto i = this->_coeffs.size() - 1; i-- != 0;) {
+                    const auto &c = this->_coeffs[i];
+                    for (std::size_t l = 0; l != lanes; ++l) {
+                        qpow[l] *= xs[k + l].denom();
+                        acc[l] = acc[l] * xs[k + l].numer() + c * qpow[l];
+                    }
+                }
+                for (std::size_t l = 0; l != lanes; ++l) {
+                    out.emplace_back(std::move(acc[l]), this->_denom * qpow[l]);
+                }
+            }
+            for (; k != xs.size(); ++k) {
+                out.push_back((*this)(xs[k]));
+            }
+            return out;
+        }
+
+        /**
+         * Computes the formal derivative.
+         *
+         * @return The polynomial p'(x).
+         */
+        auto derivative() const -> RationalPolynomial {
+            if (this->_coeffs.size() < 2) {
+                return RationalPolynomial();
+            }
+            std::vector<T> res(this->_coeffs.size() - 1);
+            for (std::size_t i = 1; i != this->_coeffs.size(); ++i) {
+                res[i - 1] = this->_coeffs[i] * T(i);
+            }
+            return RationalPolynomial(std::move(res), this->_denom);
+        }
+
+        /** @name Arithmetic operators */
+        ///@{
+
+        /**
+         * Negates the polynomial.
+         */
+        auto operator-() const -> RationalPolynomial {
+            auto res = *this;
+            for (auto &c : res._coeffs) {
+                c = -c;
+            }
+            return res;
+        }
+
+        /**
+         * Adds another polynomial. Both operands are brought to the common
+         * denominator lcm(d1, d2) and the sum is reduced once.
+         */
+        auto operator+=(const RationalPolynomial &rhs) -> RationalPolynomial & {
+            if (rhs.is_zero()) {
+                return *this;
+            }
+            const auto common = gcd(this->_denom, rhs._denom);
+            const auto l = rhs._denom / common;   // scale for *this
+            const auto r = this->_denom / common;  // scale for rhs
+            if (this->_coeffs.size() < rhs._coeffs.size()) {
+                this->_coeffs.resize(rhs._coeffs.size(), T(0));
+            }
+            if (l != 1) {
+                for (auto &c : this->_coeffs) {
+                    c *= l;
+                }
+            }
+            for (std::size_t i = 0; i != rhs._coeffs.size(); ++i) {
+                this->_coeffs[i] += rhs._coeffs[i] * r;
+            }
+            this->_denom *= l;
+            this->normalize();
+            return *this;
+        }
+
+        /**
+         * Subtracts another polynomial.
+         */
+        auto operator-=(const RationalPolynomial &rhs) -> RationalPolynomial & {
+            return *this += -rhs;
+        }
+
+        /**
+         * Multiplies by another polynomial using Karatsuba multiplication on
+         * the integer coefficients and a single final reduction.
+         */
+        auto operator*=(const RationalPolynomial &rhs) -> RationalPolynomial & {
+            this->_coeffs = detail::poly_mul(this->_coeffs, rhs._coeffs);
+            this->_denom *= rhs._denom;
+            this->normalize();
+            return *this;
+        }
+
+        /**
+         * Multiplies by a rational scalar.
+         */
+        auto operator*=(const Fraction<T> &rhs) -> RationalPolynomial & {
+            for (auto &c : this->_coeffs) {
+                c *= rhs.numer();
+            }
+            this->_denom *= rhs.denom();
+            this->normalize();
+            return *this;
+        }
+
+        friend auto operator+(RationalPolynomial lhs, const RationalPolynomial &rhs)
+            -> RationalPolynomial {
+            return lhs += rhs;
+        }
+
+        friend auto operator-(RationalPolynomial lhs, const RationalPolynomial &rhs)
+            -> RationalPolynomial {
+            return lhs -= rhs;
+        }
+
+        friend auto operator*(RationalPolynomial lhs, const RationalPolynomial &rhs)
+            -> RationalPolynomial {
+            return lhs *= rhs;
+        }
+
+        friend auto operator*(RationalPolynomial lhs, const Fraction<T> &rhs)
+            -> RationalPolynomial {
+            return lhs *= rhs;
+        }
+
+        ///@}
+
+        /**
+         * Compares two polynomials for equality (canonical forms make this a
+         * plain member-wise comparison).
+         */
+        friend auto operator==(const RationalPolynomial &lhs, const RationalPolynomial &rhs)
+            -> bool {
+            return lhs._denom == rhs._denom && lhs._coeffs == rhs._coeffs;
+        }
+
+        friend auto operator!=(const RationalPolynomial &lhs, const RationalPolynomial &rhs)
+            -> bool {
+            return !(lhs == rhs);
+        }
+
+        /**
+         * Prints the polynomial as "(c_0 + c_1*x + ... )/d".
+         */
+        template <typename _Stream>
+        friend auto operator<<(_Stream &os, const RationalPolynomial &p) -> _Stream & {
+            os << "(";
+            for (std::size_t i = 0; i != p._coeffs.size(); ++i) {
+                if (i != 0) {
+                    os << " + ";
+                }
+                os << p._coeffs[i];
+                if (i != 0) {
+                    os << "*x^" << i;
+                }
+            }
+            if (p._coeffs.empty()) {
+                os << 0;
+            }
+            os << ")/" << p._denom;
+            return os;
+        }
+    };
+}  // namespace fractions
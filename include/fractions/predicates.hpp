@@ -0,0 +1,293 @@
+#pragma once
+
+/** @file include/fractions/predicates.hpp
+ *  Filtered exact geometric predicates over fraction coordinates.
+ *
+ *  Each predicate first evaluates its determinant in `double` together with
+ *  an error bound proportional to the permanent of the matrix (the same
+ *  expression with absolute values). Only if the floating-point result is
+ *  within that bound of zero is the determinant recomputed exactly: every
+ *  point is moved to homogeneous integer coordinates by clearing its
+ *  denominators and the determinant is evaluated with BigInt.
+ *
+ *  Coordinates must be finite (non-zero denominators).
+ */
+
+#include <cmath>
+#include <type_traits>
+
+#include "bigint.hpp"
+#include "fractions.hpp"
+
+namespace fractions {
+
+    /** @brief A point in the plane with fraction coordinates. */
+    template <typename T> struct Point2 {
+        Fraction<T> x;  ///< x coordinate
+        Fraction<T> y;  ///< y coordinate
+    };
+
+    /** @brief A point in space with fraction coordinates. */
+    template <typename T> struct Point3 {
+        Fraction<T> x;  ///< x coordinate
+        Fraction<T> y;  ///< y coordinate
+        Fraction<T> z;  ///< z coordinate
+    };
+
+    namespace detail {
+
+        /**
+         * Error-bound multipliers, in units of 2^-53, on the permanent. Every
+         * converted coordinate carries a relative error of at most 4u (two
+         * conversions and a division); the constants cover that plus the
+         * rounding of the determinant expression with a safety margin.
+         */
+        constexpr double orient2d_bound = 16.0 / 9007199254740992.0;
+        constexpr double orient3d_bound = 64.0 / 9007199254740992.0;
+        constexpr double incircle_bound = 128.0 / 9007199254740992.0;
+
+        inline auto sign_of(double v) -> int { return (v > 0.0) - (v < 0.0); }
+
+        /**
+         * Decides the sign of det with the error bound, returning 2 when the
+         * filter is inconclusive (including overflow or NaN).
+         */
+        inline auto filtered_sign(double det, double errbound) -> int {
+            if (!std::isfinite(errbound)) {
+                FRACTIONS_COUNT(FilterOverflow);
+                FRACTIONS_COUNT(FilterExact);
+                return 2;
+            }
+            if (det > errbound) {
+                FRACTIONS_COUNT(FilterDecided);
+                return 1;
+            }
+            if (-det > errbound) {
+                FRACTIONS_COUNT(FilterDecided);
+                return -1;
+            }
+            FRACTIONS_COUNT(FilterExact);
+            return 2;
+        }
+
+        inline auto det2(const BigInt &a, const BigInt &b, const BigInt &c, const BigInt &d)
+            -> BigInt {
+            return a * d - b * c;
+        }
+
+        inline auto det3(const BigInt (&m)[3][3]) -> BigInt {
+            return m[0][0] * det2(m[1][1], m[1][2], m[2][1], m[2][2])
+                   - m[0][1] * det2(m[1][0], m[1][2], m[2][0], m[2][2])
+                   + m[0][2] * det2(m[1][0], m[1][1], m[2][0], m[2][1]);
+        }
+
+        /** 4x4 determinant by Laplace expansion along the first two rows. */
+        inline auto det4(const BigInt (&m)[4][4]) -> BigInt {
+            const auto s0 = det2(m[0][0], m[0][1], m[1][0], m[1][1]);
+            const auto s1 = det2(m[0][0], m[0][2], m[1][0], m[1][2]);
+            const auto s2 = det2(m[0][0], m[0][3], m[1][0], m[1][3]);
+            const auto s3 = det2(m[0][1], m[0][2], m[1][1], m[1][2]);
+            const auto s4 = det2(m[0][1], m[0][3], m[1][1], m[1][3]);
+            const auto s5 = det2(m[0][2], m[0][3], m[1][2], m[1][3]);
+            const auto c5 = det2(m[2][2], m[2][3], m[3][2], m[3][3]);
+            const auto c4 = det2(m[2][1], m[2][3], m[3][1], m[3][3]);
+            const auto c3 = det2(m[2][1], m[2][2], m[3][1], m[3][2]);
+            const auto c2 = det2(m[2][0], m[2][3], m[3][0], m[3][3]);
+            const auto c1 = det2(m[2][0], m[2][2], m[3][0], m[3][2]);
+            const auto c0 = det2(m[2][0], m[2][1], m[3][0], m[3][1]);
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }
+
+        /**
+         * Homogeneous integer coordinates (X_1, ..., X_k, W) of a point, with
+         * W the product of the coordinate denominators (W > 0).
+         */
+        template <typename T, std::size_t K>
+        void homogeneous(const Fraction<T> (&coords)[K], BigInt (&out)[K + 1]) {
+            BigInt w(T(1));
+            for (std::size_t i = 0; i != K; ++i) {
+                w *= BigInt(coords[i].denom());
+            }
+            for (std::size_t i = 0; i != K; ++i) {
+                BigInt x(coords[i].numer());
+                for (std::size_t j = 0; j != K; ++j) {
+                    if (j != i) {
+                        x *= BigInt(coords[j].denom());
+                    }
+                }
+                out[i] = x;
+            }
+            out[K] = w;
+        }
+
+        /** Exact orient2d for built-in integer T: sign of det [x y 1]. */
+        template <typename T>
+        auto orient2d_exact(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c) ->
+            typename std::enable_if<std::is_integral<T>::value, int>::type {
+            BigInt m[3][3];
+            const Point2<T> *pts[3] = {&a, &b, &c};
+            for (int i = 0; i != 3; ++i) {
+                const Fraction<T> coords[2] = {pts[i]->x, pts[i]->y};
+                homogeneous(coords, m[i]);
+            }
+            return det3(m).sign();
+        }
+
+        /** Exact orient2d for other T: the difference form in Fraction<T>. */
+        template <typename T>
+        auto orient2d_exact(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c) ->
+            typename std::enable_if<!std::is_integral<T>::value, int>::type {
+            const auto det = (a.x - c.x) * (b.y - c.y) - (a.y - c.y) * (b.x - c.x);
+            return (det.numer() > 0) - (det.numer() < 0);
+        }
+
+        /** Exact orient3d for built-in integer T: sign of det [x y z 1]. */
+        template <typename T>
+        auto orient3d_exact(const Point3<T> &a, const Point3<T> &b, const Point3<T> &c,
+                            const Point3<T> &d) ->
+            typename std::enable_if<std::is_integral<T>::value, int>::type {
+            BigInt m[4][4];
+            const Point3<T> *pts[4] = {&a, &b, &c, &d};
+            for (int i = 0; i != 4; ++i) {
+                const Fraction<T> coords[3] = {pts[i]->x, pts[i]->y, pts[i]->z};
+                homogeneous(coords, m[i]);
+            }
+            return det4(m).sign();
+        }
+
+        /** Exact orient3d for other T: the difference form in Fraction<T>. */
+        template <typename T>
+        auto orient3d_exact(const Point3<T> &a, const Point3<T> &b, const Point3<T> &c,
+                            const Point3<T> &d) ->
+            typename std::enable_if<!std::is_integral<T>::value, int>::type {
+            const auto adx = a.x - d.x, ady = a.y - d.y, adz = a.z - d.z;
+            const auto bdx = b.x - d.x, bdy = b.y - d.y, bdz = b.z - d.z;
+            const auto cdx = c.x - d.x, cdy = c.y - d.y, cdz = c.z - d.z;
+            const auto det = adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy)
+                             + cdz * (adx * bdy - bdx * ady);
+            return (det.numer() > 0) - (det.numer() < 0);
+        }
+
+        /**
+         * Exact incircle for built-in integer T: sign of det [x y x^2+y^2 1],
+         * with each row scaled by W^2 to [XW, YW, X^2+Y^2, W^2].
+         */
+        template <typename T>
+        auto incircle_exact(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c,
+                            const Point2<T> &d) ->
+            typename std::enable_if<std::is_integral<T>::value, int>::type {
+            BigInt m[4][4];
+            const Point2<T> *pts[4] = {&a, &b, &c, &d};
+            for (int i = 0; i != 4; ++i) {
+                const Fraction<T> coords[2] = {pts[i]->x, pts[i]->y};
+                BigInt h[3];
+                homogeneous(coords, h);
+                m[i][0] = h[0] * h[2];
+                m[i][1] = h[1] * h[2];
+                m[i][2] = h[0] * h[0] + h[1] * h[1];
+                m[i][3] = h[2] * h[2];
+            }
+            return det4(m).sign();
+        }
+
+        /** Exact incircle for other T: the difference form in Fraction<T>. */
+        template <typename T>
+        auto incircle_exact(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c,
+                            const Point2<T> &d) ->
+            typename std::enable_if<!std::is_integral<T>::value, int>::type {
+            const auto adx = a.x - d.x, ady = a.y - d.y;
+            const auto bdx = b.x - d.x, bdy = b.y - d.y;
+            const auto cdx = c.x - d.x, cdy = c.y - d.y;
+            const auto det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+                             + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+                             + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+            return (det.numer() > 0) - (det.numer() < 0);
+        }
+
+    }  // namespace detail
+
+    /**
+     * Orientation of three points in the plane.
+     *
+     * Example:
+     * ```
+     * orient2d(P{0, 0}, P{1, 0}, P{0, 1}) == 1
+     * ```
+     *
+     * @param[in] a, b, c The points.
+     * @return 1 if a, b, c turn counterclockwise, -1 if clockwise, 0 if collinear.
+     */
+    template <typename T>
+    auto orient2d(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c) -> int {
+        const auto ax = to_double(a.x), ay = to_double(a.y);
+        const auto bx = to_double(b.x), by = to_double(b.y);
+        const auto cx = to_double(c.x), cy = to_double(c.y);
+        const auto det = (ax - cx) * (by - cy) - (ay - cy) * (bx - cx);
+        const auto permanent = (std::fabs(ax) + std::fabs(cx)) * (std::fabs(by) + std::fabs(cy))
+                               + (std::fabs(ay) + std::fabs(cy)) * (std::fabs(bx) + std::fabs(cx));
+        const auto s = detail::filtered_sign(det, detail::orient2d_bound * permanent);
+        return s != 2 ? s : detail::orient2d_exact(a, b, c);
+    }
+
+    /**
+     * Orientation of four points in space.
+     *
+     * @param[in] a, b, c, d The points.
+     * @return 1 if d lies below the plane through a, b, c (which then appear
+     * counterclockwise seen from above), -1 if above, 0 if coplanar.
+     */
+    template <typename T>
+    auto orient3d(const Point3<T> &a, const Point3<T> &b, const Point3<T> &c,
+                  const Point3<T> &d) -> int {
+        const auto dx = to_double(d.x), dy = to_double(d.y), dz = to_double(d.z);
+        const auto ax = to_double(a.x), ay = to_double(a.y), az = to_double(a.z);
+        const auto bx = to_double(b.x), by = to_double(b.y), bz = to_double(b.z);
+        const auto cx = to_double(c.x), cy = to_double(c.y), cz = to_double(c.z);
+        const auto adx = ax - dx, ady = ay - dy, adz = az - dz;
+        const auto bdx = bx - dx, bdy = by - dy, bdz = bz - dz;
+        const auto cdx = cx - dx, cdy = cy - dy, cdz = cz - dz;
+        const auto det = adz * (bdx * cdy - cdx * bdy) + bdz * (cdx * ady - adx * cdy)
+                         + cdz * (adx * bdy - bdx * ady);
+        const auto pax = std::fabs(ax) + std::fabs(dx), pay = std::fabs(ay) + std::fabs(dy),
+                   paz = std::fabs(az) + std::fabs(dz);
+        const auto pbx = std::fabs(bx) + std::fabs(dx), pby = std::fabs(by) + std::fabs(dy),
+                   pbz = std::fabs(bz) + std::fabs(dz);
+        const auto pcx = std::fabs(cx) + std::fabs(dx), pcy = std::fabs(cy) + std::fabs(dy),
+                   pcz = std::fabs(cz) + std::fabs(dz);
+        const auto permanent = paz * (pbx * pcy + pcx * pby) + pbz * (pcx * pay + pax * pcy)
+                               + pcz * (pax * pby + pbx * pay);
+        const auto s = detail::filtered_sign(det, detail::orient3d_bound * permanent);
+        return s != 2 ? s : detail::orient3d_exact(a, b, c, d);
+    }
+
+    /**
+     * In-circle test of d against the circle through a, b, c.
+     *
+     * @param[in] a, b, c The points on the circle, in counterclockwise order.
+     * @param[in] d The query point.
+     * @return 1 if d lies inside the circle, -1 if outside, 0 if on it
+     * (signs flip when a, b, c are clockwise).
+     */
+    template <typename T>
+    auto incircle(const Point2<T> &a, const Point2<T> &b, const Point2<T> &c,
+                  const Point2<T> &d) -> int {
+        const auto dx = to_double(d.x), dy = to_double(d.y);
+        const auto ax = to_double(a.x), ay = to_double(a.y);
+        const auto bx = to_double(b.x), by = to_double(b.y);
+        const auto cx = to_double(c.x), cy = to_double(c.y);
+        const auto adx = ax - dx, ady = ay - dy;
+        const auto bdx = bx - dx, bdy = by - dy;
+        const auto cdx = cx - dx, cdy = cy - dy;
+        const auto det = (adx * adx + ady * ady) * (bdx * cdy - cdx * bdy)
+                         + (bdx * bdx + bdy * bdy) * (cdx * ady - adx * cdy)
+                         + (cdx * cdx + cdy * cdy) * (adx * bdy - bdx * ady);
+        const auto pax = std::fabs(ax) + std::fabs(dx), pay = std::fabs(ay) + std::fabs(dy);
+        const auto pbx = std::fabs(bx) + std::fabs(dx), pby = std::fabs(by) + std::fabs(dy);
+        const auto pcx = std::fabs(cx) + std::fabs(dx), pcy = std::fabs(cy) + std::fabs(dy);
+        const auto permanent = (pax * pax + pay * pay) * (pbx * pcy + pcx * pby)
+                               + (pbx * pbx + pby * pby) * (pcx * pay + pax * pcy)
+                               + (pcx * pcx + pcy * pcy) * (pax * pby + pbx * pay);
+        const auto s = detail::filtered_sign(det, detail::incircle_bound * permanent);
+        return s != 2 ? s : detail::incircle_exact(a, b, c, d);
+    }
+}  // namespace fractions
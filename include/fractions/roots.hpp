@@ -0,0 +1,460 @@
+#pragma once
+
+/** @file include/fractions/roots.hpp
+ *  Real root isolation for rational polynomials.
+ *
+ *  Uses Descartes' rule of signs with the continued-fraction strategy of
+ *  Vincent, Akritas and Strzebonski: Mobius transformations
+ *  x -> (a x + b) / (c x + d) with integer entries map the positive real
+ *  axis onto ever smaller intervals, whose endpoints are therefore exact
+ *  fractions.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include "approximation.hpp"
+#include "fractions.hpp"
+#include "polynomial.hpp"
+
+namespace fractions {
+
+    /**
+     * @brief An isolating interval of a real root.
+     *
+     * Either the open interval (lo, hi) contains exactly one root, or
+     * lo == hi and the root is the rational number lo itself.
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> struct RootInterval {
+        Fraction<T> lo;  ///< lower end
+        Fraction<T> hi;  ///< upper end
+
+        /** @return true if the root is known exactly (lo == hi). */
+        auto is_exact() const -> bool { return this->lo == this->hi; }
+    };
+
+    namespace detail {
+
+        template <typename T> void poly_trim(std::vector<T> &a) {
+            while (!a.empty() && a.back() == 0) {
+                a.pop_back();
+            }
+        }
+
+        /** Divides out the content and makes the leading coefficient positive. */
+        template <typename T> void make_primitive(std::vector<T> &a) {
+            poly_trim(a);
+            if (a.empty()) {
+                return;
+            }
+            T common(0);
+            for (const auto &c : a) {
+                common = gcd(common, c);
+                if (common == 1) {
+                    break;
+                }
+            }
+            if (a.back() < 0) {
+                common = -common;
+            }
+            if (common != 1) {
+                for (auto &c : a) {
+                    c /= common;
+                }
+            }
+        }
+
+        /** Counts the sign changes in the coefficient sequence. */
+        template <typename T> auto sign_variations(const std::vector<T> &a) -> std::size_t {
+            std::size_t count = 0;
+            int last = 0;
+            for (const auto &c : a) {
+                const int s = (c > 0) - (c < 0);
+                if (s != 0) {
+                    if (last != 0 && s != last) {
+                        ++count;
+                    }
+                    last = s;
+                }
+            }
+            return count;
+        }
+
+        /** Replaces a(x) by a(x + s) in place (Horner-style, O(n^2)). */
+        template <typename T> void taylor_shift(std::vector<T> &a, const T &s) {
+            const auto n = a.size();
+            for (std::size_t i = 0; i + 1 < n; ++i) {
+                for (auto j = n - 1; j-- != i;) {
+                    a[j] += s * a[j + 1];
+                }
+            }
+        }
+
+        /**
+         * Pseudo-remainder of a by b, returned as a primitive polynomial. The
+         * content is divided out after every elimination step to slow down
+         * coefficient growth.
+         */
+        template <typename T>
+        auto pseudo_rem(std::vector<T> r, const std::vector<T> &b) -> std::vector<T> {
+            make_primitive(r);
+            const auto &lb = b.back();
+            while (r.size() >= b.size()) {
+                const auto k = r.size() - b.size();
+                const T t = r.back();
+                for (auto &c : r) {
+                    c *= lb;
+                }
+                for (std::size_t i = 0; i != b.size(); ++i) {
+                    r[k + i] -= t * b[i];
+                }
+                make_primitive(r);
+            }
+            return r;
+        }
+
+        /** Primitive gcd of two integer polynomials (primitive PRS). */
+        template <typename T>
+        auto poly_gcd(std::vector<T> a, std::vector<T> b) -> std::vector<T> {
+            make_primitive(a);
+            make_primitive(b);
+            while (!b.empty()) {
+                auto r = pseudo_rem(a, b);
+                a.swap(b);
+                b.swap(r);
+            }
+            return a;
+        }
+
+        /**
+         * Quotient a / b of primitive integer polynomials where b divides a;
+         * by Gauss's lemma the quotient has integer coefficients, so plain
+         * long division never leaves the integers.
+         */
+        template <typename T>
+        auto exact_quotient(std::vector<T> a, const std::vector<T> &b) -> std::vector<T> {
+            std::vector<T> q(a.size() - b.size() + 1, T(0));
+            for (auto k = q.size(); k-- != 0;) {
+                q[k] = a[k + b.size() - 1] / b.back();
+                for (std::size_t i = 0; i != b.size(); ++i) {
+                    a[k + i] -= q[k] * b[i];
+                }
+            }
+            return q;
+        }
+
+        /**
+         * Checks gcd(a, a') == 1 modulo the prime 2^31 - 1. A positive answer
+         * proves that a is square-free over the rationals, which lets the
+         * common case skip the exact gcd and its coefficient growth.
+         */
+        template <typename T> auto square_free_mod_prime(const std::vector<T> &a) -> bool {
+            constexpr long long prime = 2147483647LL;
+            auto reduce = [](const std::vector<long long> &v) {
+                auto r = v;
+                while (!r.empty() && r.back() == 0) {
+                    r.pop_back();
+                }
+                return r;
+            };
+            auto inverse = [](long long x) {
+                long long res = 1;
+                for (auto e = prime - 2; e != 0; e >>= 1) {
+                    if (e & 1) {
+                        res = res * x % prime;
+                    }
+                    x = x * x % prime;
+                }
+                return res;
+            };
+            std::vector<long long> f, g;
+            for (std::size_t i = 0; i != a.size(); ++i) {
+                auto c = static_cast<long long>(a[i] % T(prime));
+                c = c < 0 ? c + prime : c;
+                f.push_back(c);
+                if (i != 0) {
+                    g.push_back(c * static_cast<long long>(i % prime) % prime);
+                }
+            }
+            if (f.back() == 0) {
+                return false;  // degree drops: inconclusive
+            }
+            f = reduce(f);
+            g = reduce(g);
+            while (!g.empty()) {
+                const auto inv = inverse(g.back());
+                while (f.size() >= g.size()) {
+                    const auto k = f.size() - g.size();
+                    const auto t = f.back() * inv % prime;
+                    for (std::size_t i = 0; i != g.size(); ++i) {
+                        f[k + i] = ((f[k + i] - t * g[i]) % prime + prime) % prime;
+                    }
+                    f = reduce(f);
+                }
+                f.swap(g);
+            }
+            return f.size() == 1;
+        }
+
+        /**
+         * Kioustelidis' bound `2 max (|a_i| / a_n)^(1/(n-i))` over the
+         * coefficients whose sign differs from the leading one: every
+         * positive root is below it.
+         */
+        template <typename T> auto positive_root_bound(const std::vector<T> &a) -> double {
+            const auto n = a.size() - 1;
+            const auto lead = static_cast<double>(a[n]);
+            double bound = 0.0;
+            for (std::size_t i = 0; i != n; ++i) {
+                const auto c = static_cast<double>(a[i]);
+                if ((c < 0) != (lead < 0) && c != 0.0) {
+                    bound = std::fmax(bound, std::pow(std::fabs(c / lead), 1.0 / double(n - i)));
+                }
+            }
+            return 2.0 * bound;
+        }
+
+        /** Cauchy's strict upper bound `2 + max |a_i| / |a_n|` on all root moduli. */
+        template <typename T> auto cauchy_bound(const std::vector<T> &a) -> T {
+            T m(0);
+            for (std::size_t i = 0; i + 1 < a.size(); ++i) {
+                const auto c = abs(a[i]);
+                if (m < c) {
+                    m = c;
+                }
+            }
+            return m / abs(a.back()) + 2;
+        }
+
+        /**
+         * Isolates the positive roots of a square-free integer polynomial with
+         * p(0) != 0, appending intervals to `out`. `ub` is a strict upper
+         * bound on the roots, used to close the unbounded rightmost interval.
+         */
+        template <typename T>
+        void isolate_positive(std::vector<T> p, const T &ub, std::vector<RootInterval<T>> &out) {
+            struct Node {
+                std::vector<T> p;
+                T a, b, c, d;  // x -> (a x + b) / (c x + d)
+            };
+            auto emit = [&](const Node &nd) {
+                auto lo = Fraction<T>(nd.b, nd.d);
+                auto hi = nd.c == 0 ? Fraction<T>(ub) : Fraction<T>(nd.a, nd.c);
+                if (hi < lo) {
+                    std::swap(lo, hi);
+                }
+                out.push_back(RootInterval<T>{lo, hi});
+            };
+            auto exact = [&](const T &n, const T &d) {
+                const auto x = Fraction<T>(n, d);
+                out.push_back(RootInterval<T>{x, x});
+            };
+
+            std::vector<Node> stack;
+            stack.push_back(Node{std::move(p), T(1), T(0), T(0), T(1)});
+            while (!stack.empty()) {
+                auto nd = std::move(stack.back());
+                stack.pop_back();
+                auto v = sign_variations(nd.p);
+                if (v == 0) {
+                    continue;
+                }
+                if (v == 1) {
+                    emit(nd);
+                    continue;
+                }
+
+                // continued-fraction step: jump over the root-free part (0, lb)
+                const auto bound = positive_root_bound(std::vector<T>(nd.p.rbegin(), nd.p.rend()));
+                const auto lb_d = bound > 0.0 ? std::floor(1.0 / (bound * (1.0 + 1e-9))) : 0.0;
+                if (lb_d >= 1.0 && lb_d < 1e9) {
+                    const auto lb = T(static_cast<long long>(lb_d));
+                    taylor_shift(nd.p, lb);
+                    nd.b += nd.a * lb;
+                    nd.d += nd.c * lb;
+                    if (nd.p.front() == 0) {
+                        exact(nd.b, nd.d);
+                        nd.p.erase(nd.p.begin());
+                    }
+                    make_primitive(nd.p);
+                    v = sign_variations(nd.p);
+                    if (v == 0) {
+                        continue;
+                    }
+                    if (v == 1) {
+                        emit(nd);
+                        continue;
+                    }
+                }
+
+                // split into x > 1 (p(x + 1)) and 0 < x < 1 ((x + 1)^n p(1 / (x + 1)))
+                Node right{nd.p, nd.a, nd.a + nd.b, nd.c, nd.c + nd.d};
+                Node left{std::vector<T>(nd.p.rbegin(), nd.p.rend()), nd.b, nd.a + nd.b, nd.d,
+                          nd.c + nd.d};
+                taylor_shift(right.p, T(1));
+                taylor_shift(left.p, T(1));
+                if (right.p.front() == 0) {
+                    exact(right.b, right.d);
+                    right.p.erase(right.p.begin());
+                    left.p.erase(left.p.begin());
+                }
+                make_primitive(right.p);
+                make_primitive(left.p);
+                stack.push_back(std::move(right));
+                stack.push_back(std::move(left));
+            }
+        }
+
+    }  // namespace detail
+
+    /**
+     * Computes the square-free part `p / gcd(p, p')` of a polynomial, as a
+     * primitive integer polynomial with the same real roots.
+     *
+     * Square-free inputs are recognized modulo a prime and returned as is.
+     * Otherwise the gcd is computed by a primitive remainder sequence, whose
+     * intermediate coefficients need far more bits than the input; use a
+     * wide or arbitrary-precision T for high-degree inputs with multiple roots.
+     *
+     * @tparam T The integer type.
+     * @param[in] p The polynomial.
+     * @return The square-free part.
+     */
+    template <typename T>
+    auto square_free_part(const RationalPolynomial<T> &p) -> RationalPolynomial<T> {
+        auto a = p.coeffs();
+        detail::make_primitive(a);
+        if (a.size() < 2) {
+            return RationalPolynomial<T>(std::move(a));
+        }
+        if (detail::square_free_mod_prime(a)) {
+            return RationalPolynomial<T>(std::move(a));
+        }
+        const auto g = detail::poly_gcd(a, p.derivative().coeffs());
+        if (g.size() < 2) {
+            return RationalPolynomial<T>(std::move(a));
+        }
+        auto q = detail::exact_quotient(std::move(a), g);
+        detail::make_primitive(q);
+        return RationalPolynomial<T>(std::move(q));
+    }
+
+    /**
+     * @brief The real roots of a rational polynomial, isolated by disjoint
+     * intervals with fraction endpoints.
+     *
+     * Multiple roots are reported once. Intervals are sorted and can be
+     * narrowed on demand with refine().
+     *
+     * Example:
+     * ```
+     * // (x^2 - 2)(2x - 1)
+     * RealRoots<long long> roots(RationalPolynomial<long long>({2, -4, -1, 2}));
+     * roots.size() == 3;  // (-2, -1), [1/2, 1/2], (1, 2)
+     * roots.refine(0, Fraction<long long>(1, 1000));
+     * ```
+     * @tparam T The integer type.
+     */
+    template <typename T> class RealRoots {
+        RationalPolynomial<T> _sqfree;
+        RationalPolynomial<T> _deriv;
+        std::vector<RootInterval<T>> _roots;
+
+        auto sign_at(const RationalPolynomial<T> &q, const Fraction<T> &x) const -> int {
+            const auto v = q(x);
+            return (v.numer() > 0) - (v.numer() < 0);
+        }
+
+      public:
+        /**
+         * Isolates the real roots of p. The zero polynomial has no isolated
+         * roots.
+         *
+         * @param[in] p The polynomial.
+         */
+        explicit RealRoots(const RationalPolynomial<T> &p)
+            : _sqfree{square_free_part(p)}, _deriv{_sqfree.derivative()} {
+            auto a = this->_sqfree.coeffs();
+            if (a.size() < 2) {
+                return;
+            }
+            if (a.front() == 0) {
+                this->_roots.push_back(RootInterval<T>{Fraction<T>(), Fraction<T>()});
+                a.erase(a.begin());
+            }
+            if (a.size() < 2) {
+                return;
+            }
+            const auto ub = detail::cauchy_bound(a);
+            detail::isolate_positive(a, ub, this->_roots);
+            for (std::size_t i = 1; i < a.size(); i += 2) {
+                a[i] = -a[i];
+            }
+            std::vector<RootInterval<T>> neg;
+            detail::isolate_positive(a, ub, neg);
+            for (const auto &iv : neg) {
+                this->_roots.push_back(RootInterval<T>{-iv.hi, -iv.lo});
+            }
+            std::sort(this->_roots.begin(), this->_roots.end(),
+                      [](const RootInterval<T> &x, const RootInterval<T> &y) {
+                          return x.lo < y.lo || (x.lo == y.lo && x.hi < y.hi);
+                      });
+        }
+
+        /** @return The number of distinct real roots. */
+        auto size() const -> std::size_t { return this->_roots.size(); }
+
+        /** @return The isolating interval of the i-th smallest root. */
+        auto operator[](std::size_t i) const -> const RootInterval<T> & {
+            return this->_roots[i];
+        }
+
+        /** @return All isolating intervals in increasing order. */
+        auto intervals() const -> const std::vector<RootInterval<T>> & { return this->_roots; }
+
+        /** @return The square-free polynomial whose roots are isolated. */
+        auto square_free() const -> const RationalPolynomial<T> & { return this->_sqfree; }
+
+        /**
+         * Narrows the i-th interval by bisection until `hi - lo <= max_width`
+         * (or the root is hit exactly).
+         *
+         * Instead of the midpoint, each step splits at the simplest fraction
+         * in the middle half of the interval, so the interval shrinks by at
+         * least a quarter while its endpoints keep small denominators.
+         *
+         * @param[in] i The index of the root.
+         * @param[in] max_width The requested width (positive).
+         */
+        void refine(std::size_t i, const Fraction<T> &max_width) {
+            auto &iv = this->_roots[i];
+            if (iv.is_exact()) {
+                return;
+            }
+            // sign just right of lo; an endpoint may itself be a (simple) root
+            auto s_lo = this->sign_at(this->_sqfree, iv.lo);
+            if (s_lo == 0) {
+                s_lo = this->sign_at(this->_deriv, iv.lo);
+            }
+            while (max_width < iv.hi - iv.lo) {
+                const auto quarter = (iv.hi - iv.lo) / T(4);
+                const auto m = simplest_between(iv.lo + quarter, iv.hi - quarter);
+                const auto s = this->sign_at(this->_sqfree, m);
+                if (s == 0) {
+                    iv.lo = iv.hi = m;
+                    return;
+                }
+                if (s == s_lo) {
+                    iv.lo = m;
+                } else {
+                    iv.hi = m;
+                }
+            }
+        }
+    };
+}  // namespace fractions
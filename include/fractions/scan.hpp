@@ -0,0 +1,326 @@
+#pragma once
+
+/** @file include/fractions/scan.hpp
+ *  Column scan kernels: threshold predicates and min/max reductions.
+ *
+ *  The kernels work on a column of fractions stored either as an array of
+ *  `Fraction<T>` (AoS) or as two parallel arrays of numerators and
+ *  denominators (SoA). Values are compared by cross-multiplication in
+ *  `widened<T>` lanes, without copying or reducing anything, and the inner
+ *  loops are branch-free over fixed-width blocks so that compilers
+ *  vectorize them (fully for 32-bit terms, whose widened lanes are 64 bits).
+ *
+ *  Denominators must be non-negative, as in canonical form; infinities
+ *  compare as expected. 0/0 never satisfies a predicate and must not occur
+ *  in the input of the min/max reductions.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#include "fractions.hpp"
+#include "kernels.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    /** Comparison operator of a threshold predicate `x op c`. */
+    enum class CompareOp { Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual };
+
+    namespace detail {
+
+        /** Compares the cross products l = x.numer * c.denom and r = c.numer * x.denom. */
+        template <CompareOp Op> struct cross_pred;
+
+        template <> struct cross_pred<CompareOp::Less> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l < r;
+            }
+        };
+        template <> struct cross_pred<CompareOp::LessEqual> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l <= r;
+            }
+        };
+        template <> struct cross_pred<CompareOp::Greater> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l > r;
+            }
+        };
+        template <> struct cross_pred<CompareOp::GreaterEqual> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l >= r;
+            }
+        };
+        template <> struct cross_pred<CompareOp::Equal> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l == r;
+            }
+        };
+        template <> struct cross_pred<CompareOp::NotEqual> {
+            template <typename W> static auto test(const W &l, const W &r) -> bool {
+                return l != r;
+            }
+        };
+
+        /** AoS column accessor. */
+        template <typename T> struct AosColumn {
+            const Fraction<T> *x;
+            auto numer(std::size_t i) const -> const T & { return this->x[i].numer(); }
+            auto denom(std::size_t i) const -> const T & { return this->x[i].denom(); }
+            auto from(std::size_t first) const -> AosColumn { return {this->x + first}; }
+        };
+
+        /** SoA column accessor. */
+        template <typename T> struct SoaColumn {
+            const T *num;
+            const T *den;
+            auto numer(std::size_t i) const -> const T & { return this->num[i]; }
+            auto denom(std::size_t i) const -> const T & { return this->den[i]; }
+            auto from(std::size_t first) const -> SoaColumn {
+                return {this->num + first, this->den + first};
+            }
+        };
+
+        template <CompareOp Op, typename T, typename Column>
+        void compare_mask_impl(const Column &col, std::size_t n, const Fraction<T> &c,
+                               std::uint64_t *mask) {
+            using W = typename widened<T>::type;
+            using P = cross_pred<Op>;
+            const W cn(c.numer());
+            const W cd(c.denom());
+            std::size_t i = 0;
+            for (; i + 64 <= n; i += 64) {
+                std::uint64_t word = 0;
+                for (std::size_t j = 0; j != 64; ++j) {
+                    const W l = W(W(col.numer(i + j)) * cd);
+                    const W r = W(cn * W(col.denom(i + j)));
+                    // 0/0 has l == r == 0 against everything; mask it out
+                    const bool nan = col.denom(i + j) == T(0) && col.numer(i + j) == T(0);
+                    word |= std::uint64_t(P::test(l, r) && !nan) << j;
+                }
+                mask[i / 64] = word;
+            }
+            if (i != n) {
+                std::uint64_t word = 0;
+                for (std::size_t j = 0; i + j != n; ++j) {
+                    const W l = W(W(col.numer(i + j)) * cd);
+                    const W r = W(cn * W(col.denom(i + j)));
+                    const bool nan = col.denom(i + j) == T(0) && col.numer(i + j) == T(0);
+                    word |= std::uint64_t(P::test(l, r) && !nan) << j;
+                }
+                mask[i / 64] = word;
+            }
+        }
+
+        template <typename T, typename Column>
+        void compare_mask_op(const Column &col, std::size_t n, CompareOp op,
+                             const Fraction<T> &c, std::uint64_t *mask) {
+            switch (op) {
+                case CompareOp::Less:
+                    compare_mask_impl<CompareOp::Less>(col, n, c, mask);
+                    break;
+                case CompareOp::LessEqual:
+                    compare_mask_impl<CompareOp::LessEqual>(col, n, c, mask);
+                    break;
+                case CompareOp::Greater:
+                    compare_mask_impl<CompareOp::Greater>(col, n, c, mask);
+                    break;
+                case CompareOp::GreaterEqual:
+                    compare_mask_impl<CompareOp::GreaterEqual>(col, n, c, mask);
+                    break;
+                case CompareOp::Equal:
+                    compare_mask_impl<CompareOp::Equal>(col, n, c, mask);
+                    break;
+                case CompareOp::NotEqual:
+                    compare_mask_impl<CompareOp::NotEqual>(col, n, c, mask);
+                    break;
+            }
+        }
+
+        /** Runs compare_mask_op() on chunks of whole mask words on several threads. */
+        template <typename T, typename Column>
+        void compare_mask_dispatch(const Column &col, std::size_t n, CompareOp op,
+                                   const Fraction<T> &c, std::uint64_t *mask, unsigned threads) {
+            parallel_for(n, threads, 64, [&](std::size_t first, std::size_t last) {
+                compare_mask_op(col.from(first), last - first, op, c, mask + first / 64);
+            });
+        }
+
+        /**
+         * Index of the minimum (Max = false) or maximum (Max = true) of the
+         * column, first occurrence on ties. Eight independent lanes keep a
+         * running best so that the loop carries no dependency between
+         * neighbouring elements; the lanes are combined at the end.
+         */
+        template <bool Max, typename T, typename Column>
+        auto arg_extreme(const Column &col, std::size_t n) -> std::size_t {
+            using W = typename widened<T>::type;
+            constexpr std::size_t lanes = 8;
+            if (n == 0) {
+                return 0;
+            }
+            // better(a, b): a strictly before b in the requested order
+            auto better = [](const T &an, const T &ad, const T &bn, const T &bd) -> bool {
+                const W l = W(W(an) * W(bd));
+                const W r = W(W(bn) * W(ad));
+                return Max ? r < l : l < r;
+            };
+            if (n < 2 * lanes) {
+                std::size_t best = 0;
+                for (std::size_t i = 1; i != n; ++i) {
+                    if (better(col.numer(i), col.denom(i), col.numer(best), col.denom(best))) {
+                        best = i;
+                    }
+                }
+                return best;
+            }
+            T bn[lanes], bd[lanes];
+            std::size_t bi[lanes];
+            for (std::size_t j = 0; j != lanes; ++j) {
+                bn[j] = col.numer(j);
+                bd[j] = col.denom(j);
+                bi[j] = j;
+            }
+            std::size_t i = lanes;
+            for (; i + lanes <= n; i += lanes) {
+                for (std::size_t j = 0; j != lanes; ++j) {
+                    const auto &xn = col.numer(i + j);
+                    const auto &xd = col.denom(i + j);
+                    const bool take = better(xn, xd, bn[j], bd[j]);
+                    bn[j] = take ? xn : bn[j];
+                    bd[j] = take ? xd : bd[j];
+                    bi[j] = take ? i + j : bi[j];
+                }
+            }
+            std::size_t best = bi[0];
+            T best_n = bn[0], best_d = bd[0];
+            for (std::size_t j = 1; j != lanes; ++j) {
+                const bool take = better(bn[j], bd[j], best_n, best_d)
+                                  || (!better(best_n, best_d, bn[j], bd[j]) && bi[j] < best);
+                if (take) {
+                    best = bi[j];
+                    best_n = bn[j];
+                    best_d = bd[j];
+                }
+            }
+            for (; i != n; ++i) {
+                if (better(col.numer(i), col.denom(i), best_n, best_d)) {
+                    best = i;
+                    best_n = col.numer(i);
+                    best_d = col.denom(i);
+                }
+            }
+            return best;
+        }
+
+    }  // namespace detail
+
+    /**
+     * Evaluates `x[i] op c` for a column of fractions into a bitmask: bit
+     * (i % 64) of mask[i / 64] is set iff the predicate holds. Unused bits
+     * of the last word are cleared.
+     *
+     * Example:
+     * ```
+     * std::vector<Fraction<std::int64_t>> prices = ...;
+     * std::vector<std::uint64_t> mask((prices.size() + 63) / 64);
+     * compare_mask(prices.data(), prices.size(), CompareOp::Greater,
+     *              Fraction<std::int64_t>(17, 3), mask.data());
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in] x The column (AoS).
+     * @param[in] n The number of rows.
+     * @param[in] op The comparison.
+     * @param[in] c The constant (non-negative denominator).
+     * @param[out] mask The (n + 63) / 64 result words.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void compare_mask(const Fraction<T> *x, std::size_t n, CompareOp op, const Fraction<T> &c,
+                      std::uint64_t *mask, unsigned threads = 1) {
+        detail::compare_mask_dispatch(detail::AosColumn<T>{x}, n, op, c, mask, threads);
+    }
+
+    /**
+     * Evaluates `numer[i] / denom[i] op c` for a column stored as separate
+     * numerator and denominator arrays; see the AoS overload.
+     *
+     * @tparam T The integer type.
+     * @param[in] numer The numerators.
+     * @param[in] denom The denominators (non-negative).
+     * @param[in] n The number of rows.
+     * @param[in] op The comparison.
+     * @param[in] c The constant (non-negative denominator).
+     * @param[out] mask The (n + 63) / 64 result words.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void compare_mask(const T *numer, const T *denom, std::size_t n, CompareOp op,
+                      const Fraction<T> &c, std::uint64_t *mask, unsigned threads = 1) {
+        detail::compare_mask_dispatch(detail::SoaColumn<T>{numer, denom}, n, op, c, mask,
+                                      threads);
+    }
+
+    /**
+     * @return The index of the first smallest element of x[0..n) (0 if n == 0).
+     */
+    template <typename T> auto argmin(const Fraction<T> *x, std::size_t n) -> std::size_t {
+        return detail::arg_extreme<false, T>(detail::AosColumn<T>{x}, n);
+    }
+
+    /**
+     * @return The index of the first largest element of x[0..n) (0 if n == 0).
+     */
+    template <typename T> auto argmax(const Fraction<T> *x, std::size_t n) -> std::size_t {
+        return detail::arg_extreme<true, T>(detail::AosColumn<T>{x}, n);
+    }
+
+    /**
+     * @return The index of the first smallest element of an SoA column (0 if n == 0).
+     */
+    template <typename T>
+    auto argmin(const T *numer, const T *denom, std::size_t n) -> std::size_t {
+        return detail::arg_extreme<false, T>(detail::SoaColumn<T>{numer, denom}, n);
+    }
+
+    /**
+     * @return The index of the first largest element of an SoA column (0 if n == 0).
+     */
+    template <typename T>
+    auto argmax(const T *numer, const T *denom, std::size_t n) -> std::size_t {
+        return detail::arg_extreme<true, T>(detail::SoaColumn<T>{numer, denom}, n);
+    }
+
+    /**
+     * @return The smallest element of x[0..n) (n > 0).
+     */
+    template <typename T> auto min_value(const Fraction<T> *x, std::size_t n) -> Fraction<T> {
+        return x[argmin(x, n)];
+    }
+
+    /**
+     * @return The largest element of x[0..n) (n > 0).
+     */
+    template <typename T> auto max_value(const Fraction<T> *x, std::size_t n) -> Fraction<T> {
+        return x[argmax(x, n)];
+    }
+}  // namespace fractions
+
+// see FRACTIONS_FOR_INSTANTIATED_TYPES in fractions.hpp
+#define FRACTIONS_SCAN_TEMPLATES(prefix, T)                                                     \
+    prefix void compare_mask<T>(const Fraction<T> *, std::size_t, CompareOp, const Fraction<T> &,\
+                                std::uint64_t *, unsigned);                                     \
+    prefix void compare_mask<T>(const T *, const T *, std::size_t, CompareOp, const Fraction<T> &,\
+                                std::uint64_t *, unsigned);                                     \
+    prefix auto argmin<T>(const Fraction<T> *, std::size_t) -> std::size_t;                     \
+    prefix auto argmax<T>(const Fraction<T> *, std::size_t) -> std::size_t;                     \
+    prefix auto argmin<T>(const T *, const T *, std::size_t) -> std::size_t;                    \
+    prefix auto argmax<T>(const T *, const T *, std::size_t) -> std::size_t;
+
+#ifdef FRACTIONS_EXTERN_TEMPLATES
+namespace fractions {
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_SCAN_TEMPLATES, extern template)
+}  // namespace fractions
+#endif
@@ -0,0 +1,348 @@
+#pragma once
+
+/** @file include/fractions/selection.hpp
+ *  Selection and partial sorting of fractions on filtered double keys.
+ *
+ *  Every element gets a `double` key (its value to within a relative error
+ *  of a few ulps) once up front. Comparisons then look at the keys first
+ *  and fall back to an exact cross-multiplication only when the two error
+ *  intervals overlap, so the exact work is confined to the narrow band of
+ *  elements whose keys are (almost) equal. Quickselect partitions three
+ *  ways around an exact pivot value, which keeps the result exact even when
+ *  key order and value order disagree inside the band.
+ *
+ *  Elements must not be 0/0; infinities are fine.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+#include "statistics.hpp"
+
+namespace fractions {
+
+    namespace detail {
+
+        /**
+         * Relative error bound of to_double(), in units of 2^-53: two
+         * conversions and one division, with a safety margin.
+         */
+        constexpr double key_rel_error = 4.0 / 9007199254740992.0;
+
+        /** Ranges smaller than this are finished by insertion sort. */
+        constexpr std::size_t select_small = 16;
+
+        /** Ranges smaller than this per thread are partitioned sequentially. */
+        constexpr std::size_t partition_chunk_min = 1U << 16;
+
+        /** A lower bound of the exact value of an element with key k. */
+        inline auto key_down(double k) -> double {
+            if (!std::isfinite(k)) {
+                return k;
+            }
+            return k - std::fabs(k) * key_rel_error - std::numeric_limits<double>::denorm_min();
+        }
+
+        /** An upper bound of the exact value of an element with key k. */
+        inline auto key_up(double k) -> double {
+            if (!std::isfinite(k)) {
+                return k;
+            }
+            return k + std::fabs(k) * key_rel_error + std::numeric_limits<double>::denorm_min();
+        }
+
+        /** Three-way comparison of (a, ka) with (b, kb), exact only if needed. */
+        template <typename T>
+        auto keyed_cmp(const Fraction<T> &a, double ka, const Fraction<T> &b, double kb) -> int {
+            if (key_up(ka) < key_down(kb)) {
+                return -1;
+            }
+            if (key_down(ka) > key_up(kb)) {
+                return 1;
+            }
+            const CrossLess<T> less;
+            return less(a, b) ? -1 : (less(b, a) ? 1 : 0);
+        }
+
+        /** Values and their keys, permuted in lockstep. */
+        template <typename T> struct KeyedSpan {
+            Fraction<T> *x;
+            double *key;
+
+            void swap(std::size_t i, std::size_t j) {
+                std::swap(this->x[i], this->x[j]);
+                std::swap(this->key[i], this->key[j]);
+            }
+        };
+
+        template <typename T>
+        void insertion_sort(KeyedSpan<T> s, std::size_t lo, std::size_t hi) {
+            for (auto i = lo + 1; i < hi; ++i) {
+                for (auto j = i; j > lo; --j) {
+                    if (keyed_cmp(s.x[j], s.key[j], s.x[j - 1], s.key[j - 1]) >= 0) {
+                        break;
+                    }
+                    s.swap(j, j - 1);
+                }
+            }
+        }
+
+        /** Index of the median key among positions a, b, c. */
+        inline auto median_of_three(const double *key, std::size_t a, std::size_t b,
+                                    std::size_t c) -> std::size_t {
+            if (key[a] < key[b]) {
+                return key[b] < key[c] ? b : (key[a] < key[c] ? c : a);
+            }
+            return key[a] < key[c] ? a : (key[b] < key[c] ? c : b);
+        }
+
+        /**
+         * Dutch-flag partition of [lo, hi) around the value of element p:
+         * returns (lt, gt) with [lo, lt) < pivot, [lt, gt) == pivot,
+         * [gt, hi) > pivot.
+         */
+        template <typename T>
+        auto partition_seq(KeyedSpan<T> s, std::size_t lo, std::size_t hi, std::size_t p)
+            -> std::pair<std::size_t, std::size_t> {
+            const auto pivot = s.x[p];
+            const auto pk = s.key[p];
+            auto lt = lo, i = lo, gt = hi;
+            while (i < gt) {
+                const auto c = keyed_cmp(s.x[i], s.key[i], pivot, pk);
+                if (c < 0) {
+                    s.swap(lt++, i++);
+                } else if (c > 0) {
+                    s.swap(i, --gt);
+                } else {
+                    ++i;
+                }
+            }
+            return std::make_pair(lt, gt);
+        }
+
+        /**
+         * Parallel out-of-place version of partition_seq(): each thread
+         * classifies a chunk, prefix sums give every chunk its slots in the
+         * three output regions, and the chunks are scattered into the
+         * buffer and copied back.
+         */
+        template <typename T>
+        auto partition_par(KeyedSpan<T> s, KeyedSpan<T> buf, std::vector<signed char> &cls,
+                           std::size_t lo, std::size_t hi, std::size_t p, std::size_t workers)
+            -> std::pair<std::size_t, std::size_t> {
+            const auto pivot = s.x[p];
+            const auto pk = s.key[p];
+            const auto n = hi - lo;
+            const auto chunk = (n + workers - 1) / workers;
+            std::vector<std::size_t> counts(3 * workers, 0);
+            auto run = [workers](std::function<void(std::size_t)> job) {
+                std::vector<std::thread> pool;
+                pool.reserve(workers - 1);
+                for (std::size_t t = 1; t != workers; ++t) {
+                    pool.emplace_back(job, t);
+                }
+                job(0);
+                for (auto &th : pool) {
+                    th.join();
+                }
+            };
+            run([&](std::size_t t) {
+                const auto first = lo + t * chunk;
+                const auto last = std::min(hi, first + chunk);
+                for (auto i = first; i < last; ++i) {
+                    const auto c = keyed_cmp(s.x[i], s.key[i], pivot, pk);
+                    cls[i - lo] = static_cast<signed char>(c);
+                    ++counts[3 * t + static_cast<std::size_t>(c + 1)];
+                }
+            });
+            // exclusive prefix sums: region-major, chunk-minor
+            std::vector<std::size_t> offset(3 * workers);
+            std::size_t total = 0;
+            for (std::size_t r = 0; r != 3; ++r) {
+                for (std::size_t t = 0; t != workers; ++t) {
+                    offset[3 * t + r] = total;
+                    total += counts[3 * t + r];
+                }
+            }
+            run([&](std::size_t t) {
+                const auto first = lo + t * chunk;
+                const auto last = std::min(hi, first + chunk);
+                std::size_t pos[3] = {offset[3 * t], offset[3 * t + 1], offset[3 * t + 2]};
+                for (auto i = first; i < last; ++i) {
+                    auto &dst = pos[static_cast<std::size_t>(cls[i - lo] + 1)];
+                    buf.x[dst] = s.x[i];
+                    buf.key[dst] = s.key[i];
+                    ++dst;
+                }
+            });
+            run([&](std::size_t t) {
+                const auto first = t * chunk;
+                const auto last = std::min(n, first + chunk);
+                if (first < last) {
+                    std::copy(buf.x + first, buf.x + last, s.x + lo + first);
+                    std::copy(buf.key + first, buf.key + last, s.key + lo + first);
+                }
+            });
+            return std::make_pair(lo + offset[1], lo + offset[2]);
+        }
+
+        /**
+         * Quickselect on [lo, hi) until position r holds its final element.
+         */
+        template <typename T>
+        void keyed_select(KeyedSpan<T> s, std::size_t lo, std::size_t hi, std::size_t r,
+                          unsigned threads) {
+            std::vector<Fraction<T>> buf_x;
+            std::vector<double> buf_key;
+            std::vector<signed char> cls;
+            while (hi - lo > select_small) {
+                const auto mid = lo + (hi - lo) / 2;
+                auto p = median_of_three(s.key, lo, mid, hi - 1);
+                if (hi - lo > 1024) {
+                    // ninther for large ranges
+                    const auto step = (hi - lo) / 8;
+                    p = median_of_three(s.key, median_of_three(s.key, lo, lo + step, lo + 2 * step),
+                                        median_of_three(s.key, mid - step, mid, mid + step),
+                                        median_of_three(s.key, hi - 1 - 2 * step, hi - 1 - step,
+                                                        hi - 1));
+                }
+                const auto workers
+                    = std::min<std::size_t>(threads, (hi - lo) / partition_chunk_min);
+                std::pair<std::size_t, std::size_t> eq;
+                if (workers > 1) {
+                    if (buf_x.size() < hi - lo) {
+                        buf_x.resize(hi - lo);
+                        buf_key.resize(hi - lo);
+                        cls.resize(hi - lo);
+                    }
+                    eq = partition_par(s, KeyedSpan<T>{buf_x.data(), buf_key.data()}, cls, lo, hi,
+                                       p, workers);
+                } else {
+                    eq = partition_seq(s, lo, hi, p);
+                }
+                if (r < eq.first) {
+                    hi = eq.first;
+                } else if (r >= eq.second) {
+                    lo = eq.second;
+                } else {
+                    return;
+                }
+            }
+            insertion_sort(s, lo, hi);
+        }
+
+        template <typename T>
+        auto make_keys(const Fraction<T> *x, std::size_t n, unsigned threads)
+            -> std::vector<double> {
+            std::vector<double> key(n);
+            const auto workers = std::max<std::size_t>(
+                1, std::min<std::size_t>(threads, n / partition_chunk_min));
+            const auto chunk = (n + workers - 1) / workers;
+            auto job = [&](std::size_t t) {
+                const auto last = std::min(n, (t + 1) * chunk);
+                for (auto i = t * chunk; i < last; ++i) {
+                    key[i] = to_double(x[i]);
+                }
+            };
+            std::vector<std::thread> pool;
+            for (std::size_t t = 1; t < workers; ++t) {
+                pool.emplace_back(job, t);
+            }
+            job(0);
+            for (auto &th : pool) {
+                th.join();
+            }
+            return key;
+        }
+
+        inline auto resolve_threads(unsigned threads) -> unsigned {
+            return threads == 0 ? std::max(1U, std::thread::hardware_concurrency()) : threads;
+        }
+
+    }  // namespace detail
+
+    /**
+     * Rearranges [first, last) like std::nth_element: the element at nth is
+     * the one that would be there in sorted order, no element before it is
+     * greater and no element after it is smaller.
+     *
+     * Comparisons use precomputed double keys and resolve only the
+     * ambiguous band exactly (see the file description); partitioning of
+     * large ranges is spread over `threads` threads.
+     *
+     * Example:
+     * ```
+     * std::vector<Fraction<int>> v{{1, 2}, {1, 3}, {2, 3}};
+     * fractions::nth_element(v.data(), v.data() + 1, v.data() + 3);
+     * v[1] == Fraction<int>(1, 2)
+     * ```
+     *
+     * @tparam T The integer type.
+     * @param[in,out] first The begin of the range.
+     * @param[in] nth The position to settle.
+     * @param[in] last The end of the range.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void nth_element(Fraction<T> *first, Fraction<T> *nth, Fraction<T> *last,
+                     unsigned threads = 1) {
+        const auto n = static_cast<std::size_t>(last - first);
+        const auto r = static_cast<std::size_t>(nth - first);
+        if (r >= n) {
+            return;
+        }
+        threads = detail::resolve_threads(threads);
+        auto key = detail::make_keys(first, n, threads);
+        detail::keyed_select(detail::KeyedSpan<T>{first, key.data()}, 0, n, r, threads);
+    }
+
+    /**
+     * Rearranges [first, last) like std::partial_sort: [first, middle) holds
+     * the middle - first smallest elements in ascending order, the rest
+     * follow in unspecified order.
+     *
+     * The smallest elements are selected as in nth_element() and then
+     * sorted by key with exact tie resolution.
+     *
+     * @tparam T The integer type.
+     * @param[in,out] first The begin of the range.
+     * @param[in] middle The end of the sorted part.
+     * @param[in] last The end of the range.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     */
+    template <typename T>
+    void partial_sort(Fraction<T> *first, Fraction<T> *middle, Fraction<T> *last,
+                      unsigned threads = 1) {
+        const auto n = static_cast<std::size_t>(last - first);
+        const auto m = static_cast<std::size_t>(middle - first);
+        if (m == 0) {
+            return;
+        }
+        threads = detail::resolve_threads(threads);
+        auto key = detail::make_keys(first, n, threads);
+        const auto s = detail::KeyedSpan<T>{first, key.data()};
+        if (m < n) {
+            detail::keyed_select(s, 0, n, m - 1, threads);
+        }
+        // sort the selected prefix through an index permutation
+        std::vector<std::size_t> idx(m);
+        for (std::size_t i = 0; i != m; ++i) {
+            idx[i] = i;
+        }
+        std::sort(idx.begin(), idx.end(), [&s](std::size_t i, std::size_t j) {
+            return detail::keyed_cmp(s.x[i], s.key[i], s.x[j], s.key[j]) < 0;
+        });
+        std::vector<Fraction<T>> sorted(m);
+        for (std::size_t i = 0; i != m; ++i) {
+            sorted[i] = first[idx[i]];
+        }
+        std::copy(sorted.begin(), sorted.end(), first);
+    }
+}  // namespace fractions
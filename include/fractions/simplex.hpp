@@ -0,0 +1,984 @@
+#pragma once
+
+/** @file include/fractions/simplex.hpp
+ *  Exact rational linear programming with a two-phase revised simplex.
+ *
+ *  Most pivots are performed in `double` on a sparse LU factorization of the
+ *  basis that is updated with sparse eta columns. The basis found that way is then
+ *  re-solved in `Fraction<T>` arithmetic, certified (primal and dual
+ *  feasibility are checked exactly) and, if necessary, repaired by further
+ *  exact pivots. Every exact operation is overflow-checked, so the returned
+ *  answer is exact, or LpStatus::Overflow if a term does not fit in T.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    /** Sense of a linear constraint `a^T x (sense) b`. */
+    enum class ConstraintSense { LessEqual, Equal, GreaterEqual };
+
+    /** Outcome of solve_simplex(). */
+    enum class LpStatus {
+        Optimal,
+        Infeasible,
+        Unbounded,
+        IterationLimit,
+        Overflow  ///< an exact term does not fit in T; use a wider integer type
+    };
+
+    /**
+     * @brief A linear program over non-negative variables.
+     *
+     *     minimize (or maximize)  c^T x
+     *     subject to              a_i^T x (<=, =, >=) b_i,   x >= 0
+     *
+     * Example:
+     * ```
+     * LinearProgram<long long> lp(2);
+     * lp.set_objective({F(3), F(5)}, true);
+     * lp.add_constraint({F(1), F(0)}, ConstraintSense::LessEqual, F(4));
+     * ```
+     * @tparam T The integer type of the coefficients.
+     */
+    template <typename T> struct LinearProgram {
+        std::size_t num_vars;                     ///< number of variables
+        std::vector<std::vector<Fraction<T>>> A;  ///< constraint rows
+        std::vector<ConstraintSense> sense;       ///< sense of each row
+        std::vector<Fraction<T>> b;               ///< right-hand sides
+        std::vector<Fraction<T>> c;               ///< objective coefficients
+        bool maximize;                            ///< maximize instead of minimize
+
+        /**
+         * Constructs an empty program with a zero objective.
+         *
+         * @param[in] n The number of variables.
+         */
+        explicit LinearProgram(std::size_t n) : num_vars{n}, c(n), maximize{false} {}
+
+        /**
+         * Sets the objective function.
+         *
+         * @param[in] coeffs The objective coefficients (one per variable).
+         * @param[in] maximize_ Whether to maximize rather than minimize.
+         */
+        void set_objective(std::vector<Fraction<T>> coeffs, bool maximize_ = false) {
+            coeffs.resize(this->num_vars);
+            this->c = std::move(coeffs);
+            this->maximize = maximize_;
+        }
+
+        /**
+         * Appends the constraint `row^T x (s) rhs`.
+         *
+         * @param[in] row The coefficients (one per variable).
+         * @param[in] s The constraint sense.
+         * @param[in] rhs The right-hand side.
+         */
+        void add_constraint(std::vector<Fraction<T>> row, ConstraintSense s, Fraction<T> rhs) {
+            row.resize(this->num_vars);
+            this->A.push_back(std::move(row));
+            this->sense.push_back(s);
+            this->b.push_back(std::move(rhs));
+        }
+    };
+
+    /** Tuning knobs of solve_simplex(). */
+    struct SimplexOptions {
+        bool float_phase = true;            ///< run the double-precision phase first
+        std::size_t max_float_pivots = 50000;  ///< pivot limit of the double phase
+        std::size_t max_exact_pivots = 50000;  ///< pivot limit of the exact phase
+        std::size_t refactor_interval = 64;    ///< eta updates between LU refactorizations
+        double tolerance = 1e-9;               ///< pricing and ratio-test tolerance
+    };
+
+    /**
+     * @brief The exact result of solve_simplex().
+     *
+     * @tparam T The integer type of the coefficients.
+     */
+    template <typename T> struct LpSolution {
+        LpStatus status;            ///< outcome
+        Fraction<T> objective;      ///< optimal objective value (if Optimal)
+        std::vector<Fraction<T>> x; ///< optimal point (if Optimal)
+        std::size_t float_pivots;   ///< pivots performed in double precision
+        std::size_t exact_pivots;   ///< pivots performed in exact arithmetic
+    };
+
+    namespace detail {
+
+        /**
+         * The program in equality form `A x = b, x >= 0, b >= 0` with slack,
+         * surplus and artificial columns appended. Columns are stored sparsely,
+         * both exactly and as doubles.
+         */
+        template <typename T> struct StandardForm {
+            using Column = std::vector<std::pair<std::size_t, Fraction<T>>>;
+            using ColumnF = std::vector<std::pair<std::size_t, double>>;
+
+            std::size_t m;          ///< number of rows
+            std::size_t n_struct;   ///< number of original variables
+            std::size_t first_art;  ///< index of the first artificial column
+            std::vector<Column> cols;
+            std::vector<ColumnF> cols_f;
+            std::vector<Fraction<T>> b;
+            std::vector<double> b_f;
+            std::vector<Fraction<T>> cost;  ///< phase-2 costs (minimization)
+            std::vector<std::size_t> init_basis;
+            bool overflow = false;  ///< an input term cannot be negated in T
+
+            explicit StandardForm(const LinearProgram<T> &lp)
+                : m{lp.A.size()}, n_struct{lp.num_vars}, first_art{0}, b(lp.b), init_basis(m) {
+                auto rows = lp.A;
+                auto sense = lp.sense;
+                const auto negatable = [this](const Fraction<T> &v) {
+                    if (is_fixed_width<T>::value && v.numer() == std::numeric_limits<T>::min()) {
+                        this->overflow = true;
+                    }
+                };
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (this->b[i].numer() < 0) {
+                        negatable(this->b[i]);
+                        this->b[i] = -this->b[i];
+                        for (auto &a : rows[i]) {
+                            negatable(a);
+                            a = -a;
+                        }
+                        if (sense[i] == ConstraintSense::LessEqual) {
+                            sense[i] = ConstraintSense::GreaterEqual;
+                        } else if (sense[i] == ConstraintSense::GreaterEqual) {
+                            sense[i] = ConstraintSense::LessEqual;
+                        }
+                    }
+                }
+                for (std::size_t j = 0; j != n_struct; ++j) {
+                    Column col;
+                    for (std::size_t i = 0; i != m; ++i) {
+                        if (rows[i][j].numer() != 0) {
+                            col.emplace_back(i, rows[i][j]);
+                        }
+                    }
+                    this->cols.push_back(std::move(col));
+                }
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (sense[i] == ConstraintSense::Equal) {
+                        continue;
+                    }
+                    auto unit = Fraction<T>(T(sense[i] == ConstraintSense::LessEqual ? 1 : -1));
+                    this->init_basis[i] = this->cols.size();
+                    this->cols.push_back(Column{std::make_pair(i, unit)});
+                }
+                this->first_art = this->cols.size();
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (sense[i] == ConstraintSense::LessEqual) {
+                        continue;
+                    }
+                    this->init_basis[i] = this->cols.size();
+                    this->cols.push_back(Column{std::make_pair(i, Fraction<T>(T(1)))});
+                }
+                this->cost.assign(this->cols.size(), Fraction<T>());
+                for (std::size_t j = 0; j != n_struct; ++j) {
+                    negatable(lp.c[j]);
+                    this->cost[j] = lp.maximize ? -lp.c[j] : lp.c[j];
+                }
+                for (const auto &col : this->cols) {
+                    ColumnF col_f;
+                    for (const auto &e : col) {
+                        col_f.emplace_back(e.first, to_double(e.second));
+                    }
+                    this->cols_f.push_back(std::move(col_f));
+                }
+                for (const auto &v : this->b) {
+                    this->b_f.push_back(to_double(v));
+                }
+            }
+
+            auto num_cols() const -> std::size_t { return this->cols.size(); }
+            auto has_artificials() const -> bool { return this->first_art != this->num_cols(); }
+        };
+
+        /**
+         * Double-precision sparse basis factorization `B0 = L U` followed by a
+         * file of sparse eta columns, so that `B = B0 E_1 ... E_k` after k
+         * basis changes.
+         *
+         * The factorization eliminates one column of the active submatrix
+         * per step: the column with the fewest entries, pivoting in the
+         * sparsest of its rows whose entry is at least a tenth of the
+         * largest one (threshold partial pivoting). The bases of LPs are
+         * mostly slack and singleton columns, so this keeps the fill-in, and
+         * with it the cost of every ftran and btran, close to the number of
+         * nonzeros of the basis.
+         */
+        class FloatBasis {
+            using Entries = std::vector<std::pair<std::size_t, double>>;
+
+            struct Eta {
+                std::size_t r;
+                double pivot;
+                Entries col;  // off-pivot entries
+            };
+
+            /** One elimination step of the factorization. */
+            struct Step {
+                std::size_t row;
+                std::size_t col;
+                double pivot;
+                Entries l;  // multipliers of the rows below the pivot, by row
+                Entries u;  // the rest of the pivot row, by column
+            };
+
+            std::size_t _m = 0;
+            std::vector<Step> _steps;
+            std::vector<Eta> _etas;
+
+          public:
+            /**
+             * Factorizes the basis matrix from scratch and clears the eta file.
+             *
+             * @return false if the basis is numerically singular.
+             */
+            template <typename T>
+            auto factor(const StandardForm<T> &sf, const std::vector<std::size_t> &basis) -> bool {
+                const auto m = sf.m;
+                const auto threshold = 0.1;
+                this->_m = m;
+                this->_etas.clear();
+                this->_steps.clear();
+                this->_steps.reserve(m);
+
+                // the active submatrix by rows, and the rows of every column
+                std::vector<Entries> rows(m);
+                std::vector<std::vector<std::size_t>> col_rows(m);
+                std::vector<std::size_t> col_count(m, 0);
+                for (std::size_t k = 0; k != m; ++k) {
+                    for (const auto &e : sf.cols_f[basis[k]]) {
+                        rows[e.first].emplace_back(k, e.second);
+                        col_rows[k].push_back(e.first);
+                        ++col_count[k];
+                    }
+                }
+                const auto value_at = [&rows](std::size_t i, std::size_t c) -> double {
+                    for (const auto &e : rows[i]) {
+                        if (e.first == c) {
+                            return e.second;
+                        }
+                    }
+                    return 0.0;
+                };
+                std::vector<char> row_done(m, 0), col_done(m, 0);
+                std::vector<std::size_t> pos(m, 0);  // 1 + index of a column in the row
+                for (std::size_t k = 0; k != m; ++k) {
+                    auto c = m;
+                    for (std::size_t j = 0; j != m; ++j) {
+                        if (!col_done[j] && (c == m || col_count[j] < col_count[c])) {
+                            c = j;
+                        }
+                    }
+                    auto largest = 0.0;
+                    for (const auto i : col_rows[c]) {
+                        if (!row_done[i]) {
+                            largest = std::fmax(largest, std::fabs(value_at(i, c)));
+                        }
+                    }
+                    if (largest < 1e-12) {
+                        return false;
+                    }
+                    auto p = m;
+                    for (const auto i : col_rows[c]) {
+                        if (!row_done[i] && std::fabs(value_at(i, c)) >= threshold * largest
+                            && (p == m || rows[i].size() < rows[p].size())) {
+                            p = i;
+                        }
+                    }
+                    Step step{p, c, value_at(p, c), {}, {}};
+                    row_done[p] = 1;
+                    col_done[c] = 1;
+                    for (const auto &e : rows[p]) {
+                        --col_count[e.first];
+                        if (e.first != c) {
+                            step.u.push_back(e);
+                        }
+                    }
+                    rows[p] = Entries();
+
+                    for (const auto i : col_rows[c]) {
+                        const auto a = row_done[i] ? 0.0 : value_at(i, c);
+                        if (a == 0.0) {
+                            continue;
+                        }
+                        const auto l = a / step.pivot;
+                        step.l.emplace_back(i, l);
+                        auto &row = rows[i];
+                        for (std::size_t t = 0; t != row.size(); ++t) {
+                            pos[row[t].first] = t + 1;
+                        }
+                        for (const auto &e : step.u) {
+                            if (pos[e.first] != 0) {
+                                row[pos[e.first] - 1].second -= l * e.second;
+                            } else {
+                                row.emplace_back(e.first, -l * e.second);
+                                col_rows[e.first].push_back(i);
+                                ++col_count[e.first];
+                            }
+                        }
+                        for (const auto &e : row) {
+                            pos[e.first] = 0;
+                        }
+                        row.erase(std::remove_if(row.begin(), row.end(),
+                                                 [c](const std::pair<std::size_t, double> &e) {
+                                                     return e.first == c;
+                                                 }),
+                                  row.end());
+                    }
+                    this->_steps.push_back(std::move(step));
+                }
+                return true;
+            }
+
+            /** Solves `B x = v` in place. */
+            void ftran(std::vector<double> &v) const {
+                for (const auto &step : this->_steps) {
+                    const auto vp = v[step.row];
+                    if (vp != 0.0) {
+                        for (const auto &e : step.l) {
+                            v[e.first] -= e.second * vp;
+                        }
+                    }
+                }
+                std::vector<double> x(this->_m);
+                for (auto it = this->_steps.rbegin(); it != this->_steps.rend(); ++it) {
+                    auto sum = v[it->row];
+                    for (const auto &e : it->u) {
+                        sum -= e.second * x[e.first];
+                    }
+                    x[it->col] = sum / it->pivot;
+                }
+                for (const auto &eta : this->_etas) {
+                    const auto xr = x[eta.r] / eta.pivot;
+                    for (const auto &e : eta.col) {
+                        x[e.first] -= e.second * xr;
+                    }
+                    x[eta.r] = xr;
+                }
+                v.swap(x);
+            }
+
+            /** Solves `B^T y = v` in place. */
+            void btran(std::vector<double> &v) const {
+                for (auto it = this->_etas.rbegin(); it != this->_etas.rend(); ++it) {
+                    auto sum = v[it->r];
+                    for (const auto &e : it->col) {
+                        sum -= e.second * v[e.first];
+                    }
+                    v[it->r] = sum / it->pivot;
+                }
+                std::vector<double> y(this->_m);
+                for (const auto &step : this->_steps) {
+                    const auto yp = v[step.col] / step.pivot;
+                    y[step.row] = yp;
+                    if (yp != 0.0) {
+                        for (const auto &e : step.u) {
+                            v[e.first] -= e.second * yp;
+                        }
+                    }
+                }
+                for (auto it = this->_steps.rbegin(); it != this->_steps.rend(); ++it) {
+                    auto sum = y[it->row];
+                    for (const auto &e : it->l) {
+                        sum -= e.second * y[e.first];
+                    }
+                    y[it->row] = sum;
+                }
+                v.swap(y);
+            }
+
+            /**
+             * Records the replacement of basic column r, where `w = B^{-1} a_q`
+             * is the FTRAN-ed entering column.
+             */
+            void update(std::size_t r, const std::vector<double> &w) {
+                Eta eta{r, w[r], {}};
+                for (std::size_t i = 0; i != w.size(); ++i) {
+                    if (i != r && w[i] != 0.0) {
+                        eta.col.emplace_back(i, w[i]);
+                    }
+                }
+                this->_etas.push_back(std::move(eta));
+            }
+
+            auto num_updates() const -> std::size_t { return this->_etas.size(); }
+        };
+
+        /**
+         * Runs the primal revised simplex in double precision from `basis`,
+         * which is updated in place. The result is advisory only: the exact
+         * phase re-solves and certifies whatever basis this returns.
+         */
+        template <typename T>
+        auto float_simplex(const StandardForm<T> &sf, const std::vector<double> &cost,
+                           std::vector<std::size_t> &basis, bool bar_artificials,
+                           const SimplexOptions &opt, std::size_t &pivots) -> LpStatus {
+            const auto m = sf.m;
+            const auto n = sf.num_cols();
+            const auto tol = opt.tolerance;
+            FloatBasis factor;
+            std::vector<char> is_basic(n, 0);
+            for (auto j : basis) {
+                is_basic[j] = 1;
+            }
+            std::vector<double> x_b;
+            auto refactor = [&]() -> bool {
+                if (!factor.factor(sf, basis)) {
+                    return false;
+                }
+                x_b = sf.b_f;
+                factor.ftran(x_b);
+                return true;
+            };
+            if (!refactor()) {
+                return LpStatus::IterationLimit;
+            }
+            for (std::size_t iter = 0; iter != opt.max_float_pivots; ++iter) {
+                if (factor.num_updates() >= opt.refactor_interval && !refactor()) {
+                    return LpStatus::IterationLimit;
+                }
+                std::vector<double> y(m);
+                for (std::size_t i = 0; i != m; ++i) {
+                    y[i] = cost[basis[i]];
+                }
+                factor.btran(y);
+
+                // Dantzig pricing
+                auto q = n;
+                auto best = -tol;
+                for (std::size_t j = 0; j != n; ++j) {
+                    if (is_basic[j] || (bar_artificials && j >= sf.first_art)) {
+                        continue;
+                    }
+                    auto d = cost[j];
+                    for (const auto &e : sf.cols_f[j]) {
+                        d -= y[e.first] * e.second;
+                    }
+                    if (d < best) {
+                        best = d;
+                        q = j;
+                    }
+                }
+                if (q == n) {
+                    return LpStatus::Optimal;
+                }
+
+                std::vector<double> w(m, 0.0);
+                for (const auto &e : sf.cols_f[q]) {
+                    w[e.first] = e.second;
+                }
+                factor.ftran(w);
+
+                // ratio test; basic artificials (at zero in phase 2) leave first
+                auto r = m;
+                auto theta = 0.0;
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (bar_artificials && basis[i] >= sf.first_art && std::fabs(w[i]) > tol) {
+                        r = i;
+                        theta = 0.0;
+                        break;
+                    }
+                    if (w[i] > tol) {
+                        const auto ratio = std::fmax(x_b[i], 0.0) / w[i];
+                        if (r == m || ratio < theta) {
+                            r = i;
+                            theta = ratio;
+                        }
+                    }
+                }
+                if (r == m) {
+                    return LpStatus::Unbounded;
+                }
+                for (std::size_t i = 0; i != m; ++i) {
+                    x_b[i] -= theta * w[i];
+                }
+                x_b[r] = theta;
+                is_basic[basis[r]] = 0;
+                is_basic[q] = 1;
+                basis[r] = q;
+                factor.update(r, w);
+                ++pivots;
+            }
+            return LpStatus::IterationLimit;
+        }
+
+        /**
+         * Stores numer / denom (denom != 0) reduced in r; false if a term
+         * does not fit in T or is the most negative T, which could not be
+         * negated later.
+         */
+        template <typename T, typename W>
+        auto exact_store(W numer, W denom, Fraction<T> &r) -> bool {
+            if (denom == W(0)) {
+                return false;
+            }
+            if (denom < W(0)
+                && !(checked_sub(W(0), numer, numer) && checked_sub(W(0), denom, denom))) {
+                return false;
+            }
+            const auto common = gcd(numer, denom);
+            if (common != W(1)) {
+                numer /= common;
+                denom /= common;
+            }
+            if (!fits<T>(numer) || !fits<T>(denom)
+                || (is_fixed_width<T>::value && numer == W(std::numeric_limits<T>::min()))) {
+                return false;
+            }
+            r._numer = static_cast<T>(numer);
+            r._denom = static_cast<T>(denom);
+            return true;
+        }
+
+        /** @name Overflow-checked arithmetic of the exact phase
+         *  The exact value of a op b, computed in widened<T> with every
+         *  product and sum checked. ok turns false if a step or the reduced
+         *  result does not fit, and stays false; the value is then
+         *  meaningless. Denominators are positive.
+         */
+        ///@{
+        template <typename T, bool Sub>
+        auto exact_add_sub(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> Fraction<T> {
+            using W = typename widened<T>::type;
+            if (b._numer == T(0)) {
+                return a;
+            }
+            Fraction<T> r;
+            if (!ok) {
+                return r;
+            }
+            const auto common = gcd(W(a._denom), W(b._denom));
+            const auto ca = W(W(a._denom) / common), cb = W(W(b._denom) / common);
+            W l, rr, n, d;
+            ok = checked_mul(W(a._numer), cb, l) && checked_mul(W(b._numer), ca, rr)
+                 && (Sub ? checked_sub(l, rr, n) : checked_add(l, rr, n))
+                 && checked_mul(W(a._denom), cb, d) && exact_store(n, d, r);
+            return r;
+        }
+
+        template <typename T>
+        auto exact_add(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> Fraction<T> {
+            return exact_add_sub<T, false>(a, b, ok);
+        }
+
+        template <typename T>
+        auto exact_sub(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> Fraction<T> {
+            return exact_add_sub<T, true>(a, b, ok);
+        }
+
+        /** a.numer * b.numer / (a.denom * b.denom), cross-cancelled first. */
+        template <typename T>
+        auto exact_mul(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> Fraction<T> {
+            using W = typename widened<T>::type;
+            Fraction<T> r;
+            if (!ok || a._numer == T(0) || b._numer == T(0)) {
+                return r;
+            }
+            const auto g1 = gcd(W(a._numer), W(b._denom));
+            const auto g2 = gcd(W(b._numer), W(a._denom));
+            W n, d;
+            ok = checked_mul(W(W(a._numer) / g1), W(W(b._numer) / g2), n)
+                 && checked_mul(W(W(a._denom) / g2), W(W(b._denom) / g1), d)
+                 && exact_store(n, d, r);
+            return r;
+        }
+
+        /** a / b for a non-zero b. */
+        template <typename T>
+        auto exact_div(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> Fraction<T> {
+            auto inverse = b;
+            std::swap(inverse._numer, inverse._denom);
+            if (inverse._denom < T(0)) {
+                // b is normalized and never the most negative T, so both negate
+                inverse._numer = T(-inverse._numer);
+                inverse._denom = T(-inverse._denom);
+            }
+            if (inverse._denom == T(0)) {
+                ok = false;
+                return Fraction<T>();
+            }
+            return exact_mul(a, inverse, ok);
+        }
+
+        /** a < b by cross multiplication. */
+        template <typename T>
+        auto exact_less(const Fraction<T> &a, const Fraction<T> &b, bool &ok) -> bool {
+            using W = typename widened<T>::type;
+            W l, r;
+            ok = ok && checked_mul(W(a._numer), W(b._denom), l)
+                 && checked_mul(W(b._numer), W(a._denom), r);
+            return ok && l < r;
+        }
+        ///@}
+
+        /**
+         * Exact basis inverse kept as a dense m x m matrix of fractions and
+         * updated by Gauss-Jordan pivots. Unlike the float phase it is not
+         * factorized sparsely: it is inverted once per phase and, when the
+         * float phase found the optimal basis, never pivoted. Every method
+         * turns ok false on overflow.
+         */
+        template <typename T> class ExactBasis {
+            std::size_t _m = 0;
+            std::vector<Fraction<T>> _binv;  // row-major
+
+          public:
+            /**
+             * Computes `B^{-1}` by Gauss-Jordan elimination.
+             *
+             * @return false if the basis is singular (or ok turned false).
+             */
+            auto invert(const StandardForm<T> &sf, const std::vector<std::size_t> &basis,
+                        bool &ok) -> bool {
+                const auto m = sf.m;
+                this->_m = m;
+                std::vector<Fraction<T>> mat(m * m);
+                this->_binv.assign(m * m, Fraction<T>());
+                for (std::size_t k = 0; k != m; ++k) {
+                    for (const auto &e : sf.cols[basis[k]]) {
+                        mat[e.first * m + k] = e.second;
+                    }
+                    this->_binv[k * m + k] = Fraction<T>(T(1));
+                }
+                for (std::size_t k = 0; k != m && ok; ++k) {
+                    auto p = k;
+                    while (p != m && mat[p * m + k].numer() == 0) {
+                        ++p;
+                    }
+                    if (p == m) {
+                        return false;
+                    }
+                    if (p != k) {
+                        for (std::size_t j = 0; j != m; ++j) {
+                            std::swap(mat[p * m + j], mat[k * m + j]);
+                            std::swap(this->_binv[p * m + j], this->_binv[k * m + j]);
+                        }
+                    }
+                    const auto pivot = mat[k * m + k];
+                    for (std::size_t j = 0; j != m; ++j) {
+                        mat[k * m + j] = exact_div(mat[k * m + j], pivot, ok);
+                        this->_binv[k * m + j] = exact_div(this->_binv[k * m + j], pivot, ok);
+                    }
+                    for (std::size_t i = 0; i != m; ++i) {
+                        if (i == k || mat[i * m + k].numer() == 0) {
+                            continue;
+                        }
+                        const auto f = mat[i * m + k];
+                        for (std::size_t j = 0; j != m; ++j) {
+                            auto &a = mat[i * m + j];
+                            a = exact_sub(a, exact_mul(f, mat[k * m + j], ok), ok);
+                            auto &b = this->_binv[i * m + j];
+                            b = exact_sub(b, exact_mul(f, this->_binv[k * m + j], ok), ok);
+                        }
+                    }
+                }
+                return ok;
+            }
+
+            /** Returns `B^{-1} a` for a sparse column a. */
+            auto ftran(const typename StandardForm<T>::Column &a, bool &ok) const
+                -> std::vector<Fraction<T>> {
+                const auto m = this->_m;
+                std::vector<Fraction<T>> w(m);
+                for (std::size_t i = 0; i != m; ++i) {
+                    for (const auto &e : a) {
+                        const auto &v = this->_binv[i * m + e.first];
+                        w[i] = exact_add(w[i], exact_mul(v, e.second, ok), ok);
+                    }
+                }
+                return w;
+            }
+
+            /** Returns `B^{-1} b` for a dense vector b. */
+            auto ftran(const std::vector<Fraction<T>> &b, bool &ok) const
+                -> std::vector<Fraction<T>> {
+                const auto m = this->_m;
+                std::vector<Fraction<T>> x(m);
+                for (std::size_t i = 0; i != m; ++i) {
+                    for (std::size_t j = 0; j != m; ++j) {
+                        x[i] = exact_add(x[i], exact_mul(this->_binv[i * m + j], b[j], ok), ok);
+                    }
+                }
+                return x;
+            }
+
+            /** Returns `y` with `y^T = c_B^T B^{-1}`. */
+            auto btran(const std::vector<Fraction<T>> &c_b, bool &ok) const
+                -> std::vector<Fraction<T>> {
+                const auto m = this->_m;
+                std::vector<Fraction<T>> y(m);
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (c_b[i].numer() == 0) {
+                        continue;
+                    }
+                    for (std::size_t j = 0; j != m; ++j) {
+                        y[j] = exact_add(y[j], exact_mul(c_b[i], this->_binv[i * m + j], ok), ok);
+                    }
+                }
+                return y;
+            }
+
+            /** Replaces basic column r, where `w = B^{-1} a_q`. */
+            void pivot(std::size_t r, const std::vector<Fraction<T>> &w, bool &ok) {
+                const auto m = this->_m;
+                for (std::size_t j = 0; j != m; ++j) {
+                    this->_binv[r * m + j] = exact_div(this->_binv[r * m + j], w[r], ok);
+                }
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (i == r || w[i].numer() == 0) {
+                        continue;
+                    }
+                    for (std::size_t j = 0; j != m; ++j) {
+                        auto &v = this->_binv[i * m + j];
+                        v = exact_sub(v, exact_mul(w[i], this->_binv[r * m + j], ok), ok);
+                    }
+                }
+            }
+        };
+
+        /**
+         * Checks exactly that `basis` is non-singular and primal feasible
+         * (with basic artificials at zero when they are barred).
+         *
+         * @param[out] x_b The exact basic solution.
+         * @param[in,out] ok Turns false on overflow.
+         */
+        template <typename T>
+        auto exact_feasible(const StandardForm<T> &sf, const std::vector<std::size_t> &basis,
+                            bool bar_artificials, ExactBasis<T> &binv,
+                            std::vector<Fraction<T>> &x_b, bool &ok) -> bool {
+            if (!binv.invert(sf, basis, ok)) {
+                return false;
+            }
+            x_b = binv.ftran(sf.b, ok);
+            if (!ok) {
+                return false;
+            }
+            for (std::size_t i = 0; i != sf.m; ++i) {
+                if (x_b[i].numer() < 0) {
+                    return false;
+                }
+                if (bar_artificials && basis[i] >= sf.first_art && x_b[i].numer() != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /**
+         * Runs the primal revised simplex in exact arithmetic with Bland's
+         * rule, starting from a primal-feasible basis prepared by
+         * exact_feasible(). Optimality is certified by exact reduced costs.
+         */
+        template <typename T>
+        auto exact_simplex(const StandardForm<T> &sf, const std::vector<Fraction<T>> &cost,
+                           std::vector<std::size_t> &basis, bool bar_artificials,
+                           ExactBasis<T> &binv, std::vector<Fraction<T>> &x_b,
+                           const SimplexOptions &opt, std::size_t &pivots) -> LpStatus {
+            const auto m = sf.m;
+            const auto n = sf.num_cols();
+            bool ok = true;
+            std::vector<char> is_basic(n, 0);
+            for (auto j : basis) {
+                is_basic[j] = 1;
+            }
+            for (std::size_t iter = 0; iter != opt.max_exact_pivots; ++iter) {
+                std::vector<Fraction<T>> c_b(m);
+                for (std::size_t i = 0; i != m; ++i) {
+                    c_b[i] = cost[basis[i]];
+                }
+                const auto y = binv.btran(c_b, ok);
+
+                // Bland's rule: lowest-index improving column
+                auto q = n;
+                for (std::size_t j = 0; j != n && q == n && ok; ++j) {
+                    if (is_basic[j] || (bar_artificials && j >= sf.first_art)) {
+                        continue;
+                    }
+                    auto d = cost[j];
+                    for (const auto &e : sf.cols[j]) {
+                        d = exact_sub(d, exact_mul(y[e.first], e.second, ok), ok);
+                    }
+                    if (d.numer() < 0) {
+                        q = j;
+                    }
+                }
+                if (!ok) {
+                    return LpStatus::Overflow;
+                }
+                if (q == n) {
+                    return LpStatus::Optimal;
+                }
+
+                const auto w = binv.ftran(sf.cols[q], ok);
+                auto r = m;
+                auto theta = Fraction<T>();
+                for (std::size_t i = 0; i != m && ok; ++i) {
+                    if (bar_artificials && basis[i] >= sf.first_art && w[i].numer() != 0) {
+                        r = i;
+                        theta = Fraction<T>();
+                        break;
+                    }
+                    if (w[i].numer() > 0) {
+                        const auto ratio = exact_div(x_b[i], w[i], ok);
+                        if (r == m || exact_less(ratio, theta, ok)
+                            || (ratio == theta && basis[i] < basis[r])) {
+                            r = i;
+                            theta = ratio;
+                        }
+                    }
+                }
+                if (!ok) {
+                    return LpStatus::Overflow;
+                }
+                if (r == m) {
+                    return LpStatus::Unbounded;
+                }
+                for (std::size_t i = 0; i != m; ++i) {
+                    if (i != r) {
+                        x_b[i] = exact_sub(x_b[i], exact_mul(theta, w[i], ok), ok);
+                    }
+                }
+                x_b[r] = theta;
+                binv.pivot(r, w, ok);
+                if (!ok) {
+                    return LpStatus::Overflow;
+                }
+                is_basic[basis[r]] = 0;
+                is_basic[q] = 1;
+                basis[r] = q;
+                ++pivots;
+            }
+            return LpStatus::IterationLimit;
+        }
+
+        /**
+         * One simplex phase: an optional double-precision warm start followed
+         * by exact certification/repair. Falls back to `fallback` whenever the
+         * floating-point basis turns out to be singular or infeasible, or its
+         * exact solution overflows T.
+         */
+        template <typename T>
+        auto two_level_phase(const StandardForm<T> &sf, const std::vector<Fraction<T>> &cost,
+                             const std::vector<std::size_t> &fallback, bool bar_artificials,
+                             const SimplexOptions &opt, LpSolution<T> &sol,
+                             std::vector<std::size_t> &basis, std::vector<Fraction<T>> &x_b)
+            -> LpStatus {
+            ExactBasis<T> binv;
+            basis = fallback;
+            auto warm = false;
+            if (opt.float_phase) {
+                std::vector<double> cost_f;
+                for (const auto &v : cost) {
+                    cost_f.push_back(to_double(v));
+                }
+                float_simplex(sf, cost_f, basis, bar_artificials, opt, sol.float_pivots);
+                bool ok = true;
+                warm = exact_feasible(sf, basis, bar_artificials, binv, x_b, ok);
+            }
+            if (!warm) {
+                basis = fallback;
+                bool ok = true;
+                exact_feasible(sf, basis, bar_artificials, binv, x_b, ok);
+                if (!ok) {
+                    return LpStatus::Overflow;
+                }
+            }
+            return exact_simplex(sf, cost, basis, bar_artificials, binv, x_b, opt,
+                                 sol.exact_pivots);
+        }
+
+    }  // namespace detail
+
+    /**
+     * Solves a linear program exactly.
+     *
+     * A two-phase primal revised simplex is run first in `double` precision
+     * and the final basis of each phase is then re-solved, certified and, if
+     * needed, repaired with exact `Fraction<T>` pivots (Bland's rule). Only
+     * the certification touches rational arithmetic when the floating-point
+     * phase is right, so T must merely be wide enough for the basis inverse.
+     * The exact arithmetic is computed in `widened<T>` with every step
+     * checked; if a term does not fit in T the status is LpStatus::Overflow
+     * (retry with a wider or arbitrary-precision integer type).
+     *
+     * Example:
+     * ```
+     * // maximize 3x + 5y s.t. x <= 4, 2y <= 12, 3x + 2y <= 18
+     * auto sol = solve_simplex(lp);  // x = 2, y = 6, objective = 36
+     * ```
+     *
+     * @tparam T The integer type of the coefficients.
+     * @param[in] lp The linear program.
+     * @param[in] opt Solver options.
+     * @return The exact solution and pivot statistics.
+     */
+    template <typename T>
+    auto solve_simplex(const LinearProgram<T> &lp, const SimplexOptions &opt = SimplexOptions())
+        -> LpSolution<T> {
+        const detail::StandardForm<T> sf(lp);
+        LpSolution<T> sol{LpStatus::Optimal, Fraction<T>(), {}, 0, 0};
+        if (sf.overflow) {
+            sol.status = LpStatus::Overflow;
+            return sol;
+        }
+        std::vector<std::size_t> basis = sf.init_basis;
+        std::vector<Fraction<T>> x_b;
+
+        if (sf.has_artificials()) {
+            std::vector<Fraction<T>> phase1(sf.num_cols());
+            for (auto j = sf.first_art; j != sf.num_cols(); ++j) {
+                phase1[j] = Fraction<T>(T(1));
+            }
+            const auto status
+                = detail::two_level_phase(sf, phase1, sf.init_basis, false, opt, sol, basis, x_b);
+            if (status != LpStatus::Optimal) {
+                sol.status = status;
+                return sol;
+            }
+            for (std::size_t i = 0; i != sf.m; ++i) {
+                if (basis[i] >= sf.first_art && x_b[i].numer() != 0) {
+                    sol.status = LpStatus::Infeasible;
+                    return sol;
+                }
+            }
+        }
+
+        const auto start = basis;
+        sol.status = detail::two_level_phase(sf, sf.cost, start, true, opt, sol, basis, x_b);
+        if (sol.status != LpStatus::Optimal) {
+            return sol;
+        }
+        sol.x.assign(lp.num_vars, Fraction<T>());
+        for (std::size_t i = 0; i != sf.m; ++i) {
+            if (basis[i] < sf.n_struct) {
+                sol.x[basis[i]] = x_b[i];
+            }
+        }
+        bool ok = true;
+        for (std::size_t j = 0; j != lp.num_vars; ++j) {
+            sol.objective
+                = detail::exact_add(sol.objective, detail::exact_mul(lp.c[j], sol.x[j], ok), ok);
+        }
+        if (!ok) {
+            sol.status = LpStatus::Overflow;
+            sol.objective = Fraction<T>();
+            sol.x.clear();
+        }
+        return sol;
+    }
+}  // namespace fractions
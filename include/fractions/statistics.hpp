@@ -0,0 +1,342 @@
+#pragma once
+
+/** @file include/fractions/statistics.hpp
+ *  Exact streaming statistics and order statistics over fractions.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "fractions.hpp"
+#include "kernels.hpp"
+#include "widen.hpp"
+
+namespace fractions {
+
+    namespace detail {
+
+        /** r = n in W; false if n does not fit. */
+        template <typename W> auto wide_size(std::size_t n, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            r = static_cast<W>(n);
+            return r >= W(0) && static_cast<std::size_t>(r) == n;
+        }
+
+        template <typename W> auto wide_size(std::size_t n, W &r) ->
+            typename std::enable_if<!is_fixed_width<W>::value, bool>::type {
+            r = W(n);
+            return true;
+        }
+
+    }  // namespace detail
+
+    /**
+     * @brief Single-pass accumulator of count, sum and sum of squares with
+     * exact mean and variance.
+     *
+     * Both sums are kept unreduced over the lcm of the denominators seen
+     * (see fma() and dot()), so adding a value of an already seen
+     * denominator costs no gcd; values priced in a common unit such as cents
+     * never trigger one. They are sums of the deviations from the first
+     * observation, which keeps them small for data clustered away from zero
+     * (and zero for constant data). Accumulators of disjoint parts of the
+     * data can be merged, e.g. after filling one per thread (see
+     * accumulate_stats()).
+     *
+     * Example:
+     * ```
+     * RunningStats<int> s;
+     * s.add(Fraction<int>(1, 2));
+     * s.add(Fraction<int>(3, 2));
+     * s.mean() == Fraction<int>(1);
+     * s.variance() == Fraction<int>(1, 4);
+     * ```
+     *
+     * The values must be finite. All arithmetic on the sums is
+     * overflow-checked in `widened<T>`, and mean and variance are narrowed
+     * to T once at the end, so they are exact as long as the sums fit into
+     * `widened<T>` and the results themselves fit in T, even when T could
+     * not hold the sums (millions of prices in cents over 64-bit terms);
+     * results that cannot be computed are returned as 0/0.
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> class RunningStats {
+        using W = typename widened<T>::type;
+
+        std::size_t _count = 0;
+        Fraction<T> _shift;              ///< the first observation
+        detail::Accumulator<T> _sum;     ///< sum of x - _shift
+        detail::Accumulator<T> _sum_sq;  ///< sum of (x - _shift)^2
+
+      public:
+        /**
+         * Adds one observation.
+         *
+         * @param[in] x The value (finite).
+         */
+        void add(const Fraction<T> &x) {
+            if (this->_count++ == 0) {
+                this->_shift = x;
+            }
+            W n, d;
+            if (!difference(x, this->_shift, n, d)) {
+                this->_sum.fail();
+                this->_sum_sq.ok = false;
+                return;
+            }
+            add_scaled(this->_sum, W(1), n, d, W(1), W(1));
+            add_scaled(this->_sum_sq, W(1), n, d, n, d);
+        }
+
+        /**
+         * Adds all observations of another accumulator.
+         *
+         * @param[in] other The accumulator to merge.
+         */
+        void merge(const RunningStats &other) {
+            if (other._count == 0) {
+                return;
+            }
+            if (this->_count == 0) {
+                *this = other;
+                return;
+            }
+            // move the sums of other to this shift: with e = shift' - shift,
+            // sum(x - shift) = S' + n' e and sum((x - shift)^2) = Q' + 2 e S' + n' e^2
+            W n(0), d(1), count(0);
+            auto sum = other._sum;
+            auto sum_sq = other._sum_sq;
+            if (!other._sum.ok) {
+                sum_sq.ok = false;
+            } else if (!difference(other._shift, this->_shift, n, d)
+                       || !detail::wide_size(other._count, count)) {
+                sum.fail();
+                sum_sq.ok = false;
+            }
+            add_scaled(sum, count, n, d, W(1), W(1));
+            add_scaled(sum_sq, W(2), n, d, other._sum.numer, other._sum.denom);
+            add_scaled(sum_sq, count, n, d, n, d);
+            this->_count += other._count;
+            this->_sum.merge(sum);
+            this->_sum_sq.merge(sum_sq);
+        }
+
+        /** @return The number of observations. */
+        auto count() const noexcept -> std::size_t { return this->_count; }
+
+        /** @return The sum of the observations (0/0 if it does not fit in T). */
+        auto sum() const -> Fraction<T> { return this->total().result(); }
+
+        /** @return The sum of the squared observations (0/0 if it does not fit in T). */
+        auto sum_of_squares() const -> Fraction<T> {
+            // sum(x^2) = Q + 2 shift S + n shift^2
+            const auto &a = this->_shift;
+            auto res = this->_sum_sq;
+            W count(0);
+            if (!this->_sum.ok || !detail::wide_size(this->_count, count)) {
+                res.ok = false;
+            }
+            add_scaled(res, W(2), W(a.numer()), W(a.denom()), this->_sum.numer, this->_sum.denom);
+            add_scaled(res, count, W(a.numer()), W(a.denom()), W(a.numer()), W(a.denom()));
+            return res.result();
+        }
+
+        /** @return The arithmetic mean (0/0 if there are no observations). */
+        auto mean() const -> Fraction<T> {
+            const auto sum = this->total();
+            W count, denom;
+            if (!sum.ok || !detail::wide_size(this->_count, count)
+                || !detail::checked_mul(sum.denom, count, denom)) {
+                return Fraction<T>(T(0), T(0));
+            }
+            return detail::narrow<T>(sum.numer, denom);
+        }
+
+        /**
+         * @return The population variance sum((x - mean)^2) / n, computed as
+         * (n * sum_sq - sum^2) / n^2 (0/0 if there are no observations).
+         */
+        auto variance() const -> Fraction<T> { return this->central_moment(0); }
+
+        /**
+         * @return The sample variance sum((x - mean)^2) / (n - 1) (0/0 for
+         * fewer than two observations).
+         */
+        auto sample_variance() const -> Fraction<T> {
+            if (this->_count < 2) {
+                return Fraction<T>(T(0), T(0));
+            }
+            return this->central_moment(1);
+        }
+
+      private:
+        /** n / d = a - b in W, over the product of the reduced denominators. */
+        static auto difference(const Fraction<T> &a, const Fraction<T> &b, W &n, W &d) -> bool {
+            if (a.denom() == b.denom()) {
+                d = W(a.denom());
+                return detail::checked_sub(W(a.numer()), W(b.numer()), n);
+            }
+            const auto common = gcd(W(a.denom()), W(b.denom()));
+            W l, r;
+            return detail::checked_mul(W(a.numer()), W(W(b.denom()) / common), l)
+                   && detail::checked_mul(W(b.numer()), W(W(a.denom()) / common), r)
+                   && detail::checked_sub(l, r, n)
+                   && detail::checked_mul(W(W(a.denom()) / common), W(b.denom()), d);
+        }
+
+        /** Adds k * (an / ad) * (bn / bd) to acc (ad, bd > 0). */
+        static void add_scaled(detail::Accumulator<T> &acc, const W &k, const W &an, const W &ad,
+                               const W &bn, const W &bd) {
+            W n, d;
+            if (acc.ok && detail::checked_mul(k, an, n) && detail::checked_mul(n, bn, n)
+                && detail::checked_mul(ad, bd, d)) {
+                acc.add(n, d);
+            } else {
+                acc.fail();
+            }
+        }
+
+        /** @return The sum of the observations, S + n shift. */
+        auto total() const -> detail::Accumulator<T> {
+            const auto &a = this->_shift;
+            auto res = this->_sum;
+            W count(0);
+            if (!detail::wide_size(this->_count, count)) {
+                res.ok = false;
+            }
+            add_scaled(res, count, W(a.numer()), W(a.denom()), W(1), W(1));
+            return res;
+        }
+
+        /**
+         * (n * sum_sq - sum^2) / (n * (n - less)) from the raw sums: with
+         * sum = S / Ds and sum_sq = Q / Dq, over the common denominator
+         * lcm(Dq, Ds^2) (equal to Dq for values of one denominator). The
+         * numerator does not depend on the shift.
+         */
+        auto central_moment(std::size_t less) const -> Fraction<T> {
+            const auto &s = this->_sum;
+            const auto &q = this->_sum_sq;
+            W ds2, n_q, lhs, s2, rhs, numer, denom, count, rest;
+            if (!s.ok || !q.ok || !detail::wide_size(this->_count, count)
+                || !detail::wide_size(this->_count - less, rest)
+                || !detail::checked_mul(s.denom, s.denom, ds2)) {
+                return Fraction<T>(T(0), T(0));
+            }
+            const auto common = gcd(q.denom, ds2);
+            const auto scale_q = W(ds2 / common);
+            const auto scale_s = W(q.denom / common);
+            const bool ok = detail::checked_mul(count, q.numer, n_q)
+                            && detail::checked_mul(n_q, scale_q, lhs)
+                            && detail::checked_mul(s.numer, s.numer, s2)
+                            && detail::checked_mul(s2, scale_s, rhs)
+                            && detail::checked_sub(lhs, rhs, numer)
+                            && detail::checked_mul(q.denom, scale_q, denom)
+                            && detail::checked_mul(denom, count, denom)
+                            && detail::checked_mul(denom, rest, denom);
+            if (!ok) {
+                return Fraction<T>(T(0), T(0));
+            }
+            return detail::narrow<T>(numer, denom);
+        }
+    };
+
+    /**
+     * Accumulates the statistics of x[0..n), splitting long inputs into
+     * chunks that are accumulated on separate threads and then merged.
+     *
+     * @tparam T The integer type.
+     * @param[in] x The values.
+     * @param[in] n The number of values.
+     * @param[in] threads The maximal number of threads (0 uses all hardware threads).
+     * @return The merged accumulator.
+     */
+    template <typename T>
+    auto accumulate_stats(const Fraction<T> *x, std::size_t n, unsigned threads = 1)
+        -> RunningStats<T> {
+        return detail::parallel_accumulate<RunningStats<T>>(
+            n, threads, [x](std::size_t first, std::size_t last) {
+                RunningStats<T> part;
+                for (auto i = first; i != last; ++i) {
+                    part.add(x[i]);
+                }
+                return part;
+            });
+    }
+
+    /**
+     * @brief Exact strict weak order on fractions with positive denominators,
+     * by cross-multiplication in `widened<T>`.
+     *
+     * Unlike Fraction::operator<, neither operand is copied or reduced.
+     * Infinities (zero denominators) order outside all finite values, with
+     * -inf before +inf.
+     */
+    template <typename T> struct CrossLess {
+        auto operator()(const Fraction<T> &lhs, const Fraction<T> &rhs) const -> bool {
+            using W = typename widened<T>::type;
+            if (lhs.denom() == T(0) && rhs.denom() == T(0)) {
+                return lhs.numer() < T(0) && rhs.numer() > T(0);
+            }
+            return W(W(lhs.numer()) * W(rhs.denom())) < W(W(rhs.numer()) * W(lhs.denom()));
+        }
+    };
+
+    /**
+     * Rearranges [first, last) so that the element at position k is the
+     * k-th smallest (0-based) and returns it, comparing exactly with
+     * CrossLess.
+     *
+     * Example:
+     * ```
+     * std::vector<Fraction<int>> v{{1, 2}, {1, 3}, {2, 3}};
+     * order_statistic(v.begin(), v.end(), 0) == Fraction<int>(1, 3)
+     * ```
+     *
+     * @tparam RandomIt A random access iterator over Fraction<T>.
+     * @param[in] first The begin of the range.
+     * @param[in] last The end of the range.
+     * @param[in] k The rank (less than last - first).
+     * @return The k-th smallest element.
+     */
+    template <typename RandomIt>
+    auto order_statistic(RandomIt first, RandomIt last, std::size_t k) ->
+        typename std::iterator_traits<RandomIt>::value_type {
+        using F = typename std::iterator_traits<RandomIt>::value_type;
+        using T = typename std::decay<decltype(std::declval<F>().numer())>::type;
+        const auto nth = first + static_cast<std::ptrdiff_t>(k);
+        std::nth_element(first, nth, last, CrossLess<T>());
+        return *nth;
+    }
+
+    /**
+     * Computes the exact median of [first, last), averaging the two middle
+     * elements for an even count; the range is reordered.
+     *
+     * @tparam RandomIt A random access iterator over Fraction<T>.
+     * @param[in] first The begin of the range.
+     * @param[in] last The end of the range (non-empty range).
+     * @return The median.
+     */
+    template <typename RandomIt>
+    auto median(RandomIt first, RandomIt last) ->
+        typename std::iterator_traits<RandomIt>::value_type {
+        using F = typename std::iterator_traits<RandomIt>::value_type;
+        using T = typename std::decay<decltype(std::declval<F>().numer())>::type;
+        const auto n = static_cast<std::size_t>(last - first);
+        const auto upper = order_statistic(first, last, n / 2);
+        if (n % 2 == 1) {
+            return upper;
+        }
+        // after nth_element the lower middle is the largest of the left part
+        const auto mid = first + static_cast<std::ptrdiff_t>(n / 2);
+        const auto lower = *std::max_element(first, mid, CrossLess<T>());
+        return (lower + upper) / T(2);
+    }
+}  // namespace fractions
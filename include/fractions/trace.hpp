@@ -0,0 +1,336 @@
+#pragma once
+
+/** @file include/fractions/trace.hpp
+ *  Recording of Fraction operations to a compact binary log.
+ *
+ *  Tracing is compiled in only when FRACTIONS_TRACE is defined (CMake option
+ *  FRACTIONS_TRACE); otherwise the hooks in fractions.hpp expand to nothing
+ *  and this header is not even included. In a tracing build the operators
+ *  of Fraction record their operation and operand values while a log is
+ *  open, either explicitly through start() / stop() or for the whole run
+ *  by setting the environment variable FRACTIONS_TRACE_FILE. Only the
+ *  outermost operation is recorded: an operator implemented through other
+ *  operators or constructors appears once.
+ *
+ *  Log format: the 8-byte magic "FRTRACE1", then one record per operation:
+ *  a header byte (integer type code << 4 | Op) followed by the operand
+ *  values as LEB128 varints, zigzag-encoded for signed types. The type code
+ *  is log2(sizeof(T)) plus 8 for unsigned types. The arity of each Op is
+ *  fixed (see arity()).
+ *
+ *  The benchmark project's FractionsReplay tool re-executes such a log.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <initializer_list>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "widen.hpp"
+
+namespace fractions {
+
+    namespace trace {
+
+        /** The recorded operations. */
+        enum class Op : std::uint8_t {
+            Construct,  ///< Fraction(n, d)
+            Add,        ///< a + b
+            Sub,        ///< a - b
+            Mul,        ///< a * b
+            Div,        ///< a / b
+            AddAssign,  ///< a += b
+            SubAssign,  ///< a -= b
+            MulAssign,  ///< a *= b
+            DivAssign,  ///< a /= b
+            AddInt,     ///< a += n
+            SubInt,     ///< a -= n
+            MulInt,     ///< a *= n
+            DivInt,     ///< a /= n
+            Less,       ///< a < b
+            Equal,      ///< a == b
+        };
+
+        /** Number of distinct Op values. */
+        constexpr std::size_t op_count = 15;
+
+        /** @return The number of integer operands recorded for op. */
+        inline auto arity(Op op) -> std::size_t {
+            switch (op) {
+                case Op::Construct:
+                    return 2;
+                case Op::AddInt:
+                case Op::SubInt:
+                case Op::MulInt:
+                case Op::DivInt:
+                    return 3;
+                default:
+                    return 4;
+            }
+        }
+
+        /** @return The lower-case name of op, e.g. "add_assign". */
+        inline auto name(Op op) -> const char * {
+            static const char *const names[op_count]
+                = {"construct",  "add",        "sub",        "mul",     "div",
+                   "add_assign", "sub_assign", "mul_assign", "div_assign", "add_int",
+                   "sub_int",    "mul_int",    "div_int",    "less",    "equal"};
+            return names[static_cast<std::size_t>(op)];
+        }
+
+        /** An unsigned integer wide enough for every traced value. */
+#ifdef __SIZEOF_INT128__
+        using Word = fractions::detail::uint128_t;
+#else
+        using Word = std::uint64_t;
+#endif
+
+        /** A decoded log record; values are two's complement, sign-extended to Word. */
+        struct Record {
+            Op op;
+            std::uint8_t type;  ///< log2(sizeof(T)), plus 8 if T is unsigned
+            Word values[4];
+        };
+
+        namespace detail {
+
+            constexpr char magic[8] = {'F', 'R', 'T', 'R', 'A', 'C', 'E', '1'};
+            constexpr std::size_t flush_size = 1U << 16;
+
+            struct State {
+                std::mutex mutex;
+                std::FILE *file = nullptr;
+                std::vector<unsigned char> buffer;
+
+                ~State();
+            };
+
+            inline auto state() -> State & {
+                static State s;
+                return s;
+            }
+
+            /** Whether a log is open; constant-initialized, so testing it needs no guard. */
+            inline auto active_flag() -> std::atomic<bool> & {
+                static std::atomic<bool> flag{false};
+                return flag;
+            }
+
+            inline void flush(State &s) {
+                if (s.file != nullptr && !s.buffer.empty()) {
+                    std::fwrite(s.buffer.data(), 1, s.buffer.size(), s.file);
+                }
+                s.buffer.clear();
+            }
+
+            inline auto open(const char *path) -> bool {
+                auto &s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.file != nullptr) {
+                    flush(s);
+                    std::fclose(s.file);
+                }
+                s.file = std::fopen(path, "wb");
+                if (s.file == nullptr) {
+                    active_flag().store(false);
+                    return false;
+                }
+                std::fwrite(magic, 1, sizeof(magic), s.file);
+                active_flag().store(true);
+                return true;
+            }
+
+            inline void close(State &s) {
+                active_flag().store(false);
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.file != nullptr) {
+                    flush(s);
+                    std::fclose(s.file);
+                    s.file = nullptr;
+                }
+            }
+
+            inline State::~State() { close(*this); }
+
+            /** Opens the log named by FRACTIONS_TRACE_FILE during static initialization. */
+            template <typename = void> struct AutoStart {
+                static const bool started;
+            };
+
+            template <typename Tag> const bool AutoStart<Tag>::started = [] {
+                const char *path = std::getenv("FRACTIONS_TRACE_FILE");
+                return path != nullptr && open(path);
+            }();
+
+            /** Nesting depth of traced operations on this thread. */
+            inline auto depth() -> int & {
+                thread_local int d = 0;
+                return d;
+            }
+
+            template <typename T> constexpr auto log2_size(std::size_t n = sizeof(T)) -> int {
+                return n <= 1 ? 0 : 1 + log2_size<T>(n / 2);
+            }
+
+            template <typename T> constexpr auto type_code() -> std::uint8_t {
+                return static_cast<std::uint8_t>(log2_size<T>() + (T(-1) < T(0) ? 0 : 8));
+            }
+
+            /** Sign-extends v to a Word. */
+            template <typename T> auto to_word(const T &v) -> Word {
+                if (T(-1) < T(0) && v < T(0)) {
+                    return ~Word(0) - static_cast<Word>(~v);
+                }
+                return static_cast<Word>(v);
+            }
+
+            inline auto zigzag(Word v) -> Word {
+                const auto sign = v >> (8 * sizeof(Word) - 1);
+                return Word(v << 1) ^ Word(Word(0) - sign);
+            }
+
+            inline auto unzigzag(Word v) -> Word { return Word(v >> 1) ^ Word(Word(0) - (v & 1U)); }
+
+            inline void put_varint(std::vector<unsigned char> &out, Word v) {
+                while (v >= 0x80U) {
+                    out.push_back(static_cast<unsigned char>((v & 0x7FU) | 0x80U));
+                    v >>= 7;
+                }
+                out.push_back(static_cast<unsigned char>(v));
+            }
+
+            template <typename T>
+            auto record(Op op, std::initializer_list<T> values) ->
+                typename std::enable_if<std::is_integral<T>::value
+                                        && sizeof(T) <= sizeof(Word)>::type {
+                auto &s = state();
+                std::lock_guard<std::mutex> lock(s.mutex);
+                if (s.file == nullptr) {
+                    return;
+                }
+                constexpr auto code = type_code<T>();
+                s.buffer.push_back(static_cast<unsigned char>((code << 4) | std::uint8_t(op)));
+                for (const auto &v : values) {
+                    const auto w = to_word(v);
+                    put_varint(s.buffer, code < 8 ? zigzag(w) : w);
+                }
+                if (s.buffer.size() >= flush_size) {
+                    flush(s);
+                }
+            }
+
+            /** Values of types that do not fit a Word are not recorded. */
+            template <typename T>
+            auto record(Op, std::initializer_list<T>) ->
+                typename std::enable_if<!(std::is_integral<T>::value
+                                          && sizeof(T) <= sizeof(Word))>::type {}
+
+        }  // namespace detail
+
+        /**
+         * Starts recording to a new log file (replacing a running one).
+         *
+         * @param[in] path The file to write.
+         * @return false if the file cannot be opened.
+         */
+        inline auto start(const char *path) -> bool { return detail::open(path); }
+
+        /** Stops recording and closes the log. */
+        inline void stop() { detail::close(detail::state()); }
+
+        /** @return true while a log is being recorded. */
+        inline auto active() -> bool {
+            (void)detail::AutoStart<>::started;
+            return detail::active_flag().load(std::memory_order_relaxed);
+        }
+
+        /**
+         * @brief Records an operation unless it runs inside another recorded
+         * operation; placed at the top of each traced operator.
+         */
+        class Scope {
+            bool _on;
+
+          public:
+            template <typename T, typename... Ts>
+            Scope(Op op, const T &first, const Ts &...rest) : _on(active()) {
+                if (this->_on && detail::depth()++ == 0) {
+                    detail::record<T>(op, {first, rest...});
+                }
+            }
+
+            ~Scope() {
+                if (this->_on) {
+                    --detail::depth();
+                }
+            }
+
+            Scope(const Scope &) = delete;
+            auto operator=(const Scope &) -> Scope & = delete;
+        };
+
+        /**
+         * Reads a log written by a tracing build.
+         *
+         * @param[in] path The log file.
+         * @param[out] out The records, appended in log order.
+         * @return false if the file cannot be read or is not a valid log.
+         */
+        inline auto read(const char *path, std::vector<Record> &out) -> bool {
+            std::FILE *file = std::fopen(path, "rb");
+            if (file == nullptr) {
+                return false;
+            }
+            std::vector<unsigned char> data;
+            unsigned char chunk[1U << 16];
+            for (std::size_t got; (got = std::fread(chunk, 1, sizeof(chunk), file)) != 0;) {
+                data.insert(data.end(), chunk, chunk + got);
+            }
+            std::fclose(file);
+            if (data.size() < sizeof(detail::magic)
+                || !std::equal(data.begin(), data.begin() + sizeof(detail::magic),
+                               detail::magic)) {
+                return false;
+            }
+            std::size_t pos = sizeof(detail::magic);
+            while (pos < data.size()) {
+                Record rec;
+                const auto head = data[pos++];
+                if ((head & 0x0FU) >= op_count) {
+                    return false;
+                }
+                rec.op = static_cast<Op>(head & 0x0FU);
+                rec.type = static_cast<std::uint8_t>(head >> 4);
+                const auto n = arity(rec.op);
+                for (std::size_t i = 0; i != n; ++i) {
+                    Word v = 0;
+                    unsigned shift = 0;
+                    while (true) {
+                        if (pos == data.size() || shift >= 8 * sizeof(Word)) {
+                            return false;
+                        }
+                        const auto byte = data[pos++];
+                        v |= Word(byte & 0x7FU) << shift;
+                        shift += 7;
+                        if ((byte & 0x80U) == 0) {
+                            break;
+                        }
+                    }
+                    rec.values[i] = rec.type < 8 ? detail::unzigzag(v) : v;
+                }
+                for (auto i = n; i != 4; ++i) {
+                    rec.values[i] = 0;
+                }
+                out.push_back(rec);
+            }
+            return true;
+        }
+
+    }  // namespace trace
+}  // namespace fractions
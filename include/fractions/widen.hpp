@@ -0,0 +1,182 @@
+#pragma once
+
+/** @file include/fractions/widen.hpp
+ *  Double-width integer types for intermediate results.
+ */
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+namespace fractions {
+
+    namespace detail {
+
+        template <std::size_t Size, bool Signed> struct widen_by_size {};
+
+        template <> struct widen_by_size<1, true> {
+            using type = std::int16_t;
+        };
+        template <> struct widen_by_size<1, false> {
+            using type = std::uint16_t;
+        };
+        template <> struct widen_by_size<2, true> {
+            using type = std::int32_t;
+        };
+        template <> struct widen_by_size<2, false> {
+            using type = std::uint32_t;
+        };
+        template <> struct widen_by_size<4, true> {
+            using type = std::int64_t;
+        };
+        template <> struct widen_by_size<4, false> {
+            using type = std::uint64_t;
+        };
+#ifdef __SIZEOF_INT128__
+        __extension__ typedef __int128 int128_t;
+        __extension__ typedef unsigned __int128 uint128_t;
+
+        template <> struct widen_by_size<8, true> {
+            using type = int128_t;
+        };
+        template <> struct widen_by_size<8, false> {
+            using type = uint128_t;
+        };
+#endif
+
+        template <typename T, typename = void> struct widen_impl {
+            using type = T;
+        };
+
+        template <typename T> struct widen_impl<
+            T, typename std::enable_if<
+                   std::is_integral<T>::value
+                   && sizeof(typename widen_by_size<sizeof(T), (T(-1) < T(0))>::type) != 0>::type> {
+            using type = typename widen_by_size<sizeof(T), (T(-1) < T(0))>::type;
+        };
+
+    }  // namespace detail
+
+    /**
+     * @brief The integer type twice as wide as T, used for products of two
+     * T values and sums of such products.
+     *
+     * Built-in integers of 8, 16 and 32 bits map to the next standard
+     * width and 64-bit integers to `__int128` where the compiler provides
+     * it. Every other type (64-bit integers without `__int128`, 128-bit
+     * integers, user-defined big integers) maps to itself, so algorithms
+     * written against `widened<T>` still work, only without the extra
+     * headroom.
+     *
+     * Example:
+     * ```
+     * static_assert(std::is_same<widened<std::int32_t>::type, std::int64_t>::value, "");
+     * ```
+     *
+     * @tparam T The integer type.
+     */
+    template <typename T> struct widened {
+        using type = typename detail::widen_impl<T>::type;
+    };
+
+    namespace detail {
+
+        /** True for the built-in integers (including __int128), whose arithmetic can overflow. */
+        template <typename W> struct is_fixed_width : std::is_integral<W> {};
+#ifdef __SIZEOF_INT128__
+        template <> struct is_fixed_width<int128_t> : std::true_type {};
+        template <> struct is_fixed_width<uint128_t> : std::true_type {};
+#endif
+
+        /** @name Overflow-checked arithmetic
+         *  r = a op b; false if the result does not fit in W. Types that are
+         *  not built-in integers (big integers) never overflow.
+         */
+        ///@{
+#if defined(__GNUC__) || defined(__clang__)
+        template <typename W>
+        auto checked_add(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            return !__builtin_add_overflow(a, b, &r);
+        }
+
+        template <typename W>
+        auto checked_sub(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            return !__builtin_sub_overflow(a, b, &r);
+        }
+
+        template <typename W>
+        auto checked_mul(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            return !__builtin_mul_overflow(a, b, &r);
+        }
+#else
+        template <typename W>
+        auto checked_add(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            using L = std::numeric_limits<W>;
+            if ((b > W(0) && a > W(L::max() - b)) || (b < W(0) && a < W(L::min() - b))) {
+                return false;
+            }
+            r = W(a + b);
+            return true;
+        }
+
+        template <typename W>
+        auto checked_sub(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            using L = std::numeric_limits<W>;
+            if ((b < W(0) && a > W(L::max() + b)) || (b > W(0) && a < W(L::min() + b))) {
+                return false;
+            }
+            r = W(a - b);
+            return true;
+        }
+
+        template <typename W>
+        auto checked_mul(const W &a, const W &b, W &r) ->
+            typename std::enable_if<is_fixed_width<W>::value, bool>::type {
+            using L = std::numeric_limits<W>;
+            if (a != W(0) && b != W(0)) {
+                const bool over
+                    = a > W(0) ? (b > W(0) ? a > W(L::max() / b) : b < W(L::min() / a))
+                               : (b > W(0) ? a < W(L::min() / b) : b < W(L::max() / a));
+                if (over) {
+                    return false;
+                }
+            }
+            r = W(a * b);
+            return true;
+        }
+#endif
+
+        template <typename W>
+        auto checked_add(const W &a, const W &b, W &r) ->
+            typename std::enable_if<!is_fixed_width<W>::value, bool>::type {
+            r = a + b;
+            return true;
+        }
+
+        template <typename W>
+        auto checked_sub(const W &a, const W &b, W &r) ->
+            typename std::enable_if<!is_fixed_width<W>::value, bool>::type {
+            r = a - b;
+            return true;
+        }
+
+        template <typename W>
+        auto checked_mul(const W &a, const W &b, W &r) ->
+            typename std::enable_if<!is_fixed_width<W>::value, bool>::type {
+            r = a * b;
+            return true;
+        }
+        ///@}
+
+        /** @return true if w survives the conversion to T unchanged. */
+        template <typename T, typename W> auto fits(const W &w) -> bool {
+            return W(static_cast<T>(w)) == w;
+        }
+
+    }  // namespace detail
+}  // namespace fractions
@@ -0,0 +1,171 @@
+// The `fractions` C++20 module: every public name of the library, for `import fractions;` instead
+// of including the headers. The headers are compiled once in the global module fragment and their
+// public names exported below; the operators of Fraction, BigInt and the other classes are hidden
+// friends, found by argument-dependent lookup. Build it with the FRACTIONS_MODULE CMake option
+// (CMake 3.28 and a compiler that supports modules) or the fractions_module xmake target.
+//
+// Not exported: the detail namespaces, and counters.hpp and trace.hpp, which only record
+// anything when FRACTIONS_COUNTERS or FRACTIONS_TRACE is defined before the headers; a macro
+// defined by the importer cannot reach the module, so include those headers instead.
+module;
+
+#include <fractions/approximation.hpp>
+#include <fractions/arrow.hpp>
+#include <fractions/batch.hpp>
+#include <fractions/bigint.hpp>
+#include <fractions/bytecode.hpp>
+#include <fractions/codec.hpp>
+#include <fractions/column_file.hpp>
+#include <fractions/counting_int.hpp>
+#include <fractions/dispatch.hpp>
+#include <fractions/expression.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/interval.hpp>
+#include <fractions/kernels.hpp>
+#include <fractions/polynomial.hpp>
+#include <fractions/predicates.hpp>
+#include <fractions/roots.hpp>
+#include <fractions/scan.hpp>
+#include <fractions/selection.hpp>
+#include <fractions/simplex.hpp>
+#include <fractions/statistics.hpp>
+#include <fractions/widen.hpp>
+
+export module fractions;
+
+// arrow.hpp: the C data interface structs live in the global namespace
+export {
+    using ::ArrowArray;
+    using ::ArrowSchema;
+}
+
+export namespace fractions {
+    // fractions.hpp
+    using fractions::abs;
+    using fractions::Fraction;
+    using fractions::gcd;
+    using fractions::gcd_recur;
+    using fractions::lcm;
+    using fractions::to_double;
+
+    // widen.hpp
+    using fractions::widened;
+
+    // kernels.hpp
+    using fractions::dot;
+    using fractions::fma;
+
+    // statistics.hpp
+    using fractions::accumulate_stats;
+    using fractions::CrossLess;
+    using fractions::median;
+    using fractions::order_statistic;
+    using fractions::RunningStats;
+
+    // batch.hpp
+    using fractions::add_all;
+    using fractions::normalize_all;
+    using fractions::sort_all;
+    using fractions::sum_all;
+
+    // scan.hpp
+    using fractions::argmax;
+    using fractions::argmin;
+    using fractions::compare_mask;
+    using fractions::CompareOp;
+    using fractions::max_value;
+    using fractions::min_value;
+
+    // selection.hpp
+    using fractions::nth_element;
+    using fractions::partial_sort;
+
+    // approximation.hpp
+    using fractions::approx_above;
+    using fractions::approx_below;
+    using fractions::limit_denominator;
+    using fractions::simplest_between;
+
+    // arrow.hpp
+    using fractions::ArrowColumns;
+    using fractions::export_columns;
+    using fractions::export_fractions;
+
+    // bigint.hpp
+    using fractions::BigInt;
+
+    // bytecode.hpp
+    using fractions::compile;
+    using fractions::Instruction;
+    using fractions::OpCode;
+    using fractions::Program;
+
+    // codec.hpp
+    using fractions::decode;
+    using fractions::encode;
+    using fractions::FractionDecoder;
+    using fractions::FractionEncoder;
+
+    // column_file.hpp
+    using fractions::ColumnBlock;
+    using fractions::ColumnFile;
+    using fractions::ColumnWriter;
+
+    // counting_int.hpp
+    using fractions::CountingInt;
+    using fractions::op_counts;
+    using fractions::OpCounts;
+    using fractions::reset_op_counts;
+
+    // expression.hpp
+    using fractions::BinaryExpr;
+    using fractions::Expr;
+    using fractions::lazy;
+    using fractions::LeafExpr;
+    using fractions::NegExpr;
+    using fractions::operator+;
+    using fractions::operator-;
+    using fractions::operator*;
+    using fractions::operator/;
+
+    // interval.hpp
+    using fractions::RationalInterval;
+
+    // polynomial.hpp
+    using fractions::RationalPolynomial;
+
+    // predicates.hpp
+    using fractions::incircle;
+    using fractions::orient2d;
+    using fractions::orient3d;
+    using fractions::Point2;
+    using fractions::Point3;
+
+    // roots.hpp
+    using fractions::RealRoots;
+    using fractions::RootInterval;
+    using fractions::square_free_part;
+
+    // simplex.hpp
+    using fractions::ConstraintSense;
+    using fractions::LinearProgram;
+    using fractions::LpSolution;
+    using fractions::LpStatus;
+    using fractions::SimplexOptions;
+    using fractions::solve_simplex;
+}  // namespace fractions
+
+// dispatch.hpp
+export namespace fractions::dispatch {
+    using fractions::dispatch::active;
+    using fractions::dispatch::compare_mask;
+    using fractions::dispatch::detected;
+    using fractions::dispatch::force;
+    using fractions::dispatch::from_name;
+    using fractions::dispatch::Isa;
+    using fractions::dispatch::name;
+    using fractions::dispatch::normalize_all;
+    using fractions::dispatch::parse;
+    using fractions::dispatch::reset;
+    using fractions::dispatch::to_double;
+}  // namespace fractions::dispatch
@@ -0,0 +1,22 @@
+// Explicit instantiations of Fraction<T> and the kernels for the types of
+// FRACTIONS_FOR_INSTANTIATED_TYPES (see fractions.hpp). Built only with the
+// FRACTIONS_EXPLICIT_INSTANTIATION option, which also makes every user of
+// the library see them as extern templates.
+#ifdef FRACTIONS_EXTERN_TEMPLATES
+
+#    include <cstddef>
+#    include <cstdint>
+#    include <fractions/batch.hpp>
+#    include <fractions/fractions.hpp>
+#    include <fractions/kernels.hpp>
+#    include <fractions/scan.hpp>
+#    include <fractions/widen.hpp>
+
+namespace fractions {
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_FRACTION_TEMPLATES, template)
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_KERNEL_TEMPLATES, template)
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_SCAN_TEMPLATES, template)
+    FRACTIONS_FOR_INSTANTIATED_TYPES(FRACTIONS_BATCH_TEMPLATES, template)
+}  // namespace fractions
+
+#endif
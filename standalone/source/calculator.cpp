@@ -0,0 +1,575 @@
+#include "calculator.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <fractions/bytecode.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/widen.hpp>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <string_view>
+#include <thread>
+#include <utility>
+
+#include "pipeline.hpp"
+
+namespace calculator {
+
+    namespace {
+        using F = fractions::Fraction<std::int64_t>;
+        using W = fractions::widened<std::int64_t>::type;
+        using FW = fractions::Fraction<W>;
+        using clock = std::chrono::steady_clock;
+
+        /** Terms are kept in (-max_term, max_term], so negation never overflows. */
+        constexpr std::int64_t max_term = std::numeric_limits<std::int64_t>::max();
+
+        /** Operands below this bound cannot overflow one 64-bit operation. */
+        constexpr std::int64_t small_term = std::int64_t(1) << 31;
+
+        using Code = fractions::Program<std::int64_t>;
+
+        auto is_digit(char c) -> bool { return c >= '0' && c <= '9'; }
+
+        /**
+         * Reads digits with an optional fractional part ("12", "1.25", "3.")
+         * starting at pos into an exact fraction. The magnitude must be at
+         * most max_term, so "-9223372036854775808" is out of range.
+         */
+        auto read_decimal(std::string_view text, std::size_t &pos, F &value) -> bool {
+            std::uint64_t numer = 0;
+            std::int64_t denom = 1;
+            bool point = false;
+            const auto begin = pos;
+            for (; pos < text.size(); ++pos) {
+                const auto c = text[pos];
+                if (c == '.' && !point) {
+                    point = true;
+                    continue;
+                }
+                if (!is_digit(c)) {
+                    break;
+                }
+                const auto digit = static_cast<std::uint64_t>(c - '0');
+                if (numer > (std::uint64_t(max_term) - digit) / 10
+                    || (point && denom > max_term / 10)) {
+                    return false;
+                }
+                numer = numer * 10 + digit;
+                if (point) {
+                    denom *= 10;
+                }
+            }
+            if (pos == begin || (point && pos == begin + 1)) {
+                return false;
+            }
+            value = F(static_cast<std::int64_t>(numer), denom);
+            return true;
+        }
+
+        auto trim(std::string_view s) -> std::string_view {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t' || s.front() == '"')) {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t' || s.back() == '"')) {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+
+        auto is_small(const F &x) -> bool {
+            return x._numer > -small_term && x._numer < small_term && x._denom < small_term;
+        }
+
+        /**
+         * Applies op to x and y, in 64 bits when both are small and in 128
+         * bits otherwise; fails if the result does not fit 64 bits.
+         */
+        template <typename Op> auto checked(const F &x, const F &y, Op op, F &out) -> bool {
+            if (is_small(x) && is_small(y)) {
+                out = op(x, y);
+                return true;
+            }
+            FW a, b;
+            a._numer = x._numer;
+            a._denom = x._denom;
+            b._numer = y._numer;
+            b._denom = y._denom;
+            const auto r = op(a, b);
+            if (r._numer < -W(max_term) || r._numer > W(max_term) || r._denom > W(max_term)) {
+                return false;
+            }
+            out._numer = static_cast<std::int64_t>(r._numer);
+            out._denom = static_cast<std::int64_t>(r._denom);
+            return true;
+        }
+
+        /** Parses one csv cell: an optional sign, a decimal and an optional "/denominator". */
+        auto parse_cell(std::string_view cell, F &value) -> bool {
+            cell = trim(cell);
+            std::size_t pos = 0;
+            const bool negative = !cell.empty() && cell[0] == '-';
+            if (!cell.empty() && (cell[0] == '-' || cell[0] == '+')) {
+                ++pos;
+            }
+            if (!read_decimal(cell, pos, value)) {
+                return false;
+            }
+            if (pos < cell.size() && cell[pos] == '/') {
+                ++pos;
+                const auto start = pos;
+                std::int64_t denom = 0;
+                const auto r = std::from_chars(cell.data() + pos, cell.data() + cell.size(), denom);
+                if (r.ec != std::errc() || cell[start] == '-' || cell[start] == '+') {
+                    return false;
+                }
+                pos = static_cast<std::size_t>(r.ptr - cell.data());
+                if (!checked(
+                        value, F(denom), [](const auto &a, const auto &b) { return a / b; },
+                        value)) {
+                    return false;
+                }
+            }
+            if (negative) {
+                value = -value;
+            }
+            return pos == cell.size();
+        }
+
+        /** @return The bits of the larger term of x. */
+        auto bits(const F &x) -> int {
+            const auto magnitude = [](std::int64_t v) {
+                return v < 0 ? 0 - static_cast<std::uint64_t>(v) : static_cast<std::uint64_t>(v);
+            };
+            const auto m = magnitude(x._numer) | magnitude(x._denom);
+            return m == 0 ? 0 : 64 - __builtin_clzll(m);
+        }
+
+        /**
+         * True if no term of the code can exceed 63 bits while the inputs have
+         * at most `input` bits: the terms of a sum have at most one bit more
+         * than the two operands together, those of a product or quotient none.
+         */
+        auto bounded(const Code &code, int input) -> bool {
+            std::vector<int> size(code.registers(), input);
+            for (std::size_t i = 0; i != code.constants().size(); ++i) {
+                size[code.inputs() + i] = bits(code.constants()[i]);
+            }
+            for (const auto &ins : code.code()) {
+                const auto both = size[ins.a] + size[ins.b];
+                switch (ins.op) {
+                    case fractions::OpCode::Neg:
+                        size[ins.dst] = size[ins.a];
+                        break;
+                    case fractions::OpCode::Add:
+                    case fractions::OpCode::Sub:
+                        size[ins.dst] = both + 1;
+                        break;
+                    default:
+                        size[ins.dst] = both;
+                        break;
+                }
+                if (size[ins.dst] > 63) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** Sizes regs to the registers of code and loads its constants. */
+        void load(const Code &code, std::vector<F> &regs) {
+            regs.resize(code.registers());
+            std::copy(code.constants().begin(), code.constants().end(),
+                      regs.begin() + std::ptrdiff_t(code.inputs()));
+        }
+
+        /**
+         * Runs code on one row like Program::run(), but applies every
+         * instruction with checked() and fails on the first overflow.
+         *
+         * @param[in,out] regs A register file prepared by load().
+         */
+        auto evaluate(const Code &code, const F *args, std::vector<F> &regs, F &result,
+                      std::string &error) -> bool {
+            std::copy(args, args + code.inputs(), regs.begin());
+            for (const auto &ins : code.code()) {
+                const auto &x = regs[ins.a];
+                const auto &y = regs[ins.b];
+                auto &dst = regs[ins.dst];
+                bool ok = false;
+                switch (ins.op) {
+                    case fractions::OpCode::Neg:
+                        ok = checked(x, x, [](const auto &a, const auto &) { return -a; }, dst);
+                        break;
+                    case fractions::OpCode::Add:
+                        ok = checked(x, y, [](const auto &a, const auto &b) { return a + b; }, dst);
+                        break;
+                    case fractions::OpCode::Sub:
+                        ok = checked(x, y, [](const auto &a, const auto &b) { return a - b; }, dst);
+                        break;
+                    case fractions::OpCode::Mul:
+                        ok = checked(x, y, [](const auto &a, const auto &b) { return a * b; }, dst);
+                        break;
+                    case fractions::OpCode::Div:
+                        ok = checked(x, y, [](const auto &a, const auto &b) { return a / b; }, dst);
+                        break;
+                }
+                if (!ok) {
+                    error = "overflow";
+                    return false;
+                }
+            }
+            result = regs[code.result()];
+            return true;
+        }
+
+        /** The csv formula: its code and the cell each of its inputs reads. */
+        struct Formula {
+            Code code;
+            std::vector<std::size_t> cells;
+        };
+
+        /** Compiles the csv formula with one input `$k` per column it refers to. */
+        auto compile_formula(const std::string &text, Formula &formula, std::string &error)
+            -> bool {
+            std::vector<std::size_t> cells;
+            for (std::size_t pos = 0; pos < text.size(); ++pos) {
+                if (text[pos] != '$') {
+                    continue;
+                }
+                std::size_t k = 0;
+                for (; pos + 1 < text.size() && is_digit(text[pos + 1]) && k < 1000000; ++pos) {
+                    k = k * 10 + std::size_t(text[pos + 1] - '0');
+                }
+                if (k != 0) {
+                    cells.push_back(k - 1);
+                }
+            }
+            std::sort(cells.begin(), cells.end());
+            cells.erase(std::unique(cells.begin(), cells.end()), cells.end());
+            std::vector<std::string> names;
+            for (const auto cell : cells) {
+                names.push_back("$" + std::to_string(cell + 1));
+            }
+            formula.cells = std::move(cells);
+            return fractions::compile(text, names, formula.code, &error);
+        }
+
+        void append(std::string &out, std::int64_t v) {
+            char buf[24];
+            const auto r = std::to_chars(buf, buf + sizeof(buf), v);
+            out.append(buf, r.ptr);
+        }
+
+        void format(std::string &out, const F &x) {
+            if (x._denom == 0) {
+                out += x._numer > 0 ? "inf" : x._numer < 0 ? "-inf" : "nan";
+                return;
+            }
+            append(out, x._numer);
+            if (x._denom != 1) {
+                out += '/';
+                append(out, x._denom);
+            }
+        }
+
+        struct Batch {
+            std::size_t seq = 0;
+            clock::time_point start;
+            std::vector<std::string> lines;
+            std::vector<Code> code;                   // expr: per line
+            std::vector<std::vector<F>> cells;        // csv: per line
+            std::vector<F> results;
+            std::vector<std::string> errors;          // non-empty: the line failed
+            std::string text;
+            std::size_t failed = 0;
+        };
+
+        using Queue = pipeline::BoundedQueue<std::unique_ptr<Batch>>;
+
+        void parse_batch(Batch &b, const Options &options) {
+            const auto n = b.lines.size();
+            b.errors.assign(n, std::string());
+            if (options.format == "csv") {
+                b.cells.resize(n);
+                for (std::size_t i = 0; i != n; ++i) {
+                    auto &row = b.cells[i];
+                    row.clear();
+                    std::string_view rest(b.lines[i]);
+                    if (rest.empty()) {
+                        continue;
+                    }
+                    for (;;) {
+                        const auto cut = rest.find(options.delimiter);
+                        F value;
+                        if (!parse_cell(rest.substr(0, cut), value)) {
+                            b.errors[i] = "invalid cell " + std::to_string(row.size() + 1);
+                            break;
+                        }
+                        row.push_back(value);
+                        if (cut == std::string_view::npos) {
+                            break;
+                        }
+                        rest.remove_prefix(cut + 1);
+                    }
+                }
+            } else {
+                b.code.resize(n);
+                for (std::size_t i = 0; i != n; ++i) {
+                    if (!b.lines[i].empty()) {
+                        fractions::compile(b.lines[i], {}, b.code[i], &b.errors[i]);
+                    }
+                }
+            }
+        }
+
+        /**
+         * Evaluates the formula on the rows of a csv batch: column by column
+         * with Program::evaluate() if the terms of the rows are small enough
+         * that no term can overflow, and row by row with overflow checks
+         * otherwise.
+         */
+        void compute_rows(Batch &b, const Formula &formula) {
+            const auto n = b.lines.size();
+            const auto width = formula.cells.empty() ? 0 : formula.cells.back() + 1;
+            int input = 0;
+            for (std::size_t i = 0; i != n; ++i) {
+                if (b.lines[i].empty() || !b.errors[i].empty()) {
+                    continue;
+                }
+                if (b.cells[i].size() < width) {
+                    b.errors[i] = "no column $" + std::to_string(width) + " in a row of "
+                                  + std::to_string(b.cells[i].size());
+                    continue;
+                }
+                for (const auto cell : formula.cells) {
+                    input = std::max(input, bits(b.cells[i][cell]));
+                }
+            }
+
+            const auto inputs = formula.cells.size();
+            if (bounded(formula.code, input)) {
+                std::vector<F> columns(inputs * n);
+                std::vector<const F *> pointers(inputs);
+                for (std::size_t k = 0; k != inputs; ++k) {
+                    pointers[k] = columns.data() + k * n;
+                }
+                for (std::size_t i = 0; i != n; ++i) {
+                    if (b.errors[i].empty() && !b.lines[i].empty()) {
+                        for (std::size_t k = 0; k != inputs; ++k) {
+                            columns[k * n + i] = b.cells[i][formula.cells[k]];
+                        }
+                    }
+                }
+                formula.code.evaluate(pointers.data(), n, b.results.data());
+                return;
+            }
+
+            std::vector<F> args(inputs), regs;
+            load(formula.code, regs);
+            for (std::size_t i = 0; i != n; ++i) {
+                if (b.lines[i].empty() || !b.errors[i].empty()) {
+                    continue;
+                }
+                for (std::size_t k = 0; k != inputs; ++k) {
+                    args[k] = b.cells[i][formula.cells[k]];
+                }
+                evaluate(formula.code, args.data(), regs, b.results[i], b.errors[i]);
+            }
+        }
+
+        void compute_batch(Batch &b, const Options &options, const Formula &formula) {
+            const auto n = b.lines.size();
+            b.results.resize(n);
+            if (options.format == "csv") {
+                compute_rows(b, formula);
+                return;
+            }
+            std::vector<F> regs;
+            for (std::size_t i = 0; i != n; ++i) {
+                if (b.lines[i].empty() || !b.errors[i].empty()) {
+                    continue;
+                }
+                load(b.code[i], regs);
+                evaluate(b.code[i], nullptr, regs, b.results[i], b.errors[i]);
+            }
+        }
+
+        void format_batch(Batch &b) {
+            b.text.clear();
+            for (std::size_t i = 0; i != b.lines.size(); ++i) {
+                if (!b.errors[i].empty()) {
+                    b.text += "error: ";
+                    b.text += b.errors[i];
+                    ++b.failed;
+                } else if (!b.lines[i].empty()) {
+                    format(b.text, b.results[i]);
+                }
+                b.text += '\n';
+            }
+        }
+
+        /** Reads all inputs into batches; returns false if an input could not be opened. */
+        auto read_all(const Options &options, Queue &out, std::ostream &log) -> bool {
+            auto inputs = options.inputs;
+            if (inputs.empty()) {
+                inputs.push_back("-");
+            }
+            std::size_t seq = 0;
+            auto batch = std::make_unique<Batch>();
+            for (const auto &name : inputs) {
+                std::ifstream file;
+                if (name != "-") {
+                    file.open(name);
+                    if (!file) {
+                        log << "cannot read " << name << std::endl;
+                        return false;
+                    }
+                }
+                auto &in = name == "-" ? std::cin : file;
+                std::string line;
+                bool first = true;
+                while (std::getline(in, line)) {
+                    if (first && options.header && options.format == "csv") {
+                        first = false;
+                        continue;
+                    }
+                    first = false;
+                    if (!line.empty() && line.back() == '\r') {
+                        line.pop_back();
+                    }
+                    if (batch->lines.empty()) {
+                        batch->start = clock::now();
+                    }
+                    batch->lines.push_back(std::move(line));
+                    if (batch->lines.size() == options.batch) {
+                        batch->seq = seq++;
+                        if (!out.push(std::move(batch))) {
+                            return true;
+                        }
+                        batch = std::make_unique<Batch>();
+                        batch->lines.reserve(options.batch);
+                    }
+                }
+            }
+            if (!batch->lines.empty()) {
+                batch->seq = seq;
+                out.push(std::move(batch));
+            }
+            return true;
+        }
+
+        /** @return The value below which the fraction q of the rows' latencies lie. */
+        auto percentile(const std::vector<std::pair<double, std::size_t>> &sorted,
+                        std::size_t rows, double q) -> double {
+            const auto target = static_cast<std::size_t>(q * double(rows));
+            std::size_t seen = 0;
+            for (const auto &entry : sorted) {
+                seen += entry.second;
+                if (seen > target) {
+                    return entry.first;
+                }
+            }
+            return sorted.empty() ? 0.0 : sorted.back().first;
+        }
+    }  // namespace
+
+    auto run(const Options &options, std::ostream &log) -> int {
+        Formula formula;
+        if (options.format == "csv") {
+            std::string error;
+            if (options.expr.empty()) {
+                log << "csv input needs a formula, e.g. --expr '$1 + $2'" << std::endl;
+                return 1;
+            }
+            if (!compile_formula(options.expr, formula, error)) {
+                log << "invalid formula: " << error << std::endl;
+                return 1;
+            }
+        } else if (options.format != "expr") {
+            log << "unknown format: " << options.format << std::endl;
+            return 1;
+        }
+
+        std::ofstream file;
+        if (!options.output.empty() && options.output != "-") {
+            file.open(options.output, std::ios::binary);
+            if (!file) {
+                log << "cannot write " << options.output << std::endl;
+                return 1;
+            }
+        }
+        auto &out = file.is_open() ? static_cast<std::ostream &>(file) : std::cout;
+        std::ios::sync_with_stdio(false);
+
+        const auto workers = options.jobs != 0
+                                 ? options.jobs
+                                 : std::max(1U, std::thread::hardware_concurrency() / 3);
+        Queue to_parse(options.queue), to_compute(options.queue), to_format(options.queue),
+            to_write(options.queue);
+        std::vector<std::thread> pool;
+        pipeline::start_stage(workers, to_parse, to_compute,
+                              [&options](Batch &b) { parse_batch(b, options); }, pool);
+        pipeline::start_stage(
+            workers, to_compute, to_format,
+            [&options, &formula](Batch &b) { compute_batch(b, options, formula); }, pool);
+        pipeline::start_stage(workers, to_format, to_write, [](Batch &b) { format_batch(b); },
+                              pool);
+
+        bool readable = true;
+        const auto start = clock::now();
+        std::thread reader([&]() {
+            readable = read_all(options, to_parse, log);
+            to_parse.close();
+        });
+
+        // write in input order, holding back batches that overtook an earlier one
+        std::map<std::size_t, std::unique_ptr<Batch>> pending;
+        std::vector<std::pair<double, std::size_t>> latencies;
+        std::size_t next = 0, rows = 0, failed = 0;
+        std::unique_ptr<Batch> batch;
+        while (to_write.pop(batch)) {
+            const auto seq = batch->seq;
+            pending.emplace(seq, std::move(batch));
+            for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+                auto &b = *it->second;
+                out.write(b.text.data(), static_cast<std::streamsize>(b.text.size()));
+                const auto latency
+                    = std::chrono::duration<double>(clock::now() - b.start).count();
+                latencies.emplace_back(latency, b.lines.size());
+                rows += b.lines.size();
+                failed += b.failed;
+                pending.erase(it);
+                ++next;
+            }
+        }
+        out.flush();
+        reader.join();
+        for (auto &th : pool) {
+            th.join();
+        }
+        const auto seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+        if (options.stats) {
+            std::sort(latencies.begin(), latencies.end());
+            log << "rows:        " << rows << " (" << failed << " failed)\n"
+                << "time:        " << std::fixed << std::setprecision(3) << seconds << " s\n"
+                << "throughput:  " << std::setprecision(0) << double(rows) / seconds
+                << " rows/s\n"
+                << "latency ms:  " << std::setprecision(3)
+                << "p50 " << 1e3 * percentile(latencies, rows, 0.50) << ", p90 "
+                << 1e3 * percentile(latencies, rows, 0.90) << ", p99 "
+                << 1e3 * percentile(latencies, rows, 0.99) << ", max "
+                << 1e3 * (latencies.empty() ? 0.0 : latencies.back().first) << '\n'
+                << "workers:     " << workers << " per stage" << std::endl;
+        }
+        return readable && failed == 0 && out ? 0 : 1;
+    }
+
+}  // namespace calculator
@@ -0,0 +1,47 @@
+#pragma once
+
+/** @file standalone/source/calculator.hpp
+ *  A line-oriented batch calculator over `Fraction<std::int64_t>`.
+ */
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace calculator {
+
+    struct Options {
+        std::vector<std::string> inputs;  ///< files to read in order; empty or "-": stdin
+        std::string output;               ///< result file; empty or "-": stdout
+        std::string format;               ///< "expr" (one expression per line) or "csv"
+        std::string expr;                 ///< csv: formula over the columns $1, $2, ...
+        char delimiter;                   ///< csv: column separator
+        bool header;                      ///< csv: skip the first line of every input
+        unsigned jobs;                    ///< workers per stage (0: hardware threads / 3)
+        std::size_t batch;                ///< lines per batch
+        std::size_t queue;                ///< batches each queue holds
+        bool stats;                       ///< report throughput and latency on the log stream
+    };
+
+    /**
+     * Evaluates every input line and writes one result line per input line,
+     * in input order: `n/d`, `n` for integers, `inf`, `-inf` or `nan` for
+     * zero denominators, `error: ...` for lines that fail to parse or whose
+     * terms overflow 64 bits, and an empty line for an empty line.
+     *
+     * Expressions use integers, decimals (`1.25`), `+ - * /`, unary minus
+     * and parentheses; in csv mode the cells are fractions (`-3/4`, `0.5`)
+     * and `$k` refers to the k-th cell of the row. Terms, of inputs and of
+     * results, are limited to +-(2^63 - 1), so that negation never
+     * overflows: -2^63 is rejected as an input and reported as an overflow
+     * as a result.
+     *
+     * Reading, parsing, computing, formatting and writing run concurrently,
+     * connected by bounded queues of batches of lines.
+     *
+     * @return 0 on success, 1 if an input could not be read or a line failed.
+     */
+    auto run(const Options &options, std::ostream &log) -> int;
+
+}  // namespace calculator
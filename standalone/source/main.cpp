@@ -1,33 +1,56 @@
 #include <fractions/version.h>
-// #include <greeter/greeter.h>
 
 #include <cxxopts.hpp>
 #include <iostream>
 #include <string>
-// #include <unordered_map>
+#include <thread>
+#include <vector>
 
-auto main(int argc, char** argv) -> int {
-    // const std::unordered_map<std::string, fractions::LanguageCode> languages{
-    //     {"en", fractions::LanguageCode::EN},
-    //     {"de", fractions::LanguageCode::DE},
-    //     {"es", fractions::LanguageCode::ES},
-    //     {"fr", fractions::LanguageCode::FR},
-    // };
+#include "calculator.hpp"
+#include "scaling.hpp"
 
-    cxxopts::Options options(*argv, "A program to welcome the world!");
+auto main(int argc, char** argv) -> int {
+    cxxopts::Options options(*argv, "Exact rational batch calculator");
 
-    std::string language;
-    std::string name;
+    calculator::Options calc;
+    scaling::Options scale;
+    std::string delimiter;
 
     // clang-format off
   options.add_options()
     ("h,help", "Show help")
     ("v,version", "Print the current version number")
-    ("n,name", "Name to greet", cxxopts::value(name)->default_value("World"))
-    ("l,lang", "Language code to use", cxxopts::value(language)->default_value("en"))
+    ("i,input", "Input files, read in order (default: stdin)",
+     cxxopts::value(calc.inputs))
+    ("o,output", "Output file (default: stdout)", cxxopts::value(calc.output))
+    ("f,format", "Input format: expr (one expression per line) or csv",
+     cxxopts::value(calc.format)->default_value("expr"))
+    ("e,expr", "csv: formula over the columns $1, $2, ...", cxxopts::value(calc.expr))
+    ("d,delimiter", "csv: column separator",
+     cxxopts::value(delimiter)->default_value(","))
+    ("header", "csv: skip the first line of every input")
+    ("j,jobs", "Worker threads per stage (0: a third of the hardware threads)",
+     cxxopts::value(calc.jobs)->default_value("0"))
+    ("batch", "Lines per batch", cxxopts::value(calc.batch)->default_value("4096"))
+    ("queue", "Batches per queue", cxxopts::value(calc.queue)->default_value("8"))
+    ("s,stats", "Report rows/s and latency percentiles on stderr")
+  ;
+  options.add_options("scaling")
+    ("scaling", "Measure the thread scaling of the bulk kernels instead")
+    ("n,size", "Elements per array",
+     cxxopts::value(scale.size)->default_value("4000000"))
+    ("t,threads", "Largest thread count (0: all hardware threads)",
+     cxxopts::value(scale.max_threads)->default_value("0"))
+    ("k,kernels", "Run only kernels (reduce, add, compare, sort, sum) matching this regex",
+     cxxopts::value(scale.kernels)->default_value(".*"))
+    ("type", "Integer type: int32, int64 or all",
+     cxxopts::value(scale.type)->default_value("int64"))
+    ("r,repeat", "Runs per measurement; the fastest is reported",
+     cxxopts::value(scale.repeat)->default_value("3"))
   ;
     // clang-format on
 
+    options.parse_positional({"input"});
     auto result = options.parse(argc, argv);
 
     if (result["help"].as<bool>()) {
@@ -35,19 +58,25 @@ auto main(int argc, char** argv) -> int {
         return 0;
     }
 
-    // if (result["version"].as<bool>()) {
-    //   std::cout << "Fractions, version " << FRACTIONS_VERSION << std::endl;
-    //   return 0;
-    // }
-
-    // auto langIt = languages.find(language);
-    // if (langIt == languages.end()) {
-    //   std::cerr << "unknown language code: " << language << std::endl;
-    //   return 1;
-    // }
+    if (result["version"].as<bool>()) {
+        std::cout << "Fractions, version " << FRACTIONS_VERSION << std::endl;
+        return 0;
+    }
 
-    // fractions::Fractions fractions(name);
-    // std::cout << fractions.greet(langIt->second) << std::endl;
+    if (result["scaling"].as<bool>()) {
+        if (scale.type != "int32" && scale.type != "int64" && scale.type != "all") {
+            std::cerr << "unknown type: " << scale.type << std::endl;
+            return 1;
+        }
+        return scaling::run(scale, std::cout);
+    }
 
-    return 0;
+    if (delimiter.size() != 1) {
+        std::cerr << "the delimiter must be one character" << std::endl;
+        return 1;
+    }
+    calc.delimiter = delimiter[0];
+    calc.header = result["header"].as<bool>();
+    calc.stats = result["stats"].as<bool>();
+    return calculator::run(calc, std::cerr);
 }
@@ -0,0 +1,100 @@
+#pragma once
+
+/** @file standalone/source/pipeline.hpp
+ *  Bounded queues and worker stages for the batch calculator.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pipeline {
+
+    /**
+     * @brief A blocking multi-producer, multi-consumer FIFO of bounded
+     * capacity, so that a fast stage cannot run arbitrarily far ahead of a
+     * slow one.
+     */
+    template <typename T> class BoundedQueue {
+        std::mutex _mutex;
+        std::condition_variable _not_full;
+        std::condition_variable _not_empty;
+        std::deque<T> _items;
+        std::size_t _capacity;
+        bool _closed = false;
+
+      public:
+        explicit BoundedQueue(std::size_t capacity) : _capacity(capacity != 0 ? capacity : 1) {}
+
+        /** Blocks while the queue is full; returns false if it has been closed. */
+        auto push(T item) -> bool {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_not_full.wait(
+                lock, [this] { return this->_closed || this->_items.size() < this->_capacity; });
+            if (this->_closed) {
+                return false;
+            }
+            this->_items.push_back(std::move(item));
+            lock.unlock();
+            this->_not_empty.notify_one();
+            return true;
+        }
+
+        /** Blocks while the queue is empty and open; returns false once closed and drained. */
+        auto pop(T &item) -> bool {
+            std::unique_lock<std::mutex> lock(this->_mutex);
+            this->_not_empty.wait(lock, [this] { return this->_closed || !this->_items.empty(); });
+            if (this->_items.empty()) {
+                return false;
+            }
+            item = std::move(this->_items.front());
+            this->_items.pop_front();
+            lock.unlock();
+            this->_not_full.notify_one();
+            return true;
+        }
+
+        /** Wakes all waiters; queued items can still be popped, new pushes fail. */
+        void close() {
+            {
+                std::lock_guard<std::mutex> lock(this->_mutex);
+                this->_closed = true;
+            }
+            this->_not_full.notify_all();
+            this->_not_empty.notify_all();
+        }
+    };
+
+    /**
+     * Starts `workers` threads that pop items from `in`, apply `fn` and push
+     * the result to `out`. The last worker to finish closes `out`, so
+     * closing the first queue of a chain drains the whole chain.
+     */
+    template <typename T, typename Fn>
+    void start_stage(unsigned workers, BoundedQueue<T> &in, BoundedQueue<T> &out, Fn fn,
+                     std::vector<std::thread> &pool) {
+        auto running = std::make_shared<std::pair<std::mutex, unsigned>>();
+        running->second = workers;
+        for (unsigned w = 0; w != workers; ++w) {
+            pool.emplace_back([&in, &out, fn, running]() {
+                T item;
+                while (in.pop(item)) {
+                    fn(*item);
+                    if (!out.push(std::move(item))) {
+                        break;
+                    }
+                }
+                std::lock_guard<std::mutex> lock(running->first);
+                if (--running->second == 0) {
+                    out.close();
+                }
+            });
+        }
+    }
+
+}  // namespace pipeline
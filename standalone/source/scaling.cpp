@@ -0,0 +1,190 @@
+#include "scaling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fractions/batch.hpp>
+#include <fractions/scan.hpp>
+#include <functional>
+#include <iomanip>
+#include <regex>
+#include <thread>
+#include <vector>
+
+namespace scaling {
+
+    namespace {
+        using fractions::Fraction;
+
+        /** Deterministic 64-bit generator (splitmix64). */
+        struct Rng {
+            std::uint64_t state;
+
+            auto next() -> std::uint64_t {
+                auto z = (this->state += 0x9E3779B97F4A7C15ULL);
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                return z ^ (z >> 31);
+            }
+
+            auto range(std::int64_t lo, std::int64_t hi) -> std::int64_t {
+                const auto span = static_cast<std::uint64_t>(hi - lo) + 1;
+                return lo + static_cast<std::int64_t>(this->next() % span);
+            }
+        };
+
+        /** Input arrays; the denominators divide 720720 so that sums stay in range. */
+        template <typename T> struct Data {
+            std::vector<Fraction<T>> raw, a, b;
+
+            explicit Data(std::size_t n) : raw(n), a(n), b(n) {
+                static const std::int64_t denoms[]
+                    = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+                Rng rng{0x5CA1E};
+                for (std::size_t i = 0; i != n; ++i) {
+                    const auto k = rng.range(1, 12);
+                    this->raw[i]._numer = T(k * rng.range(-1000, 1000));
+                    this->raw[i]._denom = T(k * denoms[rng.range(0, 15)]);
+                    this->a[i] = Fraction<T>(T(rng.range(-1000, 1000)),
+                                              T(denoms[rng.range(0, 15)]));
+                    this->b[i] = Fraction<T>(T(rng.range(-1000, 1000)),
+                                              T(denoms[rng.range(0, 15)]));
+                }
+            }
+        };
+
+        /** A kernel run: setup() is not timed, run(threads) is. */
+        struct Kernel {
+            std::string name;
+            double bytes;  // input and output bytes of one run
+            std::function<void()> setup;
+            std::function<void(unsigned)> run;
+            std::function<std::uint64_t()> digest;  // fingerprint of the result
+        };
+
+        template <typename T> auto hash(const Fraction<T> *x, std::size_t n) -> std::uint64_t {
+            std::uint64_t h = 0;
+            for (std::size_t i = 0; i != n; ++i) {
+                h = h * 0x100000001B3ULL ^ static_cast<std::uint64_t>(x[i].numer());
+                h = h * 0x100000001B3ULL ^ static_cast<std::uint64_t>(x[i].denom());
+            }
+            return h;
+        }
+
+        template <typename T>
+        auto kernels(Data<T> &data, std::vector<Fraction<T>> &work,
+                     std::vector<std::uint64_t> &mask, Fraction<T> &total) -> std::vector<Kernel> {
+            const auto n = data.a.size();
+            const double f = sizeof(Fraction<T>);
+            std::vector<Kernel> all;
+            all.push_back(Kernel{
+                "reduce", 2 * f * double(n), [&data, &work]() { work = data.raw; },
+                [&work, n](unsigned t) { fractions::normalize_all(work.data(), n, t); },
+                [&work, n]() { return hash(work.data(), n); }});
+            all.push_back(Kernel{
+                "add", 3 * f * double(n), []() {},
+                [&data, &work, n](unsigned t) {
+                    fractions::add_all(data.a.data(), data.b.data(), work.data(), n, t);
+                },
+                [&work, n]() { return hash(work.data(), n); }});
+            all.push_back(Kernel{
+                "compare", f * double(n) + double(n) / 8, []() {},
+                [&data, &mask, n](unsigned t) {
+                    fractions::compare_mask(data.a.data(), n, fractions::CompareOp::Less,
+                                            Fraction<T>(T(1), T(3)), mask.data(), t);
+                },
+                [&mask]() {
+                    std::uint64_t h = 0;
+                    for (const auto w : mask) {
+                        h = h * 0x100000001B3ULL ^ w;
+                    }
+                    return h;
+                }});
+            all.push_back(Kernel{
+                "sort", 2 * f * double(n), [&data, &work]() { work = data.a; },
+                [&work, n](unsigned t) {
+                    fractions::sort_all(work.data(), work.data() + n, t);
+                },
+                [&work, n]() { return hash(work.data(), n); }});
+            all.push_back(Kernel{
+                "sum", f * double(n), []() {},
+                [&data, &total, n](unsigned t) { total = fractions::sum_all(data.a.data(), n, t); },
+                [&total]() { return hash(&total, 1); }});
+            return all;
+        }
+
+        auto thread_counts(unsigned max_threads) -> std::vector<unsigned> {
+            std::vector<unsigned> counts;
+            for (unsigned t = 1; t < max_threads; t *= 2) {
+                counts.push_back(t);
+            }
+            counts.push_back(max_threads);
+            return counts;
+        }
+
+        template <typename T>
+        auto run_type(const Options &options, const std::string &type, std::ostream &os) -> int {
+            using clock = std::chrono::steady_clock;
+            const auto n = options.size;
+            Data<T> data(n);
+            std::vector<Fraction<T>> work(n);
+            std::vector<std::uint64_t> mask((n + 63) / 64);
+            Fraction<T> total;
+            const std::regex pattern(options.kernels);
+            const auto max_threads = options.max_threads != 0
+                                         ? options.max_threads
+                                         : std::max(1U, std::thread::hardware_concurrency());
+            int status = 0;
+            for (const auto &k : kernels(data, work, mask, total)) {
+                if (!std::regex_search(k.name, pattern)) {
+                    continue;
+                }
+                double base = 0;
+                std::uint64_t expected = 0;
+                for (const auto t : thread_counts(max_threads)) {
+                    double best = 0;
+                    for (int r = 0; r < std::max(1, options.repeat); ++r) {
+                        k.setup();
+                        const auto start = clock::now();
+                        k.run(t);
+                        const auto elapsed
+                            = std::chrono::duration<double>(clock::now() - start).count();
+                        best = r == 0 ? elapsed : std::min(best, elapsed);
+                    }
+                    const auto digest = k.digest();
+                    if (t == 1) {
+                        base = best;
+                        expected = digest;
+                    } else if (digest != expected) {
+                        os << "error: " << k.name << " on " << t
+                           << " threads differs from the single-threaded result\n";
+                        status = 1;
+                    }
+                    const auto speedup = base / best;
+                    os << std::left << std::setw(10) << k.name << std::setw(8) << type << std::right
+                       << std::setw(8) << t << std::fixed << std::setprecision(3) << std::setw(12)
+                       << best * 1e3 << std::setprecision(2) << std::setw(10) << speedup
+                       << std::setw(12) << 100.0 * speedup / t << std::setw(10)
+                       << k.bytes / best / 1e9 << std::defaultfloat << '\n';
+                }
+            }
+            return status;
+        }
+    }  // namespace
+
+    auto run(const Options &options, std::ostream &os) -> int {
+        os << "elements: " << options.size << '\n';
+        os << std::left << std::setw(10) << "kernel" << std::setw(8) << "type" << std::right
+           << std::setw(8) << "threads" << std::setw(12) << "ms" << std::setw(10) << "speedup"
+           << std::setw(12) << "efficiency%" << std::setw(10) << "GB/s" << '\n';
+        int status = 0;
+        if (options.type == "int32" || options.type == "all") {
+            status |= run_type<std::int32_t>(options, "int32", os);
+        }
+        if (options.type == "int64" || options.type == "all") {
+            status |= run_type<std::int64_t>(options, "int64", os);
+        }
+        return status;
+    }
+
+}  // namespace scaling
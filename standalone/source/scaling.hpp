@@ -0,0 +1,30 @@
+#pragma once
+
+/** @file standalone/source/scaling.hpp
+ *  Thread-scaling measurement of the bulk kernels.
+ */
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace scaling {
+
+    struct Options {
+        std::size_t size;         ///< elements per array
+        unsigned max_threads;     ///< largest thread count (0: all hardware threads)
+        std::string kernels;      ///< regex selecting reduce, add, compare, sort, sum
+        std::string type;         ///< "int32", "int64" or "all"
+        int repeat;               ///< runs per measurement; the fastest is reported
+    };
+
+    /**
+     * Runs each selected kernel at 1, 2, 4, ... up to max_threads threads and
+     * prints time, speedup and efficiency against one thread and the
+     * effective memory bandwidth (input and output bytes per second).
+     *
+     * @return 0, or 1 if a multithreaded result differs from the single-threaded one.
+     */
+    auto run(const Options &options, std::ostream &os) -> int;
+
+}  // namespace scaling
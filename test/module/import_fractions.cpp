@@ -0,0 +1,15 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+// Smoke test of `import fractions;`, built with the FRACTIONS_MODULE option: exits with 0 if the
+// exported names, the hidden-friend operators and a kernel work through the module.
+import fractions;
+
+int main() {
+    using F = fractions::Fraction<int>;
+    const F x[] = {F{1, 2}, F{1, 3}};
+    const F y[] = {F{2}, F{3}};
+    const bool ok = F{1, 2} + F{1, 3} == F{5, 6} && fractions::dot(x, y, 2) == F{2}
+                    && fractions::gcd(12, 18) == 6;
+    return ok ? 0 : 1;
+}
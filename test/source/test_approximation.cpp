@@ -0,0 +1,70 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <fractions/approximation.hpp>
+
+using namespace fractions;
+
+TEST_CASE("floor of Fraction") {
+    CHECK_EQ(floor(Fraction<int>(7, 2)), 3);
+    CHECK_EQ(floor(Fraction<int>(-7, 2)), -4);
+    CHECK_EQ(floor(Fraction<int>(-4, 2)), -2);
+    CHECK_EQ(floor(Fraction<int>(0, 5)), 0);
+}
+
+TEST_CASE("simplest_between") {
+    CHECK_EQ(simplest_between(Fraction<int>(3, 10), Fraction<int>(2, 5)), Fraction<int>(1, 3));
+    CHECK_EQ(simplest_between(Fraction<int>(2, 5), Fraction<int>(3, 10)), Fraction<int>(1, 3));
+    CHECK_EQ(simplest_between(Fraction<int>(-2, 5), Fraction<int>(-3, 10)),
+             Fraction<int>(-1, 3));
+    CHECK_EQ(simplest_between(Fraction<int>(-1, 2), Fraction<int>(7, 3)), Fraction<int>(0));
+    CHECK_EQ(simplest_between(Fraction<int>(3, 2), Fraction<int>(5, 2)), Fraction<int>(2));
+    CHECK_EQ(simplest_between(Fraction<int>(355, 113), Fraction<int>(22, 7)),
+             Fraction<int>(22, 7));
+    CHECK_EQ(simplest_between(Fraction<int>(314, 100), Fraction<int>(315, 100)),
+             Fraction<int>(22, 7));
+    CHECK_EQ(simplest_between(Fraction<int>(5, 7), Fraction<int>(5, 7)), Fraction<int>(5, 7));
+}
+
+TEST_CASE("approx_below and approx_above") {
+    const auto x = Fraction<int>(31416, 10000);
+    CHECK_EQ(approx_below(x, 10), Fraction<int>(25, 8));
+    CHECK_EQ(approx_above(x, 10), Fraction<int>(22, 7));
+    CHECK_EQ(approx_below(-x, 10), Fraction<int>(-22, 7));
+    CHECK_EQ(approx_above(-x, 10), Fraction<int>(-25, 8));
+    CHECK_EQ(approx_below(Fraction<int>(5, 7), 7), Fraction<int>(5, 7));
+    CHECK_EQ(approx_above(Fraction<int>(1, 0), 7), Fraction<int>(1, 0));
+
+    // compare against a brute-force scan of all fractions with small denominators
+    for (int q = 1; q <= 30; ++q) {
+        for (int p = -40; p <= 40; ++p) {
+            const auto y = Fraction<int>(p, q);
+            for (int n = 1; n <= 8; ++n) {
+                auto lo = Fraction<int>(-100);
+                auto hi = Fraction<int>(100);
+                for (int d = 1; d <= n; ++d) {
+                    for (int m = -50 * d; m <= 50 * d; ++m) {
+                        const auto c = Fraction<int>(m, d);
+                        if (c <= y && lo < c) {
+                            lo = c;
+                        }
+                        if (y <= c && c < hi) {
+                            hi = c;
+                        }
+                    }
+                }
+                CHECK_EQ(approx_below(y, n), lo);
+                CHECK_EQ(approx_above(y, n), hi);
+            }
+        }
+    }
+}
+
+TEST_CASE("limit_denominator") {
+    CHECK_EQ(limit_denominator(Fraction<int>(31416, 10000), 10), Fraction<int>(22, 7));
+    CHECK_EQ(limit_denominator(Fraction<int>(31416, 10000), 200), Fraction<int>(355, 113));
+    CHECK_EQ(limit_denominator(Fraction<int>(-1, 3), 2), Fraction<int>(-1, 2));
+    CHECK_EQ(limit_denominator(Fraction<int>(3, 7), 100), Fraction<int>(3, 7));
+}
@@ -0,0 +1,152 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstring>
+#include <fractions/arrow.hpp>
+#include <fractions/fractions.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("arrow export shares the columns and releases them") {
+    auto numer = std::make_shared<std::vector<std::int64_t>>(
+        std::vector<std::int64_t>{1, -2, 3, 4, 0});
+    auto denom = std::make_shared<std::vector<std::int64_t>>(
+        std::vector<std::int64_t>{2, 3, 1, 0, 5});
+    const std::weak_ptr<std::vector<std::int64_t>> alive = numer;
+
+    ArrowArray array;
+    ArrowSchema schema;
+    REQUIRE(export_columns(numer, denom, &array, &schema));
+    const auto *data = numer->data();
+    numer.reset();
+    denom.reset();
+    CHECK_FALSE(alive.expired());
+
+    CHECK(std::strcmp(schema.format, "+s") == 0);
+    REQUIRE_EQ(schema.n_children, 2);
+    CHECK(std::strcmp(schema.children[0]->name, "numer") == 0);
+    CHECK(std::strcmp(schema.children[1]->format, "l") == 0);
+    CHECK_EQ(array.length, 5);
+    CHECK_EQ(array.children[0]->buffers[1], data);  // not copied
+
+    ArrowColumns columns;
+    std::string error;
+    REQUIRE(columns.import(&array, &schema, &error));
+    CHECK(array.release == nullptr);  // moved into columns
+    schema.release(&schema);
+    CHECK(schema.release == nullptr);
+    CHECK_EQ(columns.size(), 5U);
+    CHECK_EQ(columns.numer(), data);
+    CHECK_EQ(columns[1], Fraction<std::int64_t>(-2, 3));
+    CHECK(columns[3].denom() == 0);
+
+    ArrowColumns moved(std::move(columns));
+    CHECK_EQ(columns.size(), 0U);
+    CHECK_FALSE(alive.expired());
+    moved.reset();
+    CHECK(alive.expired());
+}
+
+TEST_CASE("arrow children can be released separately") {
+    std::vector<Fraction<std::int32_t>> rows = {{1, 2}, {-3, 4}, {5, 1}};
+    ArrowArray array;
+    export_fractions(rows.data(), rows.size(), &array);
+
+    // move the denominators out, then release the parent
+    ArrowArray denom = *array.children[1];
+    array.children[1]->release = nullptr;
+    array.release(&array);
+    const auto *d = static_cast<const std::int64_t *>(denom.buffers[1]);
+    CHECK_EQ(d[1], 4);
+    CHECK_EQ(d[2], 1);
+    denom.release(&denom);
+    CHECK(denom.release == nullptr);
+}
+
+TEST_CASE("arrow import checks the layout") {
+    auto numer = std::make_shared<std::vector<std::int64_t>>(4, 1);
+    auto denom = std::make_shared<std::vector<std::int64_t>>(3, 1);
+    ArrowArray array;
+    ArrowSchema schema;
+    std::string error;
+    CHECK_FALSE(export_columns(numer, denom, &array, &schema, &error));
+    CHECK_EQ(error, "the columns differ in length");
+
+    denom->push_back(7);
+    REQUIRE(export_columns(numer, denom, &array, &schema));
+    ArrowColumns columns;
+    schema.children[1]->format = "i";
+    CHECK_FALSE(columns.import(&array, &schema, &error));
+    CHECK_EQ(error, "expected int64 fields");
+    CHECK(array.release != nullptr);  // still the caller's
+    schema.children[1]->format = "l";
+
+    array.offset = 1;
+    array.length = 3;
+    REQUIRE(columns.import(&array, &schema));
+    CHECK_EQ(columns[2], Fraction<std::int64_t>(1, 7));
+    schema.release(&schema);
+}
+
+TEST_CASE("arrow import applies the child offsets to sliced arrays") {
+    auto numer = std::make_shared<std::vector<std::int64_t>>(
+        std::vector<std::int64_t>{9, 9, 9, 5, 6});
+    auto denom = std::make_shared<std::vector<std::int64_t>>(
+        std::vector<std::int64_t>{1, 1, 1, 7, 8});
+    ArrowArray array;
+    REQUIRE(export_columns(numer, denom, &array));
+    // children sliced to [1, 5), the struct to rows [2, 4) of them
+    for (int i = 0; i != 2; ++i) {
+        array.children[i]->offset = 1;
+        array.children[i]->length = 4;
+    }
+    array.offset = 2;
+    array.length = 2;
+    ArrowColumns columns;
+    std::string error;
+    REQUIRE(columns.import(&array, nullptr, &error));
+    CHECK_EQ(columns.size(), 2U);
+    CHECK_EQ(columns[0], Fraction<std::int64_t>(5, 7));
+    CHECK_EQ(columns.numer()[1], 6);
+    CHECK_EQ(columns.denom()[1], 8);
+    columns.reset();
+
+    REQUIRE(export_columns(numer, denom, &array));
+    array.children[0]->offset = 1;
+    array.children[0]->length = 4;
+    array.offset = 2;
+    array.length = 3;
+    CHECK_FALSE(columns.import(&array, nullptr, &error));
+    CHECK_EQ(error, "malformed int64 field");
+    array.release(&array);
+}
+
+TEST_CASE("arrow import accepts an unknown null count without a bitmap") {
+    auto numer = std::make_shared<std::vector<std::int64_t>>(3, 1);
+    auto denom = std::make_shared<std::vector<std::int64_t>>(3, 2);
+    ArrowArray array;
+    REQUIRE(export_columns(numer, denom, &array));
+    array.null_count = -1;
+    array.children[0]->null_count = -1;
+    array.children[1]->null_count = -1;
+    ArrowColumns columns;
+    std::string error;
+    REQUIRE(columns.import(&array, nullptr, &error));
+    CHECK_EQ(columns[2], Fraction<std::int64_t>(1, 2));
+
+    // with a bitmap, an unknown count may hide nulls
+    const std::uint8_t valid = 0x7;
+    REQUIRE(export_columns(numer, denom, &array));
+    array.children[1]->null_count = -1;
+    array.children[1]->buffers[0] = &valid;
+    CHECK_FALSE(columns.import(&array, nullptr, &error));
+    CHECK_EQ(error, "null terms are not supported");
+    array.children[1]->buffers[0] = nullptr;
+    array.release(&array);
+}
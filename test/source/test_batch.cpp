@@ -0,0 +1,82 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fractions/batch.hpp>
+#include <vector>
+
+using namespace fractions;
+
+namespace {
+    /** Unreduced fractions with denominators dividing 720720. */
+    auto raw_column(std::size_t n) -> std::vector<Fraction<std::int64_t>> {
+        static const std::int64_t denoms[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 16};
+        std::vector<Fraction<std::int64_t>> v(n);
+        for (std::size_t i = 0; i != n; ++i) {
+            const auto k = std::int64_t(i % 5) + 1;
+            const auto sign = i % 3 == 0 ? -1 : 1;
+            v[i]._numer = k * std::int64_t(i % 1009) * sign;
+            v[i]._denom = k * denoms[i % 14] * sign;
+        }
+        return v;
+    }
+}  // namespace
+
+TEST_CASE("normalize_all and add_all") {
+    auto v = raw_column(70001);
+    auto w = v;
+    normalize_all(v.data(), v.size(), 4);
+    for (std::size_t i = 0; i != v.size(); ++i) {
+        CHECK_EQ(v[i], Fraction<std::int64_t>(w[i].numer(), w[i].denom()));
+    }
+    std::vector<Fraction<std::int64_t>> out(v.size());
+    add_all(v.data(), v.data() + 1, out.data(), v.size() - 1, 3);
+    for (std::size_t i = 0; i + 1 != v.size(); ++i) {
+        CHECK_EQ(out[i], v[i] + v[i + 1]);
+    }
+}
+
+TEST_CASE("sum_all on several threads") {
+    auto v = raw_column(50000);
+    normalize_all(v.data(), v.size());
+    Fraction<std::int64_t> naive;
+    for (const auto &x : v) {
+        naive += x;
+    }
+    CHECK_EQ(sum_all(v.data(), v.size()), naive);
+    CHECK_EQ(sum_all(v.data(), v.size(), 4), naive);
+    CHECK_EQ(sum_all(v.data(), 0), Fraction<std::int64_t>(0));
+}
+
+TEST_CASE("sum_all returns 0/0 on overflow") {
+    using F = Fraction<std::int32_t>;
+    // the lcm of five denominators near 46000 overflows 64 bits; the overflow is in
+    // the last chunk and has to survive the merge
+    std::vector<F> v(3 * detail::dot_chunk_min, F(1));
+    const std::int32_t primes[] = {46327, 46337, 46349, 46351, 46381};
+    for (std::size_t i = 0; i != 5; ++i) {
+        v[v.size() - 1 - i] = F(1, primes[i]);
+    }
+    CHECK_EQ(sum_all(v.data(), v.size()).denom(), 0);
+    CHECK_EQ(sum_all(v.data(), v.size(), 4).denom(), 0);
+    CHECK_EQ(sum_all(v.data(), v.size() - 5), F(std::int32_t(v.size() - 5)));
+}
+
+TEST_CASE("sort_all on several threads") {
+    auto v = raw_column(100000);
+    normalize_all(v.data(), v.size());
+    auto expected = v;
+    std::sort(expected.begin(), expected.end(), CrossLess<std::int64_t>());
+    for (const unsigned threads : {1U, 3U, 4U}) {
+        auto w = v;
+        sort_all(w.data(), w.data() + w.size(), threads);
+        CHECK(std::is_sorted(w.begin(), w.end(), CrossLess<std::int64_t>()));
+        CHECK(std::equal(w.begin(), w.end(), expected.begin(),
+                         [](const Fraction<std::int64_t> &a, const Fraction<std::int64_t> &b) {
+                             return a == b;
+                         }));
+    }
+}
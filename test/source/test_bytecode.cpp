@@ -0,0 +1,117 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/bytecode.hpp>
+#include <fractions/fractions.hpp>
+#include <string>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("compile and run a formula") {
+    Program<int> p;
+    std::string error;
+    REQUIRE(compile("(a*b + c) / d", {"a", "b", "c", "d"}, p, &error));
+    CHECK(error.empty());
+    const Fraction<int> row[] = {Fraction<int>(1, 2), Fraction<int>(2, 3), Fraction<int>(1, 6),
+                                 Fraction<int>(2)};
+    CHECK_EQ(p(row), Fraction<int>(1, 4));
+    CHECK_EQ(p.inputs(), 4U);
+    CHECK_EQ(p.code().size(), 3U);
+    CHECK_EQ(p.registers(), 5U);  // four inputs and one reused temporary
+
+    REQUIRE(compile("-x - -2.5 * (y)", {"x", "y"}, p));
+    const Fraction<int> xy[] = {Fraction<int>(1, 3), Fraction<int>(2)};
+    CHECK_EQ(p(xy), Fraction<int>(14, 3));
+    CHECK_EQ(p(xy), -xy[0] + Fraction<int>(5, 2) * xy[1]);
+}
+
+TEST_CASE("constants are folded") {
+    Program<int> p;
+    REQUIRE(compile("x * (1/2 + 1/3) - 2 * 3", {"x"}, p));
+    CHECK_EQ(p.code().size(), 2U);
+    REQUIRE_EQ(p.constants().size(), 2U);
+    CHECK_EQ(p.constants()[0], Fraction<int>(5, 6));
+    CHECK_EQ(p.constants()[1], Fraction<int>(6));
+    const Fraction<int> x[] = {Fraction<int>(12)};
+    CHECK_EQ(p(x), Fraction<int>(4));
+
+    REQUIRE(compile("-(1 + 2) / 4", {}, p));
+    CHECK(p.code().empty());
+    CHECK_EQ(p(nullptr), Fraction<int>(-3, 4));
+}
+
+TEST_CASE("constants that could overflow are not folded") {
+    Program<std::int64_t> p;
+    REQUIRE(compile("3000000000 * 3000000000 / 1000000000", {}, p));
+    CHECK_EQ(p.code().size(), 2U);
+    CHECK_EQ(p.constants().size(), 3U);
+    CHECK_EQ(p(nullptr), Fraction<std::int64_t>(9000000000LL));
+
+    REQUIRE(compile("3000 * 3000 / 1000", {}, p));
+    CHECK(p.code().empty());
+    CHECK_EQ(p(nullptr), Fraction<std::int64_t>(9000, 1));
+}
+
+TEST_CASE("column names") {
+    Program<int> p;
+    std::string error;
+    REQUIRE(compile("($1 + $12) / $1", {"$1", "$12"}, p, &error));
+    const Fraction<int> row[] = {Fraction<int>(2), Fraction<int>(1, 2)};
+    CHECK_EQ(p(row), Fraction<int>(5, 4));
+    CHECK_FALSE(compile("$1 + $2", {"$1"}, p, &error));
+    CHECK_EQ(error, "unknown variable '$2' at column 6");
+}
+
+TEST_CASE("compile errors") {
+    Program<int> p;
+    std::string error;
+    CHECK_FALSE(compile("a +", {"a"}, p, &error));
+    CHECK_EQ(error, "unexpected end of formula at column 4");
+    CHECK_FALSE(compile("(a * b", {"a", "b"}, p, &error));
+    CHECK_EQ(error, "expected ')' at column 7");
+    CHECK_FALSE(compile("a + z", {"a"}, p, &error));
+    CHECK_EQ(error, "unknown variable 'z' at column 5");
+    CHECK_FALSE(compile("a $ 2", {"a"}, p, &error));
+    CHECK_EQ(error, "unexpected '$' at column 3");
+    CHECK_FALSE(compile("99999999999", {}, p, &error));
+    CHECK_EQ(error, "number out of range at column 1");
+    CHECK_FALSE(compile("-2147483648", {}, p, &error));  // the literal is read before the sign
+    CHECK_EQ(error, "number out of range at column 2");
+    CHECK_FALSE(compile(std::string(300, '(') + "1" + std::string(300, ')'), {}, p));
+}
+
+TEST_CASE("columnar evaluation matches rows") {
+    using F = Fraction<std::int64_t>;
+    Program<std::int64_t> p;
+    REQUIRE(compile("(a*b + c)/d - a/3", {"a", "b", "c", "d"}, p));
+    const std::size_t n = 70001;
+    std::vector<std::vector<F>> cols(4, std::vector<F>(n));
+    for (std::size_t i = 0; i != n; ++i) {
+        const auto k = std::int64_t(i);
+        cols[0][i] = F(k % 97 - 48, k % 7 + 1);
+        cols[1][i] = F(k % 13 + 1, 4);
+        cols[2][i] = F(-k % 31, 6);
+        cols[3][i] = F(k % 5 + 1, k % 3 + 1);
+    }
+    const F *columns[] = {cols[0].data(), cols[1].data(), cols[2].data(), cols[3].data()};
+    auto regs = p.scratch();
+    for (const unsigned threads : {1U, 3U}) {
+        std::vector<F> out(n);
+        p.evaluate(columns, n, out.data(), threads);
+        for (std::size_t i = 0; i != n; i += 1 + i % 7) {
+            const F row[] = {cols[0][i], cols[1][i], cols[2][i], cols[3][i]};
+            REQUIRE_EQ(out[i], p.run(row, regs));
+            REQUIRE_EQ(out[i], (row[0] * row[1] + row[2]) / row[3] - row[0] / F(3));
+        }
+    }
+
+    // a formula without code copies its operand
+    REQUIRE(compile("b", {"a", "b"}, p));
+    std::vector<F> out(n);
+    p.evaluate(columns, n, out.data());
+    CHECK_EQ(out[n - 1], cols[1][n - 1]);
+}
@@ -0,0 +1,189 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+#include <fractions_c.h>
+
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <string>
+#include <vector>
+
+namespace {
+    auto q64(std::int64_t n, std::int64_t d) -> fractions_q64 {
+        fractions_q64 x;
+        x.numer = n;
+        x.denom = d;
+        return x;
+    }
+
+    auto same(const fractions_q64 &x, std::int64_t n, std::int64_t d) -> bool {
+        return x.numer == n && x.denom == d;
+    }
+}  // namespace
+
+TEST_CASE("C interface arithmetic on 64-bit terms") {
+    CHECK_EQ(fractions_c_abi_version(), FRACTIONS_C_ABI_VERSION);
+    const std::int64_t big = std::numeric_limits<std::int64_t>::max();
+    std::vector<fractions_q64> a = {q64(1, 2), q64(-1, 3), q64(1, 0), q64(big, 1)};
+    std::vector<fractions_q64> b = {q64(1, 3), q64(1, 3), q64(5, 7), q64(big, 1)};
+    std::vector<fractions_q64> out(a.size());
+    CHECK_EQ(fractions_q64_add(a.data(), b.data(), out.data(), a.size()), FRACTIONS_C_OVERFLOW);
+    CHECK(same(out[0], 5, 6));
+    CHECK(same(out[1], 0, 1));
+    CHECK(same(out[2], 1, 0));
+    CHECK(same(out[3], 0, 0));  // 2 * big does not fit
+
+    CHECK_EQ(fractions_q64_mul(a.data(), b.data(), out.data(), 3), FRACTIONS_C_OK);
+    CHECK(same(out[0], 1, 6));
+    CHECK(same(out[1], -1, 9));
+
+    std::vector<fractions_q64> x = {q64(4, -6), q64(0, -3), q64(big, big)};
+    CHECK_EQ(fractions_q64_reduce(x.data(), x.size()), FRACTIONS_C_OK);
+    CHECK(same(x[0], -2, 3));
+    CHECK(same(x[1], 0, 1));
+    CHECK(same(x[2], 1, 1));
+
+    std::int8_t cmp[4];
+    CHECK_EQ(fractions_q64_compare(a.data(), b.data(), cmp, 4), FRACTIONS_C_OK);
+    CHECK_EQ(cmp[0], 1);
+    CHECK_EQ(cmp[1], -1);
+    CHECK_EQ(cmp[2], 1);
+    CHECK_EQ(cmp[3], 0);
+}
+
+TEST_CASE("C interface parses and formats") {
+    const std::string text = " 6/4, -3\n+5/10 1/0\t-9223372036854775807 ";
+    std::vector<fractions_q64> x(8);
+    std::size_t count = 0;
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_OK);
+    REQUIRE_EQ(count, 5U);
+    CHECK(same(x[0], 3, 2));
+    CHECK(same(x[1], -3, 1));
+    CHECK(same(x[2], 1, 2));
+    CHECK(same(x[3], 1, 0));
+
+    char small[8];
+    std::size_t length = 0;
+    CHECK_EQ(fractions_q64_format(x.data(), count, small, sizeof(small), &length),
+             FRACTIONS_C_NO_SPACE);
+    std::vector<char> buffer(length + 1);
+    CHECK_EQ(fractions_q64_format(x.data(), count, buffer.data(), buffer.size(), &length),
+             FRACTIONS_C_OK);
+    CHECK_EQ(std::string(buffer.data()), "3/2\n-3\n1/2\n1/0\n-9223372036854775807\n");
+
+    const std::string bad = "1/2 3/-4";
+    CHECK_EQ(fractions_q64_parse(bad.data(), bad.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_PARSE_ERROR);
+    CHECK_EQ(count, 1U);
+    const std::string wide = "9223372036854775808";
+    CHECK_EQ(fractions_q64_parse(wide.data(), wide.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_PARSE_ERROR);
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), 2, &count),
+             FRACTIONS_C_NO_SPACE);
+    CHECK_EQ(count, 2U);
+}
+
+TEST_CASE("C interface parses more rows than one chunk") {
+    std::string text;
+    for (int i = 1; i <= 1000; ++i) {
+        text += std::to_string(2 * i) + "/" + std::to_string(4 * i) + (i % 7 == 0 ? ",\n" : " ");
+    }
+    std::vector<fractions_q64> x(1000);
+    std::size_t count = 0;
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_OK);
+    CHECK_EQ(count, 1000U);
+    CHECK(same(x[0], 1, 2));
+    CHECK(same(x[999], 1, 2));
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), 512, &count),
+             FRACTIONS_C_NO_SPACE);
+    CHECK_EQ(count, 512U);
+
+    text += "7/x 5";
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_NO_SPACE);
+    x.resize(1010);
+    CHECK_EQ(fractions_q64_parse(text.data(), text.size(), x.data(), x.size(), &count),
+             FRACTIONS_C_PARSE_ERROR);
+    CHECK_EQ(count, 1000U);
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_CASE("C interface on 128-bit terms") {
+    // 2^64 + 1 and 3/2^64
+    const std::string text = "18446744073709551617 3/18446744073709551616";
+    fractions_q128 x[2];
+    std::size_t count = 0;
+    REQUIRE_EQ(fractions_q128_parse(text.data(), text.size(), x, 2, &count), FRACTIONS_C_OK);
+    CHECK_EQ(x[0].numer.hi, 1);
+    CHECK_EQ(x[0].numer.lo, 1U);
+    CHECK_EQ(x[1].denom.hi, 1);
+    CHECK_EQ(x[1].denom.lo, 0U);
+
+    fractions_q128 product;
+    CHECK_EQ(fractions_q128_mul(x, x + 1, &product, 1), FRACTIONS_C_OK);
+    char buffer[128];
+    std::size_t length = 0;
+    CHECK_EQ(fractions_q128_format(&product, 1, buffer, sizeof(buffer), &length), FRACTIONS_C_OK);
+    CHECK_EQ(std::string(buffer), "55340232221128654851/18446744073709551616\n");
+
+    std::int8_t cmp;
+    CHECK_EQ(fractions_q128_compare(x, x + 1, &cmp, 1), FRACTIONS_C_OK);
+    CHECK_EQ(cmp, 1);
+
+    // cross products near 2^254, both signs
+    const std::string large = "-170141183460469231731687303715884105727/"
+                              "170141183460469231731687303715884105726 "
+                              "-170141183460469231731687303715884105726/"
+                              "170141183460469231731687303715884105725 "
+                              "170141183460469231731687303715884105727";
+    fractions_q128 y[3];
+    REQUIRE_EQ(fractions_q128_parse(large.data(), large.size(), y, 3, &count), FRACTIONS_C_OK);
+    const fractions_q128 lhs[3] = {y[0], y[1], y[2]};
+    const fractions_q128 rhs[3] = {y[1], y[0], y[2]};
+    std::int8_t order[3];
+    CHECK_EQ(fractions_q128_compare(lhs, rhs, order, 3), FRACTIONS_C_OK);
+    CHECK_EQ(order[0], 1);
+    CHECK_EQ(order[1], -1);
+    CHECK_EQ(order[2], 0);
+}
+
+TEST_CASE("C interface reports 128-bit overflow") {
+    // 2^127 - 1 is prime: products only fit when it cancels
+    const std::string text = "170141183460469231731687303715884105727 2 "
+                             "1/170141183460469231731687303715884105727 1/3";
+    fractions_q128 x[4];
+    std::size_t count = 0;
+    REQUIRE_EQ(fractions_q128_parse(text.data(), text.size(), x, 4, &count), FRACTIONS_C_OK);
+
+    fractions_q128 out;
+    CHECK_EQ(fractions_q128_mul(x, x + 2, &out, 1), FRACTIONS_C_OK);
+    CHECK_EQ(out.numer.lo, 1U);
+    CHECK_EQ(out.denom.lo, 1U);
+    CHECK_EQ(fractions_q128_mul(x, x + 1, &out, 1), FRACTIONS_C_OVERFLOW);
+    CHECK_EQ(out.numer.lo, 0U);
+    CHECK_EQ(out.denom.lo, 0U);
+    CHECK_EQ(fractions_q128_add(x, x, &out, 1), FRACTIONS_C_OVERFLOW);
+    CHECK_EQ(fractions_q128_add(x + 2, x + 3, &out, 1), FRACTIONS_C_OVERFLOW);
+    CHECK_EQ(fractions_q128_add(x + 3, x + 3, &out, 1), FRACTIONS_C_OK);
+    char buffer[128];
+    std::size_t length = 0;
+    CHECK_EQ(fractions_q128_format(&out, 1, buffer, sizeof(buffer), &length), FRACTIONS_C_OK);
+    CHECK_EQ(std::string(buffer), "2/3\n");
+
+    // -2^127/-2 reduces to 2^126/1
+    fractions_q128 r;
+    r.numer.hi = std::numeric_limits<std::int64_t>::min();
+    r.numer.lo = 0;
+    r.denom.hi = -1;
+    r.denom.lo = ~std::uint64_t(0) - 1;
+    CHECK_EQ(fractions_q128_reduce(&r, 1), FRACTIONS_C_OK);
+    CHECK_EQ(r.numer.hi, std::int64_t(1) << 62);
+    CHECK_EQ(r.numer.lo, 0U);
+    CHECK_EQ(r.denom.hi, 0);
+    CHECK_EQ(r.denom.lo, 1U);
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/codec.hpp>
+#include <fractions/fractions.hpp>
+#include <limits>
+#include <vector>
+
+using namespace fractions;
+
+namespace {
+    template <typename T> auto raw(T n, T d) -> Fraction<T> {
+        Fraction<T> x;
+        x._numer = n;
+        x._denom = d;
+        return x;
+    }
+}  // namespace
+
+TEST_CASE("codec round trip of extreme values") {
+    using F = Fraction<std::int64_t>;
+    const auto lo = std::numeric_limits<std::int64_t>::min();
+    const auto hi = std::numeric_limits<std::int64_t>::max();
+    const std::vector<F> rows = {raw<std::int64_t>(0, 1), raw(lo, hi),   raw(hi, std::int64_t(1)),
+                                 raw<std::int64_t>(1, 0), raw(-1L, 0L),  raw(0L, 0L),
+                                 raw(lo, lo),             raw(-7L, -3L), raw(5L, 1L)};
+    const auto bytes = encode(rows.data(), rows.size());
+    std::vector<F> back;
+    REQUIRE(decode(bytes.data(), bytes.size(), back));
+    CHECK(back == rows);
+
+    using U = Fraction<std::uint64_t>;
+    const auto umax = std::numeric_limits<std::uint64_t>::max();
+    const std::vector<U> urows = {raw<std::uint64_t>(umax, 3), raw<std::uint64_t>(1, umax),
+                                  raw<std::uint64_t>(2, 3)};
+    const auto ubytes = encode(urows.data(), urows.size());
+    std::vector<U> uback;
+    REQUIRE(decode(ubytes.data(), ubytes.size(), uback));
+    CHECK(uback == urows);
+}
+
+TEST_CASE("codec sizes of shared, dictionary and new denominators") {
+    using F = Fraction<std::int32_t>;
+    std::vector<F> rows;
+    for (int i = 0; i != 1000; ++i) {
+        rows.push_back(raw(i % 31 - 15, 1));  // one byte each, decoded in runs
+    }
+    auto bytes = encode(rows.data(), rows.size());
+    CHECK_EQ(bytes.size(), 1000U);
+    std::vector<F> back;
+    REQUIRE(decode(bytes.data(), bytes.size(), back));
+    CHECK(back == rows);
+
+    rows.clear();
+    for (int i = 0; i != 1000; ++i) {
+        rows.push_back(raw(i % 16, i % 2 == 0 ? 100 : 64));  // alternating denominators
+    }
+    bytes = encode(rows.data(), rows.size());
+    CHECK_LE(bytes.size(), 2 * 1000U + 2);  // two new denominators, then dictionary hits
+
+    for (int i = 0; i != 3000; ++i) {
+        rows.push_back(raw(-i * 7919, i % 300 + 1));  // the dictionary overflows
+    }
+    bytes = encode(rows.data(), rows.size());
+    back.clear();
+    REQUIRE(decode(bytes.data(), bytes.size(), back));
+    CHECK(back == rows);
+}
+
+TEST_CASE("codec streams in chunks and rejects damaged input") {
+    using F = Fraction<std::int64_t>;
+    FractionEncoder<std::int64_t> enc;
+    FractionDecoder<std::int64_t> dec;
+    std::vector<F> sent, received;
+    for (int chunk = 0; chunk != 5; ++chunk) {
+        for (std::int64_t i = 0; i != 100; ++i) {
+            sent.push_back(raw<std::int64_t>(i * i * (chunk - 2), chunk * 10 + 1));
+            enc.push(sent.back());
+        }
+        const auto bytes = enc.take();
+        dec.feed(bytes.data(), bytes.size());
+        F x;
+        while (dec.next(x)) {
+            received.push_back(x);
+        }
+        CHECK(dec.done());
+    }
+    CHECK(received == sent);
+
+    auto bytes = encode(sent.data(), sent.size());
+    std::vector<F> back;
+    CHECK_FALSE(decode(bytes.data(), bytes.size() - 1, back));
+    CHECK_LT(back.size(), sent.size());
+
+    const unsigned char bad_index[] = {0x01, 0x05};  // dictionary entry 5 of an empty dictionary
+    back.clear();
+    CHECK_FALSE(decode(bad_index, sizeof(bad_index), back));
+    CHECK(back.empty());
+    const unsigned char bad_mode[] = {0x07, 0x02};  // mode 3 with a non-zero numerator
+    CHECK_FALSE(decode(bad_mode, sizeof(bad_mode), back));
+    CHECK(back.empty());
+    const unsigned char too_long[] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+                                      0xFF, 0xFF, 0xFF, 0xFF, 0x01};
+    CHECK_FALSE(decode(too_long, sizeof(too_long), back));
+}
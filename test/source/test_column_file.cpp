@@ -0,0 +1,166 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fractions/column_file.hpp>
+#include <fractions/fractions.hpp>
+#include <string>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("column file round trip") {
+    using F = Fraction<std::int64_t>;
+    const char *path = "fractions_test_columns.frc";
+    std::vector<F> rows;
+    for (std::int64_t i = 0; i != 1000; ++i) {
+        // rows 100..199 are integers, sharing the denominator 1; the others vary
+        rows.push_back(i / 100 == 1 ? F(i - 150) : F(i % 37 - 18, i % 11 + 1));
+    }
+    rows[3] = F(1, 0);
+    rows[4] = F(-1, 0);
+
+    ColumnWriter<std::int64_t> out(100);
+    REQUIRE(out.open(path));
+    out.write(rows.data(), 150);
+    for (std::size_t i = 150; i != rows.size(); ++i) {
+        out.push(rows[i]);
+    }
+    REQUIRE(out.close());
+
+    ColumnFile<std::int64_t> in;
+    std::string error;
+    REQUIRE(in.open(path, &error));
+    CHECK(error.empty());
+    CHECK_EQ(in.size(), rows.size());
+    CHECK_EQ(in.blocks(), 10U);
+    CHECK_EQ(in.block_rows(), 100U);
+    for (std::size_t i = 0; i != rows.size(); ++i) {
+        REQUIRE_EQ(in[i], rows[i]);
+    }
+    CHECK(in.read_all() == rows);
+
+    const auto shared = in.block(1);
+    CHECK(shared.shared());
+    CHECK_EQ(shared.shared_denom(), 1);
+    CHECK_EQ(shared.min(), F(-50));
+    CHECK_EQ(shared.max(), F(49));
+    const auto first = in.block(0);
+    CHECK_FALSE(first.shared());
+    CHECK_EQ(first.denom()[5], rows[5].denom());
+    CHECK_EQ(first.min(), F(-1, 0));
+    CHECK_EQ(first.max(), F(1, 0));
+
+    // moving keeps the views valid
+    ColumnFile<std::int64_t> moved(std::move(in));
+    CHECK_FALSE(in.is_open());
+    CHECK_EQ(moved[999], rows[999]);
+    moved.close();
+    std::remove(path);
+}
+
+TEST_CASE("column file rejects mismatched or corrupt input") {
+    const char *path = "fractions_test_columns_bad.frc";
+    ColumnWriter<std::int32_t> out(4);
+    REQUIRE(out.open(path));
+    for (int i = 0; i != 10; ++i) {
+        out.push(Fraction<std::int32_t>(i, 3));
+    }
+    REQUIRE(out.close());
+
+    std::string error;
+    ColumnFile<std::int64_t> wrong_type;
+    CHECK_FALSE(wrong_type.open(path, &error));
+    CHECK_NE(error.find("integer type"), std::string::npos);
+
+    ColumnFile<std::int32_t> ok;
+    REQUIRE(ok.open(path));
+    CHECK_EQ(ok[9], Fraction<std::int32_t>(3));
+    ok.close();
+
+    // cut the directory off
+    std::vector<char> bytes;
+    if (std::FILE *f = std::fopen(path, "rb")) {
+        char c[256];
+        std::size_t got;
+        while ((got = std::fread(c, 1, sizeof(c), f)) != 0) {
+            bytes.insert(bytes.end(), c, c + got);
+        }
+        std::fclose(f);
+    }
+    REQUIRE(bytes.size() > 100);
+    if (std::FILE *f = std::fopen(path, "wb")) {
+        std::fwrite(bytes.data(), 1, bytes.size() - 60, f);
+        std::fclose(f);
+    }
+    CHECK_FALSE(ok.open(path, &error));
+    CHECK_NE(error.find("corrupt"), std::string::npos);
+    CHECK_FALSE(ok.open("fractions_test_no_such_file.frc"));
+    std::remove(path);
+}
+
+namespace {
+    /** Writes a bare header and directory, one 120-byte file per call. */
+    auto hostile_header(const char *path, std::uint64_t rows, std::uint64_t block_rows,
+                        std::uint64_t blocks, std::uint64_t directory, std::uint64_t offset,
+                        std::uint32_t entry_rows) -> bool {
+        detail::ColumnFileHeader h{};
+        std::memcpy(h.magic, detail::column_file_magic, sizeof(h.magic));
+        h.version = detail::column_file_version;
+        h.bom = detail::column_file_bom;
+        h.term_size = sizeof(std::int32_t);
+        h.is_signed = 1;
+        h.rows = rows;
+        h.block_rows = block_rows;
+        h.blocks = blocks;
+        h.directory = directory;
+        detail::ColumnBlockEntry e{};
+        e.offset = offset;
+        e.rows = entry_rows;
+        std::FILE *f = std::fopen(path, "wb");
+        if (f == nullptr) {
+            return false;
+        }
+        const bool ok
+            = std::fwrite(&h, sizeof(h), 1, f) == 1 && std::fwrite(&e, sizeof(e), 1, f) == 1;
+        return std::fclose(f) == 0 && ok;
+    }
+}  // namespace
+
+TEST_CASE("column file rejects headers whose sizes overflow") {
+    const char *path = "fractions_test_columns_hostile.frc";
+    const std::uint64_t big = std::uint64_t(1) << 31;
+    std::string error;
+    ColumnFile<std::int32_t> in;
+
+    // 2^31 rows of 8 bytes each wrap to 0 in 32 bits
+    REQUIRE(hostile_header(path, big, big, 1, 64, 64, std::uint32_t(big)));
+    CHECK_FALSE(in.open(path, &error));
+    CHECK_NE(error.find("corrupt"), std::string::npos);
+
+    // rows + block_rows - 1 wraps, so would the block count
+    REQUIRE(hostile_header(path, ~std::uint64_t(0), 1U << 20, 1, 64, 64, 1U << 20));
+    CHECK_FALSE(in.open(path, &error));
+    CHECK_NE(error.find("corrupt"), std::string::npos);
+
+    // block_rows wider than an entry can hold
+    REQUIRE(hostile_header(path, std::uint64_t(1) << 33, std::uint64_t(1) << 32, 2, 64, 64, 0));
+    CHECK_FALSE(in.open(path, &error));
+    CHECK_NE(error.find("corrupt"), std::string::npos);
+
+    // a directory past the end of the file
+    REQUIRE(hostile_header(path, 1, 1, 1, ~std::uint64_t(0) - 7, 64, 1));
+    CHECK_FALSE(in.open(path, &error));
+    CHECK_NE(error.find("corrupt"), std::string::npos);
+
+    // an empty block inside the header is fine
+    REQUIRE(hostile_header(path, 0, 1, 0, 64, 0, 0));
+    CHECK(in.open(path, &error));
+    CHECK_EQ(in.size(), 0U);
+    in.close();
+    std::remove(path);
+}
@@ -0,0 +1,79 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <atomic>
+#include <cstdint>
+#include <fractions/counters.hpp>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace fractions;
+
+TEST_CASE("counters aggregate over threads") {
+    counters::reset();
+    counters::detail::bump(counters::Event::Reduce);
+    std::thread worker([] {
+        for (int i = 0; i != 5; ++i) {
+            counters::detail::bump(counters::Event::Reduce);
+        }
+        counters::detail::bump(counters::Event::ReduceCoprime);
+    });
+    worker.join();  // the worker's block is retired on exit
+    {
+        // a gcd of 1000 and -3 with two Euclid steps
+        const counters::detail::GcdScope scope(1000, -3);
+        counters::detail::euclid_step();
+        counters::detail::euclid_step();
+    }
+    const auto s = counters::snapshot();
+    CHECK_EQ(s[counters::Event::Reduce], 6U);
+    CHECK_EQ(s[counters::Event::ReduceCoprime], 1U);
+    CHECK_EQ(s[counters::Event::GcdCall], 1U);
+    CHECK_EQ(s.euclid_steps[2], 1U);
+    CHECK_EQ(s.operand_bits[10], 1U);
+
+    std::ostringstream os;
+    counters::report(os, s);
+    CHECK_EQ(os.str(),
+             "gcd_call 1\nreduce 6\nreduce_coprime 1\n"
+             "gcd_euclid_steps[2] 1\ngcd_operand_bits[10] 1\n");
+
+    counters::reset();
+    CHECK_EQ(counters::snapshot()[counters::Event::Reduce], 0U);
+}
+
+TEST_CASE("counters reset does not touch the blocks of running threads") {
+    std::atomic<int> stage(0);
+    std::thread worker([&stage] {
+        for (int i = 0; i != 3; ++i) {
+            counters::detail::bump(counters::Event::MulAssign);
+        }
+        stage = 1;
+        while (stage != 2) {
+            std::this_thread::yield();
+        }
+        counters::detail::bump(counters::Event::MulAssign);
+        counters::detail::bump(counters::Event::MulAssign);
+    });
+    while (stage != 1) {
+        std::this_thread::yield();
+    }
+    counters::reset();
+    CHECK_EQ(counters::snapshot()[counters::Event::MulAssign], 0U);
+    stage = 2;
+    worker.join();
+    CHECK_EQ(counters::snapshot()[counters::Event::MulAssign], 2U);
+    CHECK_EQ(std::string(counters::name(counters::Event::AccumulatorOverflow)),
+             "accumulator_overflow");
+}
+
+TEST_CASE("counters bit length") {
+    CHECK_EQ(counters::detail::bit_length(0), 0U);
+    CHECK_EQ(counters::detail::bit_length(-1), 1U);
+    CHECK_EQ(counters::detail::bit_length(std::int64_t(1) << 40), 41U);
+    CHECK_EQ(counters::detail::bit_length(~std::uint64_t(0)), 64U);
+    CHECK_EQ(counters::detail::bit_length(INT32_MIN), 32U);
+}
@@ -0,0 +1,74 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/counting_int.hpp>
+#include <fractions/fractions.hpp>
+#include <fractions/kernels.hpp>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("CountingInt arithmetic and counts") {
+    using I = CountingInt<int>;
+    reset_op_counts();
+    const I a(7), b(3);
+    CHECK_EQ((a * b).value(), 21);
+    CHECK_EQ((a / b).value(), 2);
+    CHECK_EQ((a % b).value(), 1);
+    CHECK_EQ((-a).value(), -7);
+    CHECK(b < a);
+    const auto c = op_counts();
+    CHECK_EQ(c.multiplications, 1U);
+    CHECK_EQ(c.divisions, 1U);
+    CHECK_EQ(c.modulos, 1U);
+    CHECK_EQ(c.negations, 1U);
+    CHECK_EQ(c.comparisons, 1U);
+    CHECK_EQ(c.arithmetic(), 4U);
+    reset_op_counts();
+    CHECK(op_counts() == OpCounts());
+}
+
+TEST_CASE("Fraction of CountingInt matches Fraction of int") {
+    using I = CountingInt<std::int64_t>;
+    const Fraction<I> x(I(-6), I(8)), y(I(5), I(12));
+    const Fraction<std::int64_t> u(-6, 8), v(5, 12);
+    const auto sum = x + y;
+    CHECK_EQ(sum.numer().value(), (u + v).numer());
+    CHECK_EQ(sum.denom().value(), (u + v).denom());
+    const auto quot = x / y;
+    CHECK_EQ(quot.numer().value(), (u / v).numer());
+    CHECK_EQ(quot.denom().value(), (u / v).denom());
+    CHECK_EQ(x < y, u < v);
+}
+
+TEST_CASE("operation counts are deterministic") {
+    using I = CountingInt<std::int64_t>;
+    using F = Fraction<I>;
+    const F a(I(1), I(2)), b(I(1), I(3));
+    reset_op_counts();
+    const auto s = a + b;
+    const auto add = op_counts();
+    CHECK_EQ(s.numer().value(), 5);
+    CHECK_EQ(add.multiplications, 3U);
+    CHECK_EQ(add.divisions, 2U);
+    CHECK_EQ(add.modulos, 6U);
+
+    // the common-denominator dot product needs fewer divisions than summing term by term
+    std::vector<F> x(16, F(I(1), I(6))), y(16, F(I(3), I(1)));
+    reset_op_counts();
+    const auto d = dot(x.data(), y.data(), x.size());
+    CHECK_EQ(d, F(I(8)));
+    const auto dot_counts = op_counts();
+    reset_op_counts();
+    F naive;
+    for (std::size_t i = 0; i != x.size(); ++i) {
+        naive += x[i] * y[i];
+    }
+    CHECK_EQ(naive, d);
+    const auto naive_counts = op_counts();
+    CHECK_LT(dot_counts.divisions + dot_counts.modulos,
+             naive_counts.divisions + naive_counts.modulos);
+}
@@ -0,0 +1,154 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/dispatch.hpp>
+#include <string>
+#include <vector>
+
+using namespace fractions;
+
+namespace {
+    /** The variants this CPU runs, Isa::Scalar first. */
+    auto supported() -> std::vector<dispatch::Isa> {
+        std::vector<dispatch::Isa> isas;
+        const dispatch::Isa all[] = {dispatch::Isa::Scalar, dispatch::Isa::Sse42,
+                                     dispatch::Isa::Avx2, dispatch::Isa::Avx512};
+        for (const auto isa : all) {
+            if (!(dispatch::detected() < isa)) {
+                isas.push_back(isa);
+            }
+        }
+        return isas;
+    }
+
+    /** Unnormalized fractions: signs on both terms, common factors, zeros. */
+    template <typename T> auto raw_column(std::size_t n) -> std::vector<Fraction<T>> {
+        std::vector<Fraction<T>> v(n);
+        std::uint64_t state = 7;
+        for (auto &x : v) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto k = static_cast<T>((state >> 40) % 1000) - T(500);
+            const auto d = static_cast<T>((state >> 20) % 97) - T(48);
+            const auto f = static_cast<T>(1 + (state >> 8) % 12);
+            x._numer = T(k * f);
+            x._denom = T(d * f);
+        }
+        return v;
+    }
+
+    /** Fractions with 1 to 19 digit terms, some of them long enough for the 16-byte loads. */
+    auto numbers_text(std::size_t n) -> std::string {
+        std::string text;
+        std::uint64_t state = 3;
+        for (std::size_t i = 0; i != n; ++i) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto digits = 1 + (state >> 59) % 19;
+            std::uint64_t numer = state >> 1;
+            for (auto k = digits; k < 19; ++k) {
+                numer /= 10;
+            }
+            text += (i % 3 == 0 ? "-" : i % 3 == 1 ? "+" : "") + std::to_string(numer);
+            if (i % 2 == 0) {
+                text += "/" + std::to_string(1 + (state >> 33) % 1000000007ULL);
+            }
+            text += i % 5 == 0 ? ", " : i % 7 == 0 ? "\t" : "\n";
+        }
+        return text;
+    }
+}  // namespace
+
+TEST_CASE("dispatch: names and forcing") {
+    for (const auto isa : supported()) {
+        dispatch::Isa back = dispatch::Isa::Scalar;
+        CHECK(dispatch::from_name(dispatch::name(isa), back));
+        CHECK(back == isa);
+        CHECK(dispatch::force(isa));
+        CHECK(dispatch::active() == isa);
+    }
+    dispatch::Isa isa;
+    CHECK_FALSE(dispatch::from_name("avx3", isa));
+    if (dispatch::detected() < dispatch::Isa::Avx512) {
+        std::string error;
+        const auto before = dispatch::active();
+        CHECK_FALSE(dispatch::force(dispatch::Isa::Avx512, &error));
+        CHECK_FALSE(error.empty());
+        CHECK(dispatch::active() == before);
+    }
+    dispatch::reset();
+    CHECK_FALSE(dispatch::detected() < dispatch::active());
+}
+
+TEST_CASE_TEMPLATE("dispatch: every variant reduces, compares and converts alike", T,
+                   std::int32_t, std::int64_t) {
+    const std::size_t n = 1000;
+    const auto raw = raw_column<T>(n);
+    auto expected = raw;
+    for (auto &x : expected) {
+        x.normalize();
+    }
+    std::vector<T> num, den;
+    for (const auto &x : expected) {
+        num.push_back(x.numer());
+        den.push_back(x.denom());
+    }
+    const auto c = Fraction<T>(T(-7), T(3));
+    std::vector<std::uint64_t> expected_mask((n + 63) / 64);
+    compare_mask(num.data(), den.data(), n, CompareOp::LessEqual, c, expected_mask.data());
+
+    for (const auto isa : supported()) {
+        REQUIRE(dispatch::force(isa));
+        auto x = raw;
+        dispatch::normalize_all(x.data(), n);
+        for (std::size_t i = 0; i != n; ++i) {
+            CHECK(x[i]._numer == expected[i]._numer);
+            CHECK(x[i]._denom == expected[i]._denom);
+        }
+        std::vector<std::uint64_t> mask((n + 63) / 64, ~std::uint64_t(0));
+        dispatch::compare_mask(num.data(), den.data(), n, CompareOp::LessEqual, c, mask.data());
+        CHECK(mask == expected_mask);
+        std::vector<double> out(n);
+        dispatch::to_double(expected.data(), n, out.data());
+        for (std::size_t i = 0; i != n; ++i) {
+            const auto q = to_double(expected[i]);
+            CHECK((out[i] == q || (out[i] != out[i] && q != q)));
+        }
+    }
+    dispatch::reset();
+}
+
+TEST_CASE("dispatch: every variant parses alike") {
+    const auto text = numbers_text(2000);
+    std::vector<Fraction<std::int64_t>> expected(2000);
+    std::size_t count = 0;
+    REQUIRE(dispatch::force(dispatch::Isa::Scalar));
+    REQUIRE(dispatch::parse(text.data(), text.size(), expected.data(), expected.size(), count));
+    CHECK(count == 2000);
+
+    for (const auto isa : supported()) {
+        REQUIRE(dispatch::force(isa));
+        std::vector<Fraction<std::int64_t>> out(2000);
+        CHECK(dispatch::parse(text.data(), text.size(), out.data(), out.size(), count));
+        CHECK(count == 2000);
+        for (std::size_t i = 0; i != count; ++i) {
+            CHECK(out[i]._numer == expected[i]._numer);
+            CHECK(out[i]._denom == expected[i]._denom);
+        }
+
+        std::string error;
+        const std::string bad = "1/2, 12345678901234567/3, 1234567890123456x7 5";
+        CHECK_FALSE(dispatch::parse(bad.data(), bad.size(), out.data(), out.size(), count,
+                                    &error));
+        CHECK(count == 2);
+        CHECK(out[1] == Fraction<std::int64_t>(12345678901234567LL, 3));
+        CHECK(error.find("offset 26") != std::string::npos);
+        const std::string large = "9223372036854775807 -9223372036854775808 ";
+        CHECK_FALSE(dispatch::parse(large.data(), large.size(), out.data(), out.size(), count));
+        CHECK(count == 1);
+        CHECK_FALSE(dispatch::parse(text.data(), text.size(), out.data(), 10, count, &error));
+        CHECK(count == 10);
+    }
+    dispatch::reset();
+}
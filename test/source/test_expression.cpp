@@ -0,0 +1,69 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/expression.hpp>
+
+using namespace fractions;
+
+TEST_CASE("Expression templates match eager evaluation") {
+    using F = Fraction<int>;
+    const F a(1, 2), b(2, 3), c(3, 4), d(4, 5), e(5, 6);
+    const F r = lazy(a) * b + lazy(c) * d - e;
+    CHECK_EQ(r, a * b + c * d - e);
+    CHECK_EQ(r, F(1, 10));
+
+    const F q = (lazy(a) - b) / (c + d);
+    CHECK_EQ(q, (a - b) / (c + d));
+    CHECK_EQ(F(-lazy(a) * e), -(a * e));
+    CHECK_EQ(F(lazy(F(6, 4))), F(3, 2));
+    CHECK_EQ((lazy(a) + a).eval(), F(1));
+}
+
+TEST_CASE("Expression templates exhaustive small values") {
+    using F = Fraction<int>;
+    for (int n1 = -3; n1 <= 3; ++n1) {
+        for (int d1 = 1; d1 <= 4; ++d1) {
+            for (int n2 = -3; n2 <= 3; ++n2) {
+                for (int d2 = 1; d2 <= 4; ++d2) {
+                    const F x(n1, d1), y(n2, d2), z(d1, 5);
+                    CHECK_EQ(F(lazy(x) * y + z), x * y + z);
+                    CHECK_EQ(F(lazy(x) - y * z), x - y * z);
+                    if (n2 != 0) {
+                        CHECK_EQ(F(lazy(x) / y - z), x / y - z);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("Expression templates use widened intermediates") {
+    using F = Fraction<std::int32_t>;
+    // the cleared numerator and denominator exceed 32 bits, the result does not
+    const F a(1, 65521), b(1, 65519);
+    const F r = lazy(a) * b * F(65521) * F(65519) + F(1, 3);
+    CHECK_EQ(r, F(4, 3));
+}
+
+TEST_CASE("Expression templates zero denominators") {
+    using F = Fraction<int>;
+    CHECK_EQ(F(lazy(F(1)) / F(0)), F(1, 0));
+    CHECK_EQ(F(lazy(F(-2)) / F(0)), F(-1, 0));
+    CHECK_EQ(F(lazy(F(0)) / F(0)).denom(), 0);
+}
+
+TEST_CASE("Expression templates survive overflow of the widened terms") {
+    using F = Fraction<int>;
+    // the product of the nine denominators overflows 64 bits, their lcm (720) does not
+    const F r = lazy(F(1, 720)) + F(1, 360) + F(1, 240) + F(1, 180) + F(1, 144) + F(1, 120)
+                + F(1, 90) + F(1, 80) + F(1, 72);
+    CHECK_EQ(r, F(1, 15));
+
+    // the cleared numerator of six 16-bit factors overflows 64 bits: evaluated eagerly
+    const F q = lazy(F(65520, 65521)) * F(65521, 65520) * F(65519, 65497) * F(65497, 65519)
+                * F(65479, 65449) * F(65449, 65479);
+    CHECK_EQ(q, F(1));
+}
@@ -0,0 +1,75 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/interval.hpp>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+using I = RationalInterval<std::int64_t>;
+
+TEST_CASE("RationalInterval outward rounding") {
+    const auto x = I(F(31416, 10000), 10);
+    CHECK_EQ(x.lo(), F(25, 8));
+    CHECK_EQ(x.hi(), F(22, 7));
+    CHECK(x.contains(F(31416, 10000)));
+    CHECK_EQ(I(F(1, 3), 10).width(), F(0));
+    CHECK_EQ(I(F(-31416, 10000), 10).lo(), F(-22, 7));
+}
+
+TEST_CASE("RationalInterval add and subtract") {
+    const auto x = I(F(1, 3), F(1, 2), 100);
+    const auto y = I(F(-1, 4), F(1, 5), 100);
+    CHECK_EQ(x + y, I(F(1, 12), F(7, 10), 100));
+    CHECK_EQ(x - y, I(F(2, 15), F(3, 4), 100));
+    CHECK_EQ(-y, I(F(-1, 5), F(1, 4), 100));
+}
+
+TEST_CASE("RationalInterval multiply sign cases") {
+    const auto pos = I(F(1), F(2), 100);
+    const auto neg = I(F(-3), F(-1), 100);
+    const auto mix = I(F(-1), F(4), 100);
+    CHECK_EQ(pos * pos, I(F(1), F(4), 100));
+    CHECK_EQ(pos * neg, I(F(-6), F(-1), 100));
+    CHECK_EQ(pos * mix, I(F(-2), F(8), 100));
+    CHECK_EQ(neg * pos, I(F(-6), F(-1), 100));
+    CHECK_EQ(neg * neg, I(F(1), F(9), 100));
+    CHECK_EQ(neg * mix, I(F(-12), F(3), 100));
+    CHECK_EQ(mix * pos, I(F(-2), F(8), 100));
+    CHECK_EQ(mix * neg, I(F(-12), F(3), 100));
+    CHECK_EQ(mix * I(F(-5), F(2), 100), I(F(-20), F(8), 100));
+}
+
+TEST_CASE("RationalInterval divide") {
+    const auto x = I(F(1), F(2), 100);
+    CHECK_EQ(x / I(F(-4), F(-2), 100), I(F(-1), F(-1, 4), 100));
+    const auto w = x / I(F(-1), F(1), 100);
+    CHECK_FALSE(w.is_bounded());
+    CHECK(w.contains(F(123456)));
+    CHECK_FALSE((w + x).is_bounded());
+}
+
+TEST_CASE("RationalInterval bounded term size") {
+    // x <- x^2 / 4 + 1/5 contracts towards 2 - 2 sqrt(4/5); exact Fraction
+    // arithmetic squares the denominator each step, the enclosure does not
+    const std::int64_t n = 1000;
+    auto x = I(F(1, 3), n);
+    auto exact = F(1, 3);
+    const auto quarter = I(F(1, 4), n);
+    const auto fifth = I(F(1, 5), n);
+    for (int i = 0; i != 40; ++i) {
+        x = x * x * quarter + fifth;
+        CHECK(x.lo().denom() <= n);
+        CHECK(x.hi().denom() <= n);
+        if (i < 3) {
+            exact = exact * exact * F(1, 4) + F(1, 5);
+            CHECK(x.contains(exact));
+        }
+    }
+    CHECK(F(21, 100) < x.lo());
+    CHECK(x.hi() < F(22, 100));
+    CHECK(x.width() < F(1, 100));
+}
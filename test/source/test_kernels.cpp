@@ -0,0 +1,78 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/kernels.hpp>
+#include <limits>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("fma") {
+    using F = Fraction<int>;
+    CHECK_EQ(fma(F(1, 2), F(2, 3), F(1, 6)), F(1, 2));
+    CHECK_EQ(fma(F(-3, 4), F(2, 5), F(3, 10)), F(0));
+    CHECK_EQ(fma(F(7), F(1, 7), F(-1)), F(0));
+    CHECK_EQ(fma(F(1, 6), F(1, 10), F(1, 4)), F(1, 6) * F(1, 10) + F(1, 4));
+}
+
+TEST_CASE("kernels return 0/0 on overflow") {
+    using F = Fraction<std::int32_t>;
+    const std::vector<F> x{F(1, 46337), F(1, 46349), F(1, 46351), F(1, 46381)};
+    const std::vector<F> y{F(1, 46327), F(1, 46341), F(1, 46343), F(1, 46399)};
+    const auto sum = dot(x, y);
+    CHECK(sum.numer() == 0);
+    CHECK(sum.denom() == 0);
+
+    // a block of eight products with a common denominator whose sum overflows
+    const std::vector<F> big(8, F(std::numeric_limits<std::int32_t>::min()));
+    CHECK(dot(big, big).denom() == 0);
+
+    using L = Fraction<std::int64_t>;
+    const auto r = fma(L(1, 3000000019LL), L(1, 3000000037LL), L(1, 9000000000000000041LL));
+    CHECK(r.numer() == 0);
+    CHECK(r.denom() == 0);
+}
+
+TEST_CASE("dot matches the naive loop") {
+    using F = Fraction<std::int32_t>;
+    std::vector<F> x, y;
+    for (int i = 0; i != 203; ++i) {
+        x.push_back(F(i % 7 - 3, 1 + i % 4));
+        y.push_back(F(i % 5 - 2, 1 + i % 3));
+    }
+    F expected;
+    for (std::size_t i = 0; i != x.size(); ++i) {
+        expected += x[i] * y[i];
+    }
+    CHECK_EQ(dot(x, y), expected);
+    CHECK_EQ(dot(x.data(), y.data(), 0), F(0));
+}
+
+TEST_CASE("dot with a shared denominator") {
+    using F = Fraction<std::int64_t>;
+    std::vector<F> x, y;
+    std::int64_t num = 0;
+    for (std::int64_t i = 0; i != 1001; ++i) {
+        x.push_back(F(2 * i + 1, 1024));
+        y.push_back(F(i - 500, 1024));
+        num += (2 * i + 1) * (i - 500);
+    }
+    CHECK_EQ(dot(x, y), F(num, 1024 * 1024));
+}
+
+TEST_CASE("dot on several threads") {
+    using F = Fraction<std::int32_t>;
+    const std::size_t n = 5 * detail::dot_chunk_min + 3;
+    std::vector<F> x(n), y(n);
+    for (std::size_t i = 0; i != n; ++i) {
+        const auto k = static_cast<std::int32_t>(i % 11);
+        x[i] = F(k - 5, 4);
+        y[i] = F(1, 1 + k % 3);
+    }
+    const auto serial = dot(x, y, 1);
+    CHECK_EQ(dot(x, y, 4), serial);
+    CHECK_EQ(dot(x, y, 0), serial);
+}
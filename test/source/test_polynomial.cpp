@@ -0,0 +1,86 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/polynomial.hpp>
+#include <vector>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+using P = RationalPolynomial<std::int64_t>;
+
+TEST_CASE("RationalPolynomial canonical form") {
+    const auto p = P({2, 0, 4, 0}, -6);  // (4x^2 + 2) / -6
+    CHECK_EQ(p.degree(), 2U);
+    CHECK_EQ(p.denom(), 3);
+    CHECK_EQ(p.coeffs(), std::vector<std::int64_t>{-1, 0, -2});
+    CHECK_EQ(p.coeff(2), F(-2, 3));
+    CHECK(P({0, 0}, 5).is_zero());
+}
+
+TEST_CASE("RationalPolynomial from_fractions") {
+    const auto p = P::from_fractions({F(1, 2), F(-1, 3), F(1, 6)});
+    CHECK_EQ(p, P({3, -2, 1}, 6));
+}
+
+TEST_CASE("RationalPolynomial evaluate") {
+    const auto p = P({-1, 0, 1}, 2);  // (x^2 - 1) / 2
+    CHECK_EQ(p(std::int64_t(3)), F(4));
+    CHECK_EQ(p(F(1, 2)), F(-3, 8));
+    CHECK_EQ(p(F(-2, 3)), F(-5, 18));
+    CHECK_EQ(P()(F(7, 3)), F(0));
+}
+
+TEST_CASE("RationalPolynomial batch evaluate") {
+    const auto p = P::from_fractions({F(1, 3), F(-2), F(0), F(5, 7)});
+    std::vector<F> xs;
+    for (int k = -4; k != 5; ++k) {
+        xs.push_back(F(k, 3));
+    }
+    const auto ys = p.evaluate(xs);
+    REQUIRE_EQ(ys.size(), xs.size());
+    for (std::size_t i = 0; i != xs.size(); ++i) {
+        CHECK_EQ(ys[i], p(xs[i]));
+    }
+}
+
+TEST_CASE("RationalPolynomial add and subtract") {
+    const auto p = P({1, 1}, 2);  // (x + 1) / 2
+    const auto q = P({1, 0, 1}, 3);  // (x^2 + 1) / 3
+    CHECK_EQ(p + q, P({5, 3, 2}, 6));
+    CHECK_EQ(p - p, P());
+    CHECK_EQ((p + q) - q, p);
+}
+
+TEST_CASE("RationalPolynomial multiply") {
+    const auto p = P({1, 1}, 2);
+    const auto q = P({-1, 1}, 3);
+    CHECK_EQ(p * q, P({-1, 0, 1}, 6));
+    CHECK_EQ(p * F(4, 5), P({2, 2}, 5));
+    CHECK_EQ(P({1, 2, 3}).derivative(), P({2, 6}));
+}
+
+TEST_CASE("RationalPolynomial Karatsuba matches schoolbook") {
+    std::vector<std::int64_t> a, b;
+    for (int i = 0; i != 100; ++i) {
+        a.push_back((i * 7) % 11 - 5);
+    }
+    for (int i = 0; i != 45; ++i) {
+        b.push_back((i * 5) % 9 - 4);
+    }
+    std::vector<std::int64_t> expected(a.size() + b.size() - 1, 0);
+    for (std::size_t i = 0; i != a.size(); ++i) {
+        for (std::size_t j = 0; j != b.size(); ++j) {
+            expected[i + j] += a[i] * b[j];
+        }
+    }
+    CHECK_EQ(detail::poly_mul(a, b), expected);
+    CHECK_EQ(detail::poly_mul(b, a), expected);
+
+    const auto p = P(a, 3) * P(b, 2);
+    CHECK_EQ(p(F(-1)), P(a, 3)(F(-1)) * P(b, 2)(F(-1)));
+    CHECK_EQ(p(F(1)), P(a, 3)(F(1)) * P(b, 2)(F(1)));
+}
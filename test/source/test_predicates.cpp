@@ -0,0 +1,80 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/predicates.hpp>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+using P2 = Point2<std::int64_t>;
+using P3 = Point3<std::int64_t>;
+
+TEST_CASE("BigInt arithmetic") {
+    const auto big = BigInt(INT64_MAX);
+    const auto sq = big * big;
+    CHECK_EQ(sq.bit_length(), 126U);
+    CHECK_EQ(sq - big * big, BigInt());
+    CHECK_EQ((BigInt(-5) + BigInt(3)) * BigInt(7), BigInt(-14));
+    CHECK(BigInt(-3) < BigInt(2));
+    CHECK(BigInt(-3) < BigInt(-2));
+    CHECK_EQ((-(sq * sq)).sign(), -1);
+    CHECK_EQ(BigInt(INT64_MIN) + BigInt(INT64_MAX), BigInt(-1));
+}
+
+TEST_CASE("orient2d") {
+    CHECK_EQ(orient2d(P2{F(0), F(0)}, P2{F(1), F(0)}, P2{F(0), F(1)}), 1);
+    CHECK_EQ(orient2d(P2{F(0), F(0)}, P2{F(0), F(1)}, P2{F(1), F(0)}), -1);
+    // collinear with non-representable coordinates: the filter must defer
+    const auto a = P2{F(1, 3), F(1, 7)};
+    const auto b = P2{F(2, 3), F(2, 7)};
+    const auto c = P2{F(1), F(3, 7)};
+    CHECK_EQ(orient2d(a, b, c), 0);
+    CHECK_EQ(orient2d(a, b, P2{F(1), F(3, 7) + F(1, 1000000000000LL)}), 1);
+    CHECK_EQ(orient2d(a, b, P2{F(1), F(3, 7) - F(1, 1000000000000LL)}), -1);
+}
+
+TEST_CASE("orient2d exact path agrees with filter") {
+    for (int i = 1; i != 20; ++i) {
+        for (int j = 1; j != 20; ++j) {
+            const auto a = P2{F(i, j), F(j, i + 1)};
+            const auto b = P2{F(j, 3), F(-i, 5)};
+            const auto c = P2{F(i + j, 7), F(1, i * j)};
+            CHECK_EQ(orient2d(a, b, c), detail::orient2d_exact(a, b, c));
+        }
+    }
+}
+
+TEST_CASE("orient3d") {
+    const auto a = P3{F(0), F(0), F(0)};
+    const auto b = P3{F(1), F(0), F(0)};
+    const auto c = P3{F(0), F(1), F(0)};
+    CHECK_EQ(orient3d(a, b, c, P3{F(1, 3), F(1, 3), F(-1, 9)}), 1);
+    CHECK_EQ(orient3d(a, b, c, P3{F(1, 3), F(1, 3), F(1, 9)}), -1);
+    // coplanar: all points on x + y + z = 1
+    const auto p = P3{F(1, 3), F(1, 5), F(7, 15)};
+    const auto q = P3{F(2, 7), F(3, 11), F(1) - F(2, 7) - F(3, 11)};
+    const auto r = P3{F(1, 9), F(5, 13), F(1) - F(1, 9) - F(5, 13)};
+    const auto s = P3{F(4, 17), F(1, 19), F(1) - F(4, 17) - F(1, 19)};
+    CHECK_EQ(orient3d(p, q, r, s), 0);
+    CHECK_EQ(detail::orient3d_exact(p, q, r, s), 0);
+    CHECK_EQ(orient3d(a, b, c, P3{F(1, 3), F(1, 3), F(-1, 9)}),
+             detail::orient3d_exact(a, b, c, P3{F(1, 3), F(1, 3), F(-1, 9)}));
+}
+
+TEST_CASE("incircle") {
+    const auto a = P2{F(1), F(0)};
+    const auto b = P2{F(0), F(1)};
+    const auto c = P2{F(-1), F(0)};
+    CHECK_EQ(incircle(a, b, c, P2{F(0), F(0)}), 1);
+    CHECK_EQ(incircle(a, b, c, P2{F(2), F(2)}), -1);
+    // rational points on the unit circle
+    CHECK_EQ(incircle(a, b, c, P2{F(3, 5), F(-4, 5)}), 0);
+    CHECK_EQ(incircle(a, b, c, P2{F(-5, 13), F(12, 13)}), 0);
+    const auto eps = F(1, 1000000000000000LL);
+    CHECK_EQ(incircle(a, b, c, P2{F(3, 5), F(-4, 5) + eps}), 1);
+    CHECK_EQ(incircle(a, b, c, P2{F(3, 5), F(-4, 5) - eps}), -1);
+    CHECK_EQ(detail::incircle_exact(a, b, c, P2{F(3, 5), F(-4, 5) + eps}), 1);
+}
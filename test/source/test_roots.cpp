@@ -0,0 +1,78 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/roots.hpp>
+#include <vector>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+using P = RationalPolynomial<std::int64_t>;
+
+static auto from_roots(const std::vector<F> &roots) -> P {
+    auto p = P({1});
+    for (const auto &r : roots) {
+        p *= P::from_fractions({-r, F(1)});
+    }
+    return p;
+}
+
+TEST_CASE("RealRoots rational roots") {
+    const auto roots = RealRoots<std::int64_t>(from_roots({F(-3), F(1), F(2)}));
+    REQUIRE_EQ(roots.size(), 3U);
+    for (std::size_t i = 0; i != roots.size(); ++i) {
+        CHECK(roots[i].lo <= roots[i].hi);
+    }
+    CHECK(roots[0].lo <= F(-3));
+    CHECK(F(-3) <= roots[0].hi);
+    CHECK(roots[1].hi <= roots[2].lo);
+}
+
+TEST_CASE("RealRoots exact and irrational roots") {
+    // (2x - 1)(3x + 1)(x^2 - 2)
+    const auto p = from_roots({F(1, 2), F(-1, 3)}) * P({-2, 0, 1});
+    auto roots = RealRoots<std::int64_t>(p);
+    REQUIRE_EQ(roots.size(), 4U);
+    for (std::size_t i = 0; i != roots.size(); ++i) {
+        roots.refine(i, F(1, 1000));
+        CHECK(roots[i].hi - roots[i].lo <= F(1, 1000));
+    }
+    CHECK_EQ(roots[1].lo, F(-1, 3));
+    CHECK_EQ(roots[2].lo, F(1, 2));
+    CHECK(roots[3].lo * roots[3].lo < F(2));
+    CHECK(F(2) < roots[3].hi * roots[3].hi);
+    CHECK(roots[0].lo * roots[0].lo > F(2));
+    CHECK(F(2) > roots[0].hi * roots[0].hi);
+}
+
+TEST_CASE("RealRoots multiple roots and zero") {
+    // x (x - 1)^2 (x + 2)^3
+    const auto p = from_roots({F(0), F(1), F(1), F(-2), F(-2), F(-2)});
+    const auto roots = RealRoots<std::int64_t>(p);
+    CHECK_EQ(roots.square_free().degree(), 3U);
+    REQUIRE_EQ(roots.size(), 3U);
+    CHECK(roots[1].is_exact());
+    CHECK_EQ(roots[1].lo, F(0));
+}
+
+TEST_CASE("RealRoots no real roots") {
+    CHECK_EQ(RealRoots<std::int64_t>(P({1, 0, 1})).size(), 0U);
+    CHECK_EQ(RealRoots<std::int64_t>(P({5})).size(), 0U);
+}
+
+TEST_CASE("RealRoots close roots") {
+    std::vector<F> expected;
+    for (int k = -4; k != 5; ++k) {
+        expected.push_back(F(k, 5));
+    }
+    auto roots = RealRoots<std::int64_t>(from_roots(expected));
+    REQUIRE_EQ(roots.size(), expected.size());
+    for (std::size_t i = 0; i != roots.size(); ++i) {
+        roots.refine(i, F(1, 100));
+        CHECK(roots[i].lo <= expected[i]);
+        CHECK(expected[i] <= roots[i].hi);
+    }
+}
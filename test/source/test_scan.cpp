@@ -0,0 +1,107 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/scan.hpp>
+#include <vector>
+
+using namespace fractions;
+
+namespace {
+    template <typename T> auto column(std::size_t n) -> std::vector<Fraction<T>> {
+        std::vector<Fraction<T>> v;
+        for (std::size_t i = 0; i != n; ++i) {
+            const auto k = static_cast<T>(i % 23);
+            v.push_back(Fraction<T>(T(k * 5 - 50), T(1 + k % 6)));
+        }
+        return v;
+    }
+
+    template <typename T> void check_masks(const std::vector<Fraction<T>> &v,
+                                           const Fraction<T> &c) {
+        const auto n = v.size();
+        std::vector<T> num, den;
+        for (const auto &x : v) {
+            num.push_back(x.numer());
+            den.push_back(x.denom());
+        }
+        const CompareOp ops[]
+            = {CompareOp::Less,  CompareOp::LessEqual, CompareOp::Greater,
+               CompareOp::GreaterEqual, CompareOp::Equal, CompareOp::NotEqual};
+        for (const auto op : ops) {
+            std::vector<std::uint64_t> aos((n + 63) / 64, ~std::uint64_t(0));
+            std::vector<std::uint64_t> soa((n + 63) / 64, ~std::uint64_t(0));
+            compare_mask(v.data(), n, op, c, aos.data());
+            compare_mask(num.data(), den.data(), n, op, c, soa.data());
+            CHECK_EQ(aos, soa);
+            for (std::size_t i = 0; i != n; ++i) {
+                bool expected = false;
+                switch (op) {
+                    case CompareOp::Less: expected = v[i] < c; break;
+                    case CompareOp::LessEqual: expected = v[i] <= c; break;
+                    case CompareOp::Greater: expected = v[i] > c; break;
+                    case CompareOp::GreaterEqual: expected = v[i] >= c; break;
+                    case CompareOp::Equal: expected = v[i] == c; break;
+                    case CompareOp::NotEqual: expected = v[i] != c; break;
+                }
+                CHECK_EQ(((aos[i / 64] >> (i % 64)) & 1U) == 1U, expected);
+            }
+            if (n % 64 != 0) {
+                CHECK_EQ(aos.back() >> (n % 64), 0U);
+            }
+        }
+    }
+}  // namespace
+
+TEST_CASE("compare_mask against scalar comparisons") {
+    check_masks(column<std::int32_t>(200), Fraction<std::int32_t>(17, 3));
+    check_masks(column<std::int64_t>(129), Fraction<std::int64_t>(-5, 2));
+    check_masks(column<std::int64_t>(64), Fraction<std::int64_t>(0));
+}
+
+TEST_CASE("compare_mask with infinities and nan") {
+    using F = Fraction<std::int64_t>;
+    const std::vector<F> v{F(1, 0), F(-1, 0), F(0, 0), F(6)};
+    std::uint64_t mask = 0;
+    compare_mask(v.data(), v.size(), CompareOp::Greater, F(17, 3), &mask);
+    CHECK_EQ(mask, 0x9U);
+    compare_mask(v.data(), v.size(), CompareOp::NotEqual, F(17, 3), &mask);
+    CHECK_EQ(mask, 0xBU);
+}
+
+TEST_CASE("argmin and argmax") {
+    const auto v = column<std::int32_t>(301);
+    std::size_t lo = 0, hi = 0;
+    for (std::size_t i = 1; i != v.size(); ++i) {
+        lo = v[i] < v[lo] ? i : lo;
+        hi = v[hi] < v[i] ? i : hi;
+    }
+    CHECK_EQ(argmin(v.data(), v.size()), lo);
+    CHECK_EQ(argmax(v.data(), v.size()), hi);
+    CHECK_EQ(min_value(v.data(), v.size()), v[lo]);
+    CHECK_EQ(max_value(v.data(), v.size()), v[hi]);
+
+    std::vector<std::int32_t> num, den;
+    for (const auto &x : v) {
+        num.push_back(x.numer());
+        den.push_back(x.denom());
+    }
+    CHECK_EQ(argmin(num.data(), den.data(), v.size()), lo);
+    CHECK_EQ(argmax(num.data(), den.data(), v.size()), hi);
+
+    const std::vector<Fraction<int>> small{Fraction<int>(1, 2), Fraction<int>(1, 3),
+                                           Fraction<int>(2, 6)};
+    CHECK_EQ(argmin(small.data(), small.size()), 1U);
+    CHECK_EQ(argmax(small.data(), 0), 0U);
+}
+
+TEST_CASE("compare_mask on several threads") {
+    const auto v = column<std::int64_t>(100003);
+    const Fraction<std::int64_t> c(3, 2);
+    std::vector<std::uint64_t> one((v.size() + 63) / 64), four(one.size(), ~std::uint64_t(0));
+    compare_mask(v.data(), v.size(), CompareOp::LessEqual, c, one.data());
+    compare_mask(v.data(), v.size(), CompareOp::LessEqual, c, four.data(), 4);
+    CHECK_EQ(one, four);
+}
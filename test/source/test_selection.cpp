@@ -0,0 +1,84 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <fractions/selection.hpp>
+#include <vector>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+
+namespace {
+    // values that collide as doubles: (a + k) / a for a near 2^60
+    auto near_ties(std::size_t n) -> std::vector<F> {
+        std::vector<F> v;
+        std::uint64_t seed = 12345;
+        for (std::size_t i = 0; i != n; ++i) {
+            seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+            const auto k = static_cast<std::int64_t>(seed >> 59);  // 0..31
+            if (i % 3 == 0) {
+                v.push_back(F((std::int64_t(1) << 60) + k, std::int64_t(1) << 60));
+            } else if (i % 3 == 1) {
+                v.push_back(F((std::int64_t(1) << 60) + 3 + k, (std::int64_t(1) << 60) + 3));
+            } else {
+                v.push_back(F(k - 16, 7));
+            }
+        }
+        return v;
+    }
+
+    auto sorted_copy(std::vector<F> v) -> std::vector<F> {
+        std::sort(v.begin(), v.end(), CrossLess<std::int64_t>());
+        return v;
+    }
+}  // namespace
+
+TEST_CASE("nth_element on near ties") {
+    const auto v = near_ties(500);
+    const auto ref = sorted_copy(v);
+    for (std::size_t k : {0U, 1U, 77U, 250U, 333U, 498U, 499U}) {
+        auto w = v;
+        fractions::nth_element(w.data(), w.data() + k, w.data() + w.size());
+        CHECK_EQ(w[k], ref[k]);
+        for (std::size_t i = 0; i != w.size(); ++i) {
+            if (i < k) {
+                CHECK_FALSE(CrossLess<std::int64_t>()(w[k], w[i]));
+            } else if (i > k) {
+                CHECK_FALSE(CrossLess<std::int64_t>()(w[i], w[k]));
+            }
+        }
+    }
+}
+
+TEST_CASE("partial_sort on near ties") {
+    const auto v = near_ties(300);
+    const auto ref = sorted_copy(v);
+    auto w = v;
+    fractions::partial_sort(w.data(), w.data() + 40, w.data() + w.size());
+    CHECK(std::equal(ref.begin(), ref.begin() + 40, w.begin()));
+    w = v;
+    fractions::partial_sort(w.data(), w.data() + w.size(), w.data() + w.size());
+    CHECK_EQ(w, ref);
+}
+
+TEST_CASE("nth_element with infinities") {
+    std::vector<F> w{F(1, 0), F(3), F(-1, 0), F(1, 2), F(-7, 3)};
+    fractions::nth_element(w.data(), w.data() + 4, w.data() + w.size());
+    CHECK_EQ(w[4], F(1, 0));
+    fractions::nth_element(w.data(), w.data(), w.data() + w.size());
+    CHECK_EQ(w[0], F(-1, 0));
+}
+
+TEST_CASE("nth_element parallel partitioning") {
+    const auto v = near_ties(4 * detail::partition_chunk_min + 11);
+    const auto ref = sorted_copy(v);
+    auto w = v;
+    const std::size_t k = v.size() / 3;
+    fractions::nth_element(w.data(), w.data() + k, w.data() + w.size(), 4);
+    CHECK_EQ(w[k], ref[k]);
+    CHECK(std::is_permutation(w.begin(), w.end(), v.begin()));
+}
@@ -0,0 +1,163 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/simplex.hpp>
+#include <vector>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+
+static auto wyndor() -> LinearProgram<std::int64_t> {
+    // maximize 3x + 5y s.t. x <= 4, 2y <= 12, 3x + 2y <= 18
+    LinearProgram<std::int64_t> lp(2);
+    lp.set_objective({F(3), F(5)}, true);
+    lp.add_constraint({F(1), F(0)}, ConstraintSense::LessEqual, F(4));
+    lp.add_constraint({F(0), F(2)}, ConstraintSense::LessEqual, F(12));
+    lp.add_constraint({F(3), F(2)}, ConstraintSense::LessEqual, F(18));
+    return lp;
+}
+
+TEST_CASE("solve_simplex maximize") {
+    const auto sol = solve_simplex(wyndor());
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK_EQ(sol.x[0], F(2));
+    CHECK_EQ(sol.x[1], F(6));
+    CHECK_EQ(sol.objective, F(36));
+    CHECK(sol.float_pivots > 0);
+    CHECK_EQ(sol.exact_pivots, 0U);
+}
+
+TEST_CASE("solve_simplex exact phase only") {
+    SimplexOptions opt;
+    opt.float_phase = false;
+    const auto sol = solve_simplex(wyndor(), opt);
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK_EQ(sol.objective, F(36));
+    CHECK_EQ(sol.float_pivots, 0U);
+    CHECK(sol.exact_pivots > 0);
+}
+
+TEST_CASE("solve_simplex fractional optimum with >= and = rows") {
+    // minimize x + y s.t. 3x + y >= 2, x + 3y >= 2, x - y = 0
+    LinearProgram<std::int64_t> lp(2);
+    lp.set_objective({F(1), F(1)});
+    lp.add_constraint({F(3), F(1)}, ConstraintSense::GreaterEqual, F(2));
+    lp.add_constraint({F(1), F(3)}, ConstraintSense::GreaterEqual, F(2));
+    lp.add_constraint({F(1), F(-1)}, ConstraintSense::Equal, F(0));
+    const auto sol = solve_simplex(lp);
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK_EQ(sol.x[0], F(1, 2));
+    CHECK_EQ(sol.x[1], F(1, 2));
+    CHECK_EQ(sol.objective, F(1));
+}
+
+TEST_CASE("solve_simplex thirds") {
+    // maximize x + y s.t. x + 2y <= 1, 2x + y <= 1
+    LinearProgram<std::int64_t> lp(2);
+    lp.set_objective({F(1), F(1)}, true);
+    lp.add_constraint({F(1), F(2)}, ConstraintSense::LessEqual, F(1));
+    lp.add_constraint({F(2), F(1)}, ConstraintSense::LessEqual, F(1));
+    const auto sol = solve_simplex(lp);
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK_EQ(sol.x[0], F(1, 3));
+    CHECK_EQ(sol.x[1], F(1, 3));
+    CHECK_EQ(sol.objective, F(2, 3));
+}
+
+TEST_CASE("solve_simplex negative right-hand side") {
+    // minimize x s.t. -x <= -5/2
+    LinearProgram<std::int64_t> lp(1);
+    lp.set_objective({F(1)});
+    lp.add_constraint({F(-1)}, ConstraintSense::LessEqual, F(-5, 2));
+    const auto sol = solve_simplex(lp);
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK_EQ(sol.x[0], F(5, 2));
+}
+
+TEST_CASE("solve_simplex infeasible") {
+    LinearProgram<std::int64_t> lp(1);
+    lp.set_objective({F(1)});
+    lp.add_constraint({F(1)}, ConstraintSense::LessEqual, F(1));
+    lp.add_constraint({F(1)}, ConstraintSense::GreaterEqual, F(2));
+    CHECK(solve_simplex(lp).status == LpStatus::Infeasible);
+}
+
+TEST_CASE("solve_simplex unbounded") {
+    LinearProgram<std::int64_t> lp(2);
+    lp.set_objective({F(1), F(1)}, true);
+    lp.add_constraint({F(1), F(-1)}, ConstraintSense::LessEqual, F(1));
+    CHECK(solve_simplex(lp).status == LpStatus::Unbounded);
+}
+
+TEST_CASE("solve_simplex transportation problem on a refactorized sparse basis") {
+    // 5 sources and 7 sinks; cost (3i + 5j) mod 11 + 1 per unit shipped
+    const std::size_t sources = 5, sinks = 7;
+    const std::int64_t supply[] = {30, 25, 40, 20, 35};
+    const std::int64_t demand[] = {15, 20, 25, 10, 30, 20, 30};
+    LinearProgram<std::int64_t> lp(sources * sinks);
+    std::vector<F> cost;
+    for (std::size_t i = 0; i != sources; ++i) {
+        for (std::size_t j = 0; j != sinks; ++j) {
+            cost.push_back(F(std::int64_t((3 * i + 5 * j) % 11 + 1)));
+        }
+    }
+    lp.set_objective(cost);
+    for (std::size_t i = 0; i != sources; ++i) {
+        std::vector<F> row(sources * sinks, F(0));
+        for (std::size_t j = 0; j != sinks; ++j) {
+            row[i * sinks + j] = F(1);
+        }
+        lp.add_constraint(row, ConstraintSense::LessEqual, F(supply[i]));
+    }
+    for (std::size_t j = 0; j != sinks; ++j) {
+        std::vector<F> row(sources * sinks, F(0));
+        for (std::size_t i = 0; i != sources; ++i) {
+            row[i * sinks + j] = F(1);
+        }
+        lp.add_constraint(row, ConstraintSense::Equal, F(demand[j]));
+    }
+
+    SimplexOptions opt;
+    opt.refactor_interval = 3;
+    const auto sol = solve_simplex(lp, opt);
+    REQUIRE(sol.status == LpStatus::Optimal);
+    CHECK(sol.float_pivots > 3);
+    CHECK_EQ(sol.exact_pivots, 0U);
+
+    opt.float_phase = false;
+    const auto exact = solve_simplex(lp, opt);
+    REQUIRE(exact.status == LpStatus::Optimal);
+    CHECK_EQ(sol.objective, exact.objective);
+}
+
+template <typename T> static auto tiny_coefficients() -> LinearProgram<T> {
+    // terms of 1/46327 ... 1/46399 overflow 32-bit products
+    using G = Fraction<T>;
+    LinearProgram<T> lp(3);
+    lp.set_objective({G(1, 46337), G(1, 46349), G(1, 46351)}, true);
+    lp.add_constraint({G(1, 46327), G(1, 46381), G(1, 46399)}, ConstraintSense::LessEqual, G(1));
+    lp.add_constraint({G(1, 46381), G(1, 46399), G(1, 46327)}, ConstraintSense::LessEqual, G(1));
+    lp.add_constraint({G(1, 46399), G(1, 46327), G(1, 46381)}, ConstraintSense::LessEqual, G(1));
+    return lp;
+}
+
+TEST_CASE("solve_simplex reports overflow instead of a wrong answer") {
+    CHECK(solve_simplex(tiny_coefficients<std::int32_t>()).status == LpStatus::Overflow);
+    // the optimal objective has 80-bit terms
+    CHECK(solve_simplex(tiny_coefficients<std::int64_t>()).status == LpStatus::Overflow);
+#ifdef __SIZEOF_INT128__
+    using W = detail::int128_t;
+    const auto wide = solve_simplex(tiny_coefficients<W>());
+    REQUIRE(wide.status == LpStatus::Optimal);
+    const auto x = Fraction<W>(W(99697187344213LL), W(6450251079LL));
+    for (const auto &v : wide.x) {
+        CHECK(v == x);
+    }
+    CHECK(wide.objective.numer() == W(642424987094698399LL) * W(1000000) + W(646987));
+    CHECK(wide.objective.denom() == W(642101980769178778LL) * W(1000000) + W(169877));
+#endif
+}
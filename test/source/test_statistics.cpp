@@ -0,0 +1,105 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <fractions/statistics.hpp>
+#include <vector>
+
+using namespace fractions;
+
+using F = Fraction<std::int64_t>;
+
+TEST_CASE("RunningStats mean and variance") {
+    RunningStats<std::int64_t> s;
+    for (const auto &x : {F(1, 2), F(3, 2), F(1, 3), F(-2, 3)}) {
+        s.add(x);
+    }
+    CHECK_EQ(s.count(), 4U);
+    CHECK_EQ(s.sum(), F(5, 3));
+    CHECK_EQ(s.mean(), F(5, 12));
+    // deviations 1/12, 13/12, -1/12, -13/12
+    CHECK_EQ(s.variance(), F(85, 144));
+    CHECK_EQ(s.sample_variance(), F(85, 108));
+    CHECK_EQ(RunningStats<int>().sample_variance().denom(), 0);
+}
+
+TEST_CASE("RunningStats merge and threads") {
+    std::vector<F> prices;
+    for (std::int64_t i = 0; i != 3 * detail::dot_chunk_min + 17; ++i) {
+        prices.push_back(F(1000 + (i * 37) % 501, 100));
+    }
+    RunningStats<std::int64_t> serial, left, right;
+    for (std::size_t i = 0; i != prices.size(); ++i) {
+        serial.add(prices[i]);
+        (i < 1000 ? left : right).add(prices[i]);
+    }
+    left.merge(right);
+    CHECK_EQ(left.mean(), serial.mean());
+    CHECK_EQ(left.variance(), serial.variance());
+
+    const auto par = accumulate_stats(prices.data(), prices.size(), 4);
+    CHECK_EQ(par.count(), serial.count());
+    CHECK_EQ(par.sum(), serial.sum());
+    CHECK_EQ(par.sample_variance(), serial.sample_variance());
+}
+
+TEST_CASE("RunningStats of large equal values") {
+    using G = Fraction<std::int32_t>;
+    // the squares overflow 64 bits together, the deviations from the first value are zero
+    RunningStats<std::int32_t> s, other;
+    for (int i = 0; i != 4; ++i) {
+        s.add(G(2000000000));
+        other.add(G(1999999999));
+    }
+    CHECK_EQ(s.variance(), G(0));
+    CHECK_EQ(s.mean(), G(2000000000));
+    CHECK_EQ(s.sum().denom(), 0);
+    CHECK_EQ(s.sum_of_squares().denom(), 0);
+    s.merge(other);
+    CHECK_EQ(s.variance(), G(1, 4));
+    CHECK_EQ(s.mean().denom(), 0);  // 3999999999/2
+}
+
+TEST_CASE("order_statistic and median") {
+    std::vector<F> v{F(1, 2), F(1, 3), F(2, 3), F(-1, 7), F(5, 4)};
+    CHECK_EQ(order_statistic(v.begin(), v.end(), 0), F(-1, 7));
+    CHECK_EQ(order_statistic(v.begin(), v.end(), 3), F(2, 3));
+    CHECK_EQ(median(v.begin(), v.end()), F(1, 2));
+    v.push_back(F(1, 0));
+    CHECK_EQ(order_statistic(v.begin(), v.end(), 5), F(1, 0));
+    CHECK_EQ(median(v.begin(), v.end()), F(7, 12));
+    CHECK(CrossLess<std::int64_t>()(F(-1, 0), F(-1000000)));
+    CHECK(CrossLess<std::int64_t>()(F(-1, 0), F(1, 0)));
+    CHECK_FALSE(CrossLess<std::int64_t>()(F(1, 0), F(-1, 0)));
+    CHECK_FALSE(CrossLess<std::int64_t>()(F(1, 0), F(1, 0)));
+}
+
+#ifdef __SIZEOF_INT128__
+TEST_CASE("RunningStats of millions of prices in cents") {
+    using W = detail::int128_t;
+    // 2M prices near 5000.00: the squared sums overflow 64 bits, mean and variance do not
+    const std::int64_t n = 2000000;
+    RunningStats<long long> s;
+    W sum = 0, sum_sq = 0;
+    for (std::int64_t i = 0; i != n; ++i) {
+        const auto cents = 500000 + (i * 37) % 1001 - 500;
+        s.add(Fraction<long long>(cents, 100));
+        sum += cents;
+        sum_sq += W(cents) * cents;
+    }
+    const auto reduced = [](W numer, W denom) {
+        const auto common = gcd(numer, denom);
+        return Fraction<long long>(static_cast<long long>(numer / common),
+                                   static_cast<long long>(denom / common));
+    };
+    CHECK_EQ(s.mean(), reduced(sum, W(n) * 100));
+    CHECK_EQ(s.variance(), reduced(W(n) * sum_sq - sum * sum, W(n) * n * 10000));
+    CHECK_EQ(s.sample_variance(), reduced(W(n) * sum_sq - sum * sum, W(n) * (n - 1) * 10000));
+    CHECK_GT(s.variance(), Fraction<long long>(8));
+    CHECK_LT(s.variance(), Fraction<long long>(9));
+    // the raw sum of squares is about 5e17 / 1e4 and fits once reduced
+    CHECK_EQ(s.sum_of_squares(), reduced(sum_sq, 10000));
+}
+#endif
@@ -0,0 +1,61 @@
+/*
+ *  Distributed under the MIT License (See accompanying file /LICENSE )
+ */
+#include <doctest/doctest.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <fractions/trace.hpp>
+#include <vector>
+
+using namespace fractions;
+
+TEST_CASE("trace log round trip") {
+    const char *path = "fractions_test_trace.bin";
+    REQUIRE(trace::start(path));
+    CHECK(trace::active());
+    {
+        const trace::Scope outer(trace::Op::Add, std::int64_t(-3), std::int64_t(4),
+                                 std::int64_t(1) << 40, std::int64_t(7));
+        // nested operations are part of the outer one
+        const trace::Scope inner(trace::Op::Construct, std::int64_t(1), std::int64_t(2));
+    }
+    { const trace::Scope s(trace::Op::Construct, std::int32_t(-1), std::int32_t(0)); }
+    { const trace::Scope s(trace::Op::MulInt, 5U, 6U, ~0U); }
+    trace::stop();
+    CHECK(!trace::active());
+    { const trace::Scope s(trace::Op::Sub, 1, 2, 3, 4); }  // not recording
+
+    std::vector<trace::Record> log;
+    REQUIRE(trace::read(path, log));
+    std::remove(path);
+    REQUIRE_EQ(log.size(), 3U);
+
+    CHECK(log[0].op == trace::Op::Add);
+    CHECK_EQ(log[0].type, 3);
+    CHECK_EQ(static_cast<std::int64_t>(log[0].values[0]), -3);
+    CHECK_EQ(static_cast<std::int64_t>(log[0].values[1]), 4);
+    CHECK_EQ(static_cast<std::int64_t>(log[0].values[2]), std::int64_t(1) << 40);
+    CHECK_EQ(static_cast<std::int64_t>(log[0].values[3]), 7);
+
+    CHECK(log[1].op == trace::Op::Construct);
+    CHECK_EQ(log[1].type, 2);
+    CHECK_EQ(static_cast<std::int32_t>(log[1].values[0]), -1);
+    CHECK_EQ(static_cast<std::int32_t>(log[1].values[1]), 0);
+
+    CHECK(log[2].op == trace::Op::MulInt);
+    CHECK_EQ(log[2].type, 10);
+    CHECK_EQ(static_cast<unsigned>(log[2].values[2]), ~0U);
+}
+
+TEST_CASE("trace rejects foreign files") {
+    const char *path = "fractions_test_trace.txt";
+    if (std::FILE *f = std::fopen(path, "wb")) {
+        std::fputs("not a trace", f);
+        std::fclose(f);
+    }
+    std::vector<trace::Record> log;
+    CHECK(!trace::read(path, log));
+    CHECK(!trace::read("fractions_test_missing.bin", log));
+    std::remove(path);
+}
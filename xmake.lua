@@ -3,6 +3,7 @@ set_languages("c++20")
 add_rules("mode.debug", "mode.release", "mode.coverage")
 add_requires("doctest 2.4.11", {alias = "doctest"})
 add_requires("fmt", {alias = "fmt"})
+add_requires("cxxopts", {alias = "cxxopts"})
 
 if is_mode("coverage") then
     add_cxflags("-ftest-coverage", "-fprofile-arcs", {force = true})
@@ -11,18 +12,92 @@ end
 if is_plat("linux") then
     set_warnings("all", "error")
     add_cxflags("-Wconversion", {force = true})
+    add_syslinks("pthread")
 elseif is_plat("windows") then
     add_cxflags("/W4 /WX /wd4819 /wd4996 /wd4530", {force = true})
 end
 
--- header only package
+option("explicit_instantiation")
+    set_default(false)
+    set_showmenu(true)
+    set_description("Compile Fraction<T> and the kernels for common T into a library (extern templates)")
+option_end()
+
+-- header only package, or with explicit_instantiation a static library of the instantiations
+
+target("fractions")
+    set_kind("static")
+    set_default(false)
+    add_includedirs("include", {public = true})
+    add_files("source/instantiations.cpp")
+    if has_config("explicit_instantiation") then
+        add_defines("FRACTIONS_EXTERN_TEMPLATES", {public = true})
+    end
+
+-- the fractions C++20 module, for `import fractions;` (experimental: needs GCC 14, Clang 16 or
+-- MSVC 17.4 or later; test_module imports it)
+
+target("fractions_module")
+    set_kind("static")
+    set_default(false)
+    set_policy("build.c++.modules", true)
+    add_includedirs("include", {public = true})
+    add_files("module/fractions.cppm", {public = true})
 
 target("test_frac")
     set_kind("binary")
+    if has_config("explicit_instantiation") then
+        add_deps("fractions")
+    end
     add_includedirs("include", {public = true})
-    add_files("test/source/*.cpp")
+    add_includedirs("capi/include")
+    add_files("test/source/*.cpp", "capi/source/fractions_c.cpp")
+    add_defines("FRACTIONS_C_STATIC")
     add_packages("doctest", "fmt")
 
+target("test_module")
+    set_kind("binary")
+    set_default(false)
+    set_policy("build.c++.modules", true)
+    add_deps("fractions_module")
+    add_files("test/module/import_fractions.cpp")
+
+target("fractions_c")
+    set_kind("shared")
+    set_default(false)
+    add_includedirs("include")
+    add_includedirs("capi/include", {public = true})
+    add_files("capi/source/fractions_c.cpp")
+    add_defines("FRACTIONS_C_BUILDING")
+    set_symbols("hidden")
+    set_optimize("fastest")
+
+target("bench_frac")
+    set_kind("binary")
+    if has_config("explicit_instantiation") then
+        add_deps("fractions")
+    end
+    set_default(false)
+    add_includedirs("include", {public = true})
+    add_files("benchmark/source/*.cpp")
+    add_packages("cxxopts")
+    set_optimize("fastest")
+
+target("replay_frac")
+    set_kind("binary")
+    set_default(false)
+    add_includedirs("include", {public = true})
+    add_files("benchmark/replay/main.cpp")
+    add_packages("cxxopts")
+    set_optimize("fastest")
+
+target("opcount_frac")
+    set_kind("binary")
+    set_default(false)
+    add_includedirs("include", {public = true})
+    add_files("benchmark/opcount/main.cpp")
+    add_packages("cxxopts")
+
 --
 -- If you want to known more usage about xmake, please see https://xmake.io
 --